@@ -279,6 +279,8 @@ static int demo_init(anjay_demo_t *demo,
         },
 #endif
         .confirmable_notifications = cmdline_args->confirmable_notifications,
+        .max_notifications_in_flight =
+                (size_t) cmdline_args->max_notifications_in_flight,
     };
 
     demo->connection_args = &cmdline_args->connection_args;
@@ -410,9 +412,15 @@ static socket_entry_t *create_socket_entry(anjay_demo_t *demo,
 }
 
 static void refresh_socket_entries(anjay_demo_t *demo,
-                                   AVS_LIST(socket_entry_t) *entry_ptr) {
+                                   AVS_LIST(socket_entry_t) *entry_ptr,
+                                   uint64_t *inout_generation) {
     AVS_LIST(avs_net_abstract_socket_t *const) sockets =
             anjay_get_sockets(demo->anjay);
+    uint64_t generation = anjay_get_sockets_generation(demo->anjay);
+    if (generation == *inout_generation) {
+        return;
+    }
+    bool all_added = true;
 
     AVS_LIST(avs_net_abstract_socket_t *const) socket;
     AVS_LIST_FOREACH(socket, sockets) {
@@ -430,6 +438,8 @@ static void refresh_socket_entries(anjay_demo_t *demo,
         if (new_entry) {
             AVS_LIST_INSERT(entry_ptr, new_entry);
             entry_ptr = AVS_LIST_NEXT_PTR(entry_ptr);
+        } else {
+            all_added = false;
         }
     }
     while (*entry_ptr) {
@@ -437,15 +447,20 @@ static void refresh_socket_entries(anjay_demo_t *demo,
         iosched_entry_remove(demo->iosched, (*entry_ptr)->iosched_entry);
         AVS_LIST_DELETE(entry_ptr);
     }
+    if (all_added) {
+        // otherwise, retry during the next iteration
+        *inout_generation = generation;
+    }
 }
 
 static void serve(anjay_demo_t *demo) {
     AVS_LIST(socket_entry_t) socket_entries = NULL;
+    uint64_t sockets_generation = 0;
 
     avs_time_real_t last_time = avs_time_real_now();
 
     while (demo->running) {
-        refresh_socket_entries(demo, &socket_entries);
+        refresh_socket_entries(demo, &socket_entries, &sockets_generation);
         demo_log(TRACE, "number of sockets to poll: %u",
                  (unsigned) AVS_LIST_SIZE(socket_entries));
 
@@ -157,6 +157,9 @@ static void print_option_help(const struct option *opt) {
           "Send notifications as Confirmable messages by default" },
         { 1, "PATH", DEFAULT_CMDLINE_ARGS.fw_updated_marker_path,
           "File path to use as a marker for persisting firmware update state" },
+        { 2, "COUNT", "0",
+          "Maximum number of Confirmable notifications awaiting "
+          "acknowledgement at once. 0 sends them one by one, blocking." },
     };
 
     int description_offset = 25;
@@ -342,6 +345,7 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
         { "cache-size",                 required_argument, 0, '$' },
         { "confirmable-notifications",  no_argument,       0, 'N' },
         { "fw-updated-marker-path",     required_argument, 0, 1 },
+        { "max-notifications-in-flight", required_argument, 0, 2 },
         { 0, 0, 0, 0 }
     };
     int num_servers = 0;
@@ -518,6 +522,12 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
         case 1:
             parsed_args->fw_updated_marker_path = optarg;
             break;
+        case 2:
+            if (parse_i32(optarg, &parsed_args->max_notifications_in_flight)
+                    || parsed_args->max_notifications_in_flight < 0) {
+                goto error;
+            }
+            break;
         case 0:
             goto finish;
         }
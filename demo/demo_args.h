@@ -39,6 +39,7 @@ typedef struct cmdline_args {
     int32_t outbuf_size;
     int32_t msg_cache_size;
     bool confirmable_notifications;
+    int32_t max_notifications_in_flight;
     const char *fw_updated_marker_path;
 } cmdline_args_t;
 
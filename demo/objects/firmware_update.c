@@ -79,6 +79,8 @@ typedef struct fw_repr {
     char package_uri[256];
 
     char next_target_path[256];
+    // open while a package is being written part by part
+    FILE *package_part_file;
     const char *fw_updated_marker;
 } fw_repr_t;
 
@@ -726,6 +728,90 @@ static int fw_write(anjay_t *anjay,
     }
 }
 
+static void close_package_part_file(fw_repr_t *fw) {
+    if (fw->package_part_file) {
+        fclose(fw->package_part_file);
+        fw->package_part_file = NULL;
+    }
+}
+
+static int begin_package_parts(anjay_t *anjay,
+                               fw_repr_t *fw) {
+    if (fw->state == UPDATE_STATE_DOWNLOADING && !fw->package_part_file) {
+        demo_log(ERROR, "cannot set Package resource while downloading");
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    } else if (fw->state == UPDATE_STATE_DOWNLOADED) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+
+    // a package written anew discards the unfinished one, if any
+    close_package_part_file(fw);
+    if (maybe_create_firmware_file(fw)) {
+        return -1;
+    }
+
+    demo_log(INFO, "writing package to %s part by part",
+             fw->next_target_path);
+    if (!(fw->package_part_file = fopen(fw->next_target_path, "wb"))) {
+        demo_log(ERROR, "could not open file: %s", fw->next_target_path);
+        return -1;
+    }
+    set_update_result(anjay, fw, UPDATE_RESULT_INITIAL);
+    set_state(anjay, fw, UPDATE_STATE_DOWNLOADING);
+    return 0;
+}
+
+static int fw_write_part(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         size_t offset,
+                         const void *data,
+                         size_t data_size,
+                         bool last) {
+    (void) iid;
+
+    fw_repr_t *fw = get_fw(obj_ptr);
+    if (rid != FW_RES_PACKAGE) {
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+
+    int result;
+    if (offset == 0 && (result = begin_package_parts(anjay, fw))) {
+        return result;
+    } else if (!fw->package_part_file) {
+        demo_log(ERROR, "Package part at offset %lu does not continue any "
+                 "write", (unsigned long) offset);
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+
+    if (fwrite(data, 1, data_size, fw->package_part_file) != data_size) {
+        demo_log(ERROR, "fwrite failed");
+        close_package_part_file(fw);
+        maybe_delete_firmware_file(fw);
+        set_state(anjay, fw, UPDATE_STATE_IDLE);
+        set_update_result(anjay, fw, UPDATE_RESULT_NOT_ENOUGH_SPACE);
+        return ANJAY_ERR_INTERNAL;
+    }
+
+    if (last) {
+        close_package_part_file(fw);
+        demo_log(INFO, "write finished, %lu B written",
+                 (unsigned long) (offset + data_size));
+        // unpack_firmware_in_place/validate_firmware result deliberately not
+        // propagated up: write itself succeeded
+        if (unpack_firmware_in_place(fw)) {
+            set_state(anjay, fw, UPDATE_STATE_IDLE);
+            set_update_result(anjay, fw,
+                              UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE);
+            maybe_delete_firmware_file(fw);
+        } else if (validate_firmware(anjay, fw)) {
+            maybe_delete_firmware_file(fw);
+        }
+    }
+    return 0;
+}
+
 static int create_update_marker_file(fw_repr_t *fw) {
     FILE *f = fopen(fw->fw_updated_marker, "w");
     if (!f) {
@@ -842,7 +928,8 @@ static const anjay_dm_object_def_t FIRMWARE_UPDATE = {
         .transaction_begin = anjay_dm_transaction_NOOP,
         .transaction_validate = anjay_dm_transaction_NOOP,
         .transaction_commit = anjay_dm_transaction_NOOP,
-        .transaction_rollback = anjay_dm_transaction_NOOP
+        .transaction_rollback = anjay_dm_transaction_NOOP,
+        .resource_write_part = fw_write_part
     }
 };
 
@@ -894,6 +981,7 @@ firmware_update_object_create(iosched_t *iosched,
 void firmware_update_object_release(const anjay_dm_object_def_t **def) {
     if (def) {
         fw_repr_t *fw = get_fw(def);
+        close_package_part_file(fw);
         maybe_delete_firmware_file(fw);
         free(fw);
     }
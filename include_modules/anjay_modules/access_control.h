@@ -0,0 +1,45 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_ACCESS_CONTROL_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_ACCESS_CONTROL_H
+#include <anjay/core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef WITH_ACCESS_CONTROL
+
+/**
+ * Drops the Access Control lookup cache, so that it is rebuilt from the data
+ * model on the next access check.
+ *
+ * The cache is invalidated automatically whenever a change to Object 2 is
+ * passed through the notification queue. Access Control implementations need
+ * to call this function only if their state changes in some other way, e.g.
+ * when restoring persisted data.
+ */
+void _anjay_access_control_cache_invalidate(anjay_t *anjay);
+
+#else // WITH_ACCESS_CONTROL
+
+#define _anjay_access_control_cache_invalidate(...) ((void) 0)
+
+#endif // WITH_ACCESS_CONTROL
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_ACCESS_CONTROL_H */
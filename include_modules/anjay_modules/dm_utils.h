@@ -272,6 +272,21 @@ int _anjay_dm_resource_dim(anjay_t *anjay,
                            anjay_iid_t iid,
                            anjay_rid_t rid,
                            const anjay_dm_module_t *current_module);
+int _anjay_dm_resource_version(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               uint64_t *out_version,
+                               const anjay_dm_module_t *current_module);
+int _anjay_dm_resource_write_part(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  size_t offset,
+                                  const void *data,
+                                  size_t data_size,
+                                  bool last,
+                                  const anjay_dm_module_t *current_module);
 int _anjay_dm_resource_read_attrs(anjay_t *anjay,
                                   const anjay_dm_object_def_t *const *obj_ptr,
                                   anjay_iid_t iid,
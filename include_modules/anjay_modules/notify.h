@@ -30,6 +30,10 @@ typedef struct {
     // NOTE: known_{added,removed}_iids lists may not be exhaustive
     AVS_LIST(anjay_iid_t) known_added_iids;
     AVS_LIST(anjay_iid_t) known_removed_iids;
+    // last elements of the lists above, or NULL if empty; these allow
+    // appending in O(1) and MUST only be modified by the notify queue code
+    anjay_iid_t *known_added_iids_last;
+    anjay_iid_t *known_removed_iids_last;
 } anjay_notify_queue_instance_entry_t;
 
 typedef struct {
@@ -41,6 +45,9 @@ typedef struct {
     anjay_oid_t oid;
     anjay_notify_queue_instance_entry_t instance_set_changes;
     AVS_LIST(anjay_notify_queue_resource_entry_t) resources_changed;
+    // last element of resources_changed, or NULL if empty; see
+    // anjay_notify_queue_instance_entry_t::known_added_iids_last
+    anjay_notify_queue_resource_entry_t *resources_changed_last;
 } anjay_notify_queue_object_entry_t;
 
 typedef AVS_LIST(anjay_notify_queue_object_entry_t) anjay_notify_queue_t;
@@ -84,6 +91,13 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
                                         anjay_iid_t iid,
                                         anjay_rid_t rid);
 
+/**
+ * Removes all notifications about changes of Resources within the Object
+ * Instance specified by <c>oid</c> and <c>iid</c>.
+ */
+void _anjay_notify_queue_remove_instance_resources(
+        anjay_notify_queue_t *queue, anjay_oid_t oid, anjay_iid_t iid);
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue);
 
 int _anjay_notify_instance_created(anjay_t *anjay,
@@ -72,6 +72,33 @@ void anjay_smsdrv_cleanup(anjay_smsdrv_t **smsdrv_ptr);
         /* .max_retransmit = */ 0          \
     }
 
+/**
+ * Default size of the per-server buffer for notifications that are queued for
+ * sending, used if @ref anjay_configuration_t::stored_notifications_buffer_size
+ * is 0.
+ */
+#define ANJAY_DEFAULT_STORED_NOTIFICATIONS_BUFFER_SIZE 16384
+
+/**
+ * Policy used when a new notification needs to be queued, but the stored
+ * notifications buffer is full.
+ */
+typedef enum {
+    /** Oldest queued notifications are discarded until the new one fits. */
+    ANJAY_NOTIFICATION_OVERFLOW_DROP_OLDEST,
+    /** The newest queued value for the same observation is replaced with the
+     * new one - in place, if possible. If the observation has no queued
+     * values or it is still not enough, oldest notifications are discarded
+     * like with @ref ANJAY_NOTIFICATION_OVERFLOW_DROP_OLDEST . */
+    ANJAY_NOTIFICATION_OVERFLOW_COALESCE
+} anjay_notification_overflow_policy_t;
+
+/**
+ * Callback used to wake up the event loop of the thread that runs Anjay, see
+ * @ref anjay_configuration_t::notify_wakeup_cb .
+ */
+typedef void anjay_notify_wakeup_cb_t(void *arg);
+
 typedef struct anjay_configuration {
     /** Endpoint name as presented to the LwM2M server. If not set, defaults
      * to ANJAY_DEFAULT_ENDPOINT_NAME. */
@@ -145,6 +172,69 @@ typedef struct anjay_configuration {
      * messages by default. */
     bool confirmable_notifications;
 
+    /**
+     * Maximum number of Confirmable notifications that may await
+     * acknowledgement at the same time on a single server connection (NSTART,
+     * as per RFC 7252). Non-confirmable notifications are not limited by it.
+     *
+     * If 0, queued notifications are sent one by one and each Confirmable
+     * notification blocks until it is acknowledged or times out. Otherwise,
+     * notifications are pipelined: their acknowledgements are handled by
+     * @ref anjay_serve and retransmissions are performed by
+     * @ref anjay_sched_run, so the application must call both of them
+     * regularly.
+     */
+    size_t max_notifications_in_flight;
+
+    /**
+     * Size, in bytes, of the buffer allocated for each server connection to
+     * hold notifications that have been generated but not sent yet, e.g.
+     * because the server is offline and Notification Storing is enabled.
+     *
+     * If 0, @ref ANJAY_DEFAULT_STORED_NOTIFICATIONS_BUFFER_SIZE is used. The
+     * buffer is always large enough to hold at least a single notification of
+     * the maximum supported size.
+     *
+     * Memory of discarded values, up to the same size in total, is kept for
+     * reuse instead of being freed, so that storing new values does not
+     * normally require allocations.
+     */
+    size_t stored_notifications_buffer_size;
+
+    /** Controls what happens when a notification needs to be queued, but the
+     * stored notifications buffer is full. */
+    anjay_notification_overflow_policy_t notification_overflow_policy;
+
+    /**
+     * If set to true, a new value of an observed path replaces the value for
+     * the same observation that is still waiting to be sent, instead of being
+     * queued after it - only the latest value is ever delivered. The relative
+     * order of notifications for different observations is preserved.
+     *
+     * This is useful for servers that are only interested in the current
+     * state, e.g. after a period of being offline with Notification Storing
+     * enabled.
+     */
+    bool coalesce_notifications;
+
+    /**
+     * Called by @ref anjay_notify_changed_threadsafe, from the thread calling
+     * it, when there were no other changes waiting to be processed. It is
+     * meant to wake up the event loop of the thread that runs Anjay, e.g. by
+     * writing to a pipe or eventfd polled along with the sockets returned by
+     * @ref anjay_get_sockets , so that @ref anjay_sched_run is called soon.
+     *
+     * May be NULL, in which case changes are processed during the first
+     * @ref anjay_sched_run call after the event loop wakes up for other
+     * reasons.
+     *
+     * NOTE: Only used if Anjay is compiled with WITH_THREAD_SAFE_NOTIFY.
+     */
+    anjay_notify_wakeup_cb_t *notify_wakeup_cb;
+
+    /** Opaque argument passed to @ref notify_wakeup_cb . */
+    void *notify_wakeup_arg;
+
     /** Specifies the cellular modem driver to use, enabling the SMS transport
      * if not NULL.
      *
@@ -231,6 +321,40 @@ void anjay_delete(anjay_t *anjay);
  */
 AVS_LIST(avs_net_abstract_socket_t *const) anjay_get_sockets(anjay_t *anjay);
 
+/**
+ * Returns a counter that is incremented each time the contents of the list
+ * returned by @ref anjay_get_sockets change.
+ *
+ * The list returned by @ref anjay_get_sockets is updated in place. If the
+ * value returned by this function did not change since the previous call to
+ * @ref anjay_get_sockets , the list contains exactly the same sockets as
+ * before. Applications that keep the sockets registered in an external event
+ * loop (e.g. epoll) do not need to examine the list again in such case.
+ *
+ * @code
+ * uint64_t last_generation = 0;
+ *
+ * while (true) {
+ *     AVS_LIST(avs_net_abstract_socket_t *const) sockets =
+ *             anjay_get_sockets(anjay);
+ *     uint64_t generation = anjay_get_sockets_generation(anjay);
+ *     if (generation != last_generation) {
+ *         // synchronize the event loop with the sockets list
+ *         last_generation = generation;
+ *     }
+ *     // wait for events and call anjay_serve() / anjay_sched_run()
+ * }
+ * @endcode
+ *
+ * The counter is 0 for a newly created Anjay object, which corresponds to an
+ * empty list of sockets.
+ *
+ * @param anjay Anjay object to operate on.
+ *
+ * @returns Current generation of the list of sockets.
+ */
+uint64_t anjay_get_sockets_generation(anjay_t *anjay);
+
 /**
  * Reads a message from given @p ready_socket and handles it appropriately.
  *
@@ -243,6 +367,29 @@ AVS_LIST(avs_net_abstract_socket_t *const) anjay_get_sockets(anjay_t *anjay);
 int anjay_serve(anjay_t *anjay,
                 avs_net_abstract_socket_t *ready_socket);
 
+/**
+ * Works like @ref anjay_serve , but after handling the first message, also
+ * handles all further messages that are already waiting on @p ready_socket,
+ * without blocking. Preparing the connection for communication and
+ * rescheduling of the queue mode socket closing is performed once for the
+ * whole batch, which makes it cheaper to handle bursts of requests.
+ *
+ * For sockets used for downloads, only a single packet is handled.
+ *
+ * @param anjay        Anjay object to operate on.
+ * @param ready_socket A socket to read the messages from.
+ * @param max_messages Maximum number of messages to handle in a single call,
+ *                     to prevent starvation of other sockets and scheduler
+ *                     jobs. Values lower than 1 are treated as 1.
+ *
+ * @returns 0 on success, a negative value if handling any of the messages
+ *          failed. Note that it includes non-fatal errors, such as receiving
+ *          a malformed packet.
+ */
+int anjay_serve_many(anjay_t *anjay,
+                     avs_net_abstract_socket_t *ready_socket,
+                     size_t max_messages);
+
 /** Short Server ID type. */
 typedef uint16_t anjay_ssid_t;
 
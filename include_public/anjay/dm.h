@@ -445,6 +445,48 @@ typedef int anjay_dm_resource_write_t(anjay_t *anjay,
                                       anjay_rid_t rid,
                                       anjay_input_ctx_t *ctx);
 
+/**
+ * A handler that writes a part of an opaque Resource value. It is optional; if
+ * it is implemented, Write requests with an application/octet-stream payload
+ * addressed directly to the Resource, that are too large to be buffered in
+ * memory (see the MAX_BLOCK1_REQUEST_SIZE compile-time option), are passed to
+ * it block by block as the blocks arrive, instead of being received
+ * synchronously and passed to @ref anjay_dm_resource_write_t .
+ *
+ * Parts are always passed in order. The LwM2M Server may abandon the transfer
+ * at any point, in which case the handler is never called with @p last set to
+ * true. A part with @p offset equal to 0 starts a new value; any unfinished one
+ * shall be discarded then.
+ *
+ * Unlike @ref anjay_dm_resource_write_t , this handler is not called within
+ * a transaction.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param obj_ptr   Object definition pointer, as passed to
+ *                  @ref anjay_register_object .
+ * @param iid       Object Instance ID.
+ * @param rid       Resource ID.
+ * @param offset    Offset of @p data within the whole Resource value.
+ * @param data      Next part of the Resource value.
+ * @param data_size Number of bytes in @p data.
+ * @param last      true if @p data is the final part of the Resource value.
+ *
+ * @returns This handler should return:
+ * - 0 on success,
+ * - a negative value in case of error, which aborts the transfer. If it returns
+ *   one of ANJAY_ERR_ constants, the response message will have an appropriate
+ *   CoAP response code. Otherwise, the device will respond with an unspecified
+ *   (but valid) error code.
+ */
+typedef int anjay_dm_resource_write_part_t(anjay_t *anjay,
+                                           const anjay_dm_object_def_t *const *obj_ptr,
+                                           anjay_iid_t iid,
+                                           anjay_rid_t rid,
+                                           size_t offset,
+                                           const void *data,
+                                           size_t data_size,
+                                           bool last);
+
 /**
  * A handler that performs the Execute action on given Resource.
  *
@@ -495,6 +537,30 @@ typedef int anjay_dm_resource_dim_t(anjay_t *anjay,
                                     anjay_iid_t iid,
                                     anjay_rid_t rid);
 
+/**
+ * A handler that returns a version tag of the Resource value, which shall
+ * change whenever the value changes. It is optional; if it is implemented,
+ * the library uses it to avoid reading and serializing values of observed
+ * Resources that have not changed since they were last read.
+ *
+ * @param      anjay       Anjay object to operate on.
+ * @param      obj_ptr     Object definition pointer, as passed to
+ *                         @ref anjay_register_object .
+ * @param      iid         Object Instance ID.
+ * @param      rid         Resource ID.
+ * @param[out] out_version Current version of the Resource value.
+ *
+ * @returns This handler should return:
+ * - 0 on success,
+ * - a negative value if the version cannot be determined, in which case the
+ *   value is read as usual.
+ */
+typedef int anjay_dm_resource_version_t(anjay_t *anjay,
+                                        const anjay_dm_object_def_t *const *obj_ptr,
+                                        anjay_iid_t iid,
+                                        anjay_rid_t rid,
+                                        uint64_t *out_version);
+
 /**
  * A handler that returns Resource attributes.
  *
@@ -702,6 +768,11 @@ typedef struct {
     anjay_dm_transaction_commit_t *transaction_commit;
     /** Rollback changes made in a transaction, @ref anjay_dm_transaction_rollback_t */
     anjay_dm_transaction_rollback_t *transaction_rollback;
+
+    /** Get version of the Resource value, @ref anjay_dm_resource_version_t */
+    anjay_dm_resource_version_t *resource_version;
+    /** Set a part of an opaque Resource value, @ref anjay_dm_resource_write_part_t */
+    anjay_dm_resource_write_part_t *resource_write_part;
 } anjay_dm_handlers_t;
 
 /** A simple array-plus-size container for a list of supported Resource IDs. */
@@ -796,6 +867,38 @@ int anjay_notify_changed(anjay_t *anjay,
  */
 int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid);
 
+/**
+ * Variant of @ref anjay_notify_changed that may be called from any thread,
+ * concurrently with other calls to this function and with the thread that
+ * runs Anjay.
+ *
+ * The change is pushed onto a lock-free queue and processed during the next
+ * @ref anjay_sched_run call, with repeated changes to the same Resource
+ * reported only once. @ref anjay_sched_time_to_next reports zero delay while
+ * such changes are pending, and
+ * @ref anjay_configuration_t::notify_wakeup_cb is called to wake up an event
+ * loop that is waiting for network traffic.
+ *
+ * This function never logs, as log handlers are not required to be
+ * thread-safe. Changes that could not be queued by @ref anjay_sched_run, e.g.
+ * due to lack of memory, are kept and retried during the next call.
+ *
+ * NOTE: This function is only available if Anjay is compiled with
+ * WITH_THREAD_SAFE_NOTIFY. Otherwise it always fails.
+ *
+ * @param anjay Anjay object to operate on. It MUST NOT be deleted while any
+ *              call to this function is in progress.
+ * @param oid   Object ID of the changed Resource.
+ * @param iid   Object Instance ID of the changed Resource.
+ * @param rid   Resource ID of the changed Resource.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_notify_changed_threadsafe(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid);
+
 /**
  * Registers the Object in the data model, making it available for RPC calls.
  *
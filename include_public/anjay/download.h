@@ -28,7 +28,10 @@
 extern "C" {
 #endif
 
-/** CoAP Entity Tag. */
+/**
+ * Entity Tag of the downloaded resource. For HTTP transfers, ETags longer than
+ * 8 bytes are represented by a hash of their value.
+ */
 typedef struct {
     uint8_t size;
     uint8_t value[8];
@@ -60,6 +63,33 @@ typedef int anjay_download_next_block_handler_t(anjay_t *anjay,
                                                 const anjay_etag_t *etag,
                                                 void *user_data);
 
+/**
+ * Called during the download to let the application persist the transfer
+ * progress, e.g. in non-volatile memory. If the download gets interrupted,
+ * e.g. by a reboot, it may be continued by passing @p offset and @p etag as
+ * @ref anjay_download_config_t#start_offset and
+ * @ref anjay_download_config_t#etag to @ref anjay_download .
+ *
+ * It is guaranteed that all data up to @p offset has already been passed to
+ * @ref anjay_download_config_t#on_next_block , which returned success.
+ *
+ * @param anjay     Anjay object managing the download process.
+ * @param offset    Number of bytes of the resource downloaded so far.
+ * @param etag      ETag of the downloaded resource.
+ * @param user_data Value of @ref anjay_download_config_t#user_data passed
+ *                  to @ref anjay_download .
+ *
+ * @return Should return:
+ *         @li 0 on success,
+ *         @li a nonzero value if an error occurred, in which case the
+ *             download will be terminated with @ref ANJAY_DOWNLOAD_ERR_FAILED
+ *             result.
+ */
+typedef int anjay_download_checkpoint_handler_t(anjay_t *anjay,
+                                                size_t offset,
+                                                const anjay_etag_t *etag,
+                                                void *user_data);
+
 typedef enum anjay_download_result {
     /** Download finished successfully. */
     ANJAY_DOWNLOAD_FINISHED,
@@ -86,19 +116,24 @@ typedef void anjay_download_finished_handler_t(anjay_t *anjay,
                                                void *user_data);
 
 typedef struct anjay_download_config {
-    /** Required. coap:// or coaps:// URL */
+    /** Required. coap://, coaps://, http:// or https:// URL */
     const char *url;
 
     /**
      * If the download gets interrupted for some reason, and the client
      * is aware of how much data it managed to successfully download,
      * it can resume the transfer from a specific offset.
+     *
+     * @ref anjay_download_config_t#on_checkpoint may be used to keep track
+     * of that offset.
      */
     size_t start_offset;
 
     /**
      * If start_offset is not 0, etag should be set to a value returned
-     * by the server during the transfer before it got interrupted.
+     * by the server during the transfer before it got interrupted. If the
+     * resource changed since then, the download fails with
+     * @ref ANJAY_DOWNLOAD_ERR_EXPIRED result.
      */
     anjay_etag_t etag;
 
@@ -108,6 +143,22 @@ typedef struct anjay_download_config {
     /** Required. Called after the download is finished or aborted. */
     anjay_download_finished_handler_t *on_download_finished;
 
+    /**
+     * Optional. Called after each @p checkpoint_interval bytes passed to
+     * @ref anjay_download_config_t#on_next_block .
+     *
+     * Not called for HTTP responses with a Content-Encoding other than
+     * identity, as such transfers cannot be resumed.
+     */
+    anjay_download_checkpoint_handler_t *on_checkpoint;
+
+    /**
+     * Minimum number of bytes downloaded between subsequent calls to
+     * @ref anjay_download_config_t#on_checkpoint . 0 means that it is called
+     * after every chunk of data.
+     */
+    size_t checkpoint_interval;
+
     /** Opaque pointer passed to download handlers. */
     void *user_data;
 
@@ -116,6 +167,18 @@ typedef struct anjay_download_config {
      * ignored for coap:// transfers.
      */
     avs_net_security_info_t security_info;
+
+    /**
+     * Maximum number of BLOCK2 requests that may be awaiting a response at the
+     * same time during a coap:// or coaps:// transfer. Blocks received out of
+     * order are buffered, so @ref anjay_download_config_t#on_next_block is
+     * still called with consecutive chunks of data. The buffer needs space for
+     * up to <c>coap_window_size</c> blocks.
+     *
+     * 0 or 1 means that each block is requested only after receiving the
+     * previous one. Ignored for HTTP transfers.
+     */
+    size_t coap_window_size;
 } anjay_download_config_t;
 
 typedef void *anjay_download_handle_t;
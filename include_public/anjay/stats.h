@@ -51,6 +51,53 @@ uint64_t anjay_get_num_incoming_retransmissions(anjay_t *anjay);
  */
 uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay);
 
+/**
+ * @returns the number of Observe notifications sent by the client, not
+ *          counting retransmissions.
+ *
+ * NOTE: When WITH_NET_STATS or WITH_OBSERVE is disabled this function always
+ * return 0.
+ */
+uint64_t anjay_get_num_notifications_sent(anjay_t *anjay);
+
+/**
+ * @returns the number of Confirmable Observe notifications sent by the client
+ *          that were acknowledged by the server.
+ *
+ * NOTE: When WITH_NET_STATS or WITH_OBSERVE is disabled this function always
+ * return 0.
+ */
+uint64_t anjay_get_num_notifications_acknowledged(anjay_t *anjay);
+
+/**
+ * @returns the number of Observe notifications currently queued for sending,
+ *          e.g. stored while the server is offline, summed over all servers.
+ *
+ * NOTE: When WITH_NET_STATS or WITH_OBSERVE is disabled this function always
+ * return 0.
+ */
+uint64_t anjay_get_num_stored_notifications(anjay_t *anjay);
+
+/**
+ * @returns the number of bytes of the stored notifications buffers occupied by
+ *          notifications currently queued for sending, summed over all
+ *          servers.
+ *
+ * NOTE: When WITH_NET_STATS or WITH_OBSERVE is disabled this function always
+ * return 0.
+ */
+uint64_t anjay_get_stored_notifications_size(anjay_t *anjay);
+
+/**
+ * @returns the number of queued Observe notifications that were discarded or
+ *          replaced with newer values because the stored notifications buffer
+ *          was full.
+ *
+ * NOTE: When WITH_NET_STATS or WITH_OBSERVE is disabled this function always
+ * return 0.
+ */
+uint64_t anjay_get_num_dropped_notifications(anjay_t *anjay);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
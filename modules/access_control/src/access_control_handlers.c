@@ -84,6 +84,10 @@ static int ac_instance_reset(anjay_t *anjay,
     if (!inst) {
         return ANJAY_ERR_NOT_FOUND;
     }
+    int result = _anjay_access_control_save_instance(access_control, inst);
+    if (result) {
+        return result;
+    }
     AVS_LIST_CLEAR(&inst->acl);
     inst->has_acl = false;
     inst->owner = 0;
@@ -132,8 +136,7 @@ static int ac_instance_remove(anjay_t *anjay,
     AVS_LIST(access_control_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &access_control->current.instances) {
         if ((*it)->iid == iid) {
-            AVS_LIST_CLEAR(&(*it)->acl);
-            AVS_LIST_DELETE(it);
+            _anjay_access_control_detach_instance(access_control, it);
             return 0;
         } else if ((*it)->iid > iid) {
             break;
@@ -277,6 +280,10 @@ static int ac_resource_write(anjay_t *anjay,
     if (!inst) {
         return ANJAY_ERR_NOT_FOUND;
     }
+    int result = _anjay_access_control_save_instance(access_control, inst);
+    if (result) {
+        return result;
+    }
 
     switch (rid) {
     case ANJAY_DM_RID_ACCESS_CONTROL_OID: {
@@ -398,8 +405,7 @@ static int remove_ac_instance_by_target(anjay_t *anjay,
                             ANJAY_DM_OID_ACCESS_CONTROL, (*it)->iid)) {
                 return -1;
             }
-            AVS_LIST_CLEAR(&(*it)->acl);
-            AVS_LIST_DELETE(it);
+            _anjay_access_control_detach_instance(ac, it);
         }
     }
     return 0;
@@ -502,10 +508,9 @@ static int sync_on_notify(anjay_t *anjay,
 static int ac_transaction_begin(anjay_t *anjay, obj_ptr_t obj_ptr) {
     (void) anjay;
     access_control_t *ac = _anjay_access_control_from_obj_ptr(obj_ptr);
-    if (_anjay_access_control_clone_state(&ac->saved_state, &ac->current)) {
-        ac_log(ERROR, "Out of memory");
-        return ANJAY_ERR_INTERNAL;
-    }
+    assert(!ac->saved_state.instances);
+    assert(!ac->created_iids);
+    ac->in_transaction = true;
     return 0;
 }
 
@@ -643,7 +648,7 @@ finish:
 static int ac_transaction_commit(anjay_t *anjay, obj_ptr_t obj_ptr) {
     (void) anjay;
     access_control_t *ac = _anjay_access_control_from_obj_ptr(obj_ptr);
-    _anjay_access_control_clear_state(&ac->saved_state);
+    _anjay_access_control_transaction_commit(ac);
     ac->needs_validation = false;
     return 0;
 }
@@ -651,9 +656,7 @@ static int ac_transaction_commit(anjay_t *anjay, obj_ptr_t obj_ptr) {
 static int ac_transaction_rollback(anjay_t *anjay, obj_ptr_t obj_ptr) {
     (void) anjay;
     access_control_t *ac = _anjay_access_control_from_obj_ptr(obj_ptr);
-    _anjay_access_control_clear_state(&ac->current);
-    ac->current = ac->saved_state;
-    memset(&ac->saved_state, 0, sizeof(ac->saved_state));
+    _anjay_access_control_transaction_rollback(ac);
     ac->needs_validation = false;
     return 0;
 }
@@ -662,8 +665,8 @@ static void ac_delete(anjay_t *anjay, void *access_control_) {
     (void) anjay;
     access_control_t *access_control =
             (access_control_t *) access_control_;
+    _anjay_access_control_transaction_commit(access_control);
     _anjay_access_control_clear_state(&access_control->current);
-    _anjay_access_control_clear_state(&access_control->saved_state);
     free(access_control);
 }
 
@@ -19,6 +19,8 @@
 #include <anjay/access_control.h>
 #include <anjay/persistence.h>
 
+#include <anjay_modules/access_control.h>
+
 #include "mod_access_control.h"
 
 #include <string.h>
@@ -145,6 +147,7 @@ static int restore(anjay_t *anjay,
     }
     _anjay_access_control_clear_state(&ac->current);
     ac->current = state;
+    _anjay_access_control_cache_invalidate(anjay);
 finish:
     anjay_persistence_context_delete(restore_ctx);
     anjay_persistence_context_delete(ignore_ctx);
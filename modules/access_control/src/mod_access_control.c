@@ -18,6 +18,7 @@
 
 #include <inttypes.h>
 
+#include <anjay_modules/access_control.h>
 #include <anjay_modules/observe.h>
 
 #include "mod_access_control.h"
@@ -39,37 +40,130 @@ void _anjay_access_control_clear_state(access_control_state_t *state) {
     }
 }
 
-int _anjay_access_control_clone_state(access_control_state_t *dest,
-                                      const access_control_state_t *src) {
-    assert(!dest->instances);
-    AVS_LIST(access_control_instance_t) *dest_tail = &dest->instances;
-    AVS_LIST(access_control_instance_t) src_inst;
-    AVS_LIST_FOREACH(src_inst, src->instances) {
-        AVS_LIST(access_control_instance_t) dest_inst =
-                AVS_LIST_NEW_ELEMENT(access_control_instance_t);
-        if (!dest_inst) {
-            goto error;
+static AVS_LIST(access_control_instance_t)
+clone_instance(const access_control_instance_t *src) {
+    AVS_LIST(access_control_instance_t) dest =
+            AVS_LIST_NEW_ELEMENT(access_control_instance_t);
+    if (!dest) {
+        return NULL;
+    }
+    *dest = *src;
+    dest->acl = NULL;
+    AVS_LIST(acl_entry_t) *dest_acl_tail = &dest->acl;
+    AVS_LIST(acl_entry_t) src_acl;
+    AVS_LIST_FOREACH(src_acl, src->acl) {
+        AVS_LIST(acl_entry_t) dest_acl = AVS_LIST_NEW_ELEMENT(acl_entry_t);
+        if (!dest_acl) {
+            AVS_LIST_CLEAR(&dest->acl);
+            AVS_LIST_DELETE(&dest);
+            return NULL;
         }
-        AVS_LIST_INSERT(dest_tail, dest_inst);
-        dest_tail = AVS_LIST_NEXT_PTR(dest_tail);
-        *dest_inst = *src_inst;
-        dest_inst->acl = NULL;
-        AVS_LIST(acl_entry_t) *dest_acl_tail = &dest_inst->acl;
-        AVS_LIST(acl_entry_t) src_acl;
-        AVS_LIST_FOREACH(src_acl, src_inst->acl) {
-            AVS_LIST(acl_entry_t) dest_acl = AVS_LIST_NEW_ELEMENT(acl_entry_t);
-            if (!dest_acl) {
-                goto error;
-            }
-            AVS_LIST_INSERT(dest_acl_tail, dest_acl);
-            dest_acl_tail = AVS_LIST_NEXT_PTR(dest_acl_tail);
-            *dest_acl = *src_acl;
+        AVS_LIST_INSERT(dest_acl_tail, dest_acl);
+        dest_acl_tail = AVS_LIST_NEXT_PTR(dest_acl_tail);
+        *dest_acl = *src_acl;
+    }
+    return dest;
+}
+
+static bool needs_saving(access_control_t *access_control, anjay_iid_t iid) {
+    if (!access_control->in_transaction) {
+        return false;
+    }
+    AVS_LIST(access_control_instance_t) saved;
+    AVS_LIST_FOREACH(saved, access_control->saved_state.instances) {
+        if (saved->iid == iid) {
+            return false;
         }
     }
+    AVS_LIST(anjay_iid_t) created;
+    AVS_LIST_FOREACH(created, access_control->created_iids) {
+        if (*created == iid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int mark_instance_created(access_control_t *access_control,
+                                 anjay_iid_t iid) {
+    if (!needs_saving(access_control, iid)) {
+        return 0;
+    }
+    if (!AVS_LIST_INSERT_NEW(anjay_iid_t, &access_control->created_iids)) {
+        ac_log(ERROR, "Out of memory");
+        return -1;
+    }
+    *access_control->created_iids = iid;
+    return 0;
+}
+
+int _anjay_access_control_save_instance(access_control_t *access_control,
+                                        const access_control_instance_t *inst) {
+    if (!needs_saving(access_control, inst->iid)) {
+        return 0;
+    }
+    AVS_LIST(access_control_instance_t) saved = clone_instance(inst);
+    if (!saved) {
+        ac_log(ERROR, "Out of memory");
+        return ANJAY_ERR_INTERNAL;
+    }
+    AVS_LIST_INSERT(&access_control->saved_state.instances, saved);
     return 0;
-error:
-    _anjay_access_control_clear_state(dest);
-    return -1;
+}
+
+void _anjay_access_control_detach_instance(
+        access_control_t *access_control,
+        AVS_LIST(access_control_instance_t) *inst_ptr) {
+    AVS_LIST(access_control_instance_t) inst = AVS_LIST_DETACH(inst_ptr);
+    if (needs_saving(access_control, inst->iid)) {
+        AVS_LIST_INSERT(&access_control->saved_state.instances, inst);
+    } else {
+        AVS_LIST_CLEAR(&inst->acl);
+        AVS_LIST_DELETE(&inst);
+    }
+}
+
+static AVS_LIST(access_control_instance_t) *
+find_instance_ptr(access_control_state_t *state, anjay_iid_t iid) {
+    AVS_LIST(access_control_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &state->instances) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static void delete_instance(access_control_state_t *state, anjay_iid_t iid) {
+    AVS_LIST(access_control_instance_t) *ptr = find_instance_ptr(state, iid);
+    if (*ptr && (*ptr)->iid == iid) {
+        AVS_LIST_CLEAR(&(*ptr)->acl);
+        AVS_LIST_DELETE(ptr);
+    }
+}
+
+void
+_anjay_access_control_transaction_commit(access_control_t *access_control) {
+    _anjay_access_control_clear_state(&access_control->saved_state);
+    AVS_LIST_CLEAR(&access_control->created_iids);
+    access_control->in_transaction = false;
+}
+
+void
+_anjay_access_control_transaction_rollback(access_control_t *access_control) {
+    AVS_LIST_CLEAR(&access_control->created_iids) {
+        delete_instance(&access_control->current,
+                        *access_control->created_iids);
+    }
+    while (access_control->saved_state.instances) {
+        AVS_LIST(access_control_instance_t) saved =
+                AVS_LIST_DETACH(&access_control->saved_state.instances);
+        delete_instance(&access_control->current, saved->iid);
+        AVS_LIST_INSERT(find_instance_ptr(&access_control->current,
+                                          saved->iid),
+                        saved);
+    }
+    access_control->in_transaction = false;
 }
 
 static bool
@@ -148,6 +242,9 @@ int _anjay_access_control_add_instances_without_iids(
                     return result;
                 }
             }
+            if (mark_instance_created(access_control, proposed_iid)) {
+                return -1;
+            }
             AVS_LIST_INSERT(insert_ptr, AVS_LIST_DETACH(instances_to_move));
             (*insert_ptr)->iid = proposed_iid;
         }
@@ -189,6 +286,9 @@ int _anjay_access_control_add_instance(
         result = _anjay_notify_queue_instance_created(
                 out_dm_changes, ANJAY_DM_OID_ACCESS_CONTROL, instance->iid);
     }
+    if (!result) {
+        result = mark_instance_created(access_control, instance->iid);
+    }
     if (!result) {
         AVS_LIST_INSERT(ptr, instance);
     }
@@ -254,9 +354,12 @@ int _anjay_access_control_remove_orphaned_instances(
                             (*curr)->iid))) {
                 return result;
             }
-            AVS_LIST_CLEAR(&(*curr)->acl);
-            AVS_LIST_DELETE(curr);
+            _anjay_access_control_detach_instance(access_control, curr);
         } else {
+            if ((result = _anjay_access_control_save_instance(access_control,
+                                                              *curr))) {
+                return result;
+            }
             AVS_LIST(acl_entry_t) *entry;
             AVS_LIST_FOREACH_PTR(entry, &(*curr)->acl) {
                 if ((*entry)->ssid == (*curr)->owner) {
@@ -362,9 +465,16 @@ static int set_acl(anjay_t *anjay,
             return -1;
         }
         ac_instance_needs_inserting = true;
+    } else if (_anjay_access_control_save_instance(ac, ac_instance)) {
+        return -1;
     }
 
     int result = set_acl_in_instance(anjay, ac_instance, ssid, access_mask);
+    if (!result) {
+        // the change is not visible to the core until the notifications are
+        // flushed, so make sure no stale lookups happen in the meantime
+        _anjay_access_control_cache_invalidate(anjay);
+    }
     if (!ac_instance_needs_inserting) {
         return result;
     }
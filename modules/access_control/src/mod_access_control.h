@@ -56,7 +56,12 @@ typedef struct {
 typedef struct {
     const anjay_dm_object_def_t *obj_def;
     access_control_state_t current;
+    bool in_transaction;
+    // copies of Instances modified or removed during the current transaction,
+    // in their state from before the first modification
     access_control_state_t saved_state;
+    // IIDs of Instances created during the current transaction
+    AVS_LIST(anjay_iid_t) created_iids;
     bool needs_validation;
     bool sync_in_progress;
 } access_control_t;
@@ -70,8 +75,27 @@ access_control_t *_anjay_access_control_get(anjay_t *anjay);
 
 void _anjay_access_control_clear_state(access_control_state_t *state);
 
-int _anjay_access_control_clone_state(access_control_state_t *dest,
-                                      const access_control_state_t *src);
+/**
+ * Shall be called before modifying @p inst in place. If a transaction is in
+ * progress and @p inst has not been saved yet, stores a copy of it so that it
+ * can be restored on rollback.
+ */
+int _anjay_access_control_save_instance(access_control_t *access_control,
+                                        const access_control_instance_t *inst);
+
+/**
+ * Detaches the Instance pointed to by @p inst_ptr from the current state. The
+ * Instance is either moved into the saved state, or freed.
+ */
+void _anjay_access_control_detach_instance(
+        access_control_t *access_control,
+        AVS_LIST(access_control_instance_t) *inst_ptr);
+
+void
+_anjay_access_control_transaction_commit(access_control_t *access_control);
+
+void
+_anjay_access_control_transaction_rollback(access_control_t *access_control);
 
 int
 _anjay_access_control_remove_instance(access_control_t *access_control,
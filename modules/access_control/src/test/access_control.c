@@ -128,3 +128,52 @@ AVS_UNIT_TEST(access_control, set_acl) {
 
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(access_control, transaction_rollback) {
+    access_control_t ac;
+    memset(&ac, 0, sizeof(ac));
+    for (anjay_iid_t iid = 1; iid <= 2; ++iid) {
+        AVS_LIST(access_control_instance_t) inst =
+                _anjay_access_control_create_missing_ac_instance(
+                        1, &(const acl_target_t) { TEST_OID, iid });
+        AVS_UNIT_ASSERT_NOT_NULL(inst);
+        inst->iid = iid;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_access_control_add_instance(&ac, inst, NULL));
+    }
+
+    ac.in_transaction = true;
+    // modify the first instance
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_access_control_save_instance(&ac, ac.current.instances));
+    AVS_LIST_CLEAR(&ac.current.instances->acl);
+    ac.current.instances->owner = 2;
+    // remove the second one
+    _anjay_access_control_detach_instance(
+            &ac, AVS_LIST_NEXT_PTR(&ac.current.instances));
+    // and create a new one
+    AVS_LIST(access_control_instance_t) created =
+            _anjay_access_control_create_missing_ac_instance(
+                    1, &(const acl_target_t) { TEST_OID, 3 });
+    AVS_UNIT_ASSERT_NOT_NULL(created);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_access_control_add_instance(&ac, created, NULL));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac.current.instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac.saved_state.instances), 2);
+
+    _anjay_access_control_transaction_rollback(&ac);
+    AVS_UNIT_ASSERT_FALSE(ac.in_transaction);
+    AVS_UNIT_ASSERT_NULL(ac.saved_state.instances);
+    AVS_UNIT_ASSERT_NULL(ac.created_iids);
+
+    AVS_LIST(access_control_instance_t) inst = ac.current.instances;
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(inst), 2);
+    AVS_UNIT_ASSERT_EQUAL(inst->iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst->owner, 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(inst->acl), 1);
+    inst = AVS_LIST_NEXT(inst);
+    AVS_UNIT_ASSERT_EQUAL(inst->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL(inst->target.iid, 2);
+
+    _anjay_access_control_clear_state(&ac.current);
+}
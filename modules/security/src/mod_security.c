@@ -150,6 +150,10 @@ static int add_instance(sec_repr_t *repr,
         new_instance->has_ssid = true;
     }
 
+    if (_anjay_sec_transaction_instance_created(repr, new_instance->iid)) {
+        goto error;
+    }
+
     AVS_LIST(sec_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         if ((*ptr)->iid > new_instance->iid) {
@@ -168,8 +172,7 @@ static int del_instance(sec_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST(sec_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
-            AVS_LIST(sec_instance_t) element = AVS_LIST_DETACH(it);
-            _anjay_sec_destroy_instances(&element);
+            _anjay_sec_transaction_remove_instance(repr, it);
             return 0;
         }
     }
@@ -266,19 +269,44 @@ static int sec_read(anjay_t *anjay,
     }
 }
 
+static int fetch_bytes(sec_repr_t *repr,
+                       anjay_iid_t iid,
+                       anjay_input_ctx_t *ctx,
+                       anjay_raw_buffer_t *buffer) {
+    if (_anjay_sec_transaction_owns(repr, iid, buffer->data)) {
+        *buffer = ANJAY_RAW_BUFFER_EMPTY;
+    }
+    return _anjay_sec_fetch_bytes(ctx, buffer);
+}
+
+static int fetch_string(sec_repr_t *repr,
+                        anjay_iid_t iid,
+                        anjay_input_ctx_t *ctx,
+                        char **out) {
+    if (_anjay_sec_transaction_owns(repr, iid, *out)) {
+        *out = NULL;
+    }
+    return _anjay_sec_fetch_string(ctx, out);
+}
+
 static int sec_write(anjay_t *anjay,
                      const anjay_dm_object_def_t *const *obj_ptr,
                      anjay_iid_t iid,
                      anjay_rid_t rid,
                      anjay_input_ctx_t *ctx) {
     (void) anjay;
-    sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     int retval;
     assert(inst);
 
+    if ((retval = _anjay_sec_transaction_save_instance(repr, inst))) {
+        return retval;
+    }
+
     switch ((security_resource_t) rid) {
     case SEC_RES_LWM2M_SERVER_URI:
-        return _anjay_sec_fetch_string(ctx, &inst->server_uri);
+        return fetch_string(repr, iid, ctx, &inst->server_uri);
     case SEC_RES_BOOTSTRAP_SERVER:
         if (!(retval = anjay_get_bool(ctx, &inst->is_bootstrap))) {
             inst->has_is_bootstrap = true;
@@ -291,11 +319,12 @@ static int sec_write(anjay_t *anjay,
         }
         return retval;
     case SEC_RES_PK_OR_IDENTITY:
-        return _anjay_sec_fetch_bytes(ctx, &inst->public_cert_or_psk_identity);
+        return fetch_bytes(repr, iid, ctx,
+                           &inst->public_cert_or_psk_identity);
     case SEC_RES_SERVER_PK:
-        return _anjay_sec_fetch_bytes(ctx, &inst->server_public_key);
+        return fetch_bytes(repr, iid, ctx, &inst->server_public_key);
     case SEC_RES_SECRET_KEY:
-        return _anjay_sec_fetch_bytes(ctx, &inst->private_cert_or_psk_key);
+        return fetch_bytes(repr, iid, ctx, &inst->private_cert_or_psk_key);
     case SEC_RES_SMS_SECURITY_MODE:
         if (!(retval = _anjay_sec_fetch_sms_security_mode(
                 ctx, &inst->sms_security_mode))) {
@@ -303,17 +332,19 @@ static int sec_write(anjay_t *anjay,
         }
         return retval;
     case SEC_RES_SMS_BINDING_KEY_PARAMS:
-        if (!(retval = _anjay_sec_fetch_bytes(ctx, &inst->sms_key_params))) {
+        if (!(retval = fetch_bytes(repr, iid, ctx,
+                                   &inst->sms_key_params))) {
             inst->has_sms_key_params = true;
         }
         return retval;
     case SEC_RES_SMS_BINDING_SECRET_KEYS:
-        if (!(retval = _anjay_sec_fetch_bytes(ctx, &inst->sms_secret_key))) {
+        if (!(retval = fetch_bytes(repr, iid, ctx,
+                                   &inst->sms_secret_key))) {
             inst->has_sms_secret_key = true;
         }
         return retval;
     case SEC_RES_SERVER_SMS_NUMBER:
-        return _anjay_sec_fetch_string(ctx, &inst->sms_number);
+        return fetch_string(repr, iid, ctx, &inst->sms_number);
     case SEC_RES_SHORT_SERVER_ID:
         if (!(retval = _anjay_sec_fetch_short_server_id(ctx, &inst->ssid))) {
             inst->has_ssid = true;
@@ -369,6 +400,10 @@ static int sec_instance_create(anjay_t *anjay,
     if (!created) {
         return ANJAY_ERR_INTERNAL;
     }
+    if (_anjay_sec_transaction_instance_created(repr, *inout_iid)) {
+        AVS_LIST_DELETE(&created);
+        return ANJAY_ERR_INTERNAL;
+    }
 
     created->iid = *inout_iid;
     created->ssid = *inout_iid;
@@ -424,10 +459,15 @@ sec_instance_reset(anjay_t *anjay,
                    const anjay_dm_object_def_t *const *obj_ptr,
                    anjay_iid_t iid) {
     (void) anjay;
-    sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     assert(inst);
 
-    _anjay_sec_destroy_instance_fields(inst);
+    int retval = _anjay_sec_transaction_save_instance(repr, inst);
+    if (retval) {
+        return retval;
+    }
+    _anjay_sec_transaction_release_fields(repr, inst);
     memset(inst, 0, sizeof(sec_instance_t));
     inst->iid = iid;
     return 0;
@@ -489,8 +529,9 @@ int anjay_security_object_add_instance(
 
 void anjay_security_object_purge(const anjay_dm_object_def_t *const *obj_ptr) {
     sec_repr_t *sec = _anjay_sec_get(obj_ptr);
+    /* saved Instances may share buffers with the live ones */
+    (void) _anjay_sec_transaction_commit_impl(sec);
     _anjay_sec_destroy_instances(&sec->instances);
-    _anjay_sec_destroy_instances(&sec->saved_instances);
 }
 
 void anjay_security_object_delete(const anjay_dm_object_def_t **def) {
@@ -73,7 +73,15 @@ typedef struct {
 typedef struct {
     const anjay_dm_object_def_t *def;
     AVS_LIST(sec_instance_t) instances;
+
+    bool in_transaction;
+    /* Shallow copies of Instances modified or removed during the current
+     * transaction, in their state from before the first modification. Any
+     * buffer referenced by both a saved copy and the live Instance is owned by
+     * the saved copy. */
     AVS_LIST(sec_instance_t) saved_instances;
+    /* IIDs of Instances created during the current transaction */
+    AVS_LIST(anjay_iid_t) created_iids;
 } sec_repr_t;
 
 #define security_log(level, ...) _anjay_log(security, level, __VA_ARGS__)
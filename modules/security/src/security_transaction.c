@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#include <config.h>
+
+#include <stdlib.h>
+
 #include "security_transaction.h"
 #include "security_utils.h"
 
@@ -104,20 +108,158 @@ finish:
     return result;
 }
 
-int _anjay_sec_transaction_begin_impl(sec_repr_t *repr) {
-    assert(!repr->saved_instances);
-    if (!repr->instances) {
+static AVS_LIST(sec_instance_t) *
+find_instance_ptr(AVS_LIST(sec_instance_t) *instances_ptr, anjay_iid_t iid) {
+    AVS_LIST(sec_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, instances_ptr) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static sec_instance_t *find_instance(sec_repr_t *repr, anjay_iid_t iid) {
+    AVS_LIST(sec_instance_t) *ptr = find_instance_ptr(&repr->instances, iid);
+    return (*ptr && (*ptr)->iid == iid) ? *ptr : NULL;
+}
+
+static const sec_instance_t *find_saved_instance(const sec_repr_t *repr,
+                                                 anjay_iid_t iid) {
+    AVS_LIST(sec_instance_t) it;
+    AVS_LIST_FOREACH(it, repr->saved_instances) {
+        if (it->iid == iid) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static bool is_created(const sec_repr_t *repr, anjay_iid_t iid) {
+    AVS_LIST(anjay_iid_t) it;
+    AVS_LIST_FOREACH(it, repr->created_iids) {
+        if (*it == iid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool needs_saving(const sec_repr_t *repr, anjay_iid_t iid) {
+    return repr->in_transaction
+            && !is_created(repr, iid)
+            && !find_saved_instance(repr, iid);
+}
+
+static void release_string(char **str, const char *keep) {
+    if (*str != keep) {
+        free(*str);
+    }
+    *str = NULL;
+}
+
+static void release_buffer(anjay_raw_buffer_t *buffer,
+                           const anjay_raw_buffer_t *keep) {
+    if (buffer->data == keep->data) {
+        *buffer = ANJAY_RAW_BUFFER_EMPTY;
+    } else {
+        _anjay_raw_buffer_clear(buffer);
+    }
+}
+
+/**
+ * Frees all resources held in @p inst, except for those also referenced by
+ * @p keep (which may be NULL).
+ */
+static void release_fields(sec_instance_t *inst, const sec_instance_t *keep) {
+    static const sec_instance_t NOTHING;
+    if (!keep) {
+        keep = &NOTHING;
+    }
+    release_string(&inst->server_uri, keep->server_uri);
+    release_string(&inst->sms_number, keep->sms_number);
+    release_buffer(&inst->public_cert_or_psk_identity,
+                   &keep->public_cert_or_psk_identity);
+    release_buffer(&inst->private_cert_or_psk_key,
+                   &keep->private_cert_or_psk_key);
+    release_buffer(&inst->server_public_key, &keep->server_public_key);
+    release_buffer(&inst->sms_key_params, &keep->sms_key_params);
+    release_buffer(&inst->sms_secret_key, &keep->sms_secret_key);
+}
+
+int _anjay_sec_transaction_save_instance(sec_repr_t *repr,
+                                         const sec_instance_t *inst) {
+    if (!needs_saving(repr, inst->iid)) {
+        return 0;
+    }
+    AVS_LIST(sec_instance_t) saved = AVS_LIST_NEW_ELEMENT(sec_instance_t);
+    if (!saved) {
+        security_log(ERROR, "Out of memory");
+        return ANJAY_ERR_INTERNAL;
+    }
+    *saved = *inst;
+    AVS_LIST_INSERT(&repr->saved_instances, saved);
+    return 0;
+}
+
+int _anjay_sec_transaction_instance_created(sec_repr_t *repr,
+                                            anjay_iid_t iid) {
+    if (!needs_saving(repr, iid)) {
         return 0;
     }
-    repr->saved_instances = _anjay_sec_clone_instances(repr);
-    if (!repr->saved_instances) {
+    if (!AVS_LIST_INSERT_NEW(anjay_iid_t, &repr->created_iids)) {
+        security_log(ERROR, "Out of memory");
         return ANJAY_ERR_INTERNAL;
     }
+    *repr->created_iids = iid;
+    return 0;
+}
+
+bool _anjay_sec_transaction_owns(const sec_repr_t *repr,
+                                 anjay_iid_t iid,
+                                 const void *data) {
+    const sec_instance_t *saved = find_saved_instance(repr, iid);
+    return data && saved
+            && (data == saved->server_uri
+                    || data == saved->sms_number
+                    || data == saved->public_cert_or_psk_identity.data
+                    || data == saved->private_cert_or_psk_key.data
+                    || data == saved->server_public_key.data
+                    || data == saved->sms_key_params.data
+                    || data == saved->sms_secret_key.data);
+}
+
+void _anjay_sec_transaction_release_fields(sec_repr_t *repr,
+                                           sec_instance_t *inst) {
+    release_fields(inst, find_saved_instance(repr, inst->iid));
+}
+
+void
+_anjay_sec_transaction_remove_instance(sec_repr_t *repr,
+                                       AVS_LIST(sec_instance_t) *inst_ptr) {
+    AVS_LIST(sec_instance_t) inst = AVS_LIST_DETACH(inst_ptr);
+    if (needs_saving(repr, inst->iid)) {
+        AVS_LIST_INSERT(&repr->saved_instances, inst);
+    } else {
+        _anjay_sec_transaction_release_fields(repr, inst);
+        AVS_LIST_DELETE(&inst);
+    }
+}
+
+int _anjay_sec_transaction_begin_impl(sec_repr_t *repr) {
+    assert(!repr->saved_instances);
+    assert(!repr->created_iids);
+    repr->in_transaction = true;
     return 0;
 }
 
 int _anjay_sec_transaction_commit_impl(sec_repr_t *repr) {
-    _anjay_sec_destroy_instances(&repr->saved_instances);
+    AVS_LIST_CLEAR(&repr->saved_instances) {
+        release_fields(repr->saved_instances,
+                       find_instance(repr, repr->saved_instances->iid));
+    }
+    AVS_LIST_CLEAR(&repr->created_iids);
+    repr->in_transaction = false;
     return 0;
 }
 
@@ -126,8 +268,25 @@ int _anjay_sec_transaction_validate_impl(sec_repr_t *repr) {
 }
 
 int _anjay_sec_transaction_rollback_impl(sec_repr_t *repr) {
-    _anjay_sec_destroy_instances(&repr->instances);
-    repr->instances = repr->saved_instances;
-    repr->saved_instances = NULL;
+    AVS_LIST_CLEAR(&repr->created_iids) {
+        AVS_LIST(sec_instance_t) *ptr =
+                find_instance_ptr(&repr->instances, *repr->created_iids);
+        if (*ptr && (*ptr)->iid == *repr->created_iids) {
+            release_fields(*ptr, NULL);
+            AVS_LIST_DELETE(ptr);
+        }
+    }
+    while (repr->saved_instances) {
+        AVS_LIST(sec_instance_t) saved =
+                AVS_LIST_DETACH(&repr->saved_instances);
+        AVS_LIST(sec_instance_t) *ptr =
+                find_instance_ptr(&repr->instances, saved->iid);
+        if (*ptr && (*ptr)->iid == saved->iid) {
+            release_fields(*ptr, saved);
+            AVS_LIST_DELETE(ptr);
+        }
+        AVS_LIST_INSERT(ptr, saved);
+    }
+    repr->in_transaction = false;
     return 0;
 }
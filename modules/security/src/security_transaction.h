@@ -29,6 +29,42 @@ int _anjay_sec_transaction_commit_impl(sec_repr_t *repr);
 int _anjay_sec_transaction_validate_impl(sec_repr_t *repr);
 int _anjay_sec_transaction_rollback_impl(sec_repr_t *repr);
 
+/**
+ * Shall be called before modifying @p inst in place. If a transaction is in
+ * progress and @p inst has not been saved yet, stores a shallow copy of it so
+ * that it can be restored on rollback.
+ */
+int _anjay_sec_transaction_save_instance(sec_repr_t *repr,
+                                         const sec_instance_t *inst);
+
+/**
+ * Records that an Instance with @p iid has been created, so that it can be
+ * removed on rollback.
+ */
+int _anjay_sec_transaction_instance_created(sec_repr_t *repr, anjay_iid_t iid);
+
+/**
+ * Checks whether @p data is owned by the saved copy of Instance @p iid, i.e.
+ * must not be freed when replacing a value in the live Instance.
+ */
+bool _anjay_sec_transaction_owns(const sec_repr_t *repr,
+                                 anjay_iid_t iid,
+                                 const void *data);
+
+/**
+ * Frees all resources held in @p inst that are not owned by its saved copy.
+ */
+void _anjay_sec_transaction_release_fields(sec_repr_t *repr,
+                                           sec_instance_t *inst);
+
+/**
+ * Detaches the Instance pointed to by @p inst_ptr from the list. The Instance
+ * is either moved into the set of saved Instances, or freed.
+ */
+void
+_anjay_sec_transaction_remove_instance(sec_repr_t *repr,
+                                       AVS_LIST(sec_instance_t) *inst_ptr);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SECURITY_TRANSACTION_H */
@@ -75,3 +75,49 @@ AVS_UNIT_TEST(security_object_api, add_instances_with_duplicated_ssids) {
     AVS_UNIT_ASSERT_FAILED(anjay_security_object_add_instance(env->obj, &instance1, &iid));
     AVS_UNIT_ASSERT_FAILED(anjay_security_object_add_instance(env->obj, &instance2, &iid));
 }
+
+AVS_UNIT_TEST(security_object_api, transaction_rollback) {
+    SCOPED_SERVER_TEST_ENV(env);
+    sec_repr_t *repr = _anjay_sec_get(env->obj);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(env->obj, &instance1, &iid));
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(env->obj, &instance2, &iid));
+    char *uri = repr->instances->server_uri;
+
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_begin(NULL, env->obj));
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_reset(NULL, env->obj, 1));
+    AVS_UNIT_ASSERT_NULL(repr->instances->server_uri);
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_remove(NULL, env->obj, 2));
+    iid = 3;
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_create(NULL, env->obj, &iid, 0));
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_rollback(NULL, env->obj));
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->iid, 1);
+    /* the original buffer is restored, not a copy of it */
+    AVS_UNIT_ASSERT_TRUE(repr->instances->server_uri == uri);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(AVS_LIST_NEXT(repr->instances)->server_uri,
+                                 instance2.server_uri);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_NULL(repr->created_iids);
+}
+
+AVS_UNIT_TEST(security_object_api, transaction_commit) {
+    SCOPED_SERVER_TEST_ENV(env);
+    sec_repr_t *repr = _anjay_sec_get(env->obj);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(env->obj, &instance1, &iid));
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(env->obj, &instance2, &iid));
+
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_begin(NULL, env->obj));
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_reset(NULL, env->obj, 1));
+    AVS_UNIT_ASSERT_SUCCESS(sec_instance_remove(NULL, env->obj, 2));
+    AVS_UNIT_ASSERT_SUCCESS(sec_transaction_commit(NULL, env->obj));
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 1);
+    AVS_UNIT_ASSERT_NULL(repr->instances->server_uri);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+}
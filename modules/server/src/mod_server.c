@@ -71,6 +71,9 @@ static int assign_iid(server_repr_t *repr, anjay_iid_t *inout_iid) {
 
 static int insert_created_instance(server_repr_t *repr,
                                    AVS_LIST(server_instance_t) new_instance) {
+    if (_anjay_serv_transaction_instance_created(repr, new_instance->iid)) {
+        return -1;
+    }
     AVS_LIST(server_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         assert((*ptr)->iid != new_instance->iid);
@@ -115,7 +118,7 @@ static int del_instance(server_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST(server_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
-            AVS_LIST_DELETE(it);
+            _anjay_serv_transaction_remove_instance(repr, it);
             return 0;
         } else if ((*it)->iid > iid) {
             break;
@@ -200,9 +203,14 @@ static int serv_instance_reset(anjay_t *anjay,
                                const anjay_dm_object_def_t *const *obj_ptr,
                                anjay_iid_t iid) {
     (void) anjay;
-    server_instance_t *inst = find_instance(_anjay_serv_get(obj_ptr), iid);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
 
+    int retval = _anjay_serv_transaction_save_instance(repr, inst);
+    if (retval) {
+        return retval;
+    }
     anjay_ssid_t ssid = inst->data.ssid;
     reset_instance_resources(inst);
     inst->data.ssid = ssid;
@@ -308,9 +316,13 @@ static int serv_write(anjay_t *anjay,
                       anjay_input_ctx_t *ctx) {
     (void) anjay;
 
-    server_instance_t *inst = find_instance(_anjay_serv_get(obj_ptr), iid);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
-    int retval;
+    int retval = _anjay_serv_transaction_save_instance(repr, inst);
+    if (retval) {
+        return retval;
+    }
 
     switch ((server_rid_t) rid) {
     case SERV_RES_SSID:
@@ -464,8 +476,8 @@ int anjay_server_object_add_instance(
 
 void anjay_server_object_purge(const anjay_dm_object_def_t *const *obj_ptr) {
     server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    (void) _anjay_serv_transaction_commit_impl(repr);
     _anjay_serv_destroy_instances(&repr->instances);
-    _anjay_serv_destroy_instances(&repr->saved_instances);
 }
 
 void anjay_server_object_delete(const anjay_dm_object_def_t **def) {
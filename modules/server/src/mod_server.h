@@ -50,7 +50,13 @@ typedef struct {
 typedef struct {
     const anjay_dm_object_def_t *def;
     AVS_LIST(server_instance_t) instances;
+
+    bool in_transaction;
+    /* Copies of Instances modified or removed during the current transaction,
+     * in their state from before the first modification */
     AVS_LIST(server_instance_t) saved_instances;
+    /* IIDs of Instances created during the current transaction */
+    AVS_LIST(anjay_iid_t) created_iids;
 } server_repr_t;
 
 #define server_log(level, ...) avs_log(server, level, __VA_ARGS__)
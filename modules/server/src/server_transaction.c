@@ -73,20 +73,88 @@ int _anjay_serv_object_validate(server_repr_t *repr) {
     return result;
 }
 
-int _anjay_serv_transaction_begin_impl(server_repr_t *repr) {
-    assert(!repr->saved_instances);
-    if (!repr->instances) {
+static AVS_LIST(server_instance_t) *
+find_instance_ptr(AVS_LIST(server_instance_t) *instances_ptr,
+                  anjay_iid_t iid) {
+    AVS_LIST(server_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, instances_ptr) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static bool needs_saving(const server_repr_t *repr, anjay_iid_t iid) {
+    if (!repr->in_transaction) {
+        return false;
+    }
+    AVS_LIST(server_instance_t) saved;
+    AVS_LIST_FOREACH(saved, repr->saved_instances) {
+        if (saved->iid == iid) {
+            return false;
+        }
+    }
+    AVS_LIST(anjay_iid_t) created;
+    AVS_LIST_FOREACH(created, repr->created_iids) {
+        if (*created == iid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int _anjay_serv_transaction_save_instance(server_repr_t *repr,
+                                          const server_instance_t *inst) {
+    if (!needs_saving(repr, inst->iid)) {
+        return 0;
+    }
+    AVS_LIST(server_instance_t) saved =
+            AVS_LIST_NEW_ELEMENT(server_instance_t);
+    if (!saved) {
+        server_log(ERROR, "Out of memory");
+        return ANJAY_ERR_INTERNAL;
+    }
+    *saved = *inst;
+    AVS_LIST_INSERT(&repr->saved_instances, saved);
+    return 0;
+}
+
+int _anjay_serv_transaction_instance_created(server_repr_t *repr,
+                                             anjay_iid_t iid) {
+    if (!needs_saving(repr, iid)) {
         return 0;
     }
-    repr->saved_instances = _anjay_serv_clone_instances(repr);
-    if (!repr->saved_instances) {
+    if (!AVS_LIST_INSERT_NEW(anjay_iid_t, &repr->created_iids)) {
+        server_log(ERROR, "Out of memory");
         return ANJAY_ERR_INTERNAL;
     }
+    *repr->created_iids = iid;
+    return 0;
+}
+
+void
+_anjay_serv_transaction_remove_instance(server_repr_t *repr,
+                                        AVS_LIST(server_instance_t) *inst_ptr) {
+    AVS_LIST(server_instance_t) inst = AVS_LIST_DETACH(inst_ptr);
+    if (needs_saving(repr, inst->iid)) {
+        AVS_LIST_INSERT(&repr->saved_instances, inst);
+    } else {
+        AVS_LIST_DELETE(&inst);
+    }
+}
+
+int _anjay_serv_transaction_begin_impl(server_repr_t *repr) {
+    assert(!repr->saved_instances);
+    assert(!repr->created_iids);
+    repr->in_transaction = true;
     return 0;
 }
 
 int _anjay_serv_transaction_commit_impl(server_repr_t *repr) {
     _anjay_serv_destroy_instances(&repr->saved_instances);
+    AVS_LIST_CLEAR(&repr->created_iids);
+    repr->in_transaction = false;
     return 0;
 }
 
@@ -95,8 +163,23 @@ int _anjay_serv_transaction_validate_impl(server_repr_t *repr) {
 }
 
 int _anjay_serv_transaction_rollback_impl(server_repr_t *repr) {
-    _anjay_serv_destroy_instances(&repr->instances);
-    repr->instances = repr->saved_instances;
-    repr->saved_instances = NULL;
+    AVS_LIST_CLEAR(&repr->created_iids) {
+        AVS_LIST(server_instance_t) *ptr =
+                find_instance_ptr(&repr->instances, *repr->created_iids);
+        if (*ptr && (*ptr)->iid == *repr->created_iids) {
+            AVS_LIST_DELETE(ptr);
+        }
+    }
+    while (repr->saved_instances) {
+        AVS_LIST(server_instance_t) saved =
+                AVS_LIST_DETACH(&repr->saved_instances);
+        AVS_LIST(server_instance_t) *ptr =
+                find_instance_ptr(&repr->instances, saved->iid);
+        if (*ptr && (*ptr)->iid == saved->iid) {
+            AVS_LIST_DELETE(ptr);
+        }
+        AVS_LIST_INSERT(ptr, saved);
+    }
+    repr->in_transaction = false;
     return 0;
 }
@@ -29,6 +29,29 @@ int _anjay_serv_transaction_commit_impl(server_repr_t *repr);
 int _anjay_serv_transaction_validate_impl(server_repr_t *repr);
 int _anjay_serv_transaction_rollback_impl(server_repr_t *repr);
 
+/**
+ * Shall be called before modifying @p inst in place. If a transaction is in
+ * progress and @p inst has not been saved yet, stores a copy of it so that it
+ * can be restored on rollback.
+ */
+int _anjay_serv_transaction_save_instance(server_repr_t *repr,
+                                          const server_instance_t *inst);
+
+/**
+ * Records that an Instance with @p iid has been created, so that it can be
+ * removed on rollback.
+ */
+int _anjay_serv_transaction_instance_created(server_repr_t *repr,
+                                             anjay_iid_t iid);
+
+/**
+ * Detaches the Instance pointed to by @p inst_ptr from the list. The Instance
+ * is either moved into the set of saved Instances, or freed.
+ */
+void
+_anjay_serv_transaction_remove_instance(server_repr_t *repr,
+                                        AVS_LIST(server_instance_t) *inst_ptr);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SERVER_TRANSACTION_H */
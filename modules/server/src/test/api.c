@@ -77,3 +77,30 @@ AVS_UNIT_TEST(server_object_api, add_instances_with_duplicated_ssids) {
     AVS_UNIT_ASSERT_FAILED(anjay_server_object_add_instance(env->obj, &instance1, &iid));
     AVS_UNIT_ASSERT_FAILED(anjay_server_object_add_instance(env->obj, &instance2, &iid));
 }
+
+AVS_UNIT_TEST(server_object_api, transaction_rollback) {
+    SCOPED_SERVER_TEST_ENV(env);
+    server_repr_t *repr = _anjay_serv_get(env->obj);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(env->obj, &instance1, &iid));
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(env->obj, &instance2, &iid));
+
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_begin(NULL, env->obj));
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_reset(NULL, env->obj, 1));
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->data.lifetime, -1);
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_remove(NULL, env->obj, 2));
+    iid = 3;
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_create(NULL, env->obj, &iid, 0));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->saved_instances), 2);
+    AVS_UNIT_ASSERT_SUCCESS(serv_transaction_rollback(NULL, env->obj));
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->data.lifetime, instance1.lifetime);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->iid, 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->data.lifetime,
+                          instance2.lifetime);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_NULL(repr->created_iids);
+}
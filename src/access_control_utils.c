@@ -19,6 +19,7 @@
 #include <anjay_modules/raw_buffer.h>
 
 #include "access_control_utils.h"
+#include "anjay_core.h"
 #include "io_core.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -46,13 +47,6 @@ static int read_u32(anjay_t *anjay,
     return 0;
 }
 
-typedef struct {
-    anjay_oid_t oid;
-    anjay_iid_t oiid;
-    anjay_ssid_t ssid;
-    anjay_access_mask_t result;
-} get_mask_data_t;
-
 static int read_resources(anjay_t *anjay,
                           anjay_iid_t access_control_iid,
                           anjay_oid_t *out_oid,
@@ -74,94 +68,265 @@ static int read_resources(anjay_t *anjay,
     return 0;
 }
 
-static int get_mask_from_ctx(anjay_input_ctx_t *ctx,
-                             anjay_ssid_t *inout_ssid,
-                             anjay_access_mask_t *out_mask) {
+static int read_acl_from_ctx(anjay_input_ctx_t *ctx,
+                             AVS_LIST(anjay_acl_cache_entry_t) *out_acl) {
     anjay_input_ctx_t *array_ctx = anjay_get_array(ctx);
     if (!array_ctx) {
         return -1;
     }
 
-    anjay_ssid_t ssid_lookup = *inout_ssid;
-    int32_t num_iterations = 0;
+    AVS_LIST(anjay_acl_cache_entry_t) *tail = out_acl;
     int result = 0;
     uint16_t current_ssid;
     int32_t current_mask;
-    *out_mask = ANJAY_ACCESS_MASK_NONE;
     while (!(result = anjay_get_array_index(array_ctx, &current_ssid))
             && !(result = anjay_get_i32(array_ctx, &current_mask))) {
-        if (current_ssid == ssid_lookup || current_ssid == 0) {
-            // Found an entry for the given ssid or the default ACL entry
-            *inout_ssid = current_ssid;
-            *out_mask = (anjay_access_mask_t) current_mask;
-            if (current_ssid) {
-                // not the default
-                return 0;
-            }
+        AVS_LIST(anjay_acl_cache_entry_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_acl_cache_entry_t);
+        if (!entry) {
+            anjay_log(ERROR, "out of memory");
+            return -1;
         }
-        ++num_iterations;
+        entry->ssid = current_ssid;
+        entry->mask = (anjay_access_mask_t) current_mask;
+        AVS_LIST_INSERT(tail, entry);
+        tail = AVS_LIST_NEXT_PTR(tail);
     }
-    // use the invalid SSID as a result if the ACL is empty
-    *inout_ssid = (num_iterations ? 0 : UINT16_MAX);
     return result == ANJAY_GET_INDEX_END ? 0 : result;
 }
 
-static int get_mask(anjay_t *anjay,
-                    const anjay_dm_object_def_t *const *obj,
+static int read_acl(anjay_t *anjay,
                     anjay_iid_t ac_iid,
-                    void *in_data) {
-    (void) obj;
-    get_mask_data_t *data = (get_mask_data_t *) in_data;
-    anjay_oid_t res_oid;
-    anjay_iid_t res_oiid;
-    anjay_ssid_t res_owner;
+                    AVS_LIST(anjay_acl_cache_entry_t) *out_acl) {
+    const anjay_uri_path_t path =
+            MAKE_RESOURCE_PATH(ANJAY_DM_OID_ACCESS_CONTROL, ac_iid,
+                               ANJAY_DM_RID_ACCESS_CONTROL_ACL);
 
-    if (read_resources(anjay, ac_iid, &res_oid, &res_oiid, &res_owner)) {
+    anjay_input_ctx_t *ctx = _anjay_dm_read_as_input_ctx(anjay, &path);
+    if (!ctx) {
         return -1;
     }
+    int result = read_acl_from_ctx(ctx, out_acl);
+    _anjay_input_ctx_destroy(&ctx);
+    if (result) {
+        AVS_LIST_CLEAR(out_acl);
+    }
+    return result;
+}
 
-    if (res_oiid != data->oiid || res_oid != data->oid) {
-        return ANJAY_DM_FOREACH_CONTINUE;
+static int cache_target_cmp(const void *left_, const void *right_) {
+    const anjay_acl_cache_target_t *left =
+            (const anjay_acl_cache_target_t *) left_;
+    const anjay_acl_cache_target_t *right =
+            (const anjay_acl_cache_target_t *) right_;
+    if (left->oid != right->oid) {
+        return left->oid < right->oid ? -1 : 1;
+    } else if (left->iid != right->iid) {
+        return left->iid < right->iid ? -1 : 1;
     }
+    return 0;
+}
 
-    const anjay_uri_path_t path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_ACCESS_CONTROL,
-                               (anjay_iid_t) ac_iid,
-                               ANJAY_DM_RID_ACCESS_CONTROL_ACL);
+static void clear_cache(AVS_RBTREE(anjay_acl_cache_target_t) *targets) {
+    if (!*targets) {
+        return;
+    }
+    AVS_RBTREE_DELETE(targets) {
+        AVS_LIST_CLEAR(&(**targets)->instances) {
+            AVS_LIST_CLEAR(&(**targets)->instances->acl);
+        }
+    }
+}
 
-    anjay_input_ctx_t *ctx = _anjay_dm_read_as_input_ctx(anjay, &path);
-    if (!ctx) {
+static AVS_RBTREE_ELEM(anjay_acl_cache_target_t)
+find_or_create_target(AVS_RBTREE(anjay_acl_cache_target_t) targets,
+                      anjay_oid_t oid,
+                      anjay_iid_t iid) {
+    const anjay_acl_cache_target_t query = {
+        .oid = oid,
+        .iid = iid
+    };
+    AVS_RBTREE_ELEM(anjay_acl_cache_target_t) target =
+            AVS_RBTREE_FIND(targets, &query);
+    if (target) {
+        return target;
+    }
+    if (!(target = AVS_RBTREE_ELEM_NEW(anjay_acl_cache_target_t))) {
+        anjay_log(ERROR, "out of memory");
+        return NULL;
+    }
+    target->oid = oid;
+    target->iid = iid;
+    AVS_RBTREE_INSERT(targets, target);
+    return target;
+}
+
+static int cache_instance(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj,
+                          anjay_iid_t ac_iid,
+                          void *targets_) {
+    (void) obj;
+    AVS_RBTREE(anjay_acl_cache_target_t) targets =
+            (AVS_RBTREE(anjay_acl_cache_target_t)) targets_;
+
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_ssid_t owner;
+    AVS_LIST(anjay_acl_cache_entry_t) acl = NULL;
+    if (read_resources(anjay, ac_iid, &oid, &iid, &owner)
+            || read_acl(anjay, ac_iid, &acl)) {
+        anjay_log(ERROR, "failed to read Access Control instance %u", ac_iid);
         return -1;
     }
 
-    anjay_ssid_t found_ssid = data->ssid;
-    anjay_access_mask_t mask;
-    int result = get_mask_from_ctx(ctx, &found_ssid, &mask);
-    _anjay_input_ctx_destroy(&ctx);
+    AVS_RBTREE_ELEM(anjay_acl_cache_target_t) target =
+            find_or_create_target(targets, oid, iid);
+    AVS_LIST(anjay_acl_cache_instance_t) instance =
+            target ? AVS_LIST_NEW_ELEMENT(anjay_acl_cache_instance_t) : NULL;
+    if (!instance) {
+        anjay_log(ERROR, "out of memory");
+        AVS_LIST_CLEAR(&acl);
+        return -1;
+    }
+    instance->ac_iid = ac_iid;
+    instance->owner = owner;
+    instance->acl = acl;
 
-    if (result) {
-        anjay_log(ERROR, "failed to read ACL!");
-        return result;
+    AVS_LIST(anjay_acl_cache_instance_t) *insert_ptr;
+    AVS_LIST_FOREACH_PTR(insert_ptr, &target->instances) {
+        if ((*insert_ptr)->ac_iid > ac_iid) {
+            break;
+        }
     }
+    AVS_LIST_INSERT(insert_ptr, instance);
+    return 0;
+}
 
-    if (found_ssid == data->ssid) {
-        // Found the ACL
-        data->result = mask;
-        return ANJAY_DM_FOREACH_BREAK;
-    } else if (found_ssid == UINT16_MAX) {
-        if (res_owner == data->ssid) {
+static AVS_RBTREE(anjay_acl_cache_target_t)
+build_cache(anjay_t *anjay, const anjay_dm_object_def_t *const *ac_obj) {
+    AVS_RBTREE(anjay_acl_cache_target_t) targets =
+            AVS_RBTREE_NEW(anjay_acl_cache_target_t, cache_target_cmp);
+    if (!targets) {
+        anjay_log(ERROR, "out of memory");
+        return NULL;
+    }
+    if (_anjay_dm_foreach_instance(anjay, ac_obj, cache_instance, targets)) {
+        clear_cache(&targets);
+    }
+    return targets;
+}
+
+static bool access_control_in_transaction(anjay_t *anjay) {
+    AVS_LIST(const anjay_dm_object_def_t *const *) obj;
+    AVS_LIST_FOREACH(obj, anjay->transaction_state.objs_in_transaction) {
+        if ((**obj)->oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void _anjay_access_control_cache_invalidate(anjay_t *anjay) {
+    clear_cache(&anjay->access_control_cache.targets);
+}
+
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t oiid;
+    anjay_ssid_t ssid;
+    anjay_access_mask_t result;
+} get_mask_data_t;
+
+static int get_mask(const anjay_acl_cache_instance_t *instance,
+                    get_mask_data_t *data) {
+    if (!instance->acl) {
+        if (instance->owner == data->ssid) {
             // Empty ACL, and given ssid is an owner of the instance
             data->result = ANJAY_ACCESS_MASK_FULL & ~ANJAY_ACCESS_MASK_CREATE;
             return ANJAY_DM_FOREACH_BREAK;
         }
-    } else if (!found_ssid) {
-        // Default ACL
-        data->result = mask;
+        return ANJAY_DM_FOREACH_CONTINUE;
+    }
+
+    anjay_access_mask_t default_mask = ANJAY_ACCESS_MASK_NONE;
+    AVS_LIST(anjay_acl_cache_entry_t) entry;
+    AVS_LIST_FOREACH(entry, instance->acl) {
+        if (entry->ssid == data->ssid) {
+            // Found the ACL
+            data->result = entry->mask;
+            return ANJAY_DM_FOREACH_BREAK;
+        } else if (!entry->ssid) {
+            default_mask = entry->mask;
+        }
     }
-    // Not the iid we were looking for
+    // Default ACL
+    data->result = default_mask;
     return ANJAY_DM_FOREACH_CONTINUE;
 }
 
+static void get_mask_from_cache(AVS_RBTREE(anjay_acl_cache_target_t) cache,
+                                get_mask_data_t *data) {
+    const anjay_acl_cache_target_t query = {
+        .oid = data->oid,
+        .iid = data->oiid
+    };
+    AVS_RBTREE_ELEM(anjay_acl_cache_target_t) target =
+            AVS_RBTREE_FIND(cache, &query);
+    if (!target) {
+        return;
+    }
+    AVS_LIST(anjay_acl_cache_instance_t) instance;
+    AVS_LIST_FOREACH(instance, target->instances) {
+        if (get_mask(instance, data) == ANJAY_DM_FOREACH_BREAK) {
+            break;
+        }
+    }
+}
+
+static int get_mask_uncached(anjay_t *anjay,
+                             const anjay_dm_object_def_t *const *obj,
+                             anjay_iid_t ac_iid,
+                             void *data_) {
+    (void) obj;
+    get_mask_data_t *data = (get_mask_data_t *) data_;
+    anjay_acl_cache_instance_t instance = {
+        .ac_iid = ac_iid,
+        .acl = NULL
+    };
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    int result = read_resources(anjay, ac_iid, &oid, &iid, &instance.owner);
+    if (result) {
+        return result;
+    } else if (oid != data->oid || iid != data->oiid) {
+        return ANJAY_DM_FOREACH_CONTINUE;
+    }
+    if ((result = read_acl(anjay, ac_iid, &instance.acl))) {
+        anjay_log(ERROR, "failed to read ACL!");
+        return result;
+    }
+    result = get_mask(&instance, data);
+    AVS_LIST_CLEAR(&instance.acl);
+    return result;
+}
+
+static int lookup_mask(anjay_t *anjay, get_mask_data_t *data) {
+    const anjay_dm_object_def_t *const *obj = get_access_control(anjay);
+    if (access_control_in_transaction(anjay)) {
+        // Object 2 may contain uncommitted changes - do not cache them; the
+        // ACLs of other targets are not even read, as they would be thrown
+        // away right after this single lookup anyway
+        return _anjay_dm_foreach_instance(anjay, obj, get_mask_uncached, data);
+    }
+    if (!anjay->access_control_cache.targets
+            && !(anjay->access_control_cache.targets =
+                    build_cache(anjay, obj))) {
+        return -1;
+    }
+    get_mask_from_cache(anjay->access_control_cache.targets, data);
+    return 0;
+}
+
 static anjay_access_mask_t
 access_control_mask(anjay_t *anjay,
                     const anjay_action_info_t *info) {
@@ -172,9 +337,7 @@ access_control_mask(anjay_t *anjay,
         .result = ANJAY_ACCESS_MASK_NONE
     };
 
-    const anjay_dm_object_def_t *const *obj =
-            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_ACCESS_CONTROL);
-    if (_anjay_dm_foreach_instance(anjay, obj, get_mask, &data)) {
+    if (lookup_mask(anjay, &data)) {
         return ANJAY_ACCESS_MASK_NONE;
     }
     return data.result;
@@ -189,9 +352,7 @@ static bool can_instantiate(anjay_t *anjay,
         .result = ANJAY_ACCESS_MASK_NONE
     };
 
-    const anjay_dm_object_def_t *const *obj =
-            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_ACCESS_CONTROL);
-    if (_anjay_dm_foreach_instance(anjay, obj, get_mask, &data)) {
+    if (lookup_mask(anjay, &data)) {
         return false;
     }
     return data.result & ANJAY_ACCESS_MASK_CREATE;
@@ -254,3 +415,7 @@ bool _anjay_access_control_action_allowed(anjay_t *anjay,
         return false;
     }
 }
+
+#ifdef ANJAY_TEST
+#include "test/access_control.c"
+#endif // ANJAY_TEST
@@ -14,10 +14,15 @@
  * limitations under the License.
  */
 
+
 #ifndef ACCESS_CONTROL_UTILS_H
 #define ACCESS_CONTROL_UTILS_H
 
-#include "anjay_core.h"
+#include <avsystem/commons/list.h>
+#include <avsystem/commons/rbtree.h>
+
+#include <anjay_modules/access_control.h>
+
 #include "dm_core.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -31,6 +36,34 @@ typedef struct {
 
 #ifdef WITH_ACCESS_CONTROL
 
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_access_mask_t mask;
+} anjay_acl_cache_entry_t;
+
+typedef struct {
+    anjay_iid_t ac_iid;
+    anjay_ssid_t owner;
+    // in the order in which the entries were read from the ACL resource
+    AVS_LIST(anjay_acl_cache_entry_t) acl;
+} anjay_acl_cache_instance_t;
+
+/**
+ * All Access Control Object Instances referring to a single target Object
+ * Instance (or to the Object itself, if iid == ANJAY_IID_INVALID), sorted by
+ * Access Control Instance ID.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    AVS_LIST(anjay_acl_cache_instance_t) instances;
+} anjay_acl_cache_target_t;
+
+typedef struct {
+    // NULL if the cache is not populated
+    AVS_RBTREE(anjay_acl_cache_target_t) targets;
+} anjay_access_control_cache_t;
+
 bool _anjay_access_control_action_allowed(anjay_t *anjay,
                                           const anjay_action_info_t* info);
 
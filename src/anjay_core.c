@@ -60,6 +60,10 @@ static int init(anjay_t *anjay,
 
     anjay->udp_socket_config = config->udp_socket_config;
     anjay->udp_listen_port = config->udp_listen_port;
+#ifdef WITH_THREAD_SAFE_NOTIFY
+    anjay->scheduled_notify.wakeup_cb = config->notify_wakeup_cb;
+    anjay->scheduled_notify.wakeup_arg = config->notify_wakeup_arg;
+#endif // WITH_THREAD_SAFE_NOTIFY
 
     const char *error_msg;
     if (config->udp_tx_params) {
@@ -102,7 +106,7 @@ static int init(anjay_t *anjay,
         return -1;
     }
 
-    if (_anjay_observe_init(anjay, config->confirmable_notifications)) {
+    if (_anjay_observe_init(anjay, config)) {
         return -1;
     }
 
@@ -148,7 +152,11 @@ anjay_t *anjay_new(const anjay_configuration_t *config) {
 
 void _anjay_release_server_stream_without_scheduling_queue(anjay_t *anjay) {
     memset(&anjay->current_connection, 0, sizeof(anjay->current_connection));
-    if (avs_stream_net_setsock(anjay->comm_stream, NULL)) {
+    int result = _anjay_coap_stream_set_block1_reassembly(anjay->comm_stream,
+                                                          NULL);
+    _anjay_update_ret(&result,
+                      avs_stream_net_setsock(anjay->comm_stream, NULL));
+    if (result) {
         anjay_log(ERROR, "could not set stream socket to NULL");
     }
 }
@@ -170,7 +178,10 @@ void anjay_delete(anjay_t *anjay) {
     avs_stream_cleanup(&anjay->comm_stream);
 
     _anjay_dm_cleanup(anjay);
+    _anjay_access_control_cache_invalidate(anjay);
     _anjay_observe_cleanup(anjay);
+    _anjay_notify_pending_cleanup(anjay);
+    _anjay_register_dm_cache_cleanup(anjay);
     _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
 
     free(anjay->in_buffer);
@@ -606,27 +617,22 @@ static bool critical_option_validator(uint8_t msg_code, uint32_t optnum) {
     }
 }
 
-static int block_request_equality_validator(const avs_coap_msg_t *msg,
-                                            void *orig_request_) {
-    const anjay_request_t *orig_request =
-            (const anjay_request_t *) orig_request_;
-    anjay_request_t block_request;
-    if (avs_coap_msg_validate_critical_options(msg,
-                                               critical_option_validator)
-            || parse_request(msg, &block_request)
-            || !_anjay_request_equal(&block_request, orig_request)) {
-        return -1;
-    }
-    return 0;
-}
-
 static int handle_request(anjay_t *anjay,
                           const avs_coap_msg_identity_t *request_identity,
-                          const anjay_request_t *request) {
+                          const anjay_request_t *request,
+                          bool is_block1_part) {
     int result = -1;
 
     if (_anjay_dm_current_ssid(anjay) == ANJAY_SSID_BOOTSTRAP) {
         result = _anjay_bootstrap_perform_action(anjay, request);
+    } else if (avs_coap_msg_code_is_request(request->request_code)
+            && _anjay_server_registration_pending(
+                    anjay->current_connection.server)) {
+        anjay_log(DEBUG, "Register in progress, request not served");
+        result = ANJAY_ERR_SERVICE_UNAVAILABLE;
+    } else if (is_block1_part
+            && _anjay_dm_write_part_supported(anjay, request)) {
+        result = _anjay_dm_perform_write_part(anjay, request);
     } else {
         result = _anjay_dm_perform_action(anjay, request_identity, request);
     }
@@ -661,30 +667,83 @@ static int handle_request(anjay_t *anjay,
     return result ? result : finish_result;
 }
 
-static int handle_incoming_message(anjay_t *anjay) {
-    int result = -1;
+/**
+ * @returns 0 if @p msg has been completely handled, a positive value if it
+ * still needs to be processed like a request - this is the case for Reset
+ * messages that may cancel observations, or a negative value on error.
+ */
+static int handle_non_request(anjay_t *anjay, const avs_coap_msg_t *msg) {
+    if (_anjay_dm_current_ssid(anjay) != ANJAY_SSID_BOOTSTRAP) {
+        int result = _anjay_server_handle_update_response(anjay, msg);
+        if (result <= 0
+                || (result = _anjay_observe_handle_response(anjay, msg)) <= 0) {
+            return result;
+        }
+    }
 
+    avs_coap_msg_type_t type = avs_coap_msg_get_type(msg);
+    if (type == AVS_COAP_MSG_RESET) {
+        return 1;
+    }
+
+    anjay_log(DEBUG, "ignoring unexpected response: %s",
+              AVS_COAP_CODE_STRING(avs_coap_msg_get_code(msg)));
+    if (type == AVS_COAP_MSG_CONFIRMABLE) {
+        avs_coap_ctx_send_empty(anjay->coap_ctx,
+                                avs_stream_net_getsock(anjay->comm_stream),
+                                AVS_COAP_MSG_RESET, avs_coap_msg_get_id(msg));
+    }
+    return 0;
+}
+
+/**
+ * Handles the message received on the currently bound stream. @p result is the
+ * value returned by @ref _anjay_coap_stream_get_incoming_msg .
+ */
+static int handle_received_message(anjay_t *anjay,
+                                   int result,
+                                   const avs_coap_msg_t *request_msg) {
     if (_anjay_dm_current_ssid(anjay) == ANJAY_SSID_BOOTSTRAP) {
         anjay_log(DEBUG, "bootstrap server");
     } else {
         anjay_log(DEBUG, "server ID = %u", _anjay_dm_current_ssid(anjay));
     }
 
-    const avs_coap_msg_t *request_msg;
-    if ((result = _anjay_coap_stream_get_incoming_msg(anjay->comm_stream,
-                                                      &request_msg))) {
+    // parts of Block1 requests too large to be buffered are handled one by
+    // one if possible; otherwise, the rest of the request is received
+    // synchronously
+    bool is_block1_part = (result == ANJAY_COAP_STREAM_BLOCK1_PART);
+    if (is_block1_part) {
+        anjay_log(TRACE, "Block1 request part received");
+        result = 0;
+    } else if (result) {
         if (result == AVS_COAP_CTX_ERR_DUPLICATE) {
             anjay_log(TRACE, "duplicate request received");
             result = 0;
+        } else if (result == ANJAY_COAP_STREAM_BLOCK1_CONSUMED) {
+            anjay_log(TRACE, "Block1 request block buffered");
+            result = 0;
         } else if (result == AVS_COAP_CTX_ERR_MSG_WAS_PING) {
             anjay_log(TRACE, "received CoAP ping");
             result = 0;
+        } else if (result == AVS_COAP_CTX_ERR_NETWORK) {
+            anjay_log(ERROR, "network communication error");
+            if (_anjay_dm_current_ssid(anjay) != ANJAY_SSID_BOOTSTRAP) {
+                _anjay_server_handle_network_error(anjay);
+            }
         } else {
             anjay_log(ERROR, "received packet is not a valid CoAP message");
         }
         goto cleanup;
     }
 
+    if (!avs_coap_msg_is_request(request_msg)) {
+        if ((result = handle_non_request(anjay, request_msg)) <= 0) {
+            goto cleanup;
+        }
+        result = 0;
+    }
+
     avs_coap_msg_identity_t request_identity = AVS_COAP_MSG_IDENTITY_EMPTY;
     anjay_request_t request;
     if (_anjay_coap_stream_get_request_identity(anjay->comm_stream,
@@ -702,9 +761,8 @@ static int handle_incoming_message(anjay_t *anjay) {
         goto cleanup;
     }
 
-    _anjay_coap_stream_set_block_request_validator(
-            anjay->comm_stream, block_request_equality_validator, &request);
-    result = handle_request(anjay, &request_identity, &request);
+    result = handle_request(anjay, &request_identity, &request,
+                            is_block1_part);
 
 cleanup:
     avs_stream_reset(anjay->comm_stream);
@@ -743,7 +801,9 @@ int _anjay_bind_server_stream(anjay_t *anjay, anjay_connection_ref_t ref) {
     if (!socket
             || avs_stream_net_setsock(anjay->comm_stream, socket)
             || _anjay_coap_stream_set_tx_params(anjay->comm_stream,
-                                                tx_params)) {
+                                                tx_params)
+            || _anjay_coap_stream_set_block1_reassembly(
+                    anjay->comm_stream, &connection->block1_reassembly)) {
         anjay_log(ERROR, "could not set stream socket");
         return -1;
     }
@@ -854,8 +914,37 @@ size_t _anjay_num_non_bootstrap_servers(anjay_t *anjay) {
     return num_servers;
 }
 
+/**
+ * Receives a message from @p socket onto the currently bound stream, without
+ * waiting for it if none is available yet. In that case,
+ * AVS_COAP_CTX_ERR_TIMEOUT is returned.
+ */
+static int receive_pending_message(anjay_t *anjay,
+                                   avs_net_abstract_socket_t *socket,
+                                   const avs_coap_msg_t **out_msg) {
+    avs_net_socket_opt_value_t recv_timeout;
+    if (avs_net_socket_get_opt(socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+                               &recv_timeout)
+            || avs_net_socket_set_opt(socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+                                      (avs_net_socket_opt_value_t) {
+                                          .recv_timeout = AVS_TIME_DURATION_ZERO
+                                      })) {
+        anjay_log(ERROR, "could not set socket recv timeout");
+        return -1;
+    }
+    int result = _anjay_coap_stream_get_incoming_msg(anjay->comm_stream,
+                                                     out_msg);
+    if (avs_net_socket_set_opt(socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT,
+                               recv_timeout)) {
+        anjay_log(ERROR, "could not restore socket recv timeout");
+        _anjay_update_ret(&result, -1);
+    }
+    return result;
+}
+
 static int udp_serve(anjay_t *anjay,
-                     avs_net_abstract_socket_t *ready_socket) {
+                     avs_net_abstract_socket_t *ready_socket,
+                     size_t max_messages) {
     anjay_connection_ref_t connection = {
         .server = _anjay_servers_find_by_udp_socket(&anjay->servers,
                                                     ready_socket),
@@ -866,7 +955,22 @@ static int udp_serve(anjay_t *anjay,
         return -1;
     }
 
-    int result = handle_incoming_message(anjay);
+    const avs_coap_msg_t *request_msg;
+    int recv_result = _anjay_coap_stream_get_incoming_msg(anjay->comm_stream,
+                                                          &request_msg);
+    int result = handle_received_message(anjay, recv_result, request_msg);
+    // after a network error, the connection might have been torn down
+    for (size_t served = 1;
+            served < max_messages && recv_result != AVS_COAP_CTX_ERR_NETWORK;
+            ++served) {
+        recv_result =
+                receive_pending_message(anjay, ready_socket, &request_msg);
+        if (recv_result == AVS_COAP_CTX_ERR_TIMEOUT) {
+            break;
+        }
+        _anjay_update_ret(&result, handle_received_message(anjay, recv_result,
+                                                           request_msg));
+    }
     _anjay_release_server_stream(anjay);
     return result;
 }
@@ -877,8 +981,9 @@ static int sms_serve(anjay_t *anjay) {
     return -1;
 }
 
-int anjay_serve(anjay_t *anjay,
-                avs_net_abstract_socket_t *ready_socket) {
+int anjay_serve_many(anjay_t *anjay,
+                     avs_net_abstract_socket_t *ready_socket,
+                     size_t max_messages) {
 #ifdef WITH_BLOCK_DOWNLOAD
     if (!_anjay_downloader_handle_packet(&anjay->downloader, ready_socket)) {
         return 0;
@@ -889,11 +994,21 @@ int anjay_serve(anjay_t *anjay,
             && ready_socket == _anjay_sms_poll_socket(anjay)) {
         return sms_serve(anjay);
     }
-    return udp_serve(anjay, ready_socket);
+    return udp_serve(anjay, ready_socket, max_messages);
+}
+
+int anjay_serve(anjay_t *anjay,
+                avs_net_abstract_socket_t *ready_socket) {
+    return anjay_serve_many(anjay, ready_socket, 1);
 }
 
 int anjay_sched_time_to_next(anjay_t *anjay,
                              avs_time_duration_t *out_delay) {
+    if (!_anjay_notify_pending_empty(anjay)) {
+        // changes reported from other threads need to be processed ASAP
+        *out_delay = AVS_TIME_DURATION_ZERO;
+        return 0;
+    }
     return _anjay_sched_time_to_next(anjay->sched, out_delay);
 }
 
@@ -921,6 +1036,11 @@ int anjay_sched_calculate_wait_time_ms(anjay_t *anjay, int limit_ms) {
 }
 
 int anjay_sched_run(anjay_t *anjay) {
+    if (_anjay_notify_pending_drain(anjay)) {
+        anjay_log(ERROR, "could not process changes reported from other "
+                  "threads");
+    }
+
     ssize_t tasks_executed = _anjay_sched_run(anjay->sched);
     if (tasks_executed < 0) {
         anjay_log(ERROR, "sched_run failed");
@@ -995,6 +1115,51 @@ uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay) {
 #endif
 }
 
+uint64_t anjay_get_num_notifications_sent(anjay_t *anjay) {
+#if defined(WITH_NET_STATS) && defined(WITH_OBSERVE)
+    return anjay->observe.notifications_sent;
+#else
+    (void) anjay;
+    return 0;
+#endif
+}
+
+uint64_t anjay_get_num_notifications_acknowledged(anjay_t *anjay) {
+#if defined(WITH_NET_STATS) && defined(WITH_OBSERVE)
+    return anjay->observe.notifications_acknowledged;
+#else
+    (void) anjay;
+    return 0;
+#endif
+}
+
+uint64_t anjay_get_num_stored_notifications(anjay_t *anjay) {
+#if defined(WITH_NET_STATS) && defined(WITH_OBSERVE)
+    return _anjay_observe_queue_stats(anjay).count;
+#else
+    (void) anjay;
+    return 0;
+#endif
+}
+
+uint64_t anjay_get_stored_notifications_size(anjay_t *anjay) {
+#if defined(WITH_NET_STATS) && defined(WITH_OBSERVE)
+    return _anjay_observe_queue_stats(anjay).bytes;
+#else
+    (void) anjay;
+    return 0;
+#endif
+}
+
+uint64_t anjay_get_num_dropped_notifications(anjay_t *anjay) {
+#if defined(WITH_NET_STATS) && defined(WITH_OBSERVE)
+    return anjay->observe.notifications_dropped;
+#else
+    (void) anjay;
+    return 0;
+#endif
+}
+
 #ifdef ANJAY_TEST
 #include "test/anjay.c"
 #endif // ANJAY_TEST
@@ -21,6 +21,7 @@
 #include <avsystem/commons/stream.h>
 #include <avsystem/commons/net.h>
 
+#include "access_control_utils.h"
 #include "dm_core.h"
 #include "observe_core.h"
 #include "sched.h"
@@ -32,9 +33,21 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+#ifdef WITH_THREAD_SAFE_NOTIFY
+typedef struct anjay_pending_change_struct anjay_pending_change_t;
+#endif // WITH_THREAD_SAFE_NOTIFY
+
 typedef struct {
     anjay_notify_queue_t queue;
     anjay_sched_handle_t handle;
+#ifdef WITH_THREAD_SAFE_NOTIFY
+    // lock-free stack of changes reported by
+    // anjay_notify_changed_threadsafe(), moved into queue on the Anjay thread
+    anjay_pending_change_t *pending;
+    // called when pending becomes non-empty
+    anjay_notify_wakeup_cb_t *wakeup_cb;
+    void *wakeup_arg;
+#endif // WITH_THREAD_SAFE_NOTIFY
 } anjay_scheduled_notify_t;
 
 typedef struct {
@@ -62,9 +75,13 @@ struct anjay_struct {
     avs_stream_abstract_t *comm_stream;
     anjay_connection_ref_t current_connection;
     anjay_scheduled_notify_t scheduled_notify;
+    anjay_registration_dm_cache_t registration_dm_cache;
 
     const char *endpoint_name;
     anjay_transaction_state_t transaction_state;
+#ifdef WITH_ACCESS_CONTROL
+    anjay_access_control_cache_t access_control_cache;
+#endif // WITH_ACCESS_CONTROL
 
     uint8_t *in_buffer;
     size_t in_buffer_size;
@@ -95,6 +112,23 @@ void _anjay_release_server_stream(anjay_t *anjay);
 
 size_t _anjay_num_non_bootstrap_servers(anjay_t *anjay);
 
+#ifdef WITH_THREAD_SAFE_NOTIFY
+void _anjay_notify_pending_cleanup(anjay_t *anjay);
+
+bool _anjay_notify_pending_empty(anjay_t *anjay);
+
+/**
+ * Moves all changes reported by @ref anjay_notify_changed_threadsafe into the
+ * scheduled notify queue. Must only be called from the thread that runs
+ * Anjay.
+ */
+int _anjay_notify_pending_drain(anjay_t *anjay);
+#else // WITH_THREAD_SAFE_NOTIFY
+#define _anjay_notify_pending_cleanup(anjay) ((void) (anjay))
+#define _anjay_notify_pending_empty(anjay) ((void) (anjay), true)
+#define _anjay_notify_pending_drain(anjay) ((void) (anjay), 0)
+#endif // WITH_THREAD_SAFE_NOTIFY
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_CORE_H */
@@ -15,128 +15,134 @@
  */
 
 #include <config.h>
-#include <string.h>
+
+#include <inttypes.h>
+#include <stdlib.h>
 
 #define ANJAY_COAP_STREAM_INTERNALS
 
 #include "../coap_log.h"
 
-#include "transfer_impl.h"
 #include "response.h"
-#include "../stream/common.h"
-#include "../id_source/static.h"
+#include "transfer_impl.h"
 
 VISIBILITY_SOURCE_BEGIN
 
-static int handle_block_size_renegotiation(coap_block_transfer_ctx_t *ctx,
-                                           const avs_coap_block_info_t *block2) {
-    assert(block2->size >= AVS_COAP_MSG_BLOCK_MIN_SIZE
-            && block2->size <= AVS_COAP_MSG_BLOCK_MAX_SIZE);
-
-    if (block2->size > ctx->block.size) {
-        coap_log(WARNING, "client attempted to increase block size from %u to "
-                 "%u B", ctx->block.size, block2->size);
-        return -1;
-    } else if (block2->size < ctx->block.size) {
-        if (block2->seq_num != 0 || ctx->num_sent_blocks != 0) {
-            coap_log(ERROR, "client changed block size in the middle of block "
-                     "transfer");
-            return -1;
-        } else {
-            coap_log(TRACE, "lowering block size to %u B on client request",
-                     block2->size);
-            ctx->block.size = block2->size;
-        }
+coap_block_response_t *
+_anjay_coap_block_response_new(const avs_coap_block_info_t *requested_block,
+                               coap_output_buffer_t *out) {
+    avs_coap_block_info_t block = {
+        .type = AVS_COAP_BLOCK2,
+        .valid = true,
+        .seq_num = 0,
+        .size = AVS_COAP_MSG_BLOCK_MAX_SIZE
+    };
+    if (requested_block) {
+        assert(requested_block->type == AVS_COAP_BLOCK2);
+        block = *requested_block;
     }
 
-    return 0;
-}
-
-static int block_recv_handler(void *validator_ctx_,
-                              const avs_coap_msg_t *msg,
-                              const avs_coap_msg_t *last_response,
-                              coap_block_transfer_ctx_t *ctx,
-                              bool *out_wait_for_next,
-                              uint8_t *out_error_code) {
-    anjay_coap_block_request_validator_ctx_t *validator_ctx =
-            (anjay_coap_block_request_validator_ctx_t *)validator_ctx_;
-
-    (void) last_response;
-
-    *out_wait_for_next = false;
-
-    avs_coap_msg_identity_t id = avs_coap_msg_get_identity(msg);
-    avs_coap_msg_identity_t prev_id =
-            avs_coap_msg_get_identity(last_response);
-
-    // Message identity matches last response, it means it must be a duplicate
-    // of the previous request.
-    if (avs_coap_identity_equal(&id, &prev_id)) {
-        return BLOCK_TRANSFER_RESULT_RETRY;
+    uint16_t block_size = _anjay_coap_block_proposed_size(block.size, out);
+    if (block_size == 0) {
+        return NULL;
     }
-
-    _anjay_coap_id_source_static_reset(ctx->id_source, &id);
-
-    avs_coap_block_info_t block1;
-    if (avs_coap_get_block_info(msg, AVS_COAP_BLOCK1, &block1)) {
-        // Malformed BLOCK1 option, or multiple BLOCK1 options found.
-        *out_error_code = -ANJAY_ERR_BAD_REQUEST;
-        return -1;
-    } else if (block1.valid) {
-        // BLOCK1 option present: we do not expect it to be set, as
-        // block-wise responses to block-wise requests are not supported.
-        // It must be a part of an unrelated BLOCK-wise request.
-        *out_wait_for_next = true;
-        *out_error_code = -ANJAY_ERR_SERVICE_UNAVAILABLE;
-        return -1;
+    if (block_size < block.size) {
+        // the client is expected to continue with the smaller size, see
+        // CoAP BLOCK, 2.4 "Using the Block2 Option"
+        block.seq_num *= (uint32_t) (block.size / block_size);
+        block.size = block_size;
     }
-
-    avs_coap_block_info_t block2;
-    if (avs_coap_get_block_info(msg, AVS_COAP_BLOCK2, &block2)) {
-        // Malformed BLOCK2 option, or multiple BLOCK2 options found.
-        *out_error_code = -ANJAY_ERR_BAD_REQUEST;
-        return -1;
-    } else if (!block2.valid // no BLOCK2 option - must be an unrelated request
-            || (validator_ctx && validator_ctx->validator
-                    && validator_ctx->validator(
-                            msg, validator_ctx->validator_arg))) {
-        *out_wait_for_next = true;
-        *out_error_code = -ANJAY_ERR_SERVICE_UNAVAILABLE;
-        return -1;
+    if (block.seq_num > AVS_COAP_BLOCK_MAX_SEQ_NUMBER) {
+        coap_log(ERROR, "block %" PRIu32 " out of range", block.seq_num);
+        return NULL;
     }
 
-    if (handle_block_size_renegotiation(ctx, &block2)) {
-        *out_error_code = -ANJAY_ERR_BAD_REQUEST;
-        return -1;
+    coap_block_response_t *ctx = (coap_block_response_t *)
+            calloc(1, sizeof(coap_block_response_t));
+    if (!ctx) {
+        coap_log(ERROR, "out of memory");
+        return NULL;
     }
 
-    if (block2.seq_num < ctx->block.seq_num
-            || block2.seq_num > ctx->block.seq_num + 1) {
-        coap_log(WARNING, "expected BLOCK2 seq numbers to be consecutive");
-        *out_wait_for_next = true;
-        return -1;
-    }
+    ctx->info = out->info;
+    ctx->block = block;
+    ctx->block.has_more = false;
+    ctx->block_builder = avs_coap_block_builder_init(&out->builder);
+    ctx->bytes_to_skip = (size_t) block.seq_num * block.size;
+
+    out->info = avs_coap_msg_info_init();
+    return ctx;
+}
 
-    if (block2.seq_num == ctx->block.seq_num) {
-        return BLOCK_TRANSFER_RESULT_RETRY;
+void _anjay_coap_block_response_delete(coap_block_response_t **ctx) {
+    if (ctx && *ctx) {
+        avs_coap_msg_info_reset(&(*ctx)->info);
+        free(*ctx);
+        *ctx = NULL;
     }
+}
 
-    ctx->block.seq_num = block2.seq_num;
-    return BLOCK_TRANSFER_RESULT_OK;
+void _anjay_coap_block_response_write(coap_block_response_t *ctx,
+                                      const void *data,
+                                      size_t data_length) {
+    const uint8_t *bytes = (const uint8_t *) data;
+
+    while (!ctx->block.has_more) {
+        size_t remaining =
+                avs_coap_block_builder_payload_remaining(&ctx->block_builder);
+
+        if (ctx->bytes_to_skip > 0 && remaining > 0) {
+            size_t bytes_skipped = AVS_MIN(ctx->bytes_to_skip, remaining);
+            avs_coap_block_builder_next(&ctx->block_builder, bytes_skipped);
+            ctx->bytes_to_skip -= bytes_skipped;
+        } else if (remaining > ctx->block.size) {
+            // strong inequality is deliberate - there is at least one byte
+            // after the requested block, so it is not the last one; the rest
+            // of the payload is not needed
+            ctx->block.has_more = true;
+        } else if (data_length == 0) {
+            break;
+        } else {
+            size_t bytes_written = avs_coap_block_builder_append_payload(
+                    &ctx->block_builder, bytes, data_length);
+            assert(bytes_written > 0);
+            bytes += bytes_written;
+            data_length -= bytes_written;
+        }
+    }
 }
 
-coap_block_transfer_ctx_t *
-_anjay_coap_block_response_new(
-        uint16_t max_block_size,
-        coap_stream_common_t *stream_data,
-        coap_id_source_t *id_source,
-        anjay_coap_block_request_validator_ctx_t *validator_ctx) {
-    return _anjay_coap_block_transfer_new(max_block_size, stream_data,
-                                          AVS_COAP_BLOCK2, id_source,
-                                          block_recv_handler, validator_ctx);
+bool _anjay_coap_block_response_has_block(const coap_block_response_t *ctx) {
+    return ctx->bytes_to_skip == 0
+            && (ctx->block.seq_num == 0
+                    || avs_coap_block_builder_payload_remaining(
+                            &ctx->block_builder) > 0);
 }
 
-avs_coap_msg_identity_t
-_anjay_coap_block_response_last_request_id(coap_block_transfer_ctx_t *ctx) {
-    return _anjay_coap_id_source_get(ctx->id_source);
+int _anjay_coap_block_response_send(coap_block_response_t *ctx,
+                                    avs_coap_ctx_t *coap_ctx,
+                                    avs_net_abstract_socket_t *socket) {
+    assert(_anjay_coap_block_response_has_block(ctx));
+
+    avs_coap_msg_info_opt_remove_by_number(&ctx->info, AVS_COAP_OPT_BLOCK2);
+    if (avs_coap_msg_info_opt_block(&ctx->info, &ctx->block)) {
+        return -1;
+    }
+
+    size_t storage_size =
+            avs_coap_msg_info_get_packet_storage_size(&ctx->info,
+                                                      ctx->block.size);
+    // TODO: consider failing if storage_size too big to limit stack usage
+    AVS_ALIGNED_STACK_BUF(aligned_storage, storage_size);
+
+    const avs_coap_msg_t *msg = avs_coap_block_builder_build(
+            &ctx->block_builder, &ctx->info, ctx->block.size,
+            avs_coap_ensure_aligned_buffer(aligned_storage), storage_size);
+    assert(msg);
+
+    coap_log(TRACE, "sending block %" PRIu32 " (size %" PRIu16 ", payload size "
+             "%lu), has_more=%d", ctx->block.seq_num, ctx->block.size,
+             (unsigned long) avs_coap_msg_payload_length(msg),
+             ctx->block.has_more);
+    return avs_coap_ctx_send(coap_ctx, socket, msg);
 }
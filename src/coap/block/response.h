@@ -19,58 +19,88 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
-#include <avsystem/commons/coap/msg.h>
+#include <avsystem/commons/coap/block_builder.h>
 #include <avsystem/commons/coap/ctx.h>
+#include <avsystem/commons/coap/msg.h>
+#include <avsystem/commons/coap/msg_info.h>
 
-#include "transfer.h"
-
-#include "../stream/common.h"
-#include "../stream/in.h"
 #include "../stream/out.h"
-#include "../id_source/id_source.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 #ifdef WITH_BLOCK_SEND
 
-typedef struct {
-    anjay_coap_block_request_validator_t *validator;
-    void *validator_arg;
-} anjay_coap_block_request_validator_ctx_t;
+/**
+ * A single block of a block-wise response.
+ *
+ * The response is regenerated from scratch for each request of a Block2
+ * transfer (see CoAP BLOCK, 2.4 "Using the Block2 Option") and only the
+ * requested part of its payload is kept, so that no state needs to be
+ * maintained between consecutive requests.
+ */
+typedef struct coap_block_response {
+    avs_coap_msg_info_t info;
+    avs_coap_block_info_t block;
+    avs_coap_block_builder_t block_builder;
+
+    // number of payload bytes preceding the requested block that still need
+    // to be discarded
+    size_t bytes_to_skip;
+} coap_block_response_t;
 
 /**
  * Creates a block response object.
  *
- * @param max_block_size           Maximum block size the client is willing to
- *                                 handle.
- * @param stream_data              Internal structure of the CoAP stream for
- *                                 which the block request is performed. The
- *                                 <c>out</c> field MUST NOT be used without
- *                                 reinitializing after a successful call to
- *                                 this function.
- * @param socket                   The CoAP socket used to send/receive blocks.
- * @param id_source                CoAP id source for the block responses.
- * @param validator_ctx            Request relation validator context.
+ * @param requested_block Block2 option of the request, or NULL if the request
+ *                        did not contain one.
+ * @param out             Output buffer of the CoAP stream, with the response
+ *                        headers already set up. The buffer MUST NOT be used
+ *                        without reinitializing after a successful call to
+ *                        this function.
  *
- * @returns Created block_response object on success, NULL on failure.
+ * @returns Created block response object on success, NULL on failure.
+ */
+coap_block_response_t *
+_anjay_coap_block_response_new(const avs_coap_block_info_t *requested_block,
+                               coap_output_buffer_t *out);
+
+void _anjay_coap_block_response_delete(coap_block_response_t **ctx);
+
+/**
+ * Passes next chunk of the full response payload. Parts of it that do not
+ * belong to the requested block are discarded.
  */
-coap_block_transfer_ctx_t *
-_anjay_coap_block_response_new(
-        uint16_t max_block_size,
-        coap_stream_common_t *stream_data,
-        coap_id_source_t *id_source,
-        anjay_coap_block_request_validator_ctx_t *validator_ctx);
+void _anjay_coap_block_response_write(coap_block_response_t *ctx,
+                                      const void *data,
+                                      size_t data_length);
 
-avs_coap_msg_identity_t
-_anjay_coap_block_response_last_request_id(coap_block_transfer_ctx_t *ctx);
+/**
+ * @returns false if the payload written so far ends before the requested
+ *          block, true otherwise.
+ */
+bool _anjay_coap_block_response_has_block(const coap_block_response_t *ctx);
+
+/**
+ * Sends the requested block. MUST NOT be called before the whole response
+ * payload is written, or if @ref _anjay_coap_block_response_has_block
+ * returns false.
+ */
+int _anjay_coap_block_response_send(coap_block_response_t *ctx,
+                                    avs_coap_ctx_t *coap_ctx,
+                                    avs_net_abstract_socket_t *socket);
 
 #else
 
-#define _anjay_coap_block_response_last_request_id(...) \
-        (assert(0 && "should never happen"), \
-         (avs_coap_msg_identity_t) { .msg_id = 0 })
+#define _anjay_coap_block_response_delete(ctx) ((void) 0)
+
+#define _anjay_coap_block_response_has_block(ctx) \
+        (assert(0 && "should never happen"), false)
+
+#define _anjay_coap_block_response_send(ctx, coap_ctx, socket) \
+        (assert(0 && "should never happen"), -1)
 
 #endif
 
@@ -59,8 +59,8 @@ buffer_size_enforced_payload_capacity(const coap_output_buffer_t *out) {
     return out->buffer_capacity < 1 ? 0 : out->buffer_capacity - 1;
 }
 
-static uint16_t calculate_proposed_block_size(uint16_t original_block_size,
-                                              const coap_output_buffer_t *out) {
+uint16_t _anjay_coap_block_proposed_size(uint16_t original_block_size,
+                                         const coap_output_buffer_t *out) {
     size_t payload_capacity_considering_mtu = AVS_MIN(
             mtu_enforced_payload_capacity(out),
             buffer_size_enforced_payload_capacity(out));
@@ -98,7 +98,7 @@ _anjay_coap_block_transfer_new(uint16_t max_block_size,
     assert(block_recv_handler);
 
     uint16_t block_size_considering_mtu =
-            calculate_proposed_block_size(max_block_size, &stream_data->out);
+            _anjay_coap_block_proposed_size(max_block_size, &stream_data->out);
     if (block_size_considering_mtu == 0) {
         return NULL;
     }
@@ -89,6 +89,14 @@ struct coap_block_transfer_ctx {
     void *block_recv_handler_arg;
 };
 
+/**
+ * @returns The largest block size not greater than @p original_block_size
+ *          that allows blocks to be built in @p out and sent without exceeding
+ *          the MTU, or 0 if there is no such size.
+ */
+uint16_t _anjay_coap_block_proposed_size(uint16_t original_block_size,
+                                         const coap_output_buffer_t *out);
+
 coap_block_transfer_ctx_t *
 _anjay_coap_block_transfer_new(uint16_t max_block_size,
                                coap_stream_common_t *stream_data,
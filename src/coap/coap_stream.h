@@ -54,9 +54,6 @@ typedef int
 anjay_coap_stream_setup_response_t(avs_stream_abstract_t *stream,
                                    const anjay_msg_details_t *details);
 
-typedef int anjay_coap_block_request_validator_t(const avs_coap_msg_t *msg,
-                                                 void *arg);
-
 typedef struct anjay_coap_stream_ext {
     anjay_coap_stream_setup_response_t *setup_response;
 } anjay_coap_stream_ext_t;
@@ -89,10 +86,94 @@ int _anjay_coap_stream_get_request_identity(
         avs_stream_abstract_t *stream,
         avs_coap_msg_identity_t *out_identity);
 
-void _anjay_coap_stream_set_block_request_validator(
+/**
+ * Value returned by @ref _anjay_coap_stream_get_incoming_msg when the received
+ * message was an intermediate block of a Block1 request that has been buffered
+ * and acknowledged with 2.31 Continue. There is nothing more to do with such
+ * message; the request will be available once its last block arrives.
+ */
+#define ANJAY_COAP_STREAM_BLOCK1_CONSUMED 1
+
+/**
+ * Value returned by @ref _anjay_coap_stream_get_incoming_msg when the received
+ * message is a block of a Block1 request too large to be reassembled in memory
+ * (see ANJAY_MAX_BLOCK1_REQUEST_SIZE). The message is returned through
+ * @p out_msg as usual.
+ *
+ * If @ref _anjay_coap_stream_begin_block1_part is called, reading from the
+ * stream yields the payload received since the previous part, and the response
+ * shall be 2.31 Continue for all but the last block. Otherwise, the request is
+ * handled as a whole, with its remaining blocks received synchronously - this
+ * is only possible on the first block returned that way; later ones can only be
+ * rejected with an error response.
+ */
+#define ANJAY_COAP_STREAM_BLOCK1_PART 2
+
+/**
+ * Partially received Block1 request./**
+ * Partially received Block1 request. Owned by the connection the request is
+ * being received on, so that the transfer may span many anjay_serve() calls
+ * without blocking.
+ */
+typedef struct anjay_coap_block1_reassembly anjay_coap_block1_reassembly_t;
+
+/**
+ * Sets the location of Block1 reassembly state to use for requests received
+ * on the stream. If never set (or set to NULL), Block1 requests are received
+ * synchronously, waiting for subsequent blocks on the socket.
+ *
+ * Must only be called on a stream that is not in the middle of an exchange.
+ */
+int _anjay_coap_stream_set_block1_reassembly(
         avs_stream_abstract_t *stream,
-        anjay_coap_block_request_validator_t *validator,
-        void *validator_arg);
+        anjay_coap_block1_reassembly_t **reassembly_ptr);
+
+#ifdef WITH_BLOCK_RECEIVE
+void _anjay_coap_block1_reassembly_cleanup(
+        anjay_coap_block1_reassembly_t **reassembly_ptr);
+#else // WITH_BLOCK_RECEIVE
+#define _anjay_coap_block1_reassembly_cleanup(ReassemblyPtr) \
+        ((void) (ReassemblyPtr))
+#endif // WITH_BLOCK_RECEIVE
+
+/**
+ * Makes the Block1 request for which @ref _anjay_coap_stream_get_incoming_msg
+ * returned ANJAY_COAP_STREAM_BLOCK1_PART handled part by part (see above).
+ *
+ * @param      stream     CoAP stream to operate on.
+ * @param[out] out_offset Offset of the first byte that can be read from the
+ *                        stream within the whole request payload.
+ * @param[out] out_last   Set to true if the payload ends with the current part.
+ *
+ * @returns 0 on success, a negative value if there is no such request.
+ */
+int _anjay_coap_stream_begin_block1_part(avs_stream_abstract_t *stream,
+                                         size_t *out_offset,
+                                         bool *out_last);
+
+/**
+ * Value returned by @ref _anjay_coap_stream_take_request when the request
+ * payload did not fit in a single message and a block-wise transfer has
+ * already been started. Such request can only be completed synchronously, by
+ * calling avs_stream_finish_message().
+ */
+#define ANJAY_COAP_STREAM_REQUEST_BLOCKWISE 1
+
+/**
+ * Builds the request prepared with @ref _anjay_coap_stream_setup_request and
+ * the payload written so far, without sending it. On success, the stream is
+ * reset and @p out_msg is set to a heap-allocated copy of the request that the
+ * caller is responsible for freeing. This allows sending the request and
+ * matching its response outside of the stream, without blocking on the socket.
+ *
+ * @returns
+ * - 0 on success,
+ * - ANJAY_COAP_STREAM_REQUEST_BLOCKWISE if the request cannot be taken over
+ *   (see above); the stream is left intact in that case,
+ * - a negative value on error.
+ */
+int _anjay_coap_stream_take_request(avs_stream_abstract_t *stream,
+                                    avs_coap_msg_t **out_msg);
 
 VISIBILITY_PRIVATE_HEADER_END
 
@@ -30,13 +30,18 @@
 #include "common.h"
 
 #include <inttypes.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 VISIBILITY_SOURCE_BEGIN
 
 #ifdef WITH_BLOCK_SEND
 #define has_block_ctx(client) ((client)->block_ctx)
+#define first_block2_only(client) ((client)->first_block2_only)
 #else
 #define has_block_ctx(client) (false)
+#define first_block2_only(client) (false)
 #endif
 
 const avs_coap_msg_identity_t *
@@ -51,6 +56,9 @@ _anjay_coap_client_get_request_identity(const coap_client_t *client) {
 void _anjay_coap_client_reset(coap_client_t *client) {
     client->state = COAP_CLIENT_STATE_RESET;
     _anjay_coap_block_transfer_delete(&client->block_ctx);
+#ifdef WITH_BLOCK_SEND
+    client->first_block2_only = false;
+#endif // WITH_BLOCK_SEND
 }
 
 int _anjay_coap_client_setup_request(coap_client_t *client,
@@ -360,6 +368,29 @@ int _anjay_coap_client_finish_request(coap_client_t *client) {
     }
 }
 
+int _anjay_coap_client_copy_request(coap_client_t *client,
+                                    avs_coap_msg_t **out_msg) {
+    if (client->state != COAP_CLIENT_STATE_HAS_REQUEST_HEADER) {
+        coap_log(TRACE, "unexpected client state: %d", client->state);
+        return -1;
+    }
+
+    if (has_block_ctx(client)) {
+        return COAP_CLIENT_REQUEST_BLOCKWISE;
+    }
+
+    const avs_coap_msg_t *msg = _anjay_coap_out_build_msg(&client->common.out);
+    const size_t msg_size = offsetof(avs_coap_msg_t, content) + msg->length;
+    *out_msg = (avs_coap_msg_t *) malloc(msg_size);
+    if (!*out_msg) {
+        coap_log(ERROR, "out of memory");
+        return -1;
+    }
+
+    memcpy(*out_msg, msg, msg_size);
+    return 0;
+}
+
 int _anjay_coap_client_read(coap_client_t *client,
                             size_t *out_bytes_read,
                             char *out_message_finished,
@@ -380,6 +411,21 @@ static int block_write(coap_client_t *client,
                        coap_id_source_t *id_source,
                        const void *data,
                        size_t data_length) {
+    if (client->first_block2_only) {
+        return 0;
+    }
+
+    if (!avs_coap_msg_code_is_request(client->common.out.info.code)) {
+        // a response sent through the client stream is a notification; it
+        // cannot be sent using Block1, see CoAP BLOCK, 2.6 "Combining
+        // Block-Wise Transfers with the Observe Option"
+        coap_log(DEBUG, "notification payload does not fit in the buffer - "
+                 "sending the first block only");
+        client->first_block2_only = true;
+        return _anjay_coap_out_truncate_to_first_block(&client->common.out,
+                                                       AVS_COAP_BLOCK2);
+    }
+
     if (!client->block_ctx) {
         client->block_ctx =
             _anjay_coap_block_request_new(AVS_COAP_MSG_BLOCK_MAX_SIZE,
@@ -407,7 +453,7 @@ int _anjay_coap_client_write(coap_client_t *client,
     (void) client; (void) id_source;
     size_t bytes_written = 0;
 
-    if (!has_block_ctx(client)) {
+    if (!has_block_ctx(client) && !first_block2_only(client)) {
         bytes_written = _anjay_coap_out_write(&client->common.out,
                                               data, data_length);
         if (bytes_written == data_length) {
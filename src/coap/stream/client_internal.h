@@ -61,6 +61,11 @@ typedef struct coap_client {
 
 #ifdef WITH_BLOCK_SEND
     coap_block_transfer_ctx_t *block_ctx;
+
+    // set if the message is a notification cut down to its first Block2
+    // block; the rest of the payload is discarded, as the server is expected
+    // to request further blocks on its own
+    bool first_block2_only;
 #endif
 
     // following are only valid if state != COAP_CLIENT_STATE_RESET
@@ -115,6 +120,21 @@ int _anjay_coap_client_get_or_receive_msg(coap_client_t *client,
  */
 int _anjay_coap_client_finish_request(coap_client_t *client);
 
+#define COAP_CLIENT_REQUEST_BLOCKWISE 1
+
+/**
+ * Builds the prepared request and stores its heap-allocated copy in
+ * @p out_msg without sending it.
+ *
+ * @returns
+ * - 0 on success,
+ * - COAP_CLIENT_REQUEST_BLOCKWISE if a block-wise transfer of the request has
+ *   already been started,
+ * - a negative value in case of other error.
+ */
+int _anjay_coap_client_copy_request(coap_client_t *client,
+                                    avs_coap_msg_t **out_msg);
+
 int _anjay_coap_client_read(coap_client_t *client,
                             size_t *out_bytes_read,
                             char *out_message_finished,
@@ -35,6 +35,9 @@ typedef struct coap_stream_common {
 
     coap_input_buffer_t in;
     coap_output_buffer_t out;
+
+    // see _anjay_coap_stream_set_block1_reassembly()
+    anjay_coap_block1_reassembly_t **block1_reassembly;
 } coap_stream_common_t;
 
 int _anjay_coap_common_fill_msg_info(avs_coap_msg_info_t *info,
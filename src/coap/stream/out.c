@@ -26,6 +26,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "../coap_log.h"
 
@@ -136,6 +137,44 @@ int _anjay_coap_out_update_msg_header(coap_output_buffer_t *out,
     return result;
 }
 
+int _anjay_coap_out_truncate_to_first_block(coap_output_buffer_t *out,
+                                            avs_coap_block_type_t block_type) {
+    const avs_coap_msg_t *msg = _anjay_coap_out_build_msg(out);
+    size_t payload_size = avs_coap_msg_payload_length(msg);
+    // the BLOCK option takes some of the space previously used for payload
+    size_t block_size = _anjay_max_power_of_2_not_greater_than(
+            AVS_MIN(payload_size > AVS_COAP_OPT_BLOCK_MAX_SIZE
+                            ? payload_size - AVS_COAP_OPT_BLOCK_MAX_SIZE
+                            : 0,
+                    AVS_COAP_MSG_BLOCK_MAX_SIZE));
+    if (block_size < AVS_COAP_MSG_BLOCK_MIN_SIZE) {
+        coap_log(ERROR, "buffer too small to send the first block");
+        return -1;
+    }
+
+    uint8_t block_payload[AVS_COAP_MSG_BLOCK_MAX_SIZE];
+    memcpy(block_payload, avs_coap_msg_payload(msg), block_size);
+
+    const avs_coap_block_info_t block = {
+        .type = block_type,
+        .valid = true,
+        .seq_num = 0,
+        .has_more = true,
+        .size = (uint16_t) block_size
+    };
+    int result;
+    (void) ((result = avs_coap_msg_info_opt_block(&out->info, &block))
+            || (result = avs_coap_msg_builder_init(
+                    &out->builder, avs_coap_ensure_aligned_buffer(out->buffer),
+                    effective_buffer_capacity(out), &out->info)));
+    if (!result && _anjay_coap_out_write(out, block_payload, block_size)
+                           != block_size) {
+        coap_log(ERROR, "block does not fit in the buffer");
+        result = -1;
+    }
+    return result;
+}
+
 size_t _anjay_coap_out_write(coap_output_buffer_t *out,
                              const void *data,
                              size_t data_length) {
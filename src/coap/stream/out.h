@@ -107,6 +107,25 @@ int _anjay_coap_out_update_msg_header(coap_output_buffer_t *out,
                                       const avs_coap_msg_identity_t *id,
                                       const avs_coap_block_info_t *block);
 
+/**
+ * Cuts the payload of the message being constructed down to its first block,
+ * as large as the buffer allows, and adds a BLOCK option of @p block_type with
+ * the "more" flag set to the header.
+ *
+ * Intended for messages which payload did not fit in the buffer, but that
+ * cannot be sent using a block-wise transfer driven by this endpoint, e.g.
+ * notifications (see CoAP BLOCK, 2.6 "Combining Block-Wise Transfers with
+ * the Observe Option").
+ *
+ * @param out        Buffer to operate on. Its payload MUST NOT be smaller than
+ *                   the buffer capacity allows.
+ * @param block_type Type of the BLOCK option to add.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int _anjay_coap_out_truncate_to_first_block(coap_output_buffer_t *out,
+                                            avs_coap_block_type_t block_type);
+
 /**
  * Writes a message payload.
  *
@@ -23,13 +23,14 @@
 #include <anjay_modules/time_defs.h>
 
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../coap_log.h"
 
 #include <avsystem/commons/coap/block_utils.h>
 
 #include "../content_format.h"
-#include "../id_source/static.h"
 #include "common.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -55,24 +56,27 @@ static bool is_server_reset(const coap_server_t *server) {
 void _anjay_coap_server_reset(coap_server_t *server) {
     server->state = COAP_SERVER_STATE_RESET;
     AVS_LIST_CLEAR(&server->expected_block_opts);
+#ifdef WITH_BLOCK_RECEIVE
+    if (server->block1_part != COAP_BLOCK1_PART_NONE
+            && (server->block1_part != COAP_BLOCK1_PART_STREAMING
+                    || !server->curr_block.has_more)) {
+        // the request has been either handled as a whole, rejected or
+        // received completely; there is nothing more to wait for
+        _anjay_coap_block1_reassembly_cleanup(server->common.block1_reassembly);
+    }
+    server->block1_part = COAP_BLOCK1_PART_NONE;
+    free(server->block1_prefix);
+    server->block1_prefix = NULL;
+    server->block1_prefix_size = 0;
+    server->block1_prefix_off = 0;
+#endif // WITH_BLOCK_RECEIVE
     server->curr_block.valid = false;
     clear_error(server);
 #ifdef WITH_BLOCK_SEND
-    memset(&server->block_relation_validator, 0,
-           sizeof(server->block_relation_validator));
+    _anjay_coap_block_response_delete(&server->block_ctx);
 #endif // WITH_BLOCK_SEND
 }
 
-#ifdef WITH_BLOCK_SEND
-void _anjay_coap_server_set_block_request_relation_validator(
-        coap_server_t *server,
-        anjay_coap_block_request_validator_t *validator,
-        void *validator_arg) {
-    server->block_relation_validator.validator = validator;
-    server->block_relation_validator.validator_arg = validator_arg;
-}
-#endif // WITH_BLOCK_SEND
-
 const avs_coap_msg_identity_t *
 _anjay_coap_server_get_request_identity(const coap_server_t *server) {
     if (server->state != COAP_SERVER_STATE_RESET) {
@@ -147,17 +151,35 @@ static void setup_error_response(coap_server_t *server) {
 }
 
 int _anjay_coap_server_finish_response(coap_server_t *server) {
-    if (has_error(server)) {
-        setup_error_response(server);
+    if (has_block_ctx(server)) {
+        if (!has_error(server)
+                && !_anjay_coap_block_response_has_block(server->block_ctx)) {
+            coap_log(DEBUG, "block %" PRIu32 " is past the end of response",
+                     server->curr_block.seq_num);
+            _anjay_coap_server_set_error(server, -ANJAY_ERR_BAD_OPTION);
+        }
+
+        int result = 0;
+        if (!has_error(server)) {
+            result = _anjay_coap_block_response_send(server->block_ctx,
+                                                     server->common.coap_ctx,
+                                                     server->common.socket);
+        }
+        _anjay_coap_block_response_delete(&server->block_ctx);
+        if (!has_error(server)) {
+            return result;
+        }
     }
 
-    if (has_block_ctx(server)) {
-        int result = _anjay_coap_block_transfer_finish(server->block_ctx);
-        server->request_identity =
-                _anjay_coap_block_response_last_request_id(server->block_ctx);
-        _anjay_coap_block_transfer_delete(&server->block_ctx);
-        _anjay_coap_id_source_release(&server->static_id_source);
-        return result;
+    if (has_error(server)) {
+#ifdef WITH_BLOCK_RECEIVE
+        if (server->block1_part != COAP_BLOCK1_PART_NONE) {
+            // an error response aborts the Block1 transfer
+            _anjay_coap_block1_reassembly_cleanup(
+                    server->common.block1_reassembly);
+        }
+#endif // WITH_BLOCK_RECEIVE
+        setup_error_response(server);
     }
 
     int result = 0;
@@ -216,6 +238,15 @@ static inline uint32_t get_block_offset(const avs_coap_block_info_t *block) {
     return block->seq_num * block->size;
 }
 
+static bool can_reassemble_block1(const coap_server_t *server) {
+#ifdef WITH_BLOCK_RECEIVE
+    return server->common.block1_reassembly != NULL;
+#else
+    (void) server;
+    return false;
+#endif
+}
+
 typedef enum process_result {
     /** The message is a correct request, a basic one or the first BLOCK */
     PROCESS_INITIAL_OK,
@@ -229,14 +260,16 @@ static process_result_t process_initial_request(coap_server_t *server,
                                                 const avs_coap_msg_t *msg) {
     assert(is_server_reset(server));
 
-    avs_coap_msg_type_t type = avs_coap_msg_get_type(msg);
-    if (!avs_coap_msg_is_request(msg)
-            // incoming Reset may still require some kind of reaction,
-            // so it should be handled by upper layers
-            && type != AVS_COAP_MSG_RESET) {
-        coap_log(DEBUG, "invalid request: %s",
+    if (!avs_coap_msg_is_request(msg)) {
+        // incoming Reset and responses may still require some kind of
+        // reaction (e.g. they may complete an Update exchange started
+        // earlier), so they should be handled by upper layers; Block options
+        // in them are not ours to interpret
+        coap_log(TRACE, "not a request: %s",
                  AVS_COAP_CODE_STRING(avs_coap_msg_get_code(msg)));
-        return PROCESS_INITIAL_INVALID_REQUEST;
+        server->state = COAP_SERVER_STATE_HAS_REQUEST;
+        server->request_identity = avs_coap_msg_get_identity(msg);
+        return PROCESS_INITIAL_OK;
     }
 
     avs_coap_block_info_t block1;
@@ -270,7 +303,14 @@ static process_result_t process_initial_request(coap_server_t *server,
                  get_block_offset(&server->curr_block),
                  server->curr_block.size);
 
-        if (server->curr_block.seq_num != 0) {
+        // with reassembly enabled, subsequent blocks of a Block1 request
+        // arrive as separate requests and are matched in
+        // reassemble_block1_request(); responses to GET are regenerated for
+        // each block, so any Block2 block may be requested at any time
+        if (server->curr_block.seq_num != 0
+                && !(block1.valid && can_reassemble_block1(server))
+                && !(block2.valid
+                        && avs_coap_msg_get_code(msg) == AVS_COAP_CODE_GET)) {
             coap_log(ERROR, "initial block seq_num nonzero");
             _anjay_coap_server_set_error(server,
                                          -ANJAY_ERR_REQUEST_ENTITY_INCOMPLETE);
@@ -289,65 +329,6 @@ static process_result_t process_initial_request(coap_server_t *server,
     return PROCESS_INITIAL_OK;
 }
 
-static int receive_request(coap_server_t *server) {
-    int result = _anjay_coap_in_get_next_message(&server->common.in,
-                                                 server->common.coap_ctx,
-                                                 server->common.socket);
-    if (result == AVS_COAP_CTX_ERR_MSG_TOO_LONG) {
-        const avs_coap_msg_t *partial_msg =
-                (avs_coap_msg_t *) server->common.in.buffer;
-        /**
-         * Due to Size1 Option semantics being not clear enough we don't
-         * inform Server about supported message size.
-         */
-        avs_coap_ctx_send_error(server->common.coap_ctx, server->common.socket,
-                                partial_msg,
-                                AVS_COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
-    }
-
-    if (result) {
-        return result;
-    }
-
-    const avs_coap_msg_t *msg = _anjay_coap_in_get_message(&server->common.in);
-    switch (process_initial_request(server, msg)) {
-    case PROCESS_INITIAL_INVALID_REQUEST:
-        if (!server->last_error_code) {
-            if (avs_coap_msg_get_type(msg) == AVS_COAP_MSG_CONFIRMABLE) {
-                avs_coap_ctx_send_empty(server->common.coap_ctx,
-                                        server->common.socket,
-                                        AVS_COAP_MSG_RESET,
-                                        avs_coap_msg_get_id(msg));
-            }
-        } else {
-            avs_coap_ctx_send_error(server->common.coap_ctx,
-                                    server->common.socket,
-                                    msg, server->last_error_code);
-        }
-        return -1;
-    case PROCESS_INITIAL_OK:
-        return 0;
-    }
-
-    assert(0 && "invalid enum value");
-    return -1;
-}
-
-int _anjay_coap_server_get_or_receive_msg(coap_server_t *server,
-                                          const avs_coap_msg_t **out_msg) {
-    if (server->state == COAP_SERVER_STATE_RESET) {
-        int result = receive_request(server);
-        if (result) {
-            *out_msg = NULL;
-            return result;
-        }
-    }
-
-    assert(server->state != COAP_SERVER_STATE_RESET);
-    *out_msg = _anjay_coap_in_get_message(&server->common.in);
-    return 0;
-}
-
 #ifdef WITH_BLOCK_RECEIVE
 static bool blocks_equal(const avs_coap_block_info_t *a,
                          const avs_coap_block_info_t *b) {
@@ -596,8 +577,298 @@ static int receive_next_block_with_timeout(coap_server_t *server) {
              PRIu32 ")", get_block_offset(&server->curr_block));
     return -1;
 }
+
+struct anjay_coap_block1_reassembly {
+    // critical options of the first block; all other blocks must match them
+    AVS_LIST(coap_block_optbuf_t) critical_opts;
+
+    avs_coap_msg_identity_t last_identity;
+    avs_coap_block_info_t last_block;
+    avs_time_monotonic_t expire_time;
+
+    // set if the request is handled part by part; data is not buffered then
+    bool streaming;
+
+    uint8_t *data;
+    // number of payload bytes received so far
+    size_t size;
+    size_t capacity;
+};
+
+void _anjay_coap_block1_reassembly_cleanup(
+        anjay_coap_block1_reassembly_t **reassembly_ptr) {
+    if (*reassembly_ptr) {
+        AVS_LIST_CLEAR(&(*reassembly_ptr)->critical_opts);
+        free((*reassembly_ptr)->data);
+        free(*reassembly_ptr);
+        *reassembly_ptr = NULL;
+    }
+}
+
+static int reassembly_append(anjay_coap_block1_reassembly_t *reassembly,
+                             const void *data,
+                             size_t data_size) {
+    assert(reassembly->size + data_size <= ANJAY_MAX_BLOCK1_REQUEST_SIZE);
+    if (reassembly->capacity - reassembly->size < data_size) {
+        size_t new_capacity = AVS_MAX(2 * reassembly->capacity,
+                                      reassembly->size + data_size);
+        new_capacity = AVS_MIN(new_capacity, ANJAY_MAX_BLOCK1_REQUEST_SIZE);
+        uint8_t *new_data = (uint8_t *) realloc(reassembly->data,
+                                                new_capacity);
+        if (!new_data) {
+            coap_log(ERROR, "out of memory");
+            return -1;
+        }
+        reassembly->data = new_data;
+        reassembly->capacity = new_capacity;
+    }
+    memcpy(reassembly->data + reassembly->size, data, data_size);
+    reassembly->size += data_size;
+    return 0;
+}
+
+/**
+ * Makes the payload buffered so far the beginning of the request payload, so
+ * that read() returns it before the payload of the current block.
+ */
+static void reassembly_take_data(coap_server_t *server,
+                                 anjay_coap_block1_reassembly_t *reassembly) {
+    assert(!server->block1_prefix);
+    server->block1_prefix = reassembly->data;
+    server->block1_prefix_size = reassembly->size;
+    server->block1_prefix_off = 0;
+    reassembly->data = NULL;
+    reassembly->capacity = 0;
+}
+
+static int reject_block(coap_server_t *server,
+                        const avs_coap_msg_t *msg,
+                        uint8_t error_code) {
+    avs_coap_ctx_send_error(server->common.coap_ctx, server->common.socket,
+                            msg, error_code);
+    return -1;
+}
+
+/**
+ * Handles a single block of a Block1 request without waiting for the next one.
+ *
+ * Intermediate blocks are appended to the reassembly buffer of the connection
+ * and acknowledged with 2.31 Continue immediately. When the last block arrives,
+ * the buffered payload is handed over to the server state and the request is
+ * handled as usual.
+ *
+ * If the buffer would grow past ANJAY_MAX_BLOCK1_REQUEST_SIZE, the request is
+ * passed to the upper layer part by part instead - see
+ * ANJAY_COAP_STREAM_BLOCK1_PART.
+ *
+ * @returns
+ * - 0 if the request is ready to be handled,
+ * - ANJAY_COAP_STREAM_BLOCK1_CONSUMED if the block has been buffered,
+ * - ANJAY_COAP_STREAM_BLOCK1_PART if the block is a part of a request too
+ *   large to be buffered,
+ * - a negative value in case of error; an error response is sent in that case.
+ */
+static int reassemble_block1_request(coap_server_t *server,
+                                     const avs_coap_msg_t *msg) {
+    anjay_coap_block1_reassembly_t **reassembly_ptr =
+            server->common.block1_reassembly;
+    const avs_coap_block_info_t *block = &server->curr_block;
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+
+    if (*reassembly_ptr
+            && avs_time_monotonic_before((*reassembly_ptr)->expire_time, now)) {
+        coap_log(DEBUG, "Block1 transfer expired (offset = %lu)",
+                 (unsigned long) (*reassembly_ptr)->size);
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+    }
+
+    bool matches_transfer =
+            *reassembly_ptr
+            && !block_validate_critical_options(
+                    (*reassembly_ptr)->critical_opts, msg, AVS_COAP_OPT_BLOCK1);
+
+    if (matches_transfer
+            && avs_coap_identity_equal(&(*reassembly_ptr)->last_identity,
+                                       &server->request_identity)
+            && blocks_equal(&(*reassembly_ptr)->last_block, block)) {
+        coap_log(TRACE, "block: duplicate of packet %" PRIu32,
+                 block->seq_num);
+        return send_continue(server, &server->request_identity)
+                ? -1 : ANJAY_COAP_STREAM_BLOCK1_CONSUMED;
+    }
+
+    if (block->seq_num == 0) {
+        if (matches_transfer) {
+            // RFC 7959 allows the client to restart the transfer at block 0
+            coap_log(DEBUG, "Block1 transfer restarted");
+        }
+
+        // a new transfer supersedes any unfinished one
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+        if (!block->has_more) {
+            return 0;
+        }
+
+        *reassembly_ptr = (anjay_coap_block1_reassembly_t *)
+                calloc(1, sizeof(anjay_coap_block1_reassembly_t));
+        if (!*reassembly_ptr) {
+            coap_log(ERROR, "out of memory");
+            return reject_block(server, msg,
+                                AVS_COAP_CODE_INTERNAL_SERVER_ERROR);
+        }
+        (*reassembly_ptr)->critical_opts = server->expected_block_opts;
+        server->expected_block_opts = NULL;
+    } else if (!matches_transfer) {
+        coap_log(ERROR, "block %" PRIu32 " does not belong to any transfer",
+                 block->seq_num);
+        return reject_block(server, msg,
+                            AVS_COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+    }
+
+    anjay_coap_block1_reassembly_t *reassembly = *reassembly_ptr;
+    if (get_block_offset(block) != reassembly->size) {
+        coap_log(ERROR, "incomplete block request");
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+        return reject_block(server, msg,
+                            AVS_COAP_CODE_REQUEST_ENTITY_INCOMPLETE);
+    }
+
+    size_t payload_size = avs_coap_msg_payload_length(msg);
+    if (block->has_more && payload_size != block->size) {
+        coap_log(ERROR, "block %" PRIu32 " has %lu bytes of payload, "
+                 "expected %" PRIu16, block->seq_num,
+                 (unsigned long) payload_size, block->size);
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+        return reject_block(server, msg, AVS_COAP_CODE_BAD_REQUEST);
+    }
+
+    if (reassembly->streaming) {
+        server->block1_part = COAP_BLOCK1_PART_NEXT;
+    } else if (!block->has_more) {
+        reassembly_take_data(server, reassembly);
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+        return 0;
+    } else if (reassembly->size + payload_size
+                   > ANJAY_MAX_BLOCK1_REQUEST_SIZE) {
+        coap_log(DEBUG, "Block1 request exceeds %lu bytes, passing it on "
+                 "part by part", (unsigned long) ANJAY_MAX_BLOCK1_REQUEST_SIZE);
+        reassembly_take_data(server, reassembly);
+        server->block1_part = COAP_BLOCK1_PART_FIRST;
+    } else if (reassembly_append(reassembly, avs_coap_msg_payload(msg),
+                                 payload_size)) {
+        _anjay_coap_block1_reassembly_cleanup(reassembly_ptr);
+        return reject_block(server, msg, AVS_COAP_CODE_INTERNAL_SERVER_ERROR);
+    }
+
+    avs_coap_tx_params_t tx_params =
+            avs_coap_ctx_get_tx_params(server->common.coap_ctx);
+    reassembly->last_identity = server->request_identity;
+    reassembly->last_block = *block;
+    // see CoAP BLOCK, 2.5 "Using the Block1 Option"
+    reassembly->expire_time =
+            avs_time_monotonic_add(now, avs_coap_exchange_lifetime(&tx_params));
+
+    if (server->block1_part != COAP_BLOCK1_PART_NONE) {
+        // the upper layer is responsible for responding to this one
+        reassembly->size += payload_size;
+        return ANJAY_COAP_STREAM_BLOCK1_PART;
+    }
+
+    coap_log(TRACE, "block: packet %" PRIu32 " buffered", block->seq_num);
+    if (send_continue(server, &server->request_identity)) {
+        return -1;
+    }
+    return ANJAY_COAP_STREAM_BLOCK1_CONSUMED;
+}
+
+int _anjay_coap_server_begin_block1_part(coap_server_t *server,
+                                         size_t *out_offset,
+                                         bool *out_last) {
+    if (server->block1_part != COAP_BLOCK1_PART_FIRST
+            && server->block1_part != COAP_BLOCK1_PART_NEXT) {
+        coap_log(ERROR, "no Block1 request part to handle");
+        return -1;
+    }
+
+    assert(server->state == COAP_SERVER_STATE_HAS_BLOCK1_REQUEST);
+    assert(*server->common.block1_reassembly);
+    (*server->common.block1_reassembly)->streaming = true;
+    server->block1_part = COAP_BLOCK1_PART_STREAMING;
+
+    *out_offset = get_block_offset(&server->curr_block)
+            - server->block1_prefix_size;
+    *out_last = !server->curr_block.has_more;
+    return 0;
+}
+#else // WITH_BLOCK_RECEIVE
+#define reassemble_block1_request(Server, Msg) \
+        (assert(0 && "Block1 reassembly not supported"), -1)
 #endif // WITH_BLOCK_RECEIVE
 
+static int receive_request(coap_server_t *server) {
+    int result = _anjay_coap_in_get_next_message(&server->common.in,
+                                                 server->common.coap_ctx,
+                                                 server->common.socket);
+    if (result == AVS_COAP_CTX_ERR_MSG_TOO_LONG) {
+        const avs_coap_msg_t *partial_msg =
+                (avs_coap_msg_t *) server->common.in.buffer;
+        /**
+         * Due to Size1 Option semantics being not clear enough we don't
+         * inform Server about supported message size.
+         */
+        avs_coap_ctx_send_error(server->common.coap_ctx, server->common.socket,
+                                partial_msg,
+                                AVS_COAP_CODE_REQUEST_ENTITY_TOO_LARGE);
+    }
+
+    if (result) {
+        return result;
+    }
+
+    const avs_coap_msg_t *msg = _anjay_coap_in_get_message(&server->common.in);
+    switch (process_initial_request(server, msg)) {
+    case PROCESS_INITIAL_INVALID_REQUEST:
+        if (!server->last_error_code) {
+            if (avs_coap_msg_get_type(msg) == AVS_COAP_MSG_CONFIRMABLE) {
+                avs_coap_ctx_send_empty(server->common.coap_ctx,
+                                        server->common.socket,
+                                        AVS_COAP_MSG_RESET,
+                                        avs_coap_msg_get_id(msg));
+            }
+        } else {
+            avs_coap_ctx_send_error(server->common.coap_ctx,
+                                    server->common.socket,
+                                    msg, server->last_error_code);
+        }
+        return -1;
+    case PROCESS_INITIAL_OK:
+        if (server->state == COAP_SERVER_STATE_HAS_BLOCK1_REQUEST
+                && can_reassemble_block1(server)) {
+            return reassemble_block1_request(server, msg);
+        }
+        return 0;
+    }
+
+    assert(0 && "invalid enum value");
+    return -1;
+}
+
+int _anjay_coap_server_get_or_receive_msg(coap_server_t *server,
+                                          const avs_coap_msg_t **out_msg) {
+    int result = 0;
+    if (server->state == COAP_SERVER_STATE_RESET) {
+        result = receive_request(server);
+        if (result && result != ANJAY_COAP_STREAM_BLOCK1_PART) {
+            *out_msg = NULL;
+            return result;
+        }
+    }
+
+    assert(server->state != COAP_SERVER_STATE_RESET);
+    *out_msg = _anjay_coap_in_get_message(&server->common.in);
+    return result;
+}
+
 int _anjay_coap_server_read(coap_server_t *server,
                             size_t *out_bytes_read,
                             char *out_message_finished,
@@ -608,6 +879,23 @@ int _anjay_coap_server_read(coap_server_t *server,
     }
 
 #ifdef WITH_BLOCK_RECEIVE
+    if (server->block1_part == COAP_BLOCK1_PART_NEXT) {
+        coap_log(ERROR, "Block1 request can only be handled part by part");
+        return -1;
+    }
+
+    if (server->block1_prefix_off < server->block1_prefix_size) {
+        size_t bytes_to_copy =
+                AVS_MIN(buffer_length,
+                        server->block1_prefix_size - server->block1_prefix_off);
+        memcpy(buffer, server->block1_prefix + server->block1_prefix_off,
+               bytes_to_copy);
+        server->block1_prefix_off += bytes_to_copy;
+        *out_bytes_read = bytes_to_copy;
+        *out_message_finished = false;
+        return 0;
+    }
+
     if (server->state == COAP_SERVER_STATE_NEEDS_NEXT_BLOCK) {
         // An attempt to read more payload was made, but we finished reading
         // last packet. Send 2.31 Continue to let the server know we are ready
@@ -630,6 +918,11 @@ int _anjay_coap_server_read(coap_server_t *server,
 #ifdef WITH_BLOCK_RECEIVE
             coap_log(TRACE, "block: packet %" PRIu32 " finished",
                      server->curr_block.seq_num);
+            if (server->block1_part == COAP_BLOCK1_PART_STREAMING) {
+                // the part ends here; the next one will arrive as a separate
+                // request
+                return 0;
+            }
 
             server->state = COAP_SERVER_STATE_NEEDS_NEXT_BLOCK;
             *out_message_finished = false;
@@ -653,50 +946,32 @@ int _anjay_coap_server_read(coap_server_t *server,
     return 0;
 }
 
+static bool block_response_requested(coap_server_t *server) {
+    return server->curr_block.valid
+               && server->curr_block.type == AVS_COAP_BLOCK2;
+}
+
 #ifdef WITH_BLOCK_SEND
 static int block_write(coap_server_t *server,
                        const void *data,
                        size_t data_length) {
     if (!server->block_ctx) {
-        uint16_t block_size = server->curr_block.valid
-                ? server->curr_block.size
-                : AVS_COAP_MSG_BLOCK_MAX_SIZE;
-
-        server->static_id_source = _anjay_coap_id_source_new_static(
-                _anjay_coap_server_get_request_identity(server));
-        if (!server->static_id_source) {
-            return -1;
-        }
         server->block_ctx = _anjay_coap_block_response_new(
-                block_size, &server->common, server->static_id_source,
-                &server->block_relation_validator);
-
+                block_response_requested(server) ? &server->curr_block : NULL,
+                &server->common.out);
         if (!server->block_ctx) {
-            _anjay_coap_id_source_release(&server->static_id_source);
             return -1;
         }
-
     }
-    int result = _anjay_coap_block_transfer_write(server->block_ctx, data,
-                                                  data_length);
-    if (result) {
-        server->request_identity =
-                _anjay_coap_block_response_last_request_id(server->block_ctx);
-        _anjay_coap_block_transfer_delete(&server->block_ctx);
-        _anjay_coap_id_source_release(&server->static_id_source);
-    }
-    return result;
+
+    _anjay_coap_block_response_write(server->block_ctx, data, data_length);
+    return 0;
 }
 #else
 #define block_write(...) \
         (coap_log(ERROR, "sending blockwise responses not supported"), -1)
 #endif
 
-static bool block_response_requested(coap_server_t *server) {
-    return server->curr_block.valid
-               && server->curr_block.type == AVS_COAP_BLOCK2;
-}
-
 int _anjay_coap_server_write(coap_server_t *server,
                              const void *data,
                              size_t data_length) {
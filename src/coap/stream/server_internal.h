@@ -22,7 +22,6 @@
 
 #include "../coap_stream.h"
 #include "../block/response.h"
-#include "../id_source/id_source.h"
 #include "common.h"
 #include "in.h"
 #include "out.h"
@@ -57,6 +56,21 @@ typedef enum coap_server_state {
     COAP_SERVER_STATE_NEEDS_NEXT_BLOCK
 } coap_server_state_t;
 
+typedef enum coap_block1_part_state {
+    // not a part of a Block1 request too large to be reassembled
+    COAP_BLOCK1_PART_NONE,
+
+    // first block that did not fit in the reassembly buffer; the request may
+    // still be handled as a whole, receiving remaining blocks synchronously
+    COAP_BLOCK1_PART_FIRST,
+
+    // subsequent block of a request handled part by part
+    COAP_BLOCK1_PART_NEXT,
+
+    // _anjay_coap_server_begin_block1_part() called on the current block
+    COAP_BLOCK1_PART_STREAMING
+} coap_block1_part_state_t;
+
 typedef struct coap_server {
     coap_stream_common_t common;
 
@@ -66,10 +80,8 @@ typedef struct coap_server {
     avs_coap_msg_identity_t request_identity;
 
 #ifdef WITH_BLOCK_SEND
-    coap_block_transfer_ctx_t *block_ctx;
-    anjay_coap_block_request_validator_ctx_t block_relation_validator;
+    coap_block_response_t *block_ctx;
 #endif
-    coap_id_source_t *static_id_source;
 
     // only valid if state == COAP_SERVER_STATE_HAS_BLOCK1_REQUEST or
     // state == COAP_SERVER_STATE_HAS_BLOCK2_REQUEST
@@ -78,22 +90,22 @@ typedef struct coap_server {
     uint32_t expected_block_offset;
     AVS_LIST(coap_block_optbuf_t) expected_block_opts;
 
+#ifdef WITH_BLOCK_RECEIVE
+    // payload of Block1 blocks that preceded the current one, reassembled
+    // over previous anjay_serve() calls; read() drains it before the payload
+    // of the current block
+    uint8_t *block1_prefix;
+    size_t block1_prefix_size;
+    size_t block1_prefix_off;
+
+    coap_block1_part_state_t block1_part;
+#endif // WITH_BLOCK_RECEIVE
+
     uint8_t last_error_code;
 } coap_server_t;
 
 void _anjay_coap_server_reset(coap_server_t *server);
 
-#ifdef WITH_BLOCK_SEND
-void _anjay_coap_server_set_block_request_relation_validator(
-        coap_server_t *server,
-        anjay_coap_block_request_validator_t *validator,
-        void *validator_arg);
-#else // WITH_BLOCK_SEND
-#define _anjay_coap_server_set_block_request_relation_validator( \
-                Server, Validator, Arg) \
-        ((void) (Server), (void) (Validator), (void) (Arg))
-#endif // WITH_BLOCK_SEND
-
 /**
  * @returns identity of the current request or NULL if there is no request.
  */
@@ -130,6 +142,10 @@ int _anjay_coap_server_finish_response(coap_server_t *server);
  *
  * @returns:
  * - 0 if @p out_msg was filled with a correct CoAP request,
+ * - ANJAY_COAP_STREAM_BLOCK1_CONSUMED if the request was a Block1 request
+ *   block that has been buffered; @p out_msg is set to NULL in that case,
+ * - ANJAY_COAP_STREAM_BLOCK1_PART if @p out_msg was filled with a part of
+ *   a Block1 request too large to be buffered,
  * - a negative value on error. In that case @p out_msg is set to NULL.
  */
 int _anjay_coap_server_get_or_receive_msg(coap_server_t *server,
@@ -149,6 +165,18 @@ int _anjay_coap_server_read(coap_server_t *server,
                             void *buffer,
                             size_t buffer_length);
 
+#ifdef WITH_BLOCK_RECEIVE
+/**
+ * Implements @ref _anjay_coap_stream_begin_block1_part .
+ */
+int _anjay_coap_server_begin_block1_part(coap_server_t *server,
+                                         size_t *out_offset,
+                                         bool *out_last);
+#else // WITH_BLOCK_RECEIVE
+#define _anjay_coap_server_begin_block1_part(Server, OutOffset, OutLast) \
+        ((void) (Server), (void) (OutOffset), (void) (OutLast), -1)
+#endif // WITH_BLOCK_RECEIVE
+
 int _anjay_coap_server_write(coap_server_t *server,
                              const void *data,
                              size_t data_length);
@@ -112,7 +112,7 @@ static int get_or_receive_msg(coap_stream_t *stream,
         break;
     }
 
-    if (result) {
+    if (result && result != ANJAY_COAP_STREAM_BLOCK1_PART) {
         reset(stream);
         *out_msg = NULL;
     }
@@ -218,7 +218,7 @@ static int coap_read(avs_stream_abstract_t *stream_,
 
     const avs_coap_msg_t *msg;
     int result = get_or_receive_msg(stream, &msg);
-    if (result) {
+    if (result && result != ANJAY_COAP_STREAM_BLOCK1_PART) {
         return result;
     }
 
@@ -419,6 +419,40 @@ int _anjay_coap_stream_get_incoming_msg(avs_stream_abstract_t *stream_,
     return 0;
 }
 
+int _anjay_coap_stream_begin_block1_part(avs_stream_abstract_t *stream_,
+                                         size_t *out_offset,
+                                         bool *out_last) {
+    coap_stream_t *stream = (coap_stream_t*)stream_;
+    assert(stream->vtable == &COAP_STREAM_VTABLE);
+
+    if (stream->state != STREAM_STATE_SERVER) {
+        coap_log(ERROR, "begin_block1_part called on a non-server stream");
+        return -1;
+    }
+
+    return _anjay_coap_server_begin_block1_part(get_server(stream), out_offset,
+                                                out_last);
+}
+
+int _anjay_coap_stream_take_request(avs_stream_abstract_t *stream_,
+                                    avs_coap_msg_t **out_msg) {
+    coap_stream_t *stream = (coap_stream_t*)stream_;
+    assert(stream->vtable == &COAP_STREAM_VTABLE);
+
+    if (stream->state != STREAM_STATE_CLIENT) {
+        coap_log(ERROR, "take_request called on a non-client stream");
+        return -1;
+    }
+
+    int result = _anjay_coap_client_copy_request(get_client(stream), out_msg);
+    if (result == COAP_CLIENT_REQUEST_BLOCKWISE) {
+        return ANJAY_COAP_STREAM_REQUEST_BLOCKWISE;
+    } else if (!result) {
+        reset(stream);
+    }
+    return result;
+}
+
 int _anjay_coap_stream_get_request_identity(avs_stream_abstract_t *stream_,
                                             avs_coap_msg_identity_t *out_id) {
     coap_stream_t *stream = (coap_stream_t*)stream_;
@@ -442,13 +476,17 @@ int _anjay_coap_stream_get_request_identity(avs_stream_abstract_t *stream_,
     return 0;
 }
 
-void _anjay_coap_stream_set_block_request_validator(
+int _anjay_coap_stream_set_block1_reassembly(
         avs_stream_abstract_t *stream_,
-        anjay_coap_block_request_validator_t *validator,
-        void *validator_arg) {
+        anjay_coap_block1_reassembly_t **reassembly_ptr) {
     coap_stream_t *stream = (coap_stream_t*) stream_;
     assert(stream->vtable == &COAP_STREAM_VTABLE);
 
-    _anjay_coap_server_set_block_request_relation_validator(
-            get_server(stream), validator, validator_arg);
+    if (!is_reset(stream)) {
+        coap_log(ERROR, "cannot change Block1 reassembly state mid-exchange");
+        return -1;
+    }
+
+    stream->data.common.block1_reassembly = reassembly_ptr;
+    return 0;
 }
@@ -30,7 +30,6 @@
 #include "../coap_stream.h"
 #include "../stream/stream_internal.h"
 #include "../block/response.h"
-#include "../block/transfer_impl.h"
 
 typedef struct test_ctx {
     avs_net_abstract_socket_t *mocksock;
@@ -112,16 +111,13 @@ static size_t block_size_for_buffer_size_and_mtu(size_t out_buffer_size,
     AVS_UNIT_ASSERT_SUCCESS(
             _anjay_coap_out_setup_msg(&coap_stream(&test)->data.common.out,
                                       &id, &details, NULL));
-    static coap_id_source_t *FAKE_ID_SOURCE = (coap_id_source_t *) -1;
-    coap_block_transfer_ctx_t *ctx =
-            _anjay_coap_block_response_new(AVS_COAP_MSG_BLOCK_MAX_SIZE,
-                                           &coap_stream(&test)->data.common,
-                                           FAKE_ID_SOURCE, NULL);
+    coap_block_response_t *ctx = _anjay_coap_block_response_new(
+            NULL, &coap_stream(&test)->data.common.out);
 
     size_t block_size = 0;
     if (ctx) {
         block_size = ctx->block.size;
-        _anjay_coap_block_transfer_delete(&ctx);
+        _anjay_coap_block_response_delete(&ctx);
     }
     teardown(&test);
 
@@ -748,3 +748,471 @@ AVS_UNIT_TEST(coap_stream, fuzz_1_invalid_block_size) {
 
     avs_stream_cleanup(&stream);
 }
+
+#ifdef WITH_BLOCK_SEND
+static void respond_with_block2(test_data_t *test,
+                                const char *request,
+                                size_t request_size) {
+    static const char PAYLOAD[] = "0123456789abcdef"
+                                  "ghijklmnopqrstuv"
+                                  "wxyz0123";
+    avs_unit_mocksock_input(test->mock_socket, request, request_size);
+
+    const avs_coap_msg_t *msg;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_coap_stream_get_incoming_msg(test->stream,
+                                                                &msg));
+
+    const anjay_msg_details_t details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = AVS_COAP_CODE_CONTENT,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_setup_response(test->stream, &details));
+    // the whole payload is written each time, regardless of the block
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(test->stream, PAYLOAD,
+                                             sizeof(PAYLOAD) - 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(test->stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(test->stream));
+}
+
+AVS_UNIT_TEST(coap_stream, block2_any_block) {
+    test_data_t test = setup_test();
+
+    static const char REQUEST_1[] =
+            "\x40\x01\x00\x01" // Confirmable, 0.01 Get, id = 1
+            "\xd1\x0a\x10";     // Block2: seq_num = 1, size = 16
+    static const char RESPONSE_1[] =
+            "\x60\x45\x00\x01" // Acknowledgement, 2.05 Content, id = 1
+            "\xd1\x0a\x18"      // Block2: seq_num = 1, has_more = 1, size = 16
+            "\xff"
+            "ghijklmnopqrstuv";
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE_1,
+                                    sizeof(RESPONSE_1) - 1);
+    respond_with_block2(&test, REQUEST_1, sizeof(REQUEST_1) - 1);
+
+    // blocks are not required to be requested in order
+    static const char REQUEST_0[] =
+            "\x40\x01\x00\x02" // Confirmable, 0.01 Get, id = 2
+            "\xd1\x0a\x00";     // Block2: seq_num = 0, size = 16
+    static const char RESPONSE_0[] =
+            "\x60\x45\x00\x02" // Acknowledgement, 2.05 Content, id = 2
+            "\xd1\x0a\x08"      // Block2: seq_num = 0, has_more = 1, size = 16
+            "\xff"
+            "0123456789abcdef";
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE_0,
+                                    sizeof(RESPONSE_0) - 1);
+    respond_with_block2(&test, REQUEST_0, sizeof(REQUEST_0) - 1);
+
+    static const char REQUEST_2[] =
+            "\x40\x01\x00\x03" // Confirmable, 0.01 Get, id = 3
+            "\xd1\x0a\x20";     // Block2: seq_num = 2, size = 16
+    static const char RESPONSE_2[] =
+            "\x60\x45\x00\x03" // Acknowledgement, 2.05 Content, id = 3
+            "\xd1\x0a\x20"      // Block2: seq_num = 2, has_more = 0, size = 16
+            "\xff"
+            "wxyz0123";
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE_2,
+                                    sizeof(RESPONSE_2) - 1);
+    respond_with_block2(&test, REQUEST_2, sizeof(REQUEST_2) - 1);
+
+    teardown_test(&test);
+}
+
+AVS_UNIT_TEST(coap_stream, block2_past_the_end) {
+    test_data_t test = setup_test();
+
+    static const char REQUEST[] =
+            "\x40\x01\x00\x01" // Confirmable, 0.01 Get, id = 1
+            "\xd1\x0a\x30";     // Block2: seq_num = 3, size = 16
+    static const char RESPONSE[] =
+            "\x60\x82\x00\x01"; // Acknowledgement, 4.02 Bad Option, id = 1
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE,
+                                    sizeof(RESPONSE) - 1);
+    respond_with_block2(&test, REQUEST, sizeof(REQUEST) - 1);
+
+    teardown_test(&test);
+}
+
+AVS_UNIT_TEST(coap_stream, block2_not_get) {
+    test_data_t test = setup_test();
+
+    // only GET requests are safe to be handled again for each block
+    static const char REQUEST[] =
+            "\x40\x02\x00\x01" // Confirmable, 0.02 Post, id = 1
+            "\xd1\x0a\x10";     // Block2: seq_num = 1, size = 16
+    static const char RESPONSE[] =
+            "\x60\x88\x00\x01"; // Acknowledgement, 4.08 Request Entity
+                                  // Incomplete, id = 1
+    avs_unit_mocksock_input(test.mock_socket, REQUEST, sizeof(REQUEST) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE,
+                                    sizeof(RESPONSE) - 1);
+
+    const avs_coap_msg_t *msg;
+    AVS_UNIT_ASSERT_FAILED(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                               &msg));
+    teardown_test(&test);
+}
+#endif // WITH_BLOCK_SEND
+
+#ifdef WITH_BLOCK_RECEIVE
+AVS_UNIT_TEST(coap_stream, block1_reassembly) {
+    test_data_t test = setup_test();
+    anjay_coap_block1_reassembly_t *reassembly = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, &reassembly));
+
+    static const char BLOCK_0[] =
+            "\x40\x03\x00\x01" // Confirmable, 0.03 Put, id = 1
+            "\xd1\x0e\x08"     // Block1: seq_num = 0, has_more = 1, size = 16
+            "\xff"
+            "0123456789abcdef";
+    static const char CONTINUE_0[] =
+            "\x60\x5f\x00\x01" // Acknowledgement, 2.31 Continue, id = 1
+            "\xd1\x0e\x08";
+    avs_unit_mocksock_input(test.mock_socket, BLOCK_0, sizeof(BLOCK_0) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, CONTINUE_0,
+                                    sizeof(CONTINUE_0) - 1);
+
+    // intermediate block is acknowledged without waiting for the next one
+    const avs_coap_msg_t *msg;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                              &msg),
+                          ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+    AVS_UNIT_ASSERT_NOT_NULL(reassembly);
+
+    // a block that does not continue the transfer is rejected
+    static const char STRAY_BLOCK[] =
+            "\x40\x03\x00\x02" // Confirmable, 0.03 Put, id = 2
+            "\xd1\x0e\x28"     // Block1: seq_num = 2, has_more = 1, size = 16
+            "\xff"
+            "0123456789abcdef";
+    static const char INCOMPLETE[] =
+            "\x60\x88\x00\x02"; // Acknowledgement, 4.08 Entity Incomplete
+    avs_unit_mocksock_input(test.mock_socket, STRAY_BLOCK,
+                            sizeof(STRAY_BLOCK) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, INCOMPLETE,
+                                    sizeof(INCOMPLETE) - 1);
+    AVS_UNIT_ASSERT_FAILED(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                               &msg));
+    AVS_UNIT_ASSERT_NULL(reassembly);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, NULL));
+    teardown_test(&test);
+}
+
+AVS_UNIT_TEST(coap_stream, block1_reassembly_complete) {
+    test_data_t test = setup_test();
+    anjay_coap_block1_reassembly_t *reassembly = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, &reassembly));
+
+    static const char BLOCK_0[] =
+            "\x40\x03\x00\x01" // Confirmable, 0.03 Put, id = 1
+            "\xd1\x0e\x08"     // Block1: seq_num = 0, has_more = 1, size = 16
+            "\xff"
+            "0123456789abcdef";
+    static const char CONTINUE_0[] =
+            "\x60\x5f\x00\x01" // Acknowledgement, 2.31 Continue, id = 1
+            "\xd1\x0e\x08";
+    avs_unit_mocksock_input(test.mock_socket, BLOCK_0, sizeof(BLOCK_0) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, CONTINUE_0,
+                                    sizeof(CONTINUE_0) - 1);
+
+    const avs_coap_msg_t *msg;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                              &msg),
+                          ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+
+    static const char BLOCK_1[] =
+            "\x40\x03\x00\x02" // Confirmable, 0.03 Put, id = 2
+            "\xd1\x0e\x10"     // Block1: seq_num = 1, has_more = 0, size = 16
+            "\xff"
+            "ghij";
+    avs_unit_mocksock_input(test.mock_socket, BLOCK_1, sizeof(BLOCK_1) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                                &msg));
+    AVS_UNIT_ASSERT_NULL(reassembly);
+
+    // the whole payload is readable at once, without any more packets
+    char buffer[64];
+    size_t total_read = 0;
+    char message_finished = 0;
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                test.stream, &bytes_read, &message_finished,
+                buffer + total_read, sizeof(buffer) - total_read));
+        total_read += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(total_read, sizeof("0123456789abcdefghij") - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "0123456789abcdefghij",
+                                      total_read);
+
+    static const char RESPONSE[] =
+            "\x60\x44\x00\x02" // Acknowledgement, 2.04 Changed, id = 2
+            "\xd1\x0e\x10";
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE,
+                                    sizeof(RESPONSE) - 1);
+
+    const anjay_msg_details_t details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = AVS_COAP_CODE_CHANGED,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_setup_response(test.stream, &details));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(test.stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(test.stream));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, NULL));
+    teardown_test(&test);
+}
+
+AVS_UNIT_TEST(coap_stream, block1_reassembly_restart) {
+    test_data_t test = setup_test();
+    anjay_coap_block1_reassembly_t *reassembly = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, &reassembly));
+
+    static const char BLOCK_0[] =
+            "\x40\x03\x00\x01" // Confirmable, 0.03 Put, id = 1
+            "\xd1\x0e\x08"     // Block1: seq_num = 0, has_more = 1, size = 16
+            "\xff"
+            "0123456789abcdef";
+    static const char CONTINUE_0[] =
+            "\x60\x5f\x00\x01" // Acknowledgement, 2.31 Continue, id = 1
+            "\xd1\x0e\x08";
+    avs_unit_mocksock_input(test.mock_socket, BLOCK_0, sizeof(BLOCK_0) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, CONTINUE_0,
+                                    sizeof(CONTINUE_0) - 1);
+
+    const avs_coap_msg_t *msg;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                              &msg),
+                          ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+
+    static const char BLOCK_1[] =
+            "\x40\x03\x00\x02" // Confirmable, 0.03 Put, id = 2
+            "\xd1\x0e\x18"     // Block1: seq_num = 1, has_more = 1, size = 16
+            "\xff"
+            "ghijklmnopqrstuv";
+    static const char CONTINUE_1[] =
+            "\x60\x5f\x00\x02" // Acknowledgement, 2.31 Continue, id = 2
+            "\xd1\x0e\x18";
+    avs_unit_mocksock_input(test.mock_socket, BLOCK_1, sizeof(BLOCK_1) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, CONTINUE_1,
+                                    sizeof(CONTINUE_1) - 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                              &msg),
+                          ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+
+    // a new block 0 discards the buffered data and starts over
+    static const char NEW_BLOCK_0[] =
+            "\x40\x03\x00\x03" // Confirmable, 0.03 Put, id = 3
+            "\xd1\x0e\x08"     // Block1: seq_num = 0, has_more = 1, size = 16
+            "\xff"
+            "ABCDEFGHIJKLMNOP";
+    static const char NEW_CONTINUE_0[] =
+            "\x60\x5f\x00\x03" // Acknowledgement, 2.31 Continue, id = 3
+            "\xd1\x0e\x08";
+    avs_unit_mocksock_input(test.mock_socket, NEW_BLOCK_0,
+                            sizeof(NEW_BLOCK_0) - 1);
+    avs_unit_mocksock_expect_output(test.mock_socket, NEW_CONTINUE_0,
+                                    sizeof(NEW_CONTINUE_0) - 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                              &msg),
+                          ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+    AVS_UNIT_ASSERT_NOT_NULL(reassembly);
+
+    static const char LAST_BLOCK[] =
+            "\x40\x03\x00\x04" // Confirmable, 0.03 Put, id = 4
+            "\xd1\x0e\x10"     // Block1: seq_num = 1, has_more = 0, size = 16
+            "\xff"
+            "QRST";
+    avs_unit_mocksock_input(test.mock_socket, LAST_BLOCK,
+                            sizeof(LAST_BLOCK) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_coap_stream_get_incoming_msg(test.stream,
+                                                                &msg));
+    AVS_UNIT_ASSERT_NULL(reassembly);
+
+    char buffer[64];
+    size_t total_read = 0;
+    char message_finished = 0;
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                test.stream, &bytes_read, &message_finished,
+                buffer + total_read, sizeof(buffer) - total_read));
+        total_read += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(total_read, sizeof("ABCDEFGHIJKLMNOPQRST") - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "ABCDEFGHIJKLMNOPQRST",
+                                      total_read);
+
+    static const char RESPONSE[] =
+            "\x60\x44\x00\x04" // Acknowledgement, 2.04 Changed, id = 4
+            "\xd1\x0e\x10";
+    avs_unit_mocksock_expect_output(test.mock_socket, RESPONSE,
+                                    sizeof(RESPONSE) - 1);
+
+    const anjay_msg_details_t details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = AVS_COAP_CODE_CHANGED,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_setup_response(test.stream, &details));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(test.stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(test.stream));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, NULL));
+    teardown_test(&test);
+}
+
+#define PART_BLOCK_SIZE 1024
+
+static size_t put_block1_option(uint8_t *out, uint32_t seq_num, bool has_more) {
+    // SZX = 6 encodes PART_BLOCK_SIZE
+    uint32_t value = (seq_num << 4) | ((uint32_t) has_more << 3) | 6;
+    out[1] = AVS_COAP_OPT_BLOCK1 - 13;
+    if (value <= 0xFF) {
+        out[0] = 0xd1;
+        out[2] = (uint8_t) value;
+        return 3;
+    } else {
+        out[0] = 0xd2;
+        out[2] = (uint8_t) (value >> 8);
+        out[3] = (uint8_t) value;
+        return 4;
+    }
+}
+
+static void expect_block1_response(test_data_t *test,
+                                   uint8_t code,
+                                   uint16_t msg_id,
+                                   uint32_t seq_num,
+                                   bool has_more) {
+    static uint8_t response[8];
+    response[0] = 0x60; // Acknowledgement
+    response[1] = code;
+    response[2] = (uint8_t) (msg_id >> 8);
+    response[3] = (uint8_t) msg_id;
+    size_t size = 4 + put_block1_option(&response[4], seq_num, has_more);
+    avs_unit_mocksock_expect_output(test->mock_socket, response, size);
+}
+
+static int receive_block1(test_data_t *test,
+                          uint16_t msg_id,
+                          uint32_t seq_num,
+                          bool has_more,
+                          size_t payload_size) {
+    static uint8_t request[8 + PART_BLOCK_SIZE];
+    request[0] = 0x40; // Confirmable
+    request[1] = AVS_COAP_CODE_PUT;
+    request[2] = (uint8_t) (msg_id >> 8);
+    request[3] = (uint8_t) msg_id;
+    size_t size = 4 + put_block1_option(&request[4], seq_num, has_more);
+    request[size++] = 0xff;
+    for (size_t i = 0; i < payload_size; ++i) {
+        request[size++] = (uint8_t) (seq_num * PART_BLOCK_SIZE + i);
+    }
+    avs_unit_mocksock_input(test->mock_socket, request, size);
+
+    const avs_coap_msg_t *msg;
+    return _anjay_coap_stream_get_incoming_msg(test->stream, &msg);
+}
+
+static void read_block1_part(test_data_t *test,
+                             size_t expected_offset,
+                             size_t expected_size,
+                             bool expected_last) {
+    size_t offset;
+    bool last;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_begin_block1_part(test->stream, &offset, &last));
+    AVS_UNIT_ASSERT_EQUAL(offset, expected_offset);
+    AVS_UNIT_ASSERT_EQUAL(last, expected_last);
+
+    size_t total_read = 0;
+    char message_finished = 0;
+    while (!message_finished) {
+        uint8_t buffer[PART_BLOCK_SIZE];
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(test->stream, &bytes_read,
+                                                &message_finished,
+                                                buffer, sizeof(buffer)));
+        for (size_t i = 0; i < bytes_read; ++i) {
+            AVS_UNIT_ASSERT_EQUAL(buffer[i],
+                                  (uint8_t) (offset + total_read + i));
+        }
+        total_read += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(total_read, expected_size);
+}
+
+AVS_UNIT_TEST(coap_stream, block1_parts) {
+    test_data_t test = setup_test();
+    anjay_coap_block1_reassembly_t *reassembly = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, &reassembly));
+
+    // fill the reassembly buffer
+    const uint32_t buffered_blocks =
+            ANJAY_MAX_BLOCK1_REQUEST_SIZE / PART_BLOCK_SIZE;
+    uint16_t msg_id = 1;
+    for (uint32_t seq_num = 0; seq_num < buffered_blocks; ++seq_num, ++msg_id) {
+        expect_block1_response(&test, AVS_COAP_CODE_CONTINUE, msg_id, seq_num,
+                               true);
+        AVS_UNIT_ASSERT_EQUAL(
+                receive_block1(&test, msg_id, seq_num, true, PART_BLOCK_SIZE),
+                ANJAY_COAP_STREAM_BLOCK1_CONSUMED);
+    }
+
+    // the block that does not fit is passed on along with the buffered data
+    AVS_UNIT_ASSERT_EQUAL(receive_block1(&test, msg_id, buffered_blocks, true,
+                                         PART_BLOCK_SIZE),
+                          ANJAY_COAP_STREAM_BLOCK1_PART);
+    read_block1_part(&test, 0, (buffered_blocks + 1) * PART_BLOCK_SIZE, false);
+
+    const anjay_msg_details_t continue_details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = AVS_COAP_CODE_CONTINUE,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    expect_block1_response(&test, AVS_COAP_CODE_CONTINUE, msg_id,
+                           buffered_blocks, true);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_setup_response(test.stream, &continue_details));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(test.stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(test.stream));
+    AVS_UNIT_ASSERT_NOT_NULL(reassembly);
+    ++msg_id;
+
+    // subsequent blocks are passed on one by one, as separate requests
+    AVS_UNIT_ASSERT_EQUAL(receive_block1(&test, msg_id, buffered_blocks + 1,
+                                         false, 42),
+                          ANJAY_COAP_STREAM_BLOCK1_PART);
+    read_block1_part(&test, (buffered_blocks + 1) * PART_BLOCK_SIZE, 42, true);
+
+    const anjay_msg_details_t changed_details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = AVS_COAP_CODE_CHANGED,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    expect_block1_response(&test, AVS_COAP_CODE_CHANGED, msg_id,
+                           buffered_blocks + 1, false);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_setup_response(test.stream, &changed_details));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(test.stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(test.stream));
+    AVS_UNIT_ASSERT_NULL(reassembly);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_coap_stream_set_block1_reassembly(test.stream, NULL));
+    teardown_test(&test);
+}
+#endif // WITH_BLOCK_RECEIVE
@@ -329,6 +329,39 @@ int _anjay_dm_resource_dim(anjay_t *anjay,
                               resource_dim, anjay, obj_ptr, iid, rid);
 }
 
+int _anjay_dm_resource_version(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               uint64_t *out_version,
+                               const anjay_dm_module_t *current_module) {
+    anjay_log(TRACE, "resource_version /%u/%u/%u", (*obj_ptr)->oid, iid, rid);
+    if (!_anjay_dm_handler_implemented(anjay, obj_ptr, current_module,
+                                       offsetof(anjay_dm_handlers_t,
+                                                resource_version))) {
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+    CHECKED_TAIL_CALL_HANDLER(anjay, obj_ptr, current_module,
+                              resource_version,
+                              anjay, obj_ptr, iid, rid, out_version);
+}
+
+int _anjay_dm_resource_write_part(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  size_t offset,
+                                  const void *data,
+                                  size_t data_size,
+                                  bool last,
+                                  const anjay_dm_module_t *current_module) {
+    anjay_log(TRACE, "resource_write_part /%u/%u/%u, offset %lu",
+              (*obj_ptr)->oid, iid, rid, (unsigned long) offset);
+    CHECKED_TAIL_CALL_HANDLER(anjay, obj_ptr, current_module,
+                              resource_write_part, anjay, obj_ptr, iid, rid,
+                              offset, data, data_size, last);
+}
+
 int _anjay_dm_resource_read_attrs(anjay_t *anjay,
                                   const anjay_dm_object_def_t *const *obj_ptr,
                                   anjay_iid_t iid,
@@ -497,10 +530,13 @@ _anjay_dm_transaction_finish_without_validation(anjay_t *anjay, int result) {
     }
     int final_result = result;
     AVS_LIST_CLEAR(&anjay->transaction_state.objs_in_transaction) {
-        int commit_result = commit_or_rollback_object(
-                anjay,
-                *anjay->transaction_state.objs_in_transaction,
-                result);
+        const anjay_dm_object_def_t *const *obj =
+                *anjay->transaction_state.objs_in_transaction;
+        if ((*obj)->oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+            // Access Control lookups are cached outside of transactions
+            _anjay_access_control_cache_invalidate(anjay);
+        }
+        int commit_result = commit_or_rollback_object(anjay, obj, result);
         if (!final_result && commit_result) {
             final_result = commit_result;
         }
@@ -21,6 +21,7 @@
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <anjay/core.h>
 #include <avsystem/commons/stream.h>
@@ -30,6 +31,7 @@
 
 #include <anjay_modules/notify.h>
 
+#include <avsystem/commons/coap/block_utils.h>
 #include <avsystem/commons/coap/msg.h>
 
 #include "coap/content_format.h"
@@ -65,6 +67,41 @@ static int validate_supported_rids(const anjay_dm_object_def_t *obj_def) {
     return 0;
 }
 
+/**
+ * Returns the index of the first registered Object with OID not less than
+ * @p oid, or objects_count if there is no such Object.
+ */
+static size_t find_object_index(const anjay_dm_t *dm, anjay_oid_t oid) {
+    size_t begin = 0;
+    size_t end = dm->objects_count;
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        assert(dm->objects[middle] && *dm->objects[middle]);
+        if ((*dm->objects[middle])->oid < oid) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+static int ensure_objects_capacity(anjay_dm_t *dm) {
+    if (dm->objects_count < dm->objects_capacity) {
+        return 0;
+    }
+    size_t new_capacity = dm->objects_capacity ? 2 * dm->objects_capacity : 8;
+    const anjay_dm_object_def_t *const **new_objects =
+            (const anjay_dm_object_def_t *const **)
+            realloc(dm->objects, new_capacity * sizeof(*dm->objects));
+    if (!new_objects) {
+        return -1;
+    }
+    dm->objects = new_objects;
+    dm->objects_capacity = new_capacity;
+    return 0;
+}
+
 int anjay_register_object(anjay_t *anjay,
                           const anjay_dm_object_def_t *const *def_ptr) {
     assert(!anjay->transaction_state.depth);
@@ -75,17 +112,9 @@ int anjay_register_object(anjay_t *anjay,
         return -1;
     }
 
-    AVS_LIST(const anjay_dm_object_def_t *const *) *obj_iter;
-
-    AVS_LIST_FOREACH_PTR(obj_iter, &anjay->dm.objects) {
-        assert(*obj_iter && **obj_iter);
-
-        if ((***obj_iter)->oid >= (*def_ptr)->oid) {
-            break;
-        }
-    }
-
-    if (*obj_iter && (***obj_iter)->oid == (*def_ptr)->oid) {
+    size_t index = find_object_index(&anjay->dm, (*def_ptr)->oid);
+    if (index < anjay->dm.objects_count
+            && (*anjay->dm.objects[index])->oid == (*def_ptr)->oid) {
         anjay_log(ERROR, "data model object /%u already registered",
                   (*def_ptr)->oid);
         return -1;
@@ -95,20 +124,23 @@ int anjay_register_object(anjay_t *anjay,
         return -1;
     }
 
-    AVS_LIST(const anjay_dm_object_def_t *const *) new_elem =
-            AVS_LIST_NEW_ELEMENT(const anjay_dm_object_def_t *const *);
-    if (!new_elem) {
+    if (ensure_objects_capacity(&anjay->dm)) {
         anjay_log(ERROR, "out of memory");
         return -1;
     }
 
-    *new_elem = def_ptr;
-    AVS_LIST_INSERT(obj_iter, new_elem);
+    memmove(&anjay->dm.objects[index + 1], &anjay->dm.objects[index],
+            (anjay->dm.objects_count - index) * sizeof(*anjay->dm.objects));
+    anjay->dm.objects[index] = def_ptr;
+    ++anjay->dm.objects_count;
+    if ((*def_ptr)->oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+        _anjay_access_control_cache_invalidate(anjay);
+    }
 
-    anjay_log(INFO, "successfully registered object /%u", (**new_elem)->oid);
-    if (anjay_notify_instances_changed(anjay, (**new_elem)->oid)) {
+    anjay_log(INFO, "successfully registered object /%u", (*def_ptr)->oid);
+    if (anjay_notify_instances_changed(anjay, (*def_ptr)->oid)) {
         anjay_log(WARNING, "anjay_notify_instances_changed() failed on /%u",
-                  (**new_elem)->oid);
+                  (*def_ptr)->oid);
     }
     if (anjay_schedule_registration_update(anjay, ANJAY_SSID_ANY)) {
         anjay_log(WARNING, "anjay_schedule_registration_update() failed");
@@ -140,28 +172,26 @@ int anjay_unregister_object(anjay_t *anjay,
         return -1;
     }
 
-    AVS_LIST(const anjay_dm_object_def_t *const *) *obj_iter;
-    AVS_LIST_FOREACH_PTR(obj_iter, &anjay->dm.objects) {
-        assert(*obj_iter && **obj_iter);
-        if ((***obj_iter)->oid >= (*def_ptr)->oid) {
-            break;
-        }
-    }
-
-    if (!*obj_iter || (***obj_iter)->oid != (*def_ptr)->oid) {
+    size_t index = find_object_index(&anjay->dm, (*def_ptr)->oid);
+    if (index >= anjay->dm.objects_count
+            || (*anjay->dm.objects[index])->oid != (*def_ptr)->oid) {
         anjay_log(ERROR, "object %" PRIu16 " is not currently registered",
                   (*def_ptr)->oid);
         return -1;
     }
-    if (**obj_iter != def_ptr) {
+    if (anjay->dm.objects[index] != def_ptr) {
         anjay_log(ERROR, "object %" PRIu16 " that is registered is not "
                          "the same as the object passed for unregister",
                   (*def_ptr)->oid);
         return -1;
     }
 
-    AVS_LIST(const anjay_dm_object_def_t *const *) detached =
-            AVS_LIST_DETACH(obj_iter);
+    --anjay->dm.objects_count;
+    memmove(&anjay->dm.objects[index], &anjay->dm.objects[index + 1],
+            (anjay->dm.objects_count - index) * sizeof(*anjay->dm.objects));
+    if ((*def_ptr)->oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+        _anjay_access_control_cache_invalidate(anjay);
+    }
 
     anjay_notify_queue_t notify = NULL;
     if (_anjay_notify_queue_instance_set_unknown_change(&notify,
@@ -178,7 +208,6 @@ int anjay_unregister_object(anjay_t *anjay,
                                  (*def_ptr)->oid);
 #endif // WITH_BOOTSTRAP
     anjay_log(INFO, "successfully unregistered object /%u", (*def_ptr)->oid);
-    AVS_LIST_DELETE(&detached);
     if (anjay_schedule_registration_update(anjay, ANJAY_SSID_ANY)) {
         anjay_log(WARNING, "anjay_schedule_registration_update() failed");
     }
@@ -192,17 +221,18 @@ void _anjay_dm_cleanup(anjay_t *anjay) {
         }
     }
 
-    AVS_LIST_CLEAR(&anjay->dm.objects);
+    free(anjay->dm.objects);
+    anjay->dm.objects = NULL;
+    anjay->dm.objects_count = 0;
+    anjay->dm.objects_capacity = 0;
 }
 
 const anjay_dm_object_def_t *const *
 _anjay_dm_find_object_by_oid(anjay_t *anjay, anjay_oid_t oid) {
-    AVS_LIST(const anjay_dm_object_def_t *const *) obj;
-    AVS_LIST_FOREACH(obj, anjay->dm.objects) {
-        assert(*obj && **obj);
-        if ((**obj)->oid == oid) {
-            return *obj;
-        }
+    size_t index = find_object_index(&anjay->dm, oid);
+    if (index < anjay->dm.objects_count
+            && (*anjay->dm.objects[index])->oid == oid) {
+        return anjay->dm.objects[index];
     }
     anjay_log(TRACE, "could not found object: /%u not registered", oid);
 
@@ -510,6 +540,23 @@ static int dm_read(anjay_t *anjay,
     }
 }
 
+static int dm_read_into_comm_stream(anjay_t *anjay,
+                                    const anjay_dm_object_def_t *const *obj,
+                                    const anjay_dm_read_args_t *read_args) {
+    int out_ctx_errno = 0;
+    anjay_output_ctx_t *out_ctx = dm_read_spawn_ctx(
+            anjay->comm_stream, &out_ctx_errno, read_args);
+    if (!out_ctx) {
+        return out_ctx_errno ? out_ctx_errno : ANJAY_ERR_INTERNAL;
+    }
+    int result = dm_read(anjay, obj, read_args, out_ctx);
+    if (out_ctx_errno) {
+        return out_ctx_errno;
+    } else {
+        return result;
+    }
+}
+
 #ifdef WITH_OBSERVE
 static void build_observe_key(anjay_t *anjay,
                               anjay_observe_key_t *result,
@@ -538,29 +585,22 @@ dm_observe_spawn_ctx(avs_stream_abstract_t *stream,
     return NULL;
 }
 
-ssize_t _anjay_dm_read_for_observe(anjay_t *anjay,
-                                   const anjay_dm_object_def_t *const *obj,
-                                   const anjay_dm_read_args_t *details,
-                                   anjay_msg_details_t *out_details,
-                                   double *out_numeric,
-                                   char *buffer,
-                                   size_t size) {
-    anjay_observe_stream_t out = _anjay_new_observe_stream(out_details);
-    avs_stream_outbuf_set_buffer(&out.outbuf, buffer, size);
+int _anjay_dm_read_for_observe(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj,
+                               const anjay_dm_read_args_t *details,
+                               double *out_numeric,
+                               avs_stream_abstract_t *stream) {
     int out_ctx_errno = 0;
     anjay_output_ctx_t *out_ctx =
-            dm_observe_spawn_ctx((avs_stream_abstract_t *) &out,
-                                 &out_ctx_errno, details, out_numeric);
+            dm_observe_spawn_ctx(stream, &out_ctx_errno, details, out_numeric);
     if (!out_ctx) {
         return out_ctx_errno ? out_ctx_errno : ANJAY_ERR_INTERNAL;
     }
     int result = dm_read(anjay, obj, details, out_ctx);
     if (out_ctx_errno < 0) {
-        return (ssize_t) out_ctx_errno;
-    } else if (result < 0) {
-        return (ssize_t) result;
+        return out_ctx_errno;
     }
-    return (ssize_t) avs_stream_outbuf_offset(&out.outbuf);
+    return result < 0 ? result : 0;
 }
 
 static int dm_observe(anjay_t *anjay,
@@ -569,34 +609,81 @@ static int dm_observe(anjay_t *anjay,
                       const anjay_request_t *request) {
     anjay_log(DEBUG, "Observe %s", ANJAY_DEBUG_MAKE_PATH(&request->uri));
     assert(request->uri.has_oid);
-    char buf[ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE];
+    // the buffer is shared with notifications, so that a buffer of
+    // ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE bytes is not needed on the stack
+    char *buf = _anjay_observe_read_buffer(anjay);
+    if (!buf) {
+        return ANJAY_ERR_INTERNAL;
+    }
     double numeric = NAN;
     anjay_msg_details_t observe_details;
-    ssize_t size = _anjay_dm_read_for_observe(
-            anjay, obj, &REQUEST_TO_DM_READ_ARGS(anjay, request),
-            &observe_details, &numeric, buf, sizeof(buf));
-    if (size < 0) {
-        return (int) size;
+    anjay_observe_stream_t out =
+            _anjay_new_observe_stream(&observe_details, buf,
+                                      ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE);
+    const anjay_dm_read_args_t read_args =
+            REQUEST_TO_DM_READ_ARGS(anjay, request);
+    int result = _anjay_dm_read_for_observe(anjay, obj, &read_args, &numeric,
+                                            (avs_stream_abstract_t *) &out);
+    if (result) {
+        return result;
     }
+    const bool stored = (out.length <= out.capacity);
     anjay_observe_key_t key;
     build_observe_key(anjay, &key, request);
-    int put_entry_result = _anjay_observe_put_entry(
-            anjay, &key, &observe_details, request_identity, numeric,
-            buf, (size_t) size);
+    int put_entry_result;
+    if (stored) {
+        put_entry_result = _anjay_observe_put_entry(
+                anjay, &key, &observe_details, request_identity, numeric,
+                buf, out.length);
+    } else {
+        put_entry_result = _anjay_observe_put_hashed_entry(
+                anjay, &key, &observe_details, request_identity, numeric,
+                out.length, out.hash);
+    }
     if (put_entry_result) {
         // we are unable to create the observation entry, but we can still
         // process the request as usual; compare RFC 7641, section 4.1
         observe_details.observe_serial = false;
     }
-    int result;
-    if ((result = _anjay_coap_stream_setup_response(anjay->comm_stream,
-                                                    &observe_details))
-            || (result = avs_stream_write(anjay->comm_stream,
-                                          buf, (size_t) size))) {
-        if (!put_entry_result) {
-            _anjay_observe_remove_entry(anjay, &key);
+    if (stored) {
+        (void) ((result = _anjay_coap_stream_setup_response(
+                        anjay->comm_stream, &observe_details))
+                || (result = avs_stream_write(anjay->comm_stream,
+                                              buf, out.length)));
+    } else {
+        // the value did not fit in the buffer, so it is serialized again,
+        // directly into the response
+        anjay_msg_details_t sent_details;
+        anjay_observe_stream_t sent =
+                _anjay_new_observe_stream(&sent_details, buf,
+                                          ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE);
+        (void) ((result = _anjay_coap_stream_setup_response(
+                        anjay->comm_stream, &observe_details))
+                || (result = _anjay_observe_resend_value(anjay, &key, &numeric,
+                                                         &sent)));
+        if (!result && !put_entry_result
+                && (sent.length != out.length || sent.hash != out.hash)) {
+            // the value changed in the meantime; the observation needs to
+            // refer to the one actually sent
+            if (sent.length <= sent.capacity) {
+                put_entry_result = _anjay_observe_put_entry(
+                        anjay, &key, &observe_details, request_identity,
+                        numeric, buf, sent.length);
+            } else {
+                put_entry_result = _anjay_observe_put_hashed_entry(
+                        anjay, &key, &observe_details, request_identity,
+                        numeric, sent.length, sent.hash);
+            }
+            if (put_entry_result) {
+                anjay_log(WARNING, "Observe entry for %s lost, no "
+                          "notifications will be sent",
+                          ANJAY_DEBUG_MAKE_PATH(&request->uri));
+            }
         }
     }
+    if (result && !put_entry_result) {
+        _anjay_observe_remove_entry(anjay, &key);
+    }
     return result;
 }
 #else // WITH_OBSERVE
@@ -620,20 +707,8 @@ static int dm_read_or_observe(anjay_t *anjay,
             _anjay_observe_remove_entry(anjay, &key);
         }
 #endif // WITH_OBSERVE
-        const anjay_dm_read_args_t read_args =
-                REQUEST_TO_DM_READ_ARGS(anjay, request);
-        int out_ctx_errno = 0;
-        anjay_output_ctx_t *out_ctx = dm_read_spawn_ctx(
-                anjay->comm_stream, &out_ctx_errno, &read_args);
-        if (!out_ctx) {
-            return out_ctx_errno ? out_ctx_errno : ANJAY_ERR_INTERNAL;
-        }
-        int result = dm_read(anjay, obj, &read_args, out_ctx);
-        if (out_ctx_errno) {
-            return out_ctx_errno;
-        } else {
-            return result;
-        }
+        return dm_read_into_comm_stream(
+                anjay, obj, &REQUEST_TO_DM_READ_ARGS(anjay, request));
     }
 }
 
@@ -856,6 +931,101 @@ static int dm_write(anjay_t *anjay,
     return retval;
 }
 
+#ifdef WITH_BLOCK_RECEIVE
+bool _anjay_dm_write_part_supported(anjay_t *anjay,
+                                    const anjay_request_t *request) {
+    const anjay_dm_object_def_t *const *obj;
+    return request->action == ANJAY_ACTION_WRITE
+            && request->uri.has_rid
+            && _anjay_translate_legacy_content_format(request->content_format)
+                    == ANJAY_COAP_FORMAT_OPAQUE
+            && (obj = _anjay_dm_find_object_by_oid(anjay, request->uri.oid))
+            && *obj
+            && _anjay_dm_handler_implemented(
+                    anjay, obj, NULL,
+                    offsetof(anjay_dm_handlers_t, resource_write_part));
+}
+
+static int write_part_from_stream(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj,
+                                  const anjay_uri_path_t *uri,
+                                  size_t offset,
+                                  bool last) {
+    // large enough to pass each block to the handler in a single call
+    char buffer[AVS_COAP_MSG_BLOCK_MAX_SIZE];
+    char message_finished = 0;
+    int result = 0;
+    while (!result && !message_finished) {
+        size_t bytes_read;
+        if ((result = avs_stream_read(anjay->comm_stream, &bytes_read,
+                                      &message_finished,
+                                      buffer, sizeof(buffer)))) {
+            break;
+        }
+        if (bytes_read || (last && message_finished)) {
+            result = _anjay_dm_resource_write_part(
+                    anjay, obj, uri->iid, uri->rid, offset, buffer, bytes_read,
+                    last && message_finished, NULL);
+            offset += bytes_read;
+        }
+    }
+    return result;
+}
+
+int _anjay_dm_perform_write_part(anjay_t *anjay,
+                                 const anjay_request_t *request) {
+    const anjay_dm_object_def_t *const *obj =
+            _anjay_dm_find_object_by_oid(anjay, request->uri.oid);
+    assert(obj && *obj);
+
+    size_t offset;
+    bool last;
+    int result = _anjay_coap_stream_begin_block1_part(anjay->comm_stream,
+                                                      &offset, &last);
+    if (result) {
+        return result;
+    }
+    anjay_log(DEBUG, "Write %s, part at offset %lu",
+              ANJAY_DEBUG_MAKE_PATH(&request->uri), (unsigned long) offset);
+
+    const anjay_msg_details_t msg_details = {
+        .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+        .msg_code = last ? AVS_COAP_CODE_CHANGED : AVS_COAP_CODE_CONTINUE,
+        .format = AVS_COAP_FORMAT_NONE
+    };
+    if ((result = _anjay_coap_stream_setup_response(anjay->comm_stream,
+                                                    &msg_details))
+            || (result = ensure_instance_present(anjay, obj,
+                                                 request->uri.iid))) {
+        return result;
+    }
+    if (!_anjay_access_control_action_allowed(
+            anjay, &REQUEST_TO_ACTION_INFO(anjay, request))) {
+        return ANJAY_ERR_UNAUTHORIZED;
+    }
+    if (!_anjay_dm_resource_supported(obj, request->uri.rid)) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    if (!has_resource_operation_bit(anjay, obj, request->uri.rid,
+                                    ANJAY_DM_RESOURCE_OP_BIT_W)) {
+        anjay_log(ERROR, "Write /%u/*/%u is not supported", (*obj)->oid,
+                  request->uri.rid);
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+
+    result = write_part_from_stream(anjay, obj, &request->uri, offset, last);
+    if (!result && last) {
+        anjay_notify_queue_t notify_queue = NULL;
+        (void) ((result = _anjay_notify_queue_resource_change(
+                        &notify_queue, request->uri.oid, request->uri.iid,
+                        request->uri.rid))
+                || (result = _anjay_notify_perform(anjay, notify_queue)));
+        _anjay_notify_clear_queue(&notify_queue);
+    }
+    return result;
+}
+#endif // WITH_BLOCK_RECEIVE
+
 static void update_attrs(anjay_dm_internal_res_attrs_t *attrs_ptr,
                          const anjay_request_attributes_t *request_attrs) {
     if (request_attrs->has_min_period) {
@@ -1333,17 +1503,17 @@ int _anjay_dm_perform_action(anjay_t *anjay,
 int _anjay_dm_foreach_object(anjay_t *anjay,
                              anjay_dm_foreach_object_handler_t *handler,
                              void *data) {
-    AVS_LIST(const anjay_dm_object_def_t *const *) obj;
-    AVS_LIST_FOREACH(obj, anjay->dm.objects) {
-        assert(*obj && **obj);
+    for (size_t i = 0; i < anjay->dm.objects_count; ++i) {
+        const anjay_dm_object_def_t *const *obj = anjay->dm.objects[i];
+        assert(obj && *obj);
 
-        int result = handler(anjay, *obj, data);
+        int result = handler(anjay, obj, data);
         if (result == ANJAY_DM_FOREACH_BREAK) {
-            anjay_log(DEBUG, "foreach_object: break on /%u", (**obj)->oid);
+            anjay_log(DEBUG, "foreach_object: break on /%u", (*obj)->oid);
             return 0;
         } else if (result) {
             anjay_log(ERROR, "foreach_object_handler failed for /%u (%d)",
-                      (**obj)->oid, result);
+                      (*obj)->oid, result);
             return result;
         }
     }
@@ -37,7 +37,10 @@ typedef struct {
 } anjay_dm_installed_module_t;
 
 struct anjay_dm {
-    AVS_LIST(const anjay_dm_object_def_t *const *) objects;
+    // registered Objects, sorted by OID to allow binary search
+    const anjay_dm_object_def_t *const **objects;
+    size_t objects_count;
+    size_t objects_capacity;
     AVS_LIST(anjay_dm_installed_module_t) modules;
 };
 
@@ -166,19 +169,45 @@ static inline int _anjay_dm_transaction_rollback(anjay_t *anjay) {
 }
 
 #ifdef WITH_OBSERVE
-ssize_t _anjay_dm_read_for_observe(anjay_t *anjay,
-                                   const anjay_dm_object_def_t *const *obj,
-                                   const anjay_dm_read_args_t *details,
-                                   anjay_msg_details_t *out_details,
-                                   double *out_numeric,
-                                   char *buffer,
-                                   size_t size);
+/**
+ * Serializes the value at @p details->uri into @p stream, which needs to
+ * implement the CoAP stream extension - e.g. an anjay_observe_stream_t.
+ */
+int _anjay_dm_read_for_observe(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj,
+                               const anjay_dm_read_args_t *details,
+                               double *out_numeric,
+                               avs_stream_abstract_t *stream);
 #endif // WITH_OBSERVE
 
 int _anjay_dm_perform_action(anjay_t *anjay,
                              const avs_coap_msg_identity_t *request_identity,
                              const anjay_request_t *request);
 
+#ifdef WITH_BLOCK_RECEIVE
+/**
+ * Checks whether @p request may be handled part by part, as its blocks arrive,
+ * by @ref _anjay_dm_perform_write_part . This is the case for Write requests
+ * with opaque payload on Resources that implement the resource_write_part
+ * handler.
+ */
+bool _anjay_dm_write_part_supported(anjay_t *anjay,
+                                    const anjay_request_t *request);
+
+/**
+ * Handles a part of a Block1 Write request for which the CoAP stream returned
+ * ANJAY_COAP_STREAM_BLOCK1_PART, passing the part to the resource_write_part
+ * handler and setting up the response.
+ */
+int _anjay_dm_perform_write_part(anjay_t *anjay,
+                                 const anjay_request_t *request);
+#else // WITH_BLOCK_RECEIVE
+#define _anjay_dm_write_part_supported(Anjay, Request) \
+        ((void) (Anjay), (void) (Request), false)
+#define _anjay_dm_perform_write_part(Anjay, Request) \
+        (assert(0 && "should never happen"), -1)
+#endif // WITH_BLOCK_RECEIVE
+
 anjay_input_ctx_t *_anjay_dm_read_as_input_ctx(anjay_t *anjay,
                                                const anjay_uri_path_t *path);
 
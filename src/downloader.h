@@ -73,12 +73,11 @@ _anjay_downloader_download(anjay_downloader_t *dl,
                            const anjay_download_config_t *config);
 
 /**
- * Retrieves all sockets used for downloads managed by @p dl and prepends them
- * to @p out_socks.
+ * Puts all sockets used for downloads managed by @p dl into the list being
+ * rebuilt by @p updater.
  */
-int _anjay_downloader_get_sockets(
-        anjay_downloader_t *dl,
-        AVS_LIST(avs_net_abstract_socket_t *const) *out_socks);
+int _anjay_downloader_update_socket_list(anjay_downloader_t *dl,
+                                         anjay_socket_list_updater_t *updater);
 
 /**
  * @returns @li 0 if @p socket was a downloaded socket and the incoming packet
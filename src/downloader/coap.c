@@ -17,6 +17,7 @@
 #include <config.h>
 
 #include <inttypes.h>
+#include <stdlib.h>
 
 #include <avsystem/commons/coap/msg_builder.h>
 #include <avsystem/commons/coap/msg_opt.h>
@@ -28,6 +29,26 @@
 
 VISIBILITY_SOURCE_BEGIN
 
+typedef enum {
+    COAP_BLOCK_SLOT_FREE,
+    COAP_BLOCK_SLOT_REQUESTED,
+    COAP_BLOCK_SLOT_RECEIVED
+} coap_block_slot_state_t;
+
+typedef struct {
+    coap_block_slot_state_t state;
+    size_t seq_num;
+    avs_coap_msg_identity_t req_id;
+    /* Set after receiving a Separate ACK; request is no longer retransmitted */
+    bool separate_ack;
+
+    /* Valid in COAP_BLOCK_SLOT_RECEIVED state only */
+    bool has_more;
+    size_t payload_size;
+    /* Part of the reassembly buffer; NULL if pipelining is not used */
+    uint8_t *data;
+} coap_block_slot_t;
+
 typedef struct {
     anjay_download_ctx_common_t common;
 
@@ -37,20 +58,55 @@ typedef struct {
     anjay_etag_t etag;
 
     avs_net_abstract_socket_t *socket;
-    avs_coap_msg_identity_t last_req_id;
+
+    /*
+     * Requests for blocks that were not delivered to the user yet. Block with
+     * a given seq_num is tracked by slots[seq_num % window_size].
+     */
+    coap_block_slot_t *slots;
+    size_t window_size;
+    uint8_t *reassembly_buffer;
+    /*
+     * Number of blocks that may be requested at once. Equal to 1 until the
+     * first block is received, so that its size and ETag are known before
+     * asking for any further ones.
+     */
+    size_t max_requested_blocks;
+    /* Set if the server misbehaved when handling pipelined requests */
+    bool pipelining_failed;
+    /* Blocks past this one are only requested when they are next in order */
+    size_t seq_num_limit;
 
     /*
      * After calling @ref _anjay_downloader_download:
      *     handle to a job that sends the initial request.
      * During the download (after sending the initial request):
      *     handle to retransmission job.
-     * After receiving a separate ACK:
+     * After receiving Separate ACKs for all pending requests:
      *     handle to a job aborting the transfer if no Separate Response was
      *     received.
      */
     anjay_sched_handle_t sched_job;
 } anjay_coap_download_ctx_t;
 
+static size_t next_seq_num(const anjay_coap_download_ctx_t *ctx) {
+    return ctx->bytes_downloaded / ctx->block_size;
+}
+
+static coap_block_slot_t *get_block_slot(anjay_coap_download_ctx_t *ctx,
+                                         size_t seq_num) {
+    return &ctx->slots[seq_num % ctx->window_size];
+}
+
+static void release_block_slots(anjay_coap_download_ctx_t *ctx,
+                                size_t first_seq_num) {
+    for (size_t i = 0; i < ctx->window_size; ++i) {
+        if (ctx->slots[i].seq_num >= first_seq_num) {
+            ctx->slots[i].state = COAP_BLOCK_SLOT_FREE;
+        }
+    }
+}
+
 static void cleanup_coap_transfer(anjay_downloader_t *dl,
                                   AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) *ctx_ptr;
@@ -62,14 +118,17 @@ static void cleanup_coap_transfer(anjay_downloader_t *dl,
 #ifndef ANJAY_TEST
     avs_net_socket_cleanup(&ctx->socket);
 #endif // ANJAY_TEST
+    free(ctx->slots);
+    free(ctx->reassembly_buffer);
     AVS_LIST_DELETE(ctx_ptr);
 }
 
 static int fill_coap_request_info(avs_coap_msg_info_t *req_info,
-                                  const anjay_coap_download_ctx_t *ctx) {
+                                  const anjay_coap_download_ctx_t *ctx,
+                                  const coap_block_slot_t *slot) {
     req_info->type = AVS_COAP_MSG_CONFIRMABLE;
     req_info->code = AVS_COAP_CODE_GET;
-    req_info->identity = ctx->last_req_id;
+    req_info->identity = slot->req_id;
 
     AVS_LIST(anjay_string_t) elem;
     AVS_LIST_FOREACH(elem, ctx->uri.uri_path) {
@@ -88,7 +147,7 @@ static int fill_coap_request_info(avs_coap_msg_info_t *req_info,
     avs_coap_block_info_t block2 = {
         .type = AVS_COAP_BLOCK2,
         .valid = true,
-        .seq_num = (uint32_t)(ctx->bytes_downloaded / ctx->block_size),
+        .seq_num = (uint32_t) slot->seq_num,
         .size = (uint16_t)ctx->block_size,
         .has_more = false
     };
@@ -100,20 +159,27 @@ static int fill_coap_request_info(avs_coap_msg_info_t *req_info,
 }
 
 static int request_coap_block(anjay_downloader_t *dl,
-                              anjay_coap_download_ctx_t *ctx);
+                              anjay_coap_download_ctx_t *ctx,
+                              const coap_block_slot_t *slot);
 
 static int request_coap_block_job(anjay_t *anjay,
                                   void *id_) {
     uintptr_t id = (uintptr_t)id_;
 
-    AVS_LIST(anjay_download_ctx_t) *ctx =
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
             _anjay_downloader_find_ctx_ptr_by_id(&anjay->downloader, id);
-    if (!ctx) {
+    if (!ctx_ptr) {
         dl_log(DEBUG, "download id = %" PRIuPTR " not found (expired?)", id);
         return 0;
     }
 
-    request_coap_block(&anjay->downloader, (anjay_coap_download_ctx_t *) *ctx);
+    anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) *ctx_ptr;
+    for (size_t i = 0; i < ctx->window_size; ++i) {
+        if (ctx->slots[i].state == COAP_BLOCK_SLOT_REQUESTED
+                && !ctx->slots[i].separate_ack) {
+            request_coap_block(&anjay->downloader, ctx, &ctx->slots[i]);
+        }
+    }
 
     // return non-zero to ensure job retries
     return -1;
@@ -143,13 +209,64 @@ static int schedule_coap_retransmission(anjay_downloader_t *dl,
                                   (void*)ctx->common.id);
 }
 
+static int abort_transfer_job(anjay_t *anjay,
+                              void *ctx_) {
+    AVS_LIST(anjay_download_ctx_t) ctx = (AVS_LIST(anjay_download_ctx_t))ctx_;
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            AVS_LIST_FIND_PTR(&anjay->downloader.downloads, ctx);
+
+    if (!ctx_ptr) {
+        anjay_log(WARNING, "transfer already aborted");
+    } else {
+        anjay_log(WARNING, "aborting download: response not received");
+        _anjay_downloader_abort_transfer(&anjay->downloader, ctx_ptr,
+                                         ANJAY_DOWNLOAD_ERR_FAILED);
+    }
+
+    return 0;
+}
+
+/**
+ * Schedules retransmission of pending requests, or - if Separate ACKs were
+ * received for all of them - a job that aborts the transfer if no Separate
+ * Response arrives in time.
+ */
+static int schedule_coap_timeout(anjay_downloader_t *dl,
+                                 anjay_coap_download_ctx_t *ctx) {
+    anjay_t *anjay = _anjay_downloader_get_anjay(dl);
+    bool any_requested = false;
+    for (size_t i = 0; i < ctx->window_size; ++i) {
+        if (ctx->slots[i].state == COAP_BLOCK_SLOT_REQUESTED) {
+            if (!ctx->slots[i].separate_ack) {
+                return schedule_coap_retransmission(dl, ctx);
+            }
+            any_requested = true;
+        }
+    }
+
+    _anjay_sched_del(anjay->sched, &ctx->sched_job);
+    if (!any_requested) {
+        return 0;
+    }
+
+    avs_time_duration_t abort_delay =
+            avs_coap_exchange_lifetime(&anjay->udp_tx_params);
+    dl_log(DEBUG, "Separate ACK received, waiting "
+                  "%" PRId64 ".%09" PRId32 " for response",
+           abort_delay.seconds, abort_delay.nanoseconds);
+
+    return _anjay_sched(anjay->sched, &ctx->sched_job, abort_delay,
+                        abort_transfer_job, ctx);
+}
+
 static int request_coap_block(anjay_downloader_t *dl,
-                              anjay_coap_download_ctx_t *ctx) {
+                              anjay_coap_download_ctx_t *ctx,
+                              const coap_block_slot_t *slot) {
     anjay_t *anjay = _anjay_downloader_get_anjay(dl);
     avs_coap_msg_info_t info = avs_coap_msg_info_init();
     int result = -1;
 
-    if (fill_coap_request_info(&info, (anjay_coap_download_ctx_t *) ctx)) {
+    if (fill_coap_request_info(&info, ctx, slot)) {
         goto finish;
     }
 
@@ -179,13 +296,38 @@ finish:
     return result;
 }
 
+static int request_missing_blocks(anjay_downloader_t *dl,
+                                  anjay_coap_download_ctx_t *ctx) {
+    const size_t first_seq_num = next_seq_num(ctx);
+    for (size_t i = 0; i < ctx->max_requested_blocks; ++i) {
+        const size_t seq_num = first_seq_num + i;
+        if (i > 0 && seq_num > ctx->seq_num_limit) {
+            break;
+        }
+
+        coap_block_slot_t *slot = get_block_slot(ctx, seq_num);
+        if (slot->state != COAP_BLOCK_SLOT_FREE) {
+            assert(slot->seq_num == seq_num);
+            continue;
+        }
+
+        slot->state = COAP_BLOCK_SLOT_REQUESTED;
+        slot->seq_num = seq_num;
+        slot->req_id = _anjay_coap_id_source_get(dl->id_source);
+        slot->separate_ack = false;
+        if (request_coap_block(dl, ctx, slot)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 static int request_next_coap_block(anjay_downloader_t *dl,
                                    AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) *ctx_ptr;
-    ctx->last_req_id = _anjay_coap_id_source_get(dl->id_source);
 
-    if (request_coap_block(dl, ctx)
-            || schedule_coap_retransmission(dl, ctx)) {
+    if (request_missing_blocks(dl, ctx)
+            || schedule_coap_timeout(dl, ctx)) {
         dl_log(WARNING, "could not request block starting at %zu for download "
                "id = %" PRIuPTR, ctx->bytes_downloaded, ctx->common.id);
         _anjay_downloader_abort_transfer(dl, ctx_ptr,
@@ -259,6 +401,7 @@ static inline bool etag_matches(const anjay_etag_t *a,
 
 static int parse_coap_response(const avs_coap_msg_t *msg,
                                anjay_coap_download_ctx_t *ctx,
+                               const coap_block_slot_t *slot,
                                avs_coap_block_info_t *out_block2,
                                anjay_etag_t *out_etag) {
     if (read_etag(msg, out_etag)) {
@@ -284,8 +427,7 @@ static int parse_coap_response(const avs_coap_msg_t *msg,
     }
 
 
-    const size_t requested_seq_num = ctx->bytes_downloaded / ctx->block_size;
-    const size_t expected_offset = requested_seq_num * ctx->block_size;
+    const size_t expected_offset = slot->seq_num * ctx->block_size;
     const size_t obtained_offset = out_block2->seq_num * out_block2->size;
     if (expected_offset != obtained_offset) {
         dl_log(DEBUG,
@@ -299,6 +441,12 @@ static int parse_coap_response(const avs_coap_msg_t *msg,
                ctx->block_size, (size_t)out_block2->size);
         return -1;
     } else if (out_block2->size < ctx->block_size) {
+        if (slot->seq_num != next_seq_num(ctx)) {
+            // Renegotiation invalidates the numbering of all other pending
+            // requests; only accept it on the block we are waiting for.
+            dl_log(DEBUG, "block size changed in an out-of-order block");
+            return -1;
+        }
         // Allow late block size renegotiation, as we may be in the middle of
         // a download resumption, in which case we have no idea what block size
         // is appropriate. If it is not the case, and the server decided to send
@@ -311,24 +459,86 @@ static int parse_coap_response(const avs_coap_msg_t *msg,
     return 0;
 }
 
+static void stop_pipelining(anjay_coap_download_ctx_t *ctx) {
+    dl_log(DEBUG, "transfer id = %" PRIuPTR ": falling back to requesting "
+           "one block at a time", ctx->common.id);
+    ctx->pipelining_failed = true;
+    ctx->max_requested_blocks = 1;
+    release_block_slots(ctx, next_seq_num(ctx) + 1);
+}
+
+static int store_out_of_order_block(anjay_coap_download_ctx_t *ctx,
+                                    coap_block_slot_t *slot,
+                                    const avs_coap_msg_t *msg,
+                                    const avs_coap_block_info_t *block2) {
+    assert(slot->data);
+    slot->payload_size = avs_coap_msg_payload_length(msg);
+    if (slot->payload_size > ctx->block_size) {
+        dl_log(DEBUG, "block payload larger than block size");
+        return -1;
+    }
+    memcpy(slot->data, avs_coap_msg_payload(msg), slot->payload_size);
+    slot->has_more = block2->has_more;
+    slot->state = COAP_BLOCK_SLOT_RECEIVED;
+
+    if (!block2->has_more && slot->seq_num < ctx->seq_num_limit) {
+        ctx->seq_num_limit = slot->seq_num;
+    }
+    return 0;
+}
+
+static int deliver_block(anjay_downloader_t *dl,
+                         anjay_coap_download_ctx_t *ctx,
+                         const void *payload,
+                         size_t payload_size,
+                         bool has_more) {
+    if (ctx->common.on_next_block(_anjay_downloader_get_anjay(dl),
+                                  (const uint8_t *) payload, payload_size,
+                                  &ctx->etag, ctx->common.user_data)) {
+        return -1;
+    }
+
+    if (has_more && next_seq_num(ctx) >= ctx->seq_num_limit) {
+        // the limit turned out to be wrong
+        ctx->seq_num_limit = SIZE_MAX;
+    }
+    ctx->bytes_downloaded += payload_size;
+    return _anjay_downloader_checkpoint(dl, &ctx->common,
+                                        ctx->bytes_downloaded, &ctx->etag);
+}
+
 static void handle_coap_response(const avs_coap_msg_t *msg,
                                  anjay_downloader_t *dl,
-                                 AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
+                                 AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
+                                 coap_block_slot_t *slot) {
+    anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) *ctx_ptr;
+    const bool in_order = (slot->seq_num == next_seq_num(ctx));
+
     const uint8_t code = avs_coap_msg_get_code(msg);
     if (code != AVS_COAP_CODE_CONTENT) {
         dl_log(DEBUG, "server responded with %s (expected %s)",
                AVS_COAP_CODE_STRING(code),
                AVS_COAP_CODE_STRING(AVS_COAP_CODE_CONTENT));
-        _anjay_downloader_abort_transfer(dl, ctx_ptr, -code);
+        if (in_order) {
+            _anjay_downloader_abort_transfer(dl, ctx_ptr, -code);
+        } else {
+            // most likely a block past the end of the resource
+            ctx->seq_num_limit = slot->seq_num - 1;
+            release_block_slots(ctx, slot->seq_num);
+        }
         return;
     }
 
-    anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) *ctx_ptr;
     avs_coap_block_info_t block2;
     anjay_etag_t etag;
-    if (parse_coap_response(msg, ctx, &block2, &etag)) {
-        _anjay_downloader_abort_transfer(dl, ctx_ptr,
-                                         ANJAY_DOWNLOAD_ERR_FAILED);
+    const size_t requested_block_size = ctx->block_size;
+    if (parse_coap_response(msg, ctx, slot, &block2, &etag)) {
+        if (in_order) {
+            _anjay_downloader_abort_transfer(dl, ctx_ptr,
+                                             ANJAY_DOWNLOAD_ERR_FAILED);
+        } else {
+            stop_pipelining(ctx);
+        }
         return;
     }
 
@@ -343,6 +553,20 @@ static void handle_coap_response(const avs_coap_msg_t *msg,
         return;
     }
 
+    if (!in_order) {
+        if (store_out_of_order_block(ctx, slot, msg, &block2)) {
+            stop_pipelining(ctx);
+        }
+        return;
+    }
+
+    if (ctx->block_size != requested_block_size) {
+        // seq_nums of all other pending requests are now meaningless
+        release_block_slots(ctx, 0);
+    } else {
+        slot->state = COAP_BLOCK_SLOT_FREE;
+    }
+
     const void *payload = avs_coap_msg_payload(msg);
     size_t payload_size = avs_coap_msg_payload_length(msg);
 
@@ -353,16 +577,33 @@ static void handle_coap_response(const avs_coap_msg_t *msg,
         payload_size -= offset;
     }
 
-    if (ctx->common.on_next_block(_anjay_downloader_get_anjay(dl),
-                                  (const uint8_t *) payload, payload_size,
-                                  &etag, ctx->common.user_data)) {
+    bool has_more = block2.has_more;
+    int result = deliver_block(dl, ctx, payload, payload_size, has_more);
+
+    // deliver blocks that arrived out of order, if any
+    while (!result && has_more) {
+        slot = get_block_slot(ctx, next_seq_num(ctx));
+        if (slot->state != COAP_BLOCK_SLOT_RECEIVED) {
+            break;
+        }
+        assert(slot->seq_num == next_seq_num(ctx));
+        slot->state = COAP_BLOCK_SLOT_FREE;
+        has_more = slot->has_more;
+        result = deliver_block(dl, ctx, slot->data, slot->payload_size,
+                               has_more);
+    }
+
+    if (result) {
         _anjay_downloader_abort_transfer(dl, ctx_ptr,
                                          ANJAY_DOWNLOAD_ERR_FAILED);
         return;
     }
 
-    ctx->bytes_downloaded += payload_size;
-    if (!block2.has_more) {
+    if (!ctx->pipelining_failed) {
+        ctx->max_requested_blocks = ctx->window_size;
+    }
+
+    if (!has_more) {
         dl_log(INFO, "transfer id = %" PRIuPTR " finished", ctx->common.id);
         _anjay_downloader_abort_transfer(dl, ctx_ptr, 0);
     } else if (!request_next_coap_block(dl, ctx_ptr)) {
@@ -371,21 +612,22 @@ static void handle_coap_response(const avs_coap_msg_t *msg,
     }
 }
 
-static int abort_transfer_job(anjay_t *anjay,
-                              void *ctx_) {
-    AVS_LIST(anjay_download_ctx_t) ctx = (AVS_LIST(anjay_download_ctx_t))ctx_;
-    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
-            AVS_LIST_FIND_PTR(&anjay->downloader.downloads, ctx);
-
-    if (!ctx_ptr) {
-        anjay_log(WARNING, "transfer already aborted");
-    } else {
-        anjay_log(WARNING, "aborting download: response not received");
-        _anjay_downloader_abort_transfer(&anjay->downloader, ctx_ptr,
-                                         ANJAY_DOWNLOAD_ERR_FAILED);
+static coap_block_slot_t *find_block_slot(anjay_coap_download_ctx_t *ctx,
+                                          const avs_coap_msg_t *msg,
+                                          bool msg_id_must_match) {
+    // iterate in order of seq_nums, so that if tokens are ambiguous, the
+    // Separate Response is matched with the oldest request
+    const size_t first_seq_num = next_seq_num(ctx);
+    for (size_t i = 0; i < ctx->window_size; ++i) {
+        coap_block_slot_t *slot = get_block_slot(ctx, first_seq_num + i);
+        if (slot->state == COAP_BLOCK_SLOT_REQUESTED
+                && avs_coap_msg_token_matches(msg, &slot->req_id)
+                && (!msg_id_must_match
+                        || avs_coap_msg_get_id(msg) == slot->req_id.msg_id)) {
+            return slot;
+        }
     }
-
-    return 0;
+    return NULL;
 }
 
 static void handle_coap_message(anjay_downloader_t *dl,
@@ -421,32 +663,27 @@ static void handle_coap_message(anjay_downloader_t *dl,
         return;
     }
 
-    if (!avs_coap_msg_token_matches(msg, &ctx->last_req_id)) {
-        dl_log(DEBUG, "token mismatch, ignoring");
+    coap_block_slot_t *slot = find_block_slot(ctx, msg, msg_id_must_match);
+    if (!slot) {
+        dl_log(DEBUG, "no matching request (msg id %u), ignoring",
+               avs_coap_msg_get_id(msg));
         return;
     }
 
     if (msg_id_must_match) {
-        if (avs_coap_msg_get_id(msg) != ctx->last_req_id.msg_id) {
-            dl_log(DEBUG, "msg id mismatch (got %u, expected %u), ignoring",
-                   avs_coap_msg_get_id(msg), ctx->last_req_id.msg_id);
-            return;
-        } else if (type == AVS_COAP_MSG_RESET) {
-            dl_log(DEBUG, "Reset response, aborting transfer");
-            _anjay_downloader_abort_transfer(dl, ctx_ptr,
-                                             ANJAY_DOWNLOAD_ERR_FAILED);
+        if (type == AVS_COAP_MSG_RESET) {
+            if (slot->seq_num == next_seq_num(ctx)) {
+                dl_log(DEBUG, "Reset response, aborting transfer");
+                _anjay_downloader_abort_transfer(dl, ctx_ptr,
+                                                 ANJAY_DOWNLOAD_ERR_FAILED);
+            } else {
+                stop_pipelining(ctx);
+            }
             return;
         } else if (type == AVS_COAP_MSG_ACKNOWLEDGEMENT
                    && avs_coap_msg_get_code(msg) == AVS_COAP_CODE_EMPTY) {
-            avs_time_duration_t abort_delay = avs_coap_exchange_lifetime(
-                    &anjay->udp_tx_params);
-            dl_log(DEBUG, "Separate ACK received, waiting "
-                          "%" PRId64 ".%09" PRId32 " for response",
-                   abort_delay.seconds, abort_delay.nanoseconds);
-
-            _anjay_sched_del(anjay->sched, &ctx->sched_job);
-            _anjay_sched(anjay->sched, &ctx->sched_job, abort_delay,
-                         abort_transfer_job, *ctx_ptr);
+            slot->separate_ack = true;
+            schedule_coap_timeout(dl, ctx);
             return;
         }
     } else {
@@ -456,7 +693,7 @@ static void handle_coap_message(anjay_downloader_t *dl,
                                 avs_coap_msg_get_id(msg));
     }
 
-    handle_coap_response(msg, dl, ctx_ptr);
+    handle_coap_response(msg, dl, ctx_ptr, slot);
 }
 
 static avs_net_abstract_socket_t *get_coap_socket(anjay_downloader_t *dl,
@@ -553,14 +790,32 @@ _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
         goto error;
     }
 
-    ctx->common.id = id;
-    ctx->common.on_next_block = cfg->on_next_block;
-    ctx->common.on_download_finished = cfg->on_download_finished;
-    ctx->common.user_data = cfg->user_data;
+    _anjay_downloader_init_ctx_common(&ctx->common, cfg, id);
     ctx->bytes_downloaded = cfg->start_offset;
     ctx->block_size = get_max_acceptable_block_size(anjay->in_buffer_size);
     ctx->etag = cfg->etag;
 
+    ctx->window_size = cfg->coap_window_size ? cfg->coap_window_size : 1;
+    ctx->max_requested_blocks = 1;
+    ctx->seq_num_limit = SIZE_MAX;
+    ctx->slots = (coap_block_slot_t *) calloc(ctx->window_size,
+                                              sizeof(coap_block_slot_t));
+    if (!ctx->slots) {
+        dl_log(ERROR, "out of memory");
+        goto error;
+    }
+    if (ctx->window_size > 1) {
+        ctx->reassembly_buffer =
+                (uint8_t *) calloc(ctx->window_size, ctx->block_size);
+        if (!ctx->reassembly_buffer) {
+            dl_log(ERROR, "out of memory");
+            goto error;
+        }
+        for (size_t i = 0; i < ctx->window_size; ++i) {
+            ctx->slots[i].data = &ctx->reassembly_buffer[i * ctx->block_size];
+        }
+    }
+
     if (_anjay_sched_now(anjay->sched, &ctx->sched_job,
                          request_next_coap_block_job,
                          (void *) ctx->common.id)) {
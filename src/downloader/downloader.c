@@ -114,25 +114,15 @@ find_ctx_ptr_by_socket(anjay_downloader_t *dl,
     return NULL;
 }
 
-int _anjay_downloader_get_sockets(
-        anjay_downloader_t *dl,
-        AVS_LIST(avs_net_abstract_socket_t *const) *out_socks) {
-    AVS_LIST(avs_net_abstract_socket_t *const) sockets = NULL;
+int _anjay_downloader_update_socket_list(anjay_downloader_t *dl,
+                                         anjay_socket_list_updater_t *updater) {
     AVS_LIST(anjay_download_ctx_t) dl_ctx;
-
     AVS_LIST_FOREACH(dl_ctx, dl->downloads) {
-        AVS_LIST(avs_net_abstract_socket_t *) elem =
-                AVS_LIST_NEW_ELEMENT(avs_net_abstract_socket_t *);
-        if (!elem) {
-            AVS_LIST_CLEAR(&sockets);
+        if (_anjay_socket_list_updater_add(updater,
+                                           get_ctx_socket(dl, dl_ctx))) {
             return -1;
         }
-
-        *elem = get_ctx_socket(dl, dl_ctx);
-        AVS_LIST_INSERT(&sockets, elem);
     }
-
-    AVS_LIST_INSERT(out_socks, sockets);
     return 0;
 }
 
@@ -166,6 +156,33 @@ int _anjay_downloader_handle_packet(anjay_downloader_t *dl,
     return 0;
 }
 
+void _anjay_downloader_init_ctx_common(anjay_download_ctx_common_t *common,
+                                       const anjay_download_config_t *cfg,
+                                       uintptr_t id) {
+    common->id = id;
+    common->on_next_block = cfg->on_next_block;
+    common->on_download_finished = cfg->on_download_finished;
+    common->on_checkpoint = cfg->on_checkpoint;
+    common->checkpoint_interval = cfg->checkpoint_interval;
+    common->last_checkpoint = cfg->start_offset;
+    common->user_data = cfg->user_data;
+}
+
+int _anjay_downloader_checkpoint(anjay_downloader_t *dl,
+                                 anjay_download_ctx_common_t *common,
+                                 size_t offset,
+                                 const anjay_etag_t *etag) {
+    assert(offset >= common->last_checkpoint);
+    if (!common->on_checkpoint
+            || offset - common->last_checkpoint < common->checkpoint_interval) {
+        return 0;
+    }
+
+    common->last_checkpoint = offset;
+    return common->on_checkpoint(_anjay_downloader_get_anjay(dl), offset, etag,
+                                 common->user_data);
+}
+
 static uintptr_t find_free_id(anjay_downloader_t *dl) {
     uintptr_t id;
 
@@ -18,6 +18,9 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <avsystem/commons/http.h>
 #include <avsystem/commons/stream/stream_net.h>
@@ -35,8 +38,127 @@ typedef struct {
     avs_url_t *parsed_url;
     avs_stream_abstract_t *stream;
     anjay_sched_handle_t send_request_job;
+
+    size_t bytes_downloaded;
+    /* Number of received bytes preceding the requested range */
+    size_t bytes_to_skip;
+    /* Set if the response body has a Content-Encoding other than identity;
+     * offsets into decoded data cannot be resumed from, so no checkpoints are
+     * reported for such transfers */
+    bool content_encoded;
+    anjay_etag_t etag;
 } anjay_http_download_ctx_t;
 
+static const char *find_header(AVS_LIST(const avs_http_header_t) headers,
+                               const char *key) {
+    AVS_LIST(const avs_http_header_t) header;
+    AVS_LIST_FOREACH(header, headers) {
+        if (!avs_strcasecmp(header->key, key)) {
+            return header->value;
+        }
+    }
+    return NULL;
+}
+
+static void read_etag(const char *value, anjay_etag_t *out_etag) {
+    const size_t length = strlen(value);
+    if (length <= sizeof(out_etag->value)) {
+        out_etag->size = (uint8_t) length;
+        memcpy(out_etag->value, value, length);
+    } else {
+        uint64_t hash = _anjay_fnv1a_64_update(ANJAY_FNV1A_64_OFFSET_BASIS,
+                                               value, length);
+        out_etag->size = (uint8_t) sizeof(out_etag->value);
+        for (size_t i = 0; i < sizeof(out_etag->value); ++i) {
+            out_etag->value[i] = (uint8_t) (hash >> (8 * i));
+        }
+    }
+}
+
+static int read_range_start(const char *content_range, size_t *out_start) {
+    // Content-Range: bytes <first>-<last>/<complete-length>
+    static const char PREFIX[] = "bytes ";
+    if (avs_strncasecmp(content_range, PREFIX, sizeof(PREFIX) - 1)) {
+        return -1;
+    }
+    const char *first = content_range + sizeof(PREFIX) - 1;
+    char *endptr = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(first, &endptr, 10);
+    if (errno || endptr == first || *endptr != '-' || value > SIZE_MAX) {
+        return -1;
+    }
+    *out_start = (size_t) value;
+    return 0;
+}
+
+/**
+ * Validates response headers against the requested range and expected ETag.
+ *
+ * @returns 0 on success, or one of @ref anjay_download_result_t values.
+ */
+static int handle_response_headers(anjay_http_download_ctx_t *ctx,
+                                   int status_code,
+                                   AVS_LIST(const avs_http_header_t) headers) {
+    const char *etag = find_header(headers, "ETag");
+    if (ctx->etag.size) {
+        anjay_etag_t received = { 0 };
+        if (etag) {
+            read_etag(etag, &received);
+        }
+        if (received.size != ctx->etag.size
+                || memcmp(received.value, ctx->etag.value, received.size)) {
+            dl_log(DEBUG, "remote resource expired, aborting download");
+            return ANJAY_DOWNLOAD_ERR_EXPIRED;
+        }
+    } else if (etag) {
+        read_etag(etag, &ctx->etag);
+    }
+
+    const char *encoding = find_header(headers, "Content-Encoding");
+    ctx->content_encoded = (encoding && avs_strcasecmp(encoding, "identity"));
+    if (!ctx->bytes_downloaded) {
+        if (ctx->content_encoded) {
+            dl_log(DEBUG, "content is encoded, download cannot be resumed");
+        }
+        return 0;
+    }
+
+    if (ctx->content_encoded) {
+        dl_log(ERROR, "cannot resume download of encoded content");
+        return ANJAY_DOWNLOAD_ERR_FAILED;
+    }
+
+    if (status_code != 206) {
+        dl_log(DEBUG, "server ignored Range, skipping %zu B",
+               ctx->bytes_downloaded);
+        ctx->bytes_to_skip = ctx->bytes_downloaded;
+        return 0;
+    }
+
+    const char *content_range = find_header(headers, "Content-Range");
+    size_t range_start;
+    if (!content_range || read_range_start(content_range, &range_start)
+            || range_start > ctx->bytes_downloaded) {
+        dl_log(ERROR, "invalid Content-Range in response");
+        return ANJAY_DOWNLOAD_ERR_FAILED;
+    }
+    ctx->bytes_to_skip = ctx->bytes_downloaded - range_start;
+    return 0;
+}
+
+static int add_range_headers(anjay_http_download_ctx_t *ctx) {
+    char range[sizeof("bytes=-") + 20];
+    if (snprintf(range, sizeof(range), "bytes=%zu-", ctx->bytes_downloaded)
+            >= (int) sizeof(range)) {
+        return -1;
+    }
+    // the offset refers to the decoded content, so it needs to be requested
+    // as is - ranges of encoded representations would not match
+    return avs_http_add_header(ctx->stream, "Range", range)
+            || avs_http_add_header(ctx->stream, "Accept-Encoding", "identity");
+}
+
 static int send_request(anjay_t *anjay, void *id_) {
     uintptr_t id = (uintptr_t) id_;
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
@@ -56,12 +178,27 @@ static int send_request(anjay_t *anjay, void *id_) {
         goto error;
     }
 
+    if (ctx->bytes_downloaded > 0 && add_range_headers(ctx)) {
+        dl_log(ERROR, "Could not add Range header");
+        goto error;
+    }
+
+    AVS_LIST(const avs_http_header_t) headers = NULL;
+    avs_http_set_header_storage(ctx->stream, &headers);
     if (avs_stream_finish_message(ctx->stream)) {
         dl_log(ERROR, "Could not send HTTP request, error %d",
                avs_stream_errno(ctx->stream));
-        goto error;
+        result = ANJAY_DOWNLOAD_ERR_FAILED;
+    } else {
+        result = handle_response_headers(
+                ctx, avs_http_status_code(ctx->stream), headers);
     }
+    avs_http_set_header_storage(ctx->stream, NULL);
+    AVS_LIST_CLEAR(&headers);
 
+    if (result) {
+        _anjay_downloader_abort_transfer(&anjay->downloader, ctx_ptr, result);
+    }
     return 0;
 error:
     _anjay_downloader_abort_transfer(&anjay->downloader, ctx_ptr,
@@ -90,13 +227,30 @@ static void handle_http_packet(anjay_downloader_t *dl,
                                              ANJAY_DOWNLOAD_ERR_FAILED);
             return;
         }
-        if (bytes_read
-                && ctx->common.on_next_block(_anjay_downloader_get_anjay(dl),
-                                             anjay->in_buffer, bytes_read, NULL,
-                                             ctx->common.user_data)) {
-            _anjay_downloader_abort_transfer(dl, ctx_ptr,
-                                             ANJAY_DOWNLOAD_ERR_FAILED);
-            return;
+        const uint8_t *data = anjay->in_buffer;
+        if (ctx->bytes_to_skip) {
+            size_t skipped = AVS_MIN(ctx->bytes_to_skip, bytes_read);
+            ctx->bytes_to_skip -= skipped;
+            data += skipped;
+            bytes_read -= skipped;
+        }
+        if (bytes_read) {
+            if (ctx->common.on_next_block(_anjay_downloader_get_anjay(dl),
+                                          data, bytes_read, &ctx->etag,
+                                          ctx->common.user_data)) {
+                _anjay_downloader_abort_transfer(dl, ctx_ptr,
+                                                 ANJAY_DOWNLOAD_ERR_FAILED);
+                return;
+            }
+            ctx->bytes_downloaded += bytes_read;
+            if (!ctx->content_encoded
+                    && _anjay_downloader_checkpoint(dl, &ctx->common,
+                                                    ctx->bytes_downloaded,
+                                                    &ctx->etag)) {
+                _anjay_downloader_abort_transfer(dl, ctx_ptr,
+                                                 ANJAY_DOWNLOAD_ERR_FAILED);
+                return;
+            }
         }
         if (message_finished) {
             dl_log(INFO, "HTTP transfer id = %" PRIuPTR " finished",
@@ -131,28 +285,6 @@ AVS_LIST(anjay_download_ctx_t)
 _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
                                const anjay_download_config_t *cfg,
                                uintptr_t id) {
-    if (cfg->start_offset > 0) {
-        dl_log(ERROR, "resuming downloads not currently supported for HTTP");
-        return NULL;
-        // TODO: Actually implement this. This is more work than it might look
-        // at first glance. We'd need to:
-        // - Send the "Range: bytes=<start_offset>-" HTTP header
-        // - Read the Content-Range response header, which might actually be
-        //   different from the requested range (might include bytes before what
-        //   we actually want, much like block-aligned requests in CoAP; or it
-        //   might even be missing completely, which means that the server sent
-        //   full body anyway
-        // - Prevent Accept-Encoding from being sent (or even better, send
-        //   "Accept-Encoding: identity") - HTTP content compression does not
-        //   play well with partial requests, because values in Range would
-        //   refer to offsets in the *compressed* stream, even though we discard
-        //   it and decompress it on the fly, so we don't know such offsets.
-        // - Send and handle the ETag header. This should be relatively
-        //   straightforward, but require ETags of arbitrary size. Premilinary
-        //   patch can be found here:
-        //   https://gist.github.com/kFYatek/42f0ef89400b5caad1f1771abdf2ea08
-    }
-
     AVS_LIST(anjay_http_download_ctx_t) ctx =
             AVS_LIST_NEW_ELEMENT(anjay_http_download_ctx_t);
     if (!ctx) {
@@ -177,10 +309,9 @@ _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
         goto error;
     }
 
-    ctx->common.id = id;
-    ctx->common.on_next_block = cfg->on_next_block;
-    ctx->common.on_download_finished = cfg->on_download_finished;
-    ctx->common.user_data = cfg->user_data;
+    _anjay_downloader_init_ctx_common(&ctx->common, cfg, id);
+    ctx->bytes_downloaded = cfg->start_offset;
+    ctx->etag = cfg->etag;
 
     if (_anjay_sched_now(_anjay_downloader_get_anjay(dl)->sched,
                          &ctx->send_request_job, send_request,
@@ -194,3 +325,7 @@ error:
     cleanup_http_transfer(dl, (AVS_LIST(anjay_download_ctx_t) *) &ctx);
     return NULL;
 }
+
+#ifdef ANJAY_TEST
+#include "test/http.c"
+#endif // ANJAY_TEST
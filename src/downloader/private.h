@@ -44,6 +44,9 @@ typedef struct {
 
     anjay_download_next_block_handler_t *on_next_block;
     anjay_download_finished_handler_t *on_download_finished;
+    anjay_download_checkpoint_handler_t *on_checkpoint;
+    size_t checkpoint_interval;
+    size_t last_checkpoint;
     void *user_data;
 } anjay_download_ctx_common_t;
 
@@ -59,6 +62,26 @@ void _anjay_downloader_abort_transfer(anjay_downloader_t *dl,
                                       AVS_LIST(anjay_download_ctx_t) *ctx,
                                       int result);
 
+/**
+ * Initializes fields of @p common that are shared by all download types.
+ * @ref anjay_download_ctx_common_t#vtable is not changed.
+ */
+void _anjay_downloader_init_ctx_common(anjay_download_ctx_common_t *common,
+                                       const anjay_download_config_t *cfg,
+                                       uintptr_t id);
+
+/**
+ * Reports that all data up to @p offset was successfully passed to the
+ * @ref anjay_download_ctx_common_t#on_next_block handler. Calls the checkpoint
+ * handler if necessary.
+ *
+ * @returns 0 on success, or a nonzero value returned by the checkpoint handler.
+ */
+int _anjay_downloader_checkpoint(anjay_downloader_t *dl,
+                                 anjay_download_ctx_common_t *common,
+                                 size_t offset,
+                                 const anjay_etag_t *etag);
+
 #ifdef WITH_BLOCK_DOWNLOAD
 AVS_LIST(anjay_download_ctx_t)
 _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
@@ -115,6 +115,7 @@ typedef struct {
 typedef struct {
     anjay_t *anjay;
     AVS_LIST(on_next_block_args_t) on_next_block_calls;
+    AVS_LIST(size_t) checkpoints;
     bool finish_call_expected;
     int expected_download_result;
 } handler_data_t;
@@ -193,9 +194,22 @@ static void teardown_simple(dl_simple_test_env_t *env) {
     teardown(&env->base);
 }
 
+static AVS_LIST(avs_net_abstract_socket_t *const)
+get_sockets(anjay_downloader_t *dl) {
+    AVS_LIST(avs_net_abstract_socket_t *const) sockets = NULL;
+    anjay_socket_list_updater_t updater = {
+        .tail_ptr = &sockets,
+        .changed = false
+    };
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_update_socket_list(dl,
+                                                                 &updater));
+    _anjay_socket_list_updater_finish(&updater);
+    return sockets;
+}
+
 static int handle_packet(dl_simple_test_env_t *env) {
-    AVS_LIST(avs_net_abstract_socket_t *const) sock = NULL;
-    _anjay_downloader_get_sockets(&env->base.anjay.downloader, &sock);
+    AVS_LIST(avs_net_abstract_socket_t *const) sock =
+            get_sockets(&env->base.anjay.downloader);
     if (!sock) {
         return -1;
     }
@@ -226,24 +240,18 @@ AVS_UNIT_TEST(downloader, empty_has_no_sockets) {
     dl_test_env_t env __attribute__((__cleanup__(teardown)));
     setup(&env);
 
-    AVS_LIST(avs_net_abstract_socket_t *const) socks = NULL;
-    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_sockets(&env.anjay.downloader,
-                                                          &socks));
-    AVS_UNIT_ASSERT_NULL(socks);
+    AVS_UNIT_ASSERT_NULL(get_sockets(&env.anjay.downloader));
 }
 
 static void assert_download_not_possible(anjay_downloader_t *dl,
                                          const anjay_download_config_t *cfg) {
-    size_t num_downloads = 0;
-
-    AVS_LIST(avs_net_abstract_socket_t *const) socks = NULL;
-    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_sockets(dl, &socks));
-    num_downloads = AVS_LIST_SIZE(socks);
+    AVS_LIST(avs_net_abstract_socket_t *const) socks = get_sockets(dl);
+    size_t num_downloads = AVS_LIST_SIZE(socks);
     AVS_LIST_CLEAR(&socks);
 
     AVS_UNIT_ASSERT_NULL(_anjay_downloader_download(dl, cfg));
 
-    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_sockets(dl, &socks));
+    socks = get_sockets(dl);
     AVS_UNIT_ASSERT_EQUAL(num_downloads, AVS_LIST_SIZE(socks));
     AVS_LIST_CLEAR(&socks);
 }
@@ -333,6 +341,132 @@ AVS_UNIT_TEST(downloader, coap_download_multiple_blocks) {
     perform_simple_download(&env);
 }
 
+static void expect_block_request(dl_simple_test_env_t *env,
+                                 uint16_t msg_id,
+                                 size_t seq_num,
+                                 size_t block_size) {
+    const avs_coap_msg_t *req = COAP_MSG(CON, GET, ID(msg_id),
+                                         BLOCK2(seq_num, block_size));
+    avs_unit_mocksock_expect_output(env->mocksock, &req->content, req->length);
+}
+
+static void input_block_response(dl_simple_test_env_t *env,
+                                 uint16_t msg_id,
+                                 size_t seq_num,
+                                 size_t block_size) {
+    const avs_coap_msg_t *res = COAP_MSG(ACK, CONTENT, ID(msg_id),
+                                         BLOCK2(seq_num, block_size, DESPAIR));
+    avs_unit_mocksock_input(env->mocksock, &res->content, res->length);
+}
+
+AVS_UNIT_TEST(downloader, coap_download_pipelined) {
+    static const size_t BLOCK_SIZE = 16;
+
+    dl_simple_test_env_t env __attribute__((__cleanup__(teardown_simple)));
+    setup_simple(&env, "coap://127.0.0.1:5683");
+    env.cfg.coap_window_size = 4;
+
+    avs_unit_mocksock_expect_connect(env.mocksock, "127.0.0.1", "5683");
+
+    // block size is negotiated before requesting more blocks
+    expect_block_request(&env, 0, 0, 1024);
+    input_block_response(&env, 0, 0, BLOCK_SIZE);
+
+    for (size_t i = 1; i <= 4; ++i) {
+        expect_block_request(&env, (uint16_t) i, i, BLOCK_SIZE);
+    }
+    // out-of-order block is buffered until the missing one arrives
+    input_block_response(&env, 2, 2, BLOCK_SIZE);
+    input_block_response(&env, 1, 1, BLOCK_SIZE);
+
+    expect_block_request(&env, 5, 5, BLOCK_SIZE);
+    expect_block_request(&env, 6, 6, BLOCK_SIZE);
+    input_block_response(&env, 4, 4, BLOCK_SIZE);
+    input_block_response(&env, 3, 3, BLOCK_SIZE);
+
+    expect_block_request(&env, 7, 7, BLOCK_SIZE);
+    expect_block_request(&env, 8, 8, BLOCK_SIZE);
+    // request past the end of the resource is not an error
+    const avs_coap_msg_t *res = COAP_MSG(ACK, BAD_OPTION, ID(8), NO_PAYLOAD);
+    avs_unit_mocksock_input(env.mocksock, &res->content, res->length);
+    input_block_response(&env, 6, 6, BLOCK_SIZE);
+    input_block_response(&env, 5, 5, BLOCK_SIZE);
+    // no more requests are sent, as the last block is already requested
+    input_block_response(&env, 7, 7, BLOCK_SIZE);
+
+    size_t num_blocks = DIV_CEIL(sizeof(DESPAIR) - 1, BLOCK_SIZE);
+    AVS_UNIT_ASSERT_EQUAL(num_blocks, 8);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        bool is_last_block = (i + 1 == num_blocks);
+        on_next_block_args_t args = {
+            .data_size = is_last_block
+                    ? sizeof(DESPAIR) - 1 - i * BLOCK_SIZE
+                    : BLOCK_SIZE,
+            .result = 0
+        };
+        memcpy(args.data, &DESPAIR[i * BLOCK_SIZE], args.data_size);
+        expect_next_block(&env.data, args);
+    }
+    expect_download_finished(&env.data, 0);
+
+    perform_simple_download(&env);
+}
+
+static int on_checkpoint(anjay_t *anjay,
+                         size_t offset,
+                         const anjay_etag_t *etag,
+                         void *user_data) {
+    (void) etag;
+    handler_data_t *hd = (handler_data_t *) user_data;
+    AVS_UNIT_ASSERT_TRUE(anjay == hd->anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(hd->checkpoints);
+    AVS_UNIT_ASSERT_EQUAL(*hd->checkpoints, offset);
+    AVS_LIST_DELETE(&hd->checkpoints);
+    return 0;
+}
+
+AVS_UNIT_TEST(downloader, coap_download_checkpoint) {
+    static const size_t BLOCK_SIZE = 16;
+
+    dl_simple_test_env_t env __attribute__((__cleanup__(teardown_simple)));
+    setup_simple(&env, "coap://127.0.0.1:5683");
+
+    env.cfg.on_checkpoint = on_checkpoint;
+    env.cfg.checkpoint_interval = 40;
+
+    avs_unit_mocksock_expect_connect(env.mocksock, "127.0.0.1", "5683");
+
+    size_t num_blocks = DIV_CEIL(sizeof(DESPAIR) - 1, BLOCK_SIZE);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        expect_block_request(&env, (uint16_t) i, i,
+                             i == 0 ? 1024 : BLOCK_SIZE);
+        input_block_response(&env, (uint16_t) i, i, BLOCK_SIZE);
+
+        bool is_last_block = (i + 1 == num_blocks);
+        on_next_block_args_t args = {
+            .data_size = is_last_block
+                    ? sizeof(DESPAIR) - 1 - i * BLOCK_SIZE
+                    : BLOCK_SIZE,
+            .result = 0
+        };
+        memcpy(args.data, &DESPAIR[i * BLOCK_SIZE], args.data_size);
+        expect_next_block(&env.data, args);
+    }
+    expect_download_finished(&env.data, 0);
+
+    // at least 40 bytes between subsequent checkpoints
+    static const size_t EXPECTED_CHECKPOINTS[] = { 48, 96 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(EXPECTED_CHECKPOINTS); ++i) {
+        AVS_LIST(size_t) checkpoint = AVS_LIST_NEW_ELEMENT(size_t);
+        AVS_UNIT_ASSERT_NOT_NULL(checkpoint);
+        *checkpoint = EXPECTED_CHECKPOINTS[i];
+        AVS_LIST_APPEND(&env.data.checkpoints, checkpoint);
+    }
+
+    perform_simple_download(&env);
+    AVS_UNIT_ASSERT_NULL(env.data.checkpoints);
+}
+
 AVS_UNIT_TEST(downloader, download_abort_on_cleanup) {
     dl_simple_test_env_t env __attribute__((__cleanup__(teardown_simple)));
     setup_simple(&env, "coap://127.0.0.1:5683");
@@ -617,8 +751,8 @@ AVS_UNIT_TEST(downloader, missing_separate_response) {
 }
 
 static size_t num_downloads_in_progress(dl_simple_test_env_t *env) {
-    AVS_LIST(avs_net_abstract_socket_t *const) sock = NULL;
-    _anjay_downloader_get_sockets(&env->base.anjay.downloader, &sock);
+    AVS_LIST(avs_net_abstract_socket_t *const) sock =
+            get_sockets(&env->base.anjay.downloader);
     size_t result = AVS_LIST_SIZE(sock);
     AVS_LIST_CLEAR(&sock);
     return result;
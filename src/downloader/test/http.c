@@ -0,0 +1,137 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/unit/test.h>
+
+static void add_header(AVS_LIST(avs_http_header_t) *headers,
+                       const char *key,
+                       const char *value) {
+    AVS_LIST(avs_http_header_t) header =
+            AVS_LIST_NEW_ELEMENT(avs_http_header_t);
+    AVS_UNIT_ASSERT_NOT_NULL(header);
+    header->key = key;
+    header->value = value;
+    AVS_LIST_APPEND(headers, header);
+}
+
+AVS_UNIT_TEST(http_download, etag_stored_from_first_response) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 0 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "ETag", "\"v1\"");
+
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 200, headers));
+    AVS_UNIT_ASSERT_EQUAL(ctx.etag.size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ctx.etag.value, "\"v1\"", 4);
+    AVS_UNIT_ASSERT_EQUAL(ctx.bytes_to_skip, 0);
+    AVS_UNIT_ASSERT_FALSE(ctx.content_encoded);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_expired) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    read_etag("\"v1\"", &ctx.etag);
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "ETag", "\"v2\"");
+    add_header(&headers, "Content-Range", "bytes 100-199/200");
+
+    AVS_UNIT_ASSERT_EQUAL(handle_response_headers(&ctx, 206, headers),
+                          ANJAY_DOWNLOAD_ERR_EXPIRED);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_partial_content) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    read_etag("\"v1\"", &ctx.etag);
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "ETag", "\"v1\"");
+    add_header(&headers, "Content-Range", "bytes 100-199/200");
+
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 206, headers));
+    AVS_UNIT_ASSERT_EQUAL(ctx.bytes_to_skip, 0);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_earlier_range) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "Content-Range", "bytes 60-199/200");
+
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 206, headers));
+    AVS_UNIT_ASSERT_EQUAL(ctx.bytes_to_skip, 40);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_later_range) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "Content-Range", "bytes 150-199/200");
+
+    AVS_UNIT_ASSERT_EQUAL(handle_response_headers(&ctx, 206, headers),
+                          ANJAY_DOWNLOAD_ERR_FAILED);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_invalid_content_range) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "Content-Range", "items 100-199/200");
+
+    AVS_UNIT_ASSERT_EQUAL(handle_response_headers(&ctx, 206, headers),
+                          ANJAY_DOWNLOAD_ERR_FAILED);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, resume_range_ignored) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 200, NULL));
+    AVS_UNIT_ASSERT_EQUAL(ctx.bytes_to_skip, 100);
+}
+
+AVS_UNIT_TEST(http_download, encoded_content_not_resumable) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 0 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "Content-Encoding", "gzip");
+
+    // the download itself is fine, but no checkpoints are reported for it
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 200, headers));
+    AVS_UNIT_ASSERT_TRUE(ctx.content_encoded);
+
+    ctx.bytes_downloaded = 100;
+    AVS_UNIT_ASSERT_EQUAL(handle_response_headers(&ctx, 200, headers),
+                          ANJAY_DOWNLOAD_ERR_FAILED);
+
+    AVS_LIST_CLEAR(&headers);
+}
+
+AVS_UNIT_TEST(http_download, identity_encoding_resumable) {
+    anjay_http_download_ctx_t ctx = { .bytes_downloaded = 100 };
+    AVS_LIST(avs_http_header_t) headers = NULL;
+    add_header(&headers, "Content-Encoding", "Identity");
+    add_header(&headers, "Content-Range", "bytes 100-199/200");
+
+    AVS_UNIT_ASSERT_SUCCESS(handle_response_headers(&ctx, 206, headers));
+    AVS_UNIT_ASSERT_FALSE(ctx.content_encoded);
+    AVS_UNIT_ASSERT_EQUAL(ctx.bytes_to_skip, 0);
+
+    AVS_LIST_CLEAR(&headers);
+}
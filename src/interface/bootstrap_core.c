@@ -82,26 +82,8 @@ static void abort_bootstrap(anjay_t *anjay) {
 static void bootstrap_remove_notify_changed(anjay_t *anjay,
                                             anjay_oid_t oid,
                                             anjay_iid_t iid) {
-    AVS_LIST(anjay_notify_queue_object_entry_t) *obj_it;
-    AVS_LIST_FOREACH_PTR(obj_it, &anjay->bootstrap.notification_queue) {
-        if ((*obj_it)->oid > oid) {
-            return;
-        } else if ((*obj_it)->oid == oid) {
-            break;
-        }
-    }
-    if (!*obj_it) {
-        return;
-    }
-    AVS_LIST(anjay_notify_queue_resource_entry_t) *res_it;
-    AVS_LIST_FOREACH_PTR(res_it, &(*obj_it)->resources_changed) {
-        if ((*res_it)->iid >= iid) {
-            break;
-        }
-    }
-    while (*res_it && (*res_it)->iid == iid) {
-        AVS_LIST_DELETE(res_it);
-    }
+    _anjay_notify_queue_remove_instance_resources(
+            &anjay->bootstrap.notification_queue, oid, iid);
 }
 
 static uint8_t make_success_response_code(anjay_request_action_t action) {
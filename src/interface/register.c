@@ -16,11 +16,16 @@
 
 #include <config.h>
 
+#include <assert.h>
 #include <inttypes.h>
+#include <stdlib.h>
 
+#include <avsystem/commons/coap/ctx.h>
 #include <avsystem/commons/coap/msg.h>
 #include <avsystem/commons/coap/msg_opt.h>
+#include <avsystem/commons/coap/tx_params.h>
 #include <avsystem/commons/stream.h>
+#include <avsystem/commons/stream/stream_net.h>
 #include <avsystem/commons/utils.h>
 
 #include <anjay_modules/time_defs.h>
@@ -86,37 +91,67 @@ static const char *assemble_endpoint_path(char *buffer,
     return buffer;
 }
 
-static int send_objects_list(avs_stream_abstract_t *stream,
-                             AVS_LIST(anjay_dm_cache_object_t) dm) {
-    // TODO: (LwM2M 5.2.1) </>;rt="oma.lwm2m";ct=100 when JSON is implemented
-    bool is_first_path = true;
+static int update_dm_cache_payload(anjay_registration_dm_cache_t *cache) {
+    if (cache->payload_generation == cache->generation) {
+        return 0;
+    }
 
+    static const size_t MAX_LINK_SIZE = sizeof(",</65535/65535>") - 1;
+    size_t num_links = 0;
     anjay_dm_cache_object_t *object;
-    AVS_LIST_FOREACH(object, dm) {
+    AVS_LIST_FOREACH(object, cache->objects) {
+        num_links += object->instances ? AVS_LIST_SIZE(object->instances) : 1;
+    }
+    // + 1 for the terminating nullbyte written by avs_simple_snprintf()
+    const size_t capacity = num_links * MAX_LINK_SIZE + 1;
+    char *payload = (char *) malloc(capacity);
+    if (!payload) {
+        anjay_log(ERROR, "out of memory");
+        return -1;
+    }
+
+    size_t offset = 0;
+    AVS_LIST_FOREACH(object, cache->objects) {
+        ssize_t result;
         if (object->instances) {
             anjay_iid_t *iid;
             AVS_LIST_FOREACH(iid, object->instances) {
-                int result = avs_stream_write_f(stream, "%s</%u/%u>",
-                                                is_first_path ? "" : ",",
-                                                object->oid, *iid);
-                if (result) {
-                    return result;
-                }
-                is_first_path = false;
+                result = avs_simple_snprintf(payload + offset,
+                                             capacity - offset, "%s</%u/%u>",
+                                             offset ? "," : "",
+                                             object->oid, *iid);
+                assert(result >= 0);
+                offset += (size_t) result;
             }
         } else {
-            int result = avs_stream_write_f(stream, "%s</%u>",
-                                            is_first_path ? "" : ",",
-                                            object->oid);
-            if (result) {
-                return result;
-            }
-            is_first_path = false;
+            result = avs_simple_snprintf(payload + offset, capacity - offset,
+                                         "%s</%u>", offset ? "," : "",
+                                         object->oid);
+            assert(result >= 0);
+            offset += (size_t) result;
         }
     }
+
+    free(cache->payload);
+    cache->payload = payload;
+    cache->payload_size = offset;
+    cache->payload_generation = cache->generation;
     return 0;
 }
 
+static int send_objects_list(anjay_t *anjay) {
+    // TODO: (LwM2M 5.2.1) </>;rt="oma.lwm2m";ct=100 when JSON is implemented
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    int result = update_dm_cache_payload(cache);
+    if (!result && cache->payload_size) {
+        // if the payload does not fit in a single message, the stream
+        // switches to a Block1 transfer on its own
+        result = avs_stream_write(anjay->comm_stream,
+                                  cache->payload, cache->payload_size);
+    }
+    return result;
+}
+
 static int get_server_lifetime(anjay_t *anjay,
                                anjay_ssid_t ssid,
                                int64_t *out_lifetime) {
@@ -143,8 +178,8 @@ static int get_server_lifetime(anjay_t *anjay,
     return 0;
 }
 
-static int send_register(anjay_t *anjay,
-                         const anjay_update_parameters_t *params) {
+static int setup_register(anjay_t *anjay,
+                          const anjay_update_parameters_t *params) {
     anjay_msg_details_t details = {
         .msg_type = AVS_COAP_MSG_CONFIRMABLE,
         .msg_code = AVS_COAP_CODE_POST,
@@ -164,13 +199,10 @@ static int send_register(anjay_t *anjay,
         goto cleanup;
     }
 
-    if (_anjay_coap_stream_setup_request(anjay->comm_stream, &details, NULL)
-            || send_objects_list(anjay->comm_stream, params->dm)
-            || avs_stream_finish_message(anjay->comm_stream)) {
-        anjay_log(ERROR, "could not send Register message");
-    } else {
-        anjay_log(INFO, "Register sent");
-        result = 0;
+    if ((result = _anjay_coap_stream_setup_request(anjay->comm_stream,
+                                                   &details, NULL))
+            || (result = send_objects_list(anjay))) {
+        anjay_log(ERROR, "could not prepare Register message");
     }
 
 cleanup:
@@ -180,14 +212,8 @@ cleanup:
 }
 
 static int
-check_register_response(avs_stream_abstract_t *stream,
-                        AVS_LIST(const anjay_string_t) *out_endpoint_path) {
-    const avs_coap_msg_t *response;
-    if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
-        anjay_log(ERROR, "could not get response");
-        return -1;
-    }
-
+handle_register_response(const avs_coap_msg_t *response,
+                         AVS_LIST(const anjay_string_t) *out_endpoint_path) {
     if (avs_coap_msg_get_code(response) != AVS_COAP_CODE_CREATED) {
         anjay_log(ERROR, "server responded with %s (expected %s)",
                   AVS_COAP_CODE_STRING(avs_coap_msg_get_code(response)),
@@ -220,6 +246,18 @@ check_register_response(avs_stream_abstract_t *stream,
     return 0;
 }
 
+static int
+check_register_response(avs_stream_abstract_t *stream,
+                        AVS_LIST(const anjay_string_t) *out_endpoint_path) {
+    const avs_coap_msg_t *response;
+    if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
+        anjay_log(ERROR, "could not get response");
+        return -1;
+    }
+
+    return handle_register_response(response, out_endpoint_path);
+}
+
 static void clear_dm_cache(AVS_LIST(anjay_dm_cache_object_t) *cache_ptr) {
     AVS_LIST_CLEAR(cache_ptr) {
         AVS_LIST_CLEAR(&(*cache_ptr)->instances);
@@ -259,6 +297,18 @@ static int compare_iids(const void *left_, const void *right_, size_t size) {
     }
 }
 
+static int query_dm_instances(anjay_t *anjay,
+                              const anjay_dm_object_def_t *const *obj,
+                              AVS_LIST(anjay_iid_t) *out) {
+    AVS_LIST(anjay_iid_t) *instance_insert_ptr = out;
+    int retval = _anjay_dm_foreach_instance(anjay, obj, query_dm_instance,
+                                            &instance_insert_ptr);
+    if (!retval) {
+        AVS_LIST_SORT(out, compare_iids);
+    }
+    return retval;
+}
+
 static int query_dm_object(anjay_t *anjay,
                            const anjay_dm_object_def_t *const *obj,
                            void *cache_object_insert_ptr_) {
@@ -281,13 +331,7 @@ static int query_dm_object(anjay_t *anjay,
     *cache_object_insert_ptr = AVS_LIST_NEXT_PTR(*cache_object_insert_ptr);
 
     new_object->oid = (*obj)->oid;
-    AVS_LIST(anjay_iid_t) *instance_insert_ptr = &new_object->instances;
-    int retval = _anjay_dm_foreach_instance(anjay, obj, query_dm_instance,
-                                            &instance_insert_ptr);
-    if (!retval) {
-        AVS_LIST_SORT(&new_object->instances, compare_iids);
-    }
-    return retval;
+    return query_dm_instances(anjay, obj, &new_object->instances);
 }
 
 static int query_dm(anjay_t *anjay, AVS_LIST(anjay_dm_cache_object_t) *out) {
@@ -302,46 +346,158 @@ static int query_dm(anjay_t *anjay, AVS_LIST(anjay_dm_cache_object_t) *out) {
     return retval;
 }
 
+static bool iid_lists_equal(AVS_LIST(anjay_iid_t) left,
+                            AVS_LIST(anjay_iid_t) right) {
+    while (left && right) {
+        if (*left != *right) {
+            return false;
+        }
+        left = AVS_LIST_NEXT(left);
+        right = AVS_LIST_NEXT(right);
+    }
+    return !(left || right);
+}
+
+static bool dm_caches_equal(AVS_LIST(anjay_dm_cache_object_t) left,
+                            AVS_LIST(anjay_dm_cache_object_t) right) {
+    while (left && right) {
+        if (left->oid != right->oid
+                || !iid_lists_equal(left->instances, right->instances)) {
+            return false;
+        }
+        left = AVS_LIST_NEXT(left);
+        right = AVS_LIST_NEXT(right);
+    }
+    return !(left || right);
+}
+
+static int rebuild_dm_cache(anjay_t *anjay) {
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    AVS_LIST(anjay_dm_cache_object_t) objects;
+    if (query_dm(anjay, &objects)) {
+        return -1;
+    }
+    if (cache->valid && dm_caches_equal(cache->objects, objects)) {
+        clear_dm_cache(&objects);
+    } else {
+        clear_dm_cache(&cache->objects);
+        cache->objects = objects;
+        ++cache->generation;
+    }
+    cache->valid = true;
+    return 0;
+}
+
+static int refresh_dm_cache_object(anjay_t *anjay, anjay_oid_t oid) {
+    if (oid == ANJAY_DM_OID_SECURITY) {
+        return 0;
+    }
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    AVS_LIST(anjay_dm_cache_object_t) *object_ptr;
+    AVS_LIST_FOREACH_PTR(object_ptr, &cache->objects) {
+        if ((*object_ptr)->oid >= oid) {
+            break;
+        }
+    }
+    const bool cached = (*object_ptr && (*object_ptr)->oid == oid);
+
+    const anjay_dm_object_def_t *const *obj =
+            _anjay_dm_find_object_by_oid(anjay, oid);
+    if (!obj) {
+        // the object has been unregistered
+        if (cached) {
+            AVS_LIST_CLEAR(&(*object_ptr)->instances);
+            AVS_LIST_DELETE(object_ptr);
+            ++cache->generation;
+        }
+        return 0;
+    }
+
+    AVS_LIST(anjay_iid_t) instances = NULL;
+    if (query_dm_instances(anjay, obj, &instances)) {
+        AVS_LIST_CLEAR(&instances);
+        return -1;
+    }
+    if (cached && iid_lists_equal((*object_ptr)->instances, instances)) {
+        AVS_LIST_CLEAR(&instances);
+        return 0;
+    }
+    if (!cached) {
+        if (!AVS_LIST_INSERT_NEW(anjay_dm_cache_object_t, object_ptr)) {
+            anjay_log(ERROR, "out of memory");
+            AVS_LIST_CLEAR(&instances);
+            return -1;
+        }
+        (*object_ptr)->oid = oid;
+    }
+    AVS_LIST_CLEAR(&(*object_ptr)->instances);
+    (*object_ptr)->instances = instances;
+    ++cache->generation;
+    return 0;
+}
+
+void _anjay_register_dm_cache_refresh(anjay_t *anjay,
+                                      anjay_notify_queue_t queue) {
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    if (!cache->valid) {
+        // will be rebuilt from scratch anyway
+        return;
+    }
+    AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, queue) {
+        if (it->instance_set_changes.instance_set_changed
+                && refresh_dm_cache_object(anjay, it->oid)) {
+            anjay_log(WARNING, "could not refresh registration data model "
+                      "cache for /%u, it will be rebuilt", it->oid);
+            cache->valid = false;
+            return;
+        }
+    }
+}
+
+void _anjay_register_dm_cache_cleanup(anjay_t *anjay) {
+    clear_dm_cache(&anjay->registration_dm_cache.objects);
+    anjay->registration_dm_cache.valid = false;
+    free(anjay->registration_dm_cache.payload);
+    anjay->registration_dm_cache.payload = NULL;
+    anjay->registration_dm_cache.payload_size = 0;
+}
+
 static avs_time_monotonic_t get_registration_expire_time(int64_t lifetime_s) {
     return avs_time_monotonic_add(avs_time_monotonic_now(),
                                   avs_time_duration_from_scalar(lifetime_s,
                                                                 AVS_TIME_S));
 }
 
-static void cleanup_update_parameters(anjay_update_parameters_t *params) {
-    clear_dm_cache(&params->dm);
-}
-
 static int init_update_parameters(anjay_t *anjay,
-                                  anjay_update_parameters_t *out_params) {
-    if (query_dm(anjay, &out_params->dm)) {
-        goto error;
+                                  anjay_update_parameters_t *out_params,
+                                  bool full_dm_query) {
+    if (!full_dm_query) {
+        // apply instance set changes that have not been flushed yet
+        _anjay_register_dm_cache_refresh(anjay, anjay->scheduled_notify.queue);
+    }
+    if ((full_dm_query || !anjay->registration_dm_cache.valid)
+            && rebuild_dm_cache(anjay)) {
+        return -1;
     }
+    out_params->dm_generation = anjay->registration_dm_cache.generation;
     if (get_server_lifetime(anjay, _anjay_dm_current_ssid(anjay),
                             &out_params->lifetime_s)) {
-        goto error;
+        return -1;
     }
     out_params->binding_mode = _anjay_server_cached_binding_mode(
             anjay->current_connection.server);
     if (out_params->binding_mode == ANJAY_BINDING_NONE) {
-        goto error;
+        return -1;
     }
     return 0;
-error:
-    cleanup_update_parameters(out_params);
-    return -1;
 }
 
 static void
 update_registration_info(anjay_registration_info_t *info,
-                         anjay_update_parameters_t *move_params) {
-    clear_dm_cache(&info->last_update_params.dm);
-    info->last_update_params.dm = move_params->dm;
-    move_params->dm = NULL;
-
-    assert(move_params->lifetime_s >= 0);
-    info->last_update_params.lifetime_s = move_params->lifetime_s;
-    info->last_update_params.binding_mode = move_params->binding_mode;
+                         const anjay_update_parameters_t *params) {
+    assert(params->lifetime_s >= 0);
+    info->last_update_params = *params;
 
     info->expire_time =
             get_registration_expire_time(info->last_update_params.lifetime_s);
@@ -350,74 +506,101 @@ update_registration_info(anjay_registration_info_t *info,
 static void
 registration_info_init(anjay_registration_info_t *info,
                        AVS_LIST(const anjay_string_t) *move_endpoint_path,
-                       anjay_update_parameters_t *move_params) {
-    update_registration_info(info, move_params);
+                       const anjay_update_parameters_t *params) {
+    update_registration_info(info, params);
 
     info->endpoint_path = *move_endpoint_path;
     *move_endpoint_path = NULL;
 }
 
+void _anjay_update_exchange_cleanup(anjay_update_exchange_t *exchange) {
+    free(exchange->request);
+    exchange->request = NULL;
+    exchange->retry_state = (avs_coap_retry_state_t) {
+        .retry_count = 0,
+        .recv_timeout = AVS_TIME_DURATION_ZERO
+    };
+    exchange->separate_ack_received = false;
+}
+
 void _anjay_registration_info_cleanup(anjay_registration_info_t *info) {
     AVS_LIST_CLEAR(&info->endpoint_path);
-    cleanup_update_parameters(&info->last_update_params);
+    _anjay_update_exchange_cleanup(&info->update_exchange);
+}
+
+static int send_exchange_request(anjay_t *anjay,
+                                 anjay_update_exchange_t *exchange) {
+    avs_coap_tx_params_t tx_params =
+            avs_coap_ctx_get_tx_params(anjay->coap_ctx);
+    avs_coap_update_retry_state(&exchange->retry_state, &tx_params,
+                                &exchange->rand_seed);
+    return avs_coap_ctx_send(anjay->coap_ctx,
+                             avs_stream_net_getsock(anjay->comm_stream),
+                             exchange->request);
+}
+
+static void finish_registration(anjay_registration_info_t *info,
+                                AVS_LIST(const anjay_string_t) *endpoint_path,
+                                const anjay_update_parameters_t *params) {
+    _anjay_registration_info_cleanup(info);
+    registration_info_init(info, endpoint_path, params);
 }
 
 int _anjay_register(anjay_t *anjay) {
+    anjay_registration_info_t *info =
+            &anjay->current_connection.server->registration_info;
+    _anjay_update_exchange_cleanup(&info->update_exchange);
+    // the previous registration, if any, is not to be relied upon from now on
+    info->expire_time = avs_time_monotonic_from_scalar(0, AVS_TIME_S);
+
+    // Register is a good opportunity to resynchronize the data model cache
+    // with any changes that the user has not reported
     anjay_update_parameters_t new_params;
-    if (init_update_parameters(anjay, &new_params)) {
+    if (init_update_parameters(anjay, &new_params, true)) {
         return -1;
     }
 
-    AVS_LIST(const anjay_string_t) endpoint_path = NULL;
-    int result = -1;
-
-    if (send_register(anjay, &new_params)
-            || check_register_response(anjay->comm_stream, &endpoint_path)) {
-        anjay_log(ERROR, "could not register to server %u",
-                  _anjay_dm_current_ssid(anjay));
-        goto fail;
-    }
-
-    _anjay_registration_info_cleanup(
-            &anjay->current_connection.server->registration_info);
-    registration_info_init(
-            &anjay->current_connection.server->registration_info,
-            &endpoint_path, &new_params);
-    result = 0;
-
-fail:
-    cleanup_update_parameters(&new_params);
-    AVS_LIST_CLEAR(&endpoint_path);
-    return result;
-}
-
-static bool iid_lists_equal(AVS_LIST(anjay_iid_t) left,
-                            AVS_LIST(anjay_iid_t) right) {
-    while (left && right) {
-        if (*left != *right) {
-            return false;
+    int retval = setup_register(anjay, &new_params);
+    if (!retval) {
+        retval = _anjay_coap_stream_take_request(
+                anjay->comm_stream, &info->update_exchange.request);
+    }
+
+    if (retval == ANJAY_COAP_STREAM_REQUEST_BLOCKWISE) {
+        // part of the request has already been sent block-wise, so it needs
+        // to be completed in the usual, blocking way
+        AVS_LIST(const anjay_string_t) endpoint_path = NULL;
+        if ((retval = avs_stream_finish_message(anjay->comm_stream))
+                || (retval = check_register_response(anjay->comm_stream,
+                                                     &endpoint_path))) {
+            anjay_log(ERROR, "could not register to server %u",
+                      _anjay_dm_current_ssid(anjay));
+            AVS_LIST_CLEAR(&endpoint_path);
+            return retval;
         }
-        left = AVS_LIST_NEXT(left);
-        right = AVS_LIST_NEXT(right);
+        finish_registration(info, &endpoint_path, &new_params);
+    } else if (!retval) {
+        info->update_exchange.type = ANJAY_REGISTRATION_EXCHANGE_REGISTER;
+        info->update_exchange.params = new_params;
+        if ((retval = send_exchange_request(anjay, &info->update_exchange))) {
+            anjay_log(ERROR, "could not send Register message");
+            _anjay_update_exchange_cleanup(&info->update_exchange);
+            return retval;
+        }
+        anjay_log(INFO, "Register sent");
+        retval = ANJAY_REGISTRATION_UPDATE_IN_PROGRESS;
     }
-    return !(left || right);
+    return retval;
 }
 
-static bool dm_caches_equal(AVS_LIST(anjay_dm_cache_object_t) left,
-                            AVS_LIST(anjay_dm_cache_object_t) right) {
-    while (left && right) {
-        if (left->oid != right->oid
-                || !iid_lists_equal(left->instances, right->instances)) {
-            return false;
-        }
-        left = AVS_LIST_NEXT(left);
-        right = AVS_LIST_NEXT(right);
-    }
-    return !(left || right);
+bool _anjay_register_in_progress(const anjay_registration_info_t *info) {
+    return info->update_exchange.request
+            && info->update_exchange.type
+                       == ANJAY_REGISTRATION_EXCHANGE_REGISTER;
 }
 
-static int send_update(anjay_t *anjay,
-                       const anjay_update_parameters_t *new_params) {
+static int setup_update(anjay_t *anjay,
+                        const anjay_update_parameters_t *new_params) {
     const anjay_active_server_info_t *server = anjay->current_connection.server;
     const anjay_update_parameters_t *old_params =
             &server->registration_info.last_update_params;
@@ -432,7 +615,7 @@ static int send_update(anjay_t *anjay,
                     ? ANJAY_BINDING_NONE : new_params->binding_mode;
 
     bool dm_changed_since_last_update =
-            !dm_caches_equal(old_params->dm, new_params->dm);
+            (old_params->dm_generation != new_params->dm_generation);
     anjay_msg_details_t details = {
         .msg_type = AVS_COAP_MSG_CONFIRMABLE,
         .msg_code = AVS_COAP_CODE_POST,
@@ -448,13 +631,8 @@ static int send_update(anjay_t *anjay,
     if ((result = _anjay_coap_stream_setup_request(anjay->comm_stream, &details,
                                                    NULL))
             || (dm_changed_since_last_update
-                && (result = send_objects_list(anjay->comm_stream,
-                                               new_params->dm)))
-            || (result = avs_stream_finish_message(anjay->comm_stream))) {
-        anjay_log(ERROR, "could not send Update message");
-    } else {
-        anjay_log(INFO, "Update sent");
-        result = 0;
+                && (result = send_objects_list(anjay)))) {
+        anjay_log(ERROR, "could not prepare Update message");
     }
 
     // request_uri must not be cleared here
@@ -462,14 +640,7 @@ static int send_update(anjay_t *anjay,
     return result;
 }
 
-static int check_update_response(avs_stream_abstract_t *stream) {
-    const avs_coap_msg_t *response;
-    if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
-        anjay_log(ERROR, "could not get response");
-        return -1;
-    }
-
-    const uint8_t code = avs_coap_msg_get_code(response);
+static int handle_update_response_code(uint8_t code) {
     if (code == AVS_COAP_CODE_CHANGED) {
         anjay_log(INFO, "registration successfully updated");
         return 0;
@@ -501,28 +672,163 @@ static int check_update_response(avs_stream_abstract_t *stream) {
     }
 }
 
+static int check_update_response(avs_stream_abstract_t *stream) {
+    const avs_coap_msg_t *response;
+    if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
+        anjay_log(ERROR, "could not get response");
+        return -1;
+    }
+
+    return handle_update_response_code(avs_coap_msg_get_code(response));
+}
+
 int _anjay_update_registration(anjay_t *anjay) {
+    anjay_registration_info_t *info =
+            &anjay->current_connection.server->registration_info;
+    _anjay_update_exchange_cleanup(&info->update_exchange);
+
     anjay_update_parameters_t new_params;
-    if (init_update_parameters(anjay, &new_params)) {
+    if (init_update_parameters(anjay, &new_params, false)) {
         return -1;
     }
 
-    int retval = -1;
-    if ((retval = send_update(anjay, &new_params))
-            || (retval = check_update_response(anjay->comm_stream))) {
-        anjay_log(ERROR, "could not update registration");
-        goto finish;
+    int retval = setup_update(anjay, &new_params);
+    if (!retval) {
+        retval = _anjay_coap_stream_take_request(
+                anjay->comm_stream, &info->update_exchange.request);
     }
 
-    update_registration_info(
-            &anjay->current_connection.server->registration_info, &new_params);
-    retval = 0;
-
-finish:
-    cleanup_update_parameters(&new_params);
+    if (retval == ANJAY_COAP_STREAM_REQUEST_BLOCKWISE) {
+        // part of the request has already been sent block-wise, so it needs
+        // to be completed in the usual, blocking way
+        if ((retval = avs_stream_finish_message(anjay->comm_stream))
+                || (retval = check_update_response(anjay->comm_stream))) {
+            anjay_log(ERROR, "could not update registration");
+            return retval;
+        }
+        update_registration_info(info, &new_params);
+    } else if (!retval) {
+        info->update_exchange.type = ANJAY_REGISTRATION_EXCHANGE_UPDATE;
+        info->update_exchange.params = new_params;
+        if ((retval = send_exchange_request(anjay, &info->update_exchange))) {
+            anjay_log(ERROR, "could not send Update message");
+            _anjay_update_exchange_cleanup(&info->update_exchange);
+            return retval;
+        }
+        anjay_log(INFO, "Update sent");
+        retval = ANJAY_REGISTRATION_UPDATE_IN_PROGRESS;
+    }
     return retval;
 }
 
+static const char *exchange_name(const anjay_update_exchange_t *exchange) {
+    return exchange->type == ANJAY_REGISTRATION_EXCHANGE_REGISTER ? "Register"
+                                                                  : "Update";
+}
+
+int _anjay_update_registration_retransmit(anjay_t *anjay) {
+    anjay_update_exchange_t *exchange =
+            &anjay->current_connection.server->registration_info
+                    .update_exchange;
+    if (!exchange->request) {
+        anjay_log(ERROR, "no Register or Update message to retransmit");
+        return -1;
+    }
+
+    if (exchange->separate_ack_received
+            || exchange->retry_state.retry_count
+                    >= avs_coap_ctx_get_tx_params(anjay->coap_ctx)
+                               .max_retransmit) {
+        anjay_log(ERROR, "response to %s not received",
+                  exchange_name(exchange));
+        _anjay_update_exchange_cleanup(exchange);
+        return AVS_COAP_CTX_ERR_TIMEOUT;
+    }
+
+    anjay_log(DEBUG, "retransmitting %s", exchange_name(exchange));
+    int result = send_exchange_request(anjay, exchange);
+    if (result) {
+        anjay_log(ERROR, "could not retransmit %s message",
+                  exchange_name(exchange));
+        _anjay_update_exchange_cleanup(exchange);
+    }
+    return result;
+}
+
+static int handle_exchange_response(anjay_t *anjay,
+                                    const avs_coap_msg_t *msg) {
+    anjay_registration_info_t *info =
+            &anjay->current_connection.server->registration_info;
+    anjay_update_exchange_t *exchange = &info->update_exchange;
+    if (exchange->type == ANJAY_REGISTRATION_EXCHANGE_UPDATE) {
+        int result = handle_update_response_code(avs_coap_msg_get_code(msg));
+        if (!result) {
+            update_registration_info(info, &exchange->params);
+        }
+        return result;
+    }
+
+    AVS_LIST(const anjay_string_t) endpoint_path = NULL;
+    if (handle_register_response(msg, &endpoint_path)) {
+        anjay_log(ERROR, "could not register to server %u",
+                  _anjay_dm_current_ssid(anjay));
+        return -1;
+    }
+    // finish_registration() cleans up the exchange, including params
+    const anjay_update_parameters_t params = exchange->params;
+    finish_registration(info, &endpoint_path, &params);
+    return 0;
+}
+
+int _anjay_update_registration_handle_response(anjay_t *anjay,
+                                               const avs_coap_msg_t *msg) {
+    anjay_registration_info_t *info =
+            &anjay->current_connection.server->registration_info;
+    anjay_update_exchange_t *exchange = &info->update_exchange;
+    if (!exchange->request) {
+        return ANJAY_REGISTRATION_UPDATE_UNRELATED;
+    }
+
+    const avs_coap_msg_identity_t request_id =
+            avs_coap_msg_get_identity(exchange->request);
+    const bool msg_id_matches =
+            avs_coap_msg_get_id(msg) == request_id.msg_id;
+    const avs_coap_msg_type_t type = avs_coap_msg_get_type(msg);
+    const uint8_t code = avs_coap_msg_get_code(msg);
+
+    if (type == AVS_COAP_MSG_RESET
+            || (type == AVS_COAP_MSG_ACKNOWLEDGEMENT
+                && code == AVS_COAP_CODE_EMPTY)) {
+        if (!msg_id_matches) {
+            return ANJAY_REGISTRATION_UPDATE_UNRELATED;
+        } else if (type == AVS_COAP_MSG_RESET) {
+            anjay_log(ERROR, "%s rejected with Reset", exchange_name(exchange));
+            _anjay_update_exchange_cleanup(exchange);
+            return -1;
+        }
+        anjay_log(DEBUG, "Separate Response: ACK");
+        exchange->separate_ack_received = true;
+        return ANJAY_REGISTRATION_UPDATE_IN_PROGRESS;
+    }
+
+    if (!avs_coap_msg_token_matches(msg, &request_id)
+            || (type == AVS_COAP_MSG_ACKNOWLEDGEMENT && !msg_id_matches)) {
+        return ANJAY_REGISTRATION_UPDATE_UNRELATED;
+    }
+
+    if (type == AVS_COAP_MSG_CONFIRMABLE) {
+        anjay_log(TRACE, "Separate Response received; sending ACK");
+        avs_coap_ctx_send_empty(anjay->coap_ctx,
+                                avs_stream_net_getsock(anjay->comm_stream),
+                                AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                                avs_coap_msg_get_id(msg));
+    }
+
+    int result = handle_exchange_response(anjay, msg);
+    _anjay_update_exchange_cleanup(exchange);
+    return result;
+}
+
 static int check_deregister_response(avs_stream_abstract_t *stream) {
     const avs_coap_msg_t *response;
     if (_anjay_coap_stream_get_incoming_msg(stream, &response)) {
@@ -565,3 +871,7 @@ avs_time_duration_t
 _anjay_register_time_remaining(const anjay_registration_info_t *info) {
     return avs_time_monotonic_diff(info->expire_time, avs_time_monotonic_now());
 }
+
+#ifdef ANJAY_TEST
+#include "test/register.c"
+#endif // ANJAY_TEST
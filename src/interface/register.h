@@ -23,19 +23,95 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 void _anjay_registration_info_cleanup(anjay_registration_info_t *info);
 
+/**
+ * Sends a Register message to the server the comm stream is bound to. Unless
+ * the message needs to be sent block-wise, the response is not waited for -
+ * it is handled the same way as for @ref _anjay_update_registration .
+ *
+ * @returns:
+ * - 0 if the registration succeeded (block-wise case only),
+ * - a negative value on error,
+ * - ANJAY_REGISTRATION_UPDATE_IN_PROGRESS if the Register was sent and its
+ *   response is yet to be received.
+ */
 int _anjay_register(anjay_t *anjay);
 
+/**
+ * @returns Whether a Register message has been sent and its response is yet to
+ * be received.
+ */
+bool _anjay_register_in_progress(const anjay_registration_info_t *info);
+
+/**
+ * Updates the data model snapshot used for Register and Update messages, by
+ * re-enumerating instances of all Objects that have
+ * <c>instance_set_changed</c> set in @p queue .
+ */
+void _anjay_register_dm_cache_refresh(anjay_t *anjay,
+                                      anjay_notify_queue_t queue);
+
+void _anjay_register_dm_cache_cleanup(anjay_t *anjay);
+
 #define ANJAY_REGISTRATION_UPDATE_REJECTED 1
+#define ANJAY_REGISTRATION_UPDATE_IN_PROGRESS 2
+#define ANJAY_REGISTRATION_UPDATE_UNRELATED 3
 
 /**
+ * Sends an Update message to the server the comm stream is bound to. Unless
+ * the message needs to be sent block-wise, the response is not waited for -
+ * it shall be passed to @ref _anjay_update_registration_handle_response once
+ * received, and @ref _anjay_update_registration_retransmit shall be called
+ * after <c>update_exchange.retry_state.recv_timeout</c> elapses without it.
+ *
  * @returns:
  * - 0 on success,
  * - a negative value on error,
  * - ANJAY_REGISTRATION_UPDATE_REJECTED if the server responded with 4.xx error
- *   so the Update message should not be retransmitted.
+ *   so the Update message should not be retransmitted,
+ * - ANJAY_REGISTRATION_UPDATE_IN_PROGRESS if the Update was sent and its
+ *   response is yet to be received.
  */
 int _anjay_update_registration(anjay_t *anjay);
 
+/**
+ * Retransmits the Register or Update message in progress on the connection the
+ * comm stream is bound to.
+ *
+ * @returns:
+ * - 0 on success,
+ * - AVS_COAP_CTX_ERR_TIMEOUT if the response did not arrive in time and the
+ *   exchange has been abandoned,
+ * - a negative value on error.
+ */
+int _anjay_update_registration_retransmit(anjay_t *anjay);
+
+/**
+ * Matches @p msg against the Register or Update message in progress on the
+ * connection the comm stream is bound to.
+ *
+ * @returns:
+ * - 0 if @p msg is a successful response,
+ * - ANJAY_REGISTRATION_UPDATE_REJECTED if the server responded to an Update
+ *   with 4.xx error,
+ * - ANJAY_REGISTRATION_UPDATE_IN_PROGRESS if @p msg is an empty ACK, i.e. the
+ *   actual response will be sent separately,
+ * - ANJAY_REGISTRATION_UPDATE_UNRELATED if @p msg is not related to the Update
+ *   message in progress,
+ * - a negative value if the Update failed in any other way.
+ */
+int _anjay_update_registration_handle_response(anjay_t *anjay,
+                                               const avs_coap_msg_t *msg);
+
+/**
+ * Abandons the Register or Update exchange in progress, if any.
+ */
+void _anjay_update_exchange_cleanup(anjay_update_exchange_t *exchange);
+
+/**
+ * Sends a De-register message and waits for the response. Unlike Register and
+ * Update, it is performed synchronously: the server entry is destroyed right
+ * afterwards, so there would be nothing to match a late response against.
+ */
 int _anjay_deregister(anjay_t *anjay);
 
 /**
@@ -709,12 +709,12 @@ AVS_UNIT_TEST(bootstrap_reconnect, reconnect) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
     // mocking reconnect is rather hard, so let's just check it's scheduled
-    AVS_UNIT_ASSERT_TRUE(anjay->sched->entries
+    AVS_UNIT_ASSERT_TRUE(_anjay_sched_first_entry(anjay->sched)
             == anjay->servers.active->sched_update_handle);
     // encoded update args:
     // - SSID==65535 (0xFFFF; fake-SSID for Bootstrap Server)
     // - reconnect required == true (hence the 1 at the higher-order byte)
-    AVS_UNIT_ASSERT_EQUAL((uintptr_t) anjay->sched->entries->clb_data, 0x1FFFF);
+    AVS_UNIT_ASSERT_EQUAL((uintptr_t) _anjay_sched_first_entry(anjay->sched)->clb_data, 0x1FFFF);
     _anjay_sched_del(anjay->sched, &anjay->servers.active->sched_update_handle);
 
     int sched_job_delay_ms;
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/dm.h>
+
+static void expect_instances(anjay_t *anjay,
+                             const anjay_dm_object_def_t *const *obj,
+                             const anjay_iid_t *iids,
+                             size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        _anjay_mock_dm_expect_instance_it(anjay, obj, i, 0, iids[i]);
+    }
+    _anjay_mock_dm_expect_instance_it(anjay, obj, count, 0, ANJAY_IID_INVALID);
+}
+
+#define EXPECT_INSTANCES(Obj, ...) \
+    do { \
+        const anjay_iid_t iids[] = { __VA_ARGS__ }; \
+        expect_instances(anjay, (Obj), iids, AVS_ARRAY_SIZE(iids)); \
+    } while (0)
+
+static void refresh_dm_cache(anjay_t *anjay,
+                             anjay_notify_queue_t *queue) {
+    _anjay_register_dm_cache_refresh(anjay, *queue);
+    _anjay_notify_clear_queue(queue);
+}
+
+/**
+ * Performs the initial query of the data model, as done when registering, and
+ * marks the result as presented to the server.
+ */
+static uint64_t init_dm_cache(anjay_t *anjay) {
+    EXPECT_INSTANCES(&FAKE_SERVER, 14);
+    EXPECT_INSTANCES(&OBJ, 3);
+    AVS_UNIT_ASSERT_SUCCESS(rebuild_dm_cache(anjay));
+    AVS_UNIT_ASSERT_TRUE(anjay->registration_dm_cache.valid);
+    anjay->servers.active->registration_info.last_update_params.dm_generation =
+            anjay->registration_dm_cache.generation;
+    return anjay->registration_dm_cache.generation;
+}
+
+static bool update_needs_objects_list(anjay_t *anjay) {
+    // see setup_update() and registration_succeeded()
+    return anjay->servers.active->registration_info
+                   .last_update_params.dm_generation
+           != anjay->registration_dm_cache.generation;
+}
+
+AVS_UNIT_TEST(register_dm_cache, instance_changes_bump_generation) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &FAKE_SERVER);
+    uint64_t generation = init_dm_cache(anjay);
+    AVS_UNIT_ASSERT_FALSE(update_needs_objects_list(anjay));
+
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 7));
+    EXPECT_INSTANCES(&OBJ, 3, 7);
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_TRUE(anjay->registration_dm_cache.valid);
+    AVS_UNIT_ASSERT_EQUAL(anjay->registration_dm_cache.generation,
+                          generation + 1);
+    AVS_UNIT_ASSERT_TRUE(update_needs_objects_list(anjay));
+    anjay->servers.active->registration_info.last_update_params.dm_generation =
+            anjay->registration_dm_cache.generation;
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 3));
+    EXPECT_INSTANCES(&OBJ, 7);
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_EQUAL(anjay->registration_dm_cache.generation,
+                          generation + 2);
+    AVS_UNIT_ASSERT_TRUE(update_needs_objects_list(anjay));
+
+    AVS_LIST(anjay_dm_cache_object_t) object =
+            AVS_LIST_NEXT(anjay->registration_dm_cache.objects);
+    AVS_UNIT_ASSERT_NOT_NULL(object);
+    AVS_UNIT_ASSERT_EQUAL(object->oid, 42);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(object->instances), 1);
+    AVS_UNIT_ASSERT_EQUAL(*object->instances, 7);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(register_dm_cache, unchanged_dm_keeps_generation) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &FAKE_SERVER);
+    uint64_t generation = init_dm_cache(anjay);
+
+    // resource changes do not require querying the data model at all
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 3,
+                                                                1));
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_EQUAL(anjay->registration_dm_cache.generation, generation);
+
+    // instance set reported as changed, but actually the same
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_set_unknown_change(&queue, 42));
+    EXPECT_INSTANCES(&OBJ, 3);
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_EQUAL(anjay->registration_dm_cache.generation, generation);
+
+    // full query of an unchanged data model
+    EXPECT_INSTANCES(&FAKE_SERVER, 14);
+    EXPECT_INSTANCES(&OBJ, 3);
+    AVS_UNIT_ASSERT_SUCCESS(rebuild_dm_cache(anjay));
+    AVS_UNIT_ASSERT_EQUAL(anjay->registration_dm_cache.generation, generation);
+
+    AVS_UNIT_ASSERT_TRUE(anjay->registration_dm_cache.valid);
+    AVS_UNIT_ASSERT_FALSE(update_needs_objects_list(anjay));
+
+    DM_TEST_FINISH;
+}
+
+#define ASSERT_DM_CACHE_PAYLOAD(Anjay, Expected) \
+    do { \
+        AVS_UNIT_ASSERT_EQUAL((Anjay)->registration_dm_cache.payload_size, \
+                              sizeof(Expected) - 1); \
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED( \
+                (Anjay)->registration_dm_cache.payload, (Expected), \
+                sizeof(Expected) - 1); \
+    } while (0)
+
+AVS_UNIT_TEST(register_dm_cache, payload_reused_if_unchanged) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &FAKE_SERVER);
+    init_dm_cache(anjay);
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    ASSERT_DM_CACHE_PAYLOAD(anjay, "</1/14>,</42/3>");
+    const char *payload = cache->payload;
+
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    AVS_UNIT_ASSERT_TRUE(cache->payload == payload);
+
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_set_unknown_change(&queue, 42));
+    EXPECT_INSTANCES(&OBJ, 3);
+    refresh_dm_cache(anjay, &queue);
+    EXPECT_INSTANCES(&FAKE_SERVER, 14);
+    EXPECT_INSTANCES(&OBJ, 3);
+    AVS_UNIT_ASSERT_SUCCESS(rebuild_dm_cache(anjay));
+
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    AVS_UNIT_ASSERT_TRUE(cache->payload == payload);
+    ASSERT_DM_CACHE_PAYLOAD(anjay, "</1/14>,</42/3>");
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(register_dm_cache, payload_rebuilt_after_change) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &FAKE_SERVER);
+    init_dm_cache(anjay);
+    anjay_registration_dm_cache_t *cache = &anjay->registration_dm_cache;
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    ASSERT_DM_CACHE_PAYLOAD(anjay, "</1/14>,</42/3>");
+
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 7));
+    EXPECT_INSTANCES(&OBJ, 3, 7);
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    AVS_UNIT_ASSERT_EQUAL(cache->payload_generation, cache->generation);
+    ASSERT_DM_CACHE_PAYLOAD(anjay, "</1/14>,</42/3>,</42/7>");
+
+    // objects without instances are listed on their own
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 7));
+    _anjay_mock_dm_expect_instance_it(anjay, &OBJ, 0, 0, ANJAY_IID_INVALID);
+    refresh_dm_cache(anjay, &queue);
+    AVS_UNIT_ASSERT_SUCCESS(update_dm_cache_payload(cache));
+    ASSERT_DM_CACHE_PAYLOAD(anjay, "</1/14>,</42>");
+
+    DM_TEST_FINISH;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include "base64_codec.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static const char ENCODE_TABLE[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define XX 0xFF
+
+// Maps characters to their 6-bit values. Every character outside of the
+// alphabet (including the padding character) maps to a value with the most
+// significant bit set, so that validity of any number of characters can be
+// checked by OR-ing their values together.
+static const uint8_t DECODE_TABLE[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, XX, XX, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, XX, XX, XX,
+    XX,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, XX,
+    XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+};
+
+#undef XX
+
+static inline void encode_quantum(char *out, uint32_t value) {
+    out[0] = ENCODE_TABLE[(value >> 18) & 0x3F];
+    out[1] = ENCODE_TABLE[(value >> 12) & 0x3F];
+    out[2] = ENCODE_TABLE[(value >> 6) & 0x3F];
+    out[3] = ENCODE_TABLE[value & 0x3F];
+}
+
+size_t _anjay_base64_encode_block(char *out,
+                                  const uint8_t *in,
+                                  size_t in_size) {
+    char *dst = out;
+    const uint8_t *end = in + (in_size - in_size % 3);
+    for (; in < end; in += 3, dst += 4) {
+        encode_quantum(dst, (uint32_t) in[0] << 16
+                                | (uint32_t) in[1] << 8
+                                | (uint32_t) in[2]);
+    }
+    switch (in_size % 3) {
+    case 1:
+        encode_quantum(dst, (uint32_t) in[0] << 16);
+        dst[2] = '=';
+        dst[3] = '=';
+        dst += 4;
+        break;
+    case 2:
+        encode_quantum(dst, (uint32_t) in[0] << 16 | (uint32_t) in[1] << 8);
+        dst[3] = '=';
+        dst += 4;
+        break;
+    default:
+        break;
+    }
+    return (size_t) (dst - out);
+}
+
+ssize_t _anjay_base64_decode_block(uint8_t *out,
+                                   const char *in,
+                                   size_t in_size) {
+    if (in_size % 4) {
+        return -1;
+    }
+    if (!in_size) {
+        return 0;
+    }
+    const uint8_t *src = (const uint8_t *) in;
+    const uint8_t *last = src + in_size - 4;
+    uint8_t *dst = out;
+    uint8_t invalid = 0;
+
+    // Validity is only checked once, after the whole block is decoded, so that
+    // the main loop does not branch on the data. Garbage written to the output
+    // for invalid input is never reported back to the caller.
+    for (; src < last; src += 4, dst += 3) {
+        uint8_t a = DECODE_TABLE[src[0]];
+        uint8_t b = DECODE_TABLE[src[1]];
+        uint8_t c = DECODE_TABLE[src[2]];
+        uint8_t d = DECODE_TABLE[src[3]];
+        invalid |= (uint8_t) (a | b | c | d);
+        uint32_t value = (uint32_t) a << 18 | (uint32_t) b << 12
+                | (uint32_t) c << 6 | (uint32_t) d;
+        dst[0] = (uint8_t) (value >> 16);
+        dst[1] = (uint8_t) (value >> 8);
+        dst[2] = (uint8_t) value;
+    }
+
+    size_t tail_size = 3;
+    if (src[3] == '=') {
+        tail_size = (src[2] == '=') ? 1 : 2;
+    }
+    uint8_t a = DECODE_TABLE[src[0]];
+    uint8_t b = DECODE_TABLE[src[1]];
+    uint8_t c = (tail_size > 1) ? DECODE_TABLE[src[2]] : 0;
+    uint8_t d = (tail_size > 2) ? DECODE_TABLE[src[3]] : 0;
+    invalid |= (uint8_t) (a | b | c | d);
+    if (invalid & 0x80) {
+        return -1;
+    }
+    uint32_t value = (uint32_t) a << 18 | (uint32_t) b << 12
+            | (uint32_t) c << 6 | (uint32_t) d;
+    dst[0] = (uint8_t) (value >> 16);
+    if (tail_size > 1) {
+        dst[1] = (uint8_t) (value >> 8);
+    }
+    if (tail_size > 2) {
+        dst[2] = (uint8_t) value;
+    }
+    return (ssize_t) ((size_t) (dst - out) + tail_size);
+}
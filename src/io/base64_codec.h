@@ -0,0 +1,70 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_IO_BASE64_CODEC_H
+#define ANJAY_IO_BASE64_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/defs.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Number of characters produced by @ref _anjay_base64_encode_block for
+ * @p Bytes bytes of input. Does not include any terminating nullbyte.
+ */
+#define _ANJAY_BASE64_ENCODED_SIZE(Bytes) (4 * (((Bytes) + 2) / 3))
+
+/**
+ * Encodes @p in_size bytes of @p in as padded base64.
+ *
+ * Unlike avs_base64_encode(), the output is not nullbyte-terminated, which
+ * allows encoding consecutive chunks into a single buffer.
+ *
+ * @param out     Output buffer, at least
+ *                _ANJAY_BASE64_ENCODED_SIZE(in_size) characters long.
+ * @param in      Data to encode.
+ * @param in_size Number of bytes in @p in.
+ *
+ * @returns Number of characters written to @p out.
+ */
+size_t _anjay_base64_encode_block(char *out,
+                                  const uint8_t *in,
+                                  size_t in_size);
+
+/**
+ * Decodes @p in_size characters of strict base64 from @p in.
+ *
+ * The input does not need to be nullbyte-terminated. Its size must be a
+ * multiple of 4, no whitespace is allowed and padding characters may only
+ * appear in the last quartet.
+ *
+ * @param out     Output buffer, at least 3 * (in_size / 4) bytes long.
+ * @param in      Characters to decode.
+ * @param in_size Number of characters in @p in.
+ *
+ * @returns Number of bytes written to @p out, or a negative value if the input
+ *          is not valid base64.
+ */
+ssize_t _anjay_base64_decode_block(uint8_t *out,
+                                   const char *in,
+                                   size_t in_size);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_IO_BASE64_CODEC_H */
@@ -16,11 +16,11 @@
 
 #include <config.h>
 #include <avsystem/commons/stream.h>
-#include <avsystem/commons/base64.h>
 
 #include <anjay/core.h>
 
 #include "../utils_core.h"
+#include "base64_codec.h"
 #include "base64_out.h"
 #include "vtable.h"
 
@@ -37,43 +37,41 @@ typedef struct base64_ret_bytes_ctx {
 #define TEXT_CHUNK_SIZE 3 * 64u
 AVS_STATIC_ASSERT(TEXT_CHUNK_SIZE % 3 == 0, chunk_must_be_a_multiple_of_3);
 
-static int base64_ret_encode_and_write(base64_ret_bytes_ctx_t *ctx,
-                                       const uint8_t *buffer,
-                                       const size_t buffer_size) {
-    if (!buffer_size) {
-        return 0;
-    }
-    size_t encoded_size = avs_base64_encoded_size(buffer_size);
-    assert(encoded_size <= 4 * (TEXT_CHUNK_SIZE / 3) + 1);
-    char encoded[encoded_size];
-    int retval = avs_base64_encode(encoded, sizeof(encoded), buffer, buffer_size);
-    if (retval) {
-        return retval;
-    }
-    return avs_stream_write(ctx->stream, encoded, sizeof(encoded) - 1);
-}
-
 static int base64_ret_bytes_flush(base64_ret_bytes_ctx_t *ctx,
                                   const uint8_t **dataptr,
                                   size_t bytes_to_write) {
-    uint8_t chunk[TEXT_CHUNK_SIZE];
-    while (bytes_to_write > 0) {
-        memcpy(chunk, ctx->bytes_cached, ctx->num_bytes_cached);
-        size_t new_bytes_written =
-                AVS_MIN(TEXT_CHUNK_SIZE - ctx->num_bytes_cached,
-                          bytes_to_write);
-        assert(new_bytes_written <= TEXT_CHUNK_SIZE);
-        memcpy(&chunk[ctx->num_bytes_cached], *dataptr, new_bytes_written);
-        *dataptr += new_bytes_written;
+    char encoded[_ANJAY_BASE64_ENCODED_SIZE(TEXT_CHUNK_SIZE)];
+    size_t encoded_size = 0;
+    if (ctx->num_bytes_cached && bytes_to_write) {
+        // complete the quantum started by the previous append
+        uint8_t quantum[3];
+        size_t missing = sizeof(quantum) - ctx->num_bytes_cached;
+        assert(bytes_to_write >= missing);
+        memcpy(quantum, ctx->bytes_cached, ctx->num_bytes_cached);
+        memcpy(&quantum[ctx->num_bytes_cached], *dataptr, missing);
+        encoded_size = _anjay_base64_encode_block(encoded, quantum,
+                                                  sizeof(quantum));
+        *dataptr += missing;
+        bytes_to_write -= missing;
+        ctx->num_bytes_left -= missing;
+        ctx->num_bytes_cached = 0;
+    }
+    while (encoded_size > 0 || bytes_to_write > 0) {
+        // the rest is encoded directly from the caller's buffer
+        size_t chunk_size = AVS_MIN(bytes_to_write,
+                                    (sizeof(encoded) - encoded_size) / 4 * 3);
+        assert(chunk_size % 3 == 0 || chunk_size == bytes_to_write);
+        encoded_size += _anjay_base64_encode_block(&encoded[encoded_size],
+                                                   *dataptr, chunk_size);
+        *dataptr += chunk_size;
+        bytes_to_write -= chunk_size;
+        ctx->num_bytes_left -= chunk_size;
 
-        int retval;
-        if ((retval = base64_ret_encode_and_write(
-                     ctx, chunk, new_bytes_written + ctx->num_bytes_cached))) {
+        int retval = avs_stream_write(ctx->stream, encoded, encoded_size);
+        if (retval) {
             return retval;
         }
-        bytes_to_write -= new_bytes_written;
-        ctx->num_bytes_left -= new_bytes_written;
-        ctx->num_bytes_cached = 0;
+        encoded_size = 0;
     }
     return 0;
 }
@@ -130,8 +128,14 @@ int _anjay_base64_ret_bytes_ctx_close(anjay_ret_bytes_ctx_t *ctx_) {
         /* Some bytes were not written as we have expected */
         return -1;
     }
-    return base64_ret_encode_and_write(ctx, ctx->bytes_cached,
+    if (!ctx->num_bytes_cached) {
+        return 0;
+    }
+    char encoded[_ANJAY_BASE64_ENCODED_SIZE(sizeof(ctx->bytes_cached))];
+    size_t encoded_size =
+            _anjay_base64_encode_block(encoded, ctx->bytes_cached,
                                        ctx->num_bytes_cached);
+    return avs_stream_write(ctx->stream, encoded, encoded_size);
 }
 
 void
@@ -24,12 +24,12 @@
 #include <avsystem/commons/list.h>
 #include <avsystem/commons/log.h>
 #include <avsystem/commons/stream.h>
-#include <avsystem/commons/utils.h>
 
 #include "../coap/content_format.h"
 
 #include "../io_core.h"
 #include "base64_out.h"
+#include "numbers.h"
 #include "vtable.h"
 
 #define json_log(level, ...) avs_log(json, level, __VA_ARGS__)
@@ -52,19 +52,20 @@ typedef enum {
     JSON_DATA_STRING
 } json_data_type_t;
 
-static const char *data_type_to_string(json_data_type_t type) {
+/* Returns the SenML value field name, including quotes and the colon */
+static const char *data_type_to_key(json_data_type_t type) {
     switch(type) {
     case JSON_DATA_F32:
     case JSON_DATA_F64:
     case JSON_DATA_I32:
     case JSON_DATA_I64:
-        return "v";
+        return "\"v\":";
     case JSON_DATA_BOOL:
-        return "bv";
+        return "\"bv\":";
     case JSON_DATA_OBJLNK:
-        return "ov";
+        return "\"ov\":";
     default:
-        return "sv";
+        return "\"sv\":";
     }
 }
 
@@ -85,6 +86,8 @@ typedef struct {
     anjay_riid_t riid;
 } json_out_array_t;
 
+#define JSON_OUT_BUFFER_SIZE 512
+
 typedef struct json_out_struct {
     const anjay_output_ctx_vtable_t *vtable;
     avs_stream_abstract_t *stream;
@@ -103,6 +106,15 @@ typedef struct json_out_struct {
     bool returning_array;
     anjay_ret_bytes_ctx_t *bytes;
     json_id_t next_id;
+
+    /* '{"n":"/Y/Z",' (or just '{' for the base node) starting each record
+       for the current path; empty if it needs to be regenerated */
+    char record_prefix[sizeof("{\"n\":\"/65535/65535/65535\",")];
+    size_t record_prefix_size;
+
+    /* Output is collected here and written to the stream in large chunks */
+    char buffer[JSON_OUT_BUFFER_SIZE];
+    size_t buffer_size;
 } json_out_t;
 
 static json_id_t *last_path_elem(json_out_t *ctx) {
@@ -160,152 +172,202 @@ update_node_path(json_out_t *ctx, anjay_id_type_t type, uint16_t id) {
         ctx->num_base_path_elems = ctx->num_path_elems;
         json_log(ERROR, "num_path_elems < num_base_path_elems!");
     }
+    ctx->record_prefix_size = 0;
 }
 
-#define MAX_CHILD_PATH_LEN sizeof("/65535/65535/65535")
-
 static size_t
 count_child_path_elems(json_out_t *ctx) {
     return ctx->num_path_elems - ctx->num_base_path_elems;
 }
 
-static ssize_t child_path_to_string(json_out_t *ctx, char *dest, size_t size) {
-    switch (count_child_path_elems(ctx)) {
-    case 1:
-        return avs_simple_snprintf(dest, size, "/%"PRId32,
-                                   ctx->path[ctx->num_base_path_elems].id);
-    case 2:
-        return avs_simple_snprintf(dest, size, "/%"PRId32"/%"PRId32,
-                                   ctx->path[ctx->num_base_path_elems].id,
-                                   ctx->path[ctx->num_base_path_elems + 1].id);
-    case 3:
-        return avs_simple_snprintf(dest, size, "/%"PRId32"/%"PRId32"/%"PRId32,
-                                   ctx->path[ctx->num_base_path_elems].id,
-                                   ctx->path[ctx->num_base_path_elems + 1].id,
-                                   ctx->path[ctx->num_base_path_elems + 2].id);
-    default:
-        return -1;
+static int flush_buffer(json_out_t *ctx) {
+    int retval = 0;
+    if (ctx->buffer_size) {
+        retval = avs_stream_write(ctx->stream, ctx->buffer, ctx->buffer_size);
+        ctx->buffer_size = 0;
+    }
+    return retval;
+}
+
+static int write_raw(json_out_t *ctx, const char *data, size_t size) {
+    if (size > sizeof(ctx->buffer) - ctx->buffer_size) {
+        int retval = flush_buffer(ctx);
+        if (retval) {
+            return retval;
+        }
+        if (size >= sizeof(ctx->buffer)) {
+            return avs_stream_write(ctx->stream, data, size);
+        }
     }
+    memcpy(&ctx->buffer[ctx->buffer_size], data, size);
+    ctx->buffer_size += size;
+    return 0;
 }
 
+#define write_literal(Ctx, Literal) \
+    write_raw((Ctx), (Literal), sizeof(Literal) - 1)
+
 typedef struct {
     anjay_oid_t oid;
     anjay_iid_t iid;
 } packed_objlnk_t;
 
-static int write_quoted_string(avs_stream_abstract_t *stream,
-                               const char *value) {
-    int retval = avs_stream_write(stream, "\"", 1);
-    if (retval) {
-        return retval;
-    }
-    for (size_t i = 0; i < strlen(value); ++i) {
-        /**
-         * RFC 4627 section 2.5 Strings:
-         *
-         * "(...)
-         *  All Unicode characters may be placed within the
-         *  quotation marks except for the characters that must be escaped:
-         *  quotation mark, reverse solidus, and the control characters (U+0000
-         *  through U+001F).
-         * "
-         */
-        if (value[i] == '\\' || value[i] == '"') {
-            retval = avs_stream_write(stream, "\\", 1);
-        }
-        if (retval) {
-            return retval;
+/**
+ * RFC 4627 section 2.5 Strings:
+ *
+ * "(...)
+ *  All Unicode characters may be placed within the
+ *  quotation marks except for the characters that must be escaped:
+ *  quotation mark, reverse solidus, and the control characters (U+0000
+ *  through U+001F).
+ * "
+ *
+ * The terminating nullbyte is a control character as well, so scanning for
+ * characters to escape also finds the end of the string.
+ */
+static inline bool is_special_char(char c) {
+    return c == '"' || c == '\\' || (uint8_t) c < 0x20;
+}
+
+static int write_escaped_char(json_out_t *ctx, char c) {
+    switch (c) {
+    case '"':
+        return write_literal(ctx, "\\\"");
+    case '\\':
+        return write_literal(ctx, "\\\\");
+    case '\b':
+        return write_literal(ctx, "\\b");
+    case '\f':
+        return write_literal(ctx, "\\f");
+    case '\n':
+        return write_literal(ctx, "\\n");
+    case '\r':
+        return write_literal(ctx, "\\r");
+    case '\t':
+        return write_literal(ctx, "\\t");
+    default:
+        {
+            static const char HEX_DIGITS[] = "0123456789abcdef";
+            char escaped[] = "\\u00XX";
+            escaped[4] = HEX_DIGITS[((uint8_t) c >> 4) & 0xF];
+            escaped[5] = HEX_DIGITS[(uint8_t) c & 0xF];
+            return write_raw(ctx, escaped, sizeof(escaped) - 1);
         }
+    }
+}
 
-        if (value[i] == '\b') {
-            retval = avs_stream_write(stream, "\\b", 2);
-        } else if (value[i] == '\f') {
-            retval = avs_stream_write(stream, "\\f", 2);
-        } else if (value[i] == '\n') {
-            retval = avs_stream_write(stream, "\\n", 2);
-        } else if (value[i] == '\r') {
-            retval = avs_stream_write(stream, "\\r", 2);
-        } else if (value[i] == '\t') {
-            retval = avs_stream_write(stream, "\\t", 2);
-        } else if ((uint8_t) value[i] < 0x20) {
-            const int nibble0 = ((uint8_t)value[i] >> 4) & 0xF;
-            const int nibble1 = ((uint8_t)value[i]) & 0xF;
-            retval =
-                    avs_stream_write_f(stream, "\\u00%x%x", nibble0, nibble1);
-        } else {
-            retval = avs_stream_write(stream, &value[i], 1);
+static int write_quoted_string(json_out_t *ctx, const char *value) {
+    int retval = write_literal(ctx, "\"");
+    while (!retval) {
+        // copy the longest run of characters that need no escaping at once
+        const char *run_end = value;
+        while (!is_special_char(*run_end)) {
+            ++run_end;
         }
-        if (retval) {
-            return retval;
+        if ((retval = write_raw(ctx, value, (size_t) (run_end - value)))
+                || !*run_end) {
+            break;
         }
+        retval = write_escaped_char(ctx, *run_end);
+        value = run_end + 1;
     }
-    return avs_stream_write(stream, "\"", 1);
+    return retval ? retval : write_literal(ctx, "\"");
+}
+
+static int write_number(json_out_t *ctx, int64_t value) {
+    char buf[ANJAY_I64_STRING_SIZE];
+    return write_raw(ctx, buf, _anjay_i64_to_string(buf, value));
+}
+
+static int write_key(json_out_t *ctx, json_data_type_t type) {
+    const char *key = data_type_to_key(type);
+    return write_raw(ctx, key, strlen(key));
 }
 
-static int write_variable(avs_stream_abstract_t *stream,
+static int write_variable(json_out_t *ctx,
                           json_data_type_t type,
                           const void *value) {
-    int retval =
-            avs_stream_write_f(stream, "\"%s\":", data_type_to_string(type));
+    int retval = write_key(ctx, type);
     if (retval) {
         return retval;
     }
 
+    char buf[ANJAY_DOUBLE_STRING_SIZE];
     switch (type) {
     case JSON_DATA_I32:
-        return avs_stream_write_f(stream, "%" PRIi32, *(const int32_t *) value);
+        return write_number(ctx, *(const int32_t *) value);
     case JSON_DATA_I64:
-        return avs_stream_write_f(stream, "%" PRIi64, *(const int64_t *) value);
+        return write_number(ctx, *(const int64_t *) value);
     case JSON_DATA_F32:
-        return avs_stream_write_f(stream, "%f", *(const float *) value);
+        return write_raw(ctx, buf,
+                         _anjay_float_to_string(buf, *(const float *) value));
     case JSON_DATA_F64:
-        return avs_stream_write_f(stream, "%f", *(const double *) value);
+        return write_raw(ctx, buf,
+                         _anjay_double_to_string(buf,
+                                                 *(const double *) value));
     case JSON_DATA_BOOL:
-        return avs_stream_write_f(stream, "%s",
-                                  (*(const bool *) value) ? "true" : "false");
+        return (*(const bool *) value) ? write_literal(ctx, "true")
+                                       : write_literal(ctx, "false");
     case JSON_DATA_OBJLNK:
         {
             const packed_objlnk_t objlnk = *(const packed_objlnk_t *) value;
-            return avs_stream_write_f(stream, "\"%" PRIu16 ":%" PRIu16 "\"",
-                                      objlnk.oid, objlnk.iid);
+            (void) ((retval = write_literal(ctx, "\""))
+                    || (retval = write_number(ctx, objlnk.oid))
+                    || (retval = write_literal(ctx, ":"))
+                    || (retval = write_number(ctx, objlnk.iid))
+                    || (retval = write_literal(ctx, "\"")));
+            return retval;
         }
     case JSON_DATA_STRING:
-        return write_quoted_string(stream, (const char *) value);
+        return write_quoted_string(ctx, (const char *) value);
     default:
         json_log(ERROR, "Unsupported json data type: %d", (int) type);
         return -1;
     }
 }
 
-static int write_uri(avs_stream_abstract_t *stream,
-                     const anjay_uri_path_t *path) {
-    int retval = avs_stream_write_f(stream, "/%d", path->oid);
+static int write_uri(json_out_t *ctx, const anjay_uri_path_t *path) {
+    int retval;
+    (void) ((retval = write_literal(ctx, "/"))
+            || (retval = write_number(ctx, path->oid)));
     if (!retval && path->has_iid) {
-        retval = avs_stream_write_f(stream, "/%d", path->iid);
+        (void) ((retval = write_literal(ctx, "/"))
+                || (retval = write_number(ctx, path->iid)));
     }
     if (!retval && path->has_rid) {
-        retval = avs_stream_write_f(stream, "/%d", path->rid);
+        (void) ((retval = write_literal(ctx, "/"))
+                || (retval = write_number(ctx, path->rid)));
     }
     return retval;
 }
 
-static int write_element_name(json_out_t *ctx) {
-    const char *name = NULL;
-    char buf[MAX_CHILD_PATH_LEN];
-    if (count_child_path_elems(ctx)) {
-        if (child_path_to_string(ctx, buf, sizeof(buf)) < 0) {
-            return -1;
+static int update_record_prefix(json_out_t *ctx) {
+    const size_t num_child_elems = count_child_path_elems(ctx);
+    if (num_child_elems > 3) {
+        return -1;
+    }
+    char *ptr = ctx->record_prefix;
+    *ptr++ = '{';
+    if (num_child_elems) {
+        memcpy(ptr, "\"n\":\"", sizeof("\"n\":\"") - 1);
+        ptr += sizeof("\"n\":\"") - 1;
+        for (size_t i = 0; i < num_child_elems; ++i) {
+            *ptr++ = '/';
+            ptr += _anjay_i64_to_string(
+                    ptr, ctx->path[ctx->num_base_path_elems + i].id);
         }
-        name = buf;
+        memcpy(ptr, "\",", sizeof("\",") - 1);
+        ptr += sizeof("\",") - 1;
     }
+    ctx->record_prefix_size = (size_t) (ptr - ctx->record_prefix);
+    return 0;
+}
 
-    int retval;
-    if (name) {
-        retval = avs_stream_write_f(ctx->stream, "{\"n\":\"%s\",", name);
-    } else {
-        retval = avs_stream_write(ctx->stream, "{", 1);
+static int write_element_name(json_out_t *ctx) {
+    if (!ctx->record_prefix_size && update_record_prefix(ctx)) {
+        return -1;
     }
-    return retval;
+    return write_raw(ctx, ctx->record_prefix, ctx->record_prefix_size);
 }
 
 static int write_response_element(json_out_t *ctx,
@@ -313,8 +375,8 @@ static int write_response_element(json_out_t *ctx,
                                   const void *value) {
     int retval;
     (void) ((retval = write_element_name(ctx))
-            || (retval = write_variable(ctx->stream, type, value))
-            || (retval = avs_stream_write(ctx->stream, "}", 1)));
+            || (retval = write_variable(ctx, type, value))
+            || (retval = write_literal(ctx, "}")));
     return retval;
 }
 
@@ -347,14 +409,13 @@ static int finish_ret_bytes(json_out_t *ctx) {
     }
     int result;
     (void) ((result = _anjay_base64_ret_bytes_ctx_close(ctx->bytes))
-            || (result = avs_stream_write(ctx->stream, "\"}", 2)));
+            || (result = write_literal(ctx, "\"}")));
     _anjay_base64_ret_bytes_ctx_delete(&ctx->bytes);
     return result;
 }
 
 static int maybe_write_separator(json_out_t *ctx) {
-    if (ctx->needs_separator
-            && avs_stream_write(ctx->stream, ",", 1)) {
+    if (ctx->needs_separator && write_literal(ctx, ",")) {
         return -1;
     }
     ctx->needs_separator = true;
@@ -390,9 +451,10 @@ static anjay_ret_bytes_ctx_t *json_ret_bytes(anjay_output_ctx_t *ctx_,
     int retval;
     (void) ((retval = maybe_write_separator(ctx))
             || (retval = write_element_name(ctx))
-            || (retval = avs_stream_write_f(ctx->stream, "\"%s\":\"",
-                                            data_type_to_string(
-                                                    JSON_DATA_STRING))));
+            || (retval = write_key(ctx, JSON_DATA_STRING))
+            || (retval = write_literal(ctx, "\""))
+            // the bytes context writes directly to the stream
+            || (retval = flush_buffer(ctx)));
     if (retval) {
         return NULL;
     }
@@ -520,8 +582,11 @@ static int json_set_id(anjay_output_ctx_t *ctx_,
     return 0;
 }
 
-static int write_response_finish(avs_stream_abstract_t *stream) {
-    return avs_stream_write(stream, "]}", 2);
+static int write_response_finish(json_out_t *ctx) {
+    int retval;
+    (void) ((retval = write_literal(ctx, "]}"))
+            || (retval = flush_buffer(ctx)));
+    return retval;
 }
 
 static int json_output_close(anjay_output_ctx_t *ctx_) {
@@ -532,7 +597,7 @@ static int json_output_close(anjay_output_ctx_t *ctx_) {
             return result;
         }
     }
-    return write_response_finish(ctx->stream);
+    return write_response_finish(ctx);
 }
 
 static const anjay_output_ctx_vtable_t JSON_OUT_VTABLE = {
@@ -553,24 +618,22 @@ static const anjay_output_ctx_vtable_t JSON_OUT_VTABLE = {
     json_output_close
 };
 
-static int write_response_preamble(avs_stream_abstract_t *stream,
+static int write_response_preamble(json_out_t *ctx,
                                    const anjay_uri_path_t *base) {
     int retval;
-    (void) ((retval = avs_stream_write_f(stream, "%s", "{\"bn\":\""))
-            || (retval = write_uri(stream, base))
-            || (retval = avs_stream_write_f(stream, "%s", "\",\"e\":[")));
+    (void) ((retval = write_literal(ctx, "{\"bn\":\""))
+            || (retval = write_uri(ctx, base))
+            || (retval = write_literal(ctx, "\",\"e\":[")));
     return retval;
 }
 
 anjay_output_ctx_t *
-_anjay_output_json_create(avs_stream_abstract_t *stream,
-                          int *errno_ptr,
-                          anjay_msg_details_t *inout_details,
-                          const anjay_uri_path_t *uri) {
+_anjay_output_raw_json_create(avs_stream_abstract_t *stream,
+                              const anjay_uri_path_t *uri) {
     json_out_t *ctx = (json_out_t *) calloc(1, sizeof(json_out_t));
     if (ctx) {
         ctx->vtable = &JSON_OUT_VTABLE;
-        ctx->errno_ptr = errno_ptr;
+        ctx->errno_ptr = NULL;
         ctx->stream = stream;
         if (uri->has_oid) {
             update_node_path(ctx, ANJAY_ID_OID, uri->oid);
@@ -586,20 +649,36 @@ _anjay_output_json_create(avs_stream_abstract_t *stream,
             update_node_path(ctx, ANJAY_ID_RID, uri->rid);
             ++ctx->num_base_path_elems;
         }
-
-        if ((*errno_ptr = _anjay_handle_requested_format(
-                     &inout_details->format, ANJAY_COAP_FORMAT_JSON))
-            || _anjay_coap_stream_setup_response(stream, inout_details)) {
-            goto error;
-        }
-        if (write_response_preamble(stream, uri)) {
+        // the preamble is only buffered here, so nothing reaches the stream
+        // before the response is set up by _anjay_output_json_create()
+        if (write_response_preamble(ctx, uri)) {
             json_log(ERROR, "cannot write response preamble");
-            goto error;
+            free(ctx);
+            return NULL;
         }
+    }
+    return (anjay_output_ctx_t *) ctx;
+}
+
+anjay_output_ctx_t *
+_anjay_output_json_create(avs_stream_abstract_t *stream,
+                          int *errno_ptr,
+                          anjay_msg_details_t *inout_details,
+                          const anjay_uri_path_t *uri) {
+    json_out_t *ctx = (json_out_t *) _anjay_output_raw_json_create(stream, uri);
+    if (ctx && ((*errno_ptr = _anjay_handle_requested_format(
+                    &inout_details->format, ANJAY_COAP_FORMAT_JSON))
+            || _anjay_coap_stream_setup_response(stream, inout_details))) {
+        free(ctx);
+        return NULL;
+    }
+    if (ctx) {
+        ctx->errno_ptr = errno_ptr;
         json_log(INFO, "created json context");
     }
     return (anjay_output_ctx_t *) ctx;
-error:
-    free(ctx);
-    return NULL;
 }
+
+#ifdef ANJAY_TEST
+#include "test/json_out.c"
+#endif
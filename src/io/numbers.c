@@ -0,0 +1,761 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils_core.h"
+#include "numbers.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+///////////////////////////////////////////////////////////////////// INTEGERS
+
+static const char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "6869707172737475767778798081828384858687888990919293949596979899";
+
+/* Writes decimal digits of @p value without a terminating nullbyte. */
+static size_t format_u64(char *out, uint64_t value) {
+    char buf[20];
+    char *ptr = buf + sizeof(buf);
+    while (value >= 100) {
+        size_t pair = (size_t) (value % 100) * 2;
+        value /= 100;
+        ptr -= 2;
+        memcpy(ptr, &DIGIT_PAIRS[pair], 2);
+    }
+    if (value >= 10) {
+        ptr -= 2;
+        memcpy(ptr, &DIGIT_PAIRS[value * 2], 2);
+    } else {
+        *--ptr = (char) ('0' + value);
+    }
+    size_t length = (size_t) (buf + sizeof(buf) - ptr);
+    memcpy(out, ptr, length);
+    return length;
+}
+
+size_t _anjay_i64_to_string(char *out, int64_t value) {
+    char *ptr = out;
+    uint64_t abs_value = (uint64_t) value;
+    if (value < 0) {
+        *ptr++ = '-';
+        abs_value = UINT64_C(0) - abs_value;
+    }
+    ptr += format_u64(ptr, abs_value);
+    *ptr = '\0';
+    return (size_t) (ptr - out);
+}
+
+/////////////////////////////////////////////////////////////// FLOATING POINT
+
+/*
+ * Shortest round-trip formatting is an implementation of the Ryu algorithm
+ * (Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018), using the
+ * "small table" variant: 5^i and 2^k / 5^i approximations are computed from
+ * a few exact entries and correction bits, so that the tables take below
+ * 1 kB. The same code handles both float and double, as only the mantissa
+ * width differs.
+ */
+
+#define POW5_BITCOUNT 125
+#define POW5_INV_BITCOUNT 125
+#define POW5_TABLE_SIZE 26
+
+static const uint64_t POW5_TABLE[26] = {
+    UINT64_C(1),
+    UINT64_C(5),
+    UINT64_C(25),
+    UINT64_C(125),
+    UINT64_C(625),
+    UINT64_C(3125),
+    UINT64_C(15625),
+    UINT64_C(78125),
+    UINT64_C(390625),
+    UINT64_C(1953125),
+    UINT64_C(9765625),
+    UINT64_C(48828125),
+    UINT64_C(244140625),
+    UINT64_C(1220703125),
+    UINT64_C(6103515625),
+    UINT64_C(30517578125),
+    UINT64_C(152587890625),
+    UINT64_C(762939453125),
+    UINT64_C(3814697265625),
+    UINT64_C(19073486328125),
+    UINT64_C(95367431640625),
+    UINT64_C(476837158203125),
+    UINT64_C(2384185791015625),
+    UINT64_C(11920928955078125),
+    UINT64_C(59604644775390625),
+    UINT64_C(298023223876953125),
+};
+
+// POW5_SPLIT entries for multiples of POW5_TABLE_SIZE
+static const uint64_t POW5_SPLIT2[13][2] = {
+    { UINT64_C(0), UINT64_C(1152921504606846976) },
+    { UINT64_C(0), UINT64_C(1490116119384765625) },
+    { UINT64_C(1032610780636961552), UINT64_C(1925929944387235853) },
+    { UINT64_C(7910200175544436838), UINT64_C(1244603055572228341) },
+    { UINT64_C(16941905809032713930), UINT64_C(1608611746708759036) },
+    { UINT64_C(13024893955298202172), UINT64_C(2079081953128979843) },
+    { UINT64_C(6607496772837067824), UINT64_C(1343575221513417750) },
+    { UINT64_C(17332926989895652603), UINT64_C(1736530273035216783) },
+    { UINT64_C(13037379183483547984), UINT64_C(2244412773384604712) },
+    { UINT64_C(1605989338741628675), UINT64_C(1450417759929778918) },
+    { UINT64_C(9630225068416591280), UINT64_C(1874621017369538693) },
+    { UINT64_C(665883850346957067), UINT64_C(1211445438634777304) },
+    { UINT64_C(14931890668723713708), UINT64_C(1565756531257009982) },
+};
+
+static const uint32_t POW5_OFFSETS[21] = {
+    0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u,
+    0x40000000u, 0x59695995u, 0x55545555u, 0x56555515u,
+    0x41150504u, 0x40555410u, 0x44555145u, 0x44504540u,
+    0x45555550u, 0x40004000u, 0x96440440u, 0x55565565u,
+    0x54454045u, 0x40154151u, 0x55559155u, 0x51405555u,
+    0x00000105u,
+};
+
+static const uint64_t POW5_INV_SPLIT2[15][2] = {
+    { UINT64_C(1), UINT64_C(2305843009213693952) },
+    { UINT64_C(5955668970331000884), UINT64_C(1784059615882449851) },
+    { UINT64_C(8982663654677661702), UINT64_C(1380349269358112757) },
+    { UINT64_C(7286864317269821294), UINT64_C(2135987035920910082) },
+    { UINT64_C(7005857020398200553), UINT64_C(1652639921975621497) },
+    { UINT64_C(17965325103354776697), UINT64_C(1278668206209430417) },
+    { UINT64_C(8928596168509315048), UINT64_C(1978643211784836272) },
+    { UINT64_C(10075671573058298858), UINT64_C(1530901034580419511) },
+    { UINT64_C(597001226353042382), UINT64_C(1184477304306571148) },
+    { UINT64_C(1527430471115325346), UINT64_C(1832889850782397517) },
+    { UINT64_C(12533209867169019542), UINT64_C(1418129833677084982) },
+    { UINT64_C(5577825024675947042), UINT64_C(2194449627517475473) },
+    { UINT64_C(11006974540203867551), UINT64_C(1697873161311732311) },
+    { UINT64_C(10313493231639821582), UINT64_C(1313665730009899186) },
+    { UINT64_C(12701016819766672773), UINT64_C(2032799256770390445) },
+};
+
+static const uint32_t POW5_INV_OFFSETS[22] = {
+    0x54544554u, 0x04055545u, 0x10041000u, 0x00400414u,
+    0x40010000u, 0x41155555u, 0x00000454u, 0x00010044u,
+    0x40000000u, 0x44000041u, 0x50454450u, 0x55550054u,
+    0x51655554u, 0x40004000u, 0x01000001u, 0x00010500u,
+    0x51515411u, 0x05555554u, 0x50411500u, 0x40040000u,
+    0x05040110u, 0x00000000u,
+};
+
+static inline uint64_t umul128(uint64_t a, uint64_t b, uint64_t *out_high) {
+    const uint64_t a_lo = (uint32_t) a;
+    const uint64_t a_hi = a >> 32;
+    const uint64_t b_lo = (uint32_t) b;
+    const uint64_t b_hi = b >> 32;
+
+    const uint64_t b00 = a_lo * b_lo;
+    const uint64_t b01 = a_lo * b_hi;
+    const uint64_t b10 = a_hi * b_lo;
+    const uint64_t b11 = a_hi * b_hi;
+
+    const uint64_t mid1 = b10 + (b00 >> 32);
+    const uint64_t mid2 = b01 + (uint32_t) mid1;
+
+    *out_high = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | (uint32_t) b00;
+}
+
+static inline uint64_t shiftright128(uint64_t lo, uint64_t hi, uint32_t dist) {
+    assert(dist > 0 && dist < 64);
+    return (hi << (64 - dist)) | (lo >> dist);
+}
+
+/* ceil(log2(5^e)) for 0 <= e <= 3528 */
+static inline int32_t pow5bits(int32_t e) {
+    return (int32_t) (((uint32_t) e * 1217359) >> 19) + 1;
+}
+
+/* floor(log10(2^e)) for 0 <= e <= 1650 */
+static inline uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t) e * 78913) >> 18;
+}
+
+/* floor(log10(5^e)) for 0 <= e <= 2620 */
+static inline uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t) e * 732923) >> 20;
+}
+
+static inline bool multiple_of_pow5(uint64_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        ++count;
+    }
+    return count >= p;
+}
+
+static inline bool multiple_of_pow2(uint64_t value, uint32_t p) {
+    assert(p < 64);
+    return (value & ((UINT64_C(1) << p) - 1)) == 0;
+}
+
+/* floor(5^i / 2^(pow5bits(i) - POW5_BITCOUNT)) */
+static void compute_pow5(uint32_t i, uint64_t *result) {
+    const uint32_t base = i / POW5_TABLE_SIZE;
+    const uint32_t base2 = base * POW5_TABLE_SIZE;
+    const uint32_t offset = i - base2;
+    const uint64_t *mul = POW5_SPLIT2[base];
+    if (offset == 0) {
+        result[0] = mul[0];
+        result[1] = mul[1];
+        return;
+    }
+    const uint64_t m = POW5_TABLE[offset];
+    uint64_t high1;
+    const uint64_t low1 = umul128(m, mul[1], &high1);
+    uint64_t high0;
+    const uint64_t low0 = umul128(m, mul[0], &high0);
+    const uint64_t sum = high0 + low1;
+    if (sum < high0) {
+        ++high1;
+    }
+    const uint32_t delta =
+            (uint32_t) (pow5bits((int32_t) i) - pow5bits((int32_t) base2));
+    result[0] = shiftright128(low0, sum, delta)
+            + ((POW5_OFFSETS[i / 16] >> ((i % 16) << 1)) & 3);
+    result[1] = shiftright128(sum, high1, delta);
+}
+
+/* floor(2^(pow5bits(i) - 1 + POW5_INV_BITCOUNT) / 5^i) + 1 */
+static void compute_inv_pow5(uint32_t i, uint64_t *result) {
+    const uint32_t base = (i + POW5_TABLE_SIZE - 1) / POW5_TABLE_SIZE;
+    const uint32_t base2 = base * POW5_TABLE_SIZE;
+    const uint32_t offset = base2 - i;
+    const uint64_t *mul = POW5_INV_SPLIT2[base];
+    if (offset == 0) {
+        result[0] = mul[0];
+        result[1] = mul[1];
+        return;
+    }
+    const uint64_t m = POW5_TABLE[offset];
+    uint64_t high1;
+    const uint64_t low1 = umul128(m, mul[1], &high1);
+    uint64_t high0;
+    const uint64_t low0 = umul128(m, mul[0] - 1, &high0);
+    const uint64_t sum = high0 + low1;
+    if (sum < high0) {
+        ++high1;
+    }
+    const uint32_t delta =
+            (uint32_t) (pow5bits((int32_t) base2) - pow5bits((int32_t) i));
+    result[0] = shiftright128(low0, sum, delta) + 1
+            + ((POW5_INV_OFFSETS[i / 16] >> ((i % 16) << 1)) & 3);
+    result[1] = shiftright128(sum, high1, delta);
+}
+
+static inline uint64_t mul_shift64(uint64_t m, const uint64_t *mul,
+                                   int32_t j) {
+    uint64_t high1;
+    const uint64_t low1 = umul128(m, mul[1], &high1);
+    uint64_t high0;
+    umul128(m, mul[0], &high0);
+    const uint64_t sum = high0 + low1;
+    if (sum < high0) {
+        ++high1;
+    }
+    return shiftright128(sum, high1, (uint32_t) (j - 64));
+}
+
+typedef struct {
+    uint64_t mantissa;
+    int32_t exponent;
+} decimal_t;
+
+/*
+ * Converts a finite, non-zero binary floating-point number to the shortest
+ * decimal representation that rounds back to it.
+ */
+static decimal_t to_decimal(uint64_t ieee_mantissa,
+                            uint32_t ieee_exponent,
+                            uint32_t mantissa_bits,
+                            int32_t bias) {
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        // subnormal; subtract 2 so that the bounds computation has 2
+        // additional bits
+        e2 = 1 - bias - (int32_t) mantissa_bits - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t) ieee_exponent - bias - (int32_t) mantissa_bits - 2;
+        m2 = (UINT64_C(1) << mantissa_bits) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 % 2 == 0);
+
+    // the halfway points to the neighbouring values are mv +/- 2 (or mv - 1
+    // if the lower neighbour is closer, i.e. at a power of 2)
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = (ieee_mantissa != 0 || ieee_exponent <= 1);
+
+    // mv * 2^e2 = vr * 10^e10 + (remainder), and likewise for vp and vm
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    uint64_t pow5[2];
+    if (e2 >= 0) {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = (int32_t) q;
+        const int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t) q) - 1;
+        const int32_t i = -e2 + (int32_t) q + k;
+        compute_inv_pow5(q, pow5);
+        vr = mul_shift64(4 * m2, pow5, i);
+        vp = mul_shift64(4 * m2 + 2, pow5, i);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, pow5, i);
+        if (q <= 21) {
+            // only one of mp, mv and mm can be a multiple of 5, if any
+            if (mv % 5 == 0) {
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t) q + e2;
+        const int32_t i = -e2 - (int32_t) q;
+        const int32_t k = pow5bits(i) - POW5_BITCOUNT;
+        const int32_t j = (int32_t) q - k;
+        compute_pow5((uint32_t) i, pow5);
+        vr = mul_shift64(4 * m2, pow5, j);
+        vp = mul_shift64(4 * m2 + 2, pow5, j);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, pow5, j);
+        if (q <= 1) {
+            // mv has at least q trailing zero bits, as it is a multiple of 4
+            vr_is_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_is_trailing_zeros = (mm_shift == 1);
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // remove as many digits as possible while staying within the bounds
+    int32_t removed = 0;
+    uint8_t last_removed_digit = 0;
+    uint64_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+        for (;;) {
+            const uint64_t vp_div10 = vp / 10;
+            const uint64_t vm_div10 = vm / 10;
+            if (vp_div10 <= vm_div10) {
+                break;
+            }
+            const uint64_t vr_div10 = vr / 10;
+            vm_is_trailing_zeros &= (vm - 10 * vm_div10 == 0);
+            vr_is_trailing_zeros &= (last_removed_digit == 0);
+            last_removed_digit = (uint8_t) (vr - 10 * vr_div10);
+            vr = vr_div10;
+            vp = vp_div10;
+            vm = vm_div10;
+            ++removed;
+        }
+        if (vm_is_trailing_zeros) {
+            for (;;) {
+                const uint64_t vm_div10 = vm / 10;
+                if (vm - 10 * vm_div10 != 0) {
+                    break;
+                }
+                const uint64_t vr_div10 = vr / 10;
+                vr_is_trailing_zeros &= (last_removed_digit == 0);
+                last_removed_digit = (uint8_t) (vr - 10 * vr_div10);
+                vr = vr_div10;
+                vp /= 10;
+                vm = vm_div10;
+                ++removed;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            // exactly halfway; round to even
+            last_removed_digit = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros))
+                       || last_removed_digit >= 5);
+    } else {
+        // common case: the bounds are not exact, so no ties are possible
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = (vr % 100 >= 50);
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = (vr % 10 >= 5);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+
+    decimal_t result = {
+        .mantissa = output,
+        .exponent = e10 + removed
+    };
+    return result;
+}
+
+static size_t format_special(char *out, bool negative, bool is_nan) {
+    char *ptr = out;
+    if (is_nan) {
+        memcpy(ptr, "nan", 3);
+        ptr += 3;
+    } else {
+        if (negative) {
+            *ptr++ = '-';
+        }
+        memcpy(ptr, "inf", 3);
+        ptr += 3;
+    }
+    *ptr = '\0';
+    return (size_t) (ptr - out);
+}
+
+static size_t format_decimal(char *out,
+                             bool negative,
+                             decimal_t value,
+                             int32_t max_plain_exponent) {
+    char digits[20];
+    const int32_t num_digits = (int32_t) format_u64(digits, value.mantissa);
+    const int32_t sci_exponent = value.exponent + num_digits - 1;
+
+    char *ptr = out;
+    if (negative) {
+        *ptr++ = '-';
+    }
+    if (sci_exponent < -4 || sci_exponent >= max_plain_exponent) {
+        *ptr++ = digits[0];
+        if (num_digits > 1) {
+            *ptr++ = '.';
+            memcpy(ptr, &digits[1], (size_t) (num_digits - 1));
+            ptr += num_digits - 1;
+        }
+        *ptr++ = 'e';
+        *ptr++ = (sci_exponent < 0) ? '-' : '+';
+        uint32_t abs_exponent = (uint32_t) (sci_exponent < 0 ? -sci_exponent
+                                                             : sci_exponent);
+        if (abs_exponent < 10) {
+            // at least two digits, like printf() does
+            *ptr++ = '0';
+        }
+        ptr += format_u64(ptr, abs_exponent);
+    } else if (value.exponent >= 0) {
+        memcpy(ptr, digits, (size_t) num_digits);
+        ptr += num_digits;
+        memset(ptr, '0', (size_t) value.exponent);
+        ptr += value.exponent;
+    } else if (sci_exponent >= 0) {
+        memcpy(ptr, digits, (size_t) sci_exponent + 1);
+        ptr += sci_exponent + 1;
+        *ptr++ = '.';
+        memcpy(ptr, &digits[sci_exponent + 1],
+               (size_t) (num_digits - sci_exponent - 1));
+        ptr += num_digits - sci_exponent - 1;
+    } else {
+        *ptr++ = '0';
+        *ptr++ = '.';
+        memset(ptr, '0', (size_t) (-sci_exponent - 1));
+        ptr += -sci_exponent - 1;
+        memcpy(ptr, digits, (size_t) num_digits);
+        ptr += num_digits;
+    }
+    *ptr = '\0';
+    return (size_t) (ptr - out);
+}
+
+static size_t format_binary(char *out,
+                            uint64_t bits,
+                            uint32_t mantissa_bits,
+                            uint32_t exponent_bits,
+                            int32_t max_plain_exponent) {
+    const bool negative = (bits >> (mantissa_bits + exponent_bits)) & 1;
+    const uint64_t ieee_mantissa =
+            bits & ((UINT64_C(1) << mantissa_bits) - 1);
+    const uint32_t ieee_exponent =
+            (uint32_t) ((bits >> mantissa_bits)
+                        & ((UINT64_C(1) << exponent_bits) - 1));
+    const uint32_t max_exponent = (UINT32_C(1) << exponent_bits) - 1;
+    const int32_t bias = (int32_t) (max_exponent >> 1);
+
+    if (ieee_exponent == max_exponent) {
+        return format_special(out, negative, ieee_mantissa != 0);
+    }
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        char *ptr = out;
+        if (negative) {
+            *ptr++ = '-';
+        }
+        *ptr++ = '0';
+        *ptr = '\0';
+        return (size_t) (ptr - out);
+    }
+    return format_decimal(out, negative,
+                          to_decimal(ieee_mantissa, ieee_exponent,
+                                     mantissa_bits, bias),
+                          max_plain_exponent);
+}
+
+AVS_STATIC_ASSERT(sizeof(float) == sizeof(uint32_t), float_is_binary32);
+AVS_STATIC_ASSERT(sizeof(double) == sizeof(uint64_t), double_is_binary64);
+
+size_t _anjay_float_to_string(char *out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return format_binary(out, bits, FLT_MANT_DIG - 1, 8, 9);
+}
+
+size_t _anjay_double_to_string(char *out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return format_binary(out, bits, DBL_MANT_DIG - 1, 11, 17);
+}
+
+////////////////////////////////////////////////////////////////////// PARSING
+
+/*
+ * Parses strings matching [+-]?[0-9]*(\.[0-9]*)?([eE][+-]?[0-9]+)? with at
+ * least one mantissa digit and at most 19 significant digits. Anything else is
+ * left for the standard library to handle.
+ */
+static bool parse_simple_decimal(const char *in,
+                                 bool *out_negative,
+                                 uint64_t *out_mantissa,
+                                 int32_t *out_exponent) {
+    const char *ptr = in;
+    *out_negative = false;
+    if (*ptr == '+' || *ptr == '-') {
+        *out_negative = (*ptr++ == '-');
+    }
+
+    uint64_t mantissa = 0;
+    int32_t exponent = 0;
+    int num_digits = 0;
+    int num_significant_digits = 0;
+    bool after_point = false;
+    for (;; ++ptr) {
+        if (*ptr == '.' && !after_point) {
+            after_point = true;
+            continue;
+        }
+        if (*ptr < '0' || *ptr > '9') {
+            break;
+        }
+        ++num_digits;
+        if (mantissa || *ptr != '0') {
+            if (++num_significant_digits > 19) {
+                return false;
+            }
+            mantissa = 10 * mantissa + (uint64_t) (*ptr - '0');
+        }
+        if (after_point) {
+            --exponent;
+        }
+    }
+    if (!num_digits) {
+        return false;
+    }
+
+    if (*ptr == 'e' || *ptr == 'E') {
+        ++ptr;
+        bool exponent_negative = false;
+        if (*ptr == '+' || *ptr == '-') {
+            exponent_negative = (*ptr++ == '-');
+        }
+        if (*ptr < '0' || *ptr > '9') {
+            return false;
+        }
+        int32_t explicit_exponent = 0;
+        for (; *ptr >= '0' && *ptr <= '9'; ++ptr) {
+            if (explicit_exponent > 9999) {
+                return false;
+            }
+            explicit_exponent = 10 * explicit_exponent + (*ptr - '0');
+        }
+        exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+    if (*ptr) {
+        return false;
+    }
+    *out_mantissa = mantissa;
+    *out_exponent = exponent;
+    return true;
+}
+
+/*
+ * Clinger's fast path: if both the mantissa and the power of 10 are exactly
+ * representable, a single correctly rounded multiplication or division yields
+ * a correctly rounded result. This is only valid if intermediate results are
+ * not kept in a wider format.
+ */
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+#define DOUBLE_FAST_PATH
+static const double DOUBLE_POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define FLOAT_FAST_PATH
+static const float FLOAT_POW10[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+#endif
+
+static bool parse_double_fast(const char *in, double *out) {
+#ifdef DOUBLE_FAST_PATH
+    bool negative;
+    uint64_t mantissa;
+    int32_t exponent;
+    if (!parse_simple_decimal(in, &negative, &mantissa, &exponent)
+            || mantissa > (UINT64_C(1) << 53)
+            || exponent < -22 || exponent > 22) {
+        return false;
+    }
+    double value = (double) mantissa;
+    if (exponent < 0) {
+        value /= DOUBLE_POW10[-exponent];
+    } else {
+        value *= DOUBLE_POW10[exponent];
+    }
+    *out = negative ? -value : value;
+    return true;
+#else
+    (void) in;
+    (void) out;
+    return false;
+#endif
+}
+
+static bool parse_float_fast(const char *in, float *out) {
+#ifdef FLOAT_FAST_PATH
+    bool negative;
+    uint64_t mantissa;
+    int32_t exponent;
+    if (!parse_simple_decimal(in, &negative, &mantissa, &exponent)
+            || mantissa > (UINT64_C(1) << 24)
+            || exponent < -10 || exponent > 10) {
+        return false;
+    }
+    float value = (float) mantissa;
+    if (exponent < 0) {
+        value /= FLOAT_POW10[-exponent];
+    } else {
+        value *= FLOAT_POW10[exponent];
+    }
+    *out = negative ? -value : value;
+    return true;
+#else
+    (void) in;
+    (void) out;
+    return false;
+#endif
+}
+
+int _anjay_safe_strtoll(const char *in, long long *value) {
+    // plain decimal numbers are handled here; everything else, including
+    // octal and hexadecimal notation, is left to strtoll()
+    const char *ptr = in;
+    bool negative = false;
+    if (*ptr == '+' || *ptr == '-') {
+        negative = (*ptr++ == '-');
+    }
+    if ((*ptr >= '1' && *ptr <= '9') || (ptr[0] == '0' && !ptr[1])) {
+        const char *digits = ptr;
+        uint64_t result = 0;
+        for (; *ptr >= '0' && *ptr <= '9' && ptr - digits < 18; ++ptr) {
+            result = 10 * result + (uint64_t) (*ptr - '0');
+        }
+        if (!*ptr) {
+            *value = negative ? -(long long) result : (long long) result;
+            return 0;
+        }
+    }
+
+    char *endptr = NULL;
+    if (!*in || isspace((unsigned char) *in)) {
+        return -1;
+    }
+    errno = 0;
+    long long result = strtoll(in, &endptr, 0);
+    if (errno || !endptr || *endptr) {
+        return -1;
+    }
+    *value = result;
+    return 0;
+}
+
+int _anjay_safe_strtof(const char *in, float *value) {
+    if (parse_float_fast(in, value)) {
+        return 0;
+    }
+    char *endptr = NULL;
+    if (!*in || isspace((unsigned char) *in)) {
+        return -1;
+    }
+    errno = 0;
+    float result = strtof(in, &endptr);
+    if (errno || !endptr || *endptr) {
+        return -1;
+    }
+    *value = result;
+    return 0;
+}
+
+int _anjay_safe_strtod(const char *in, double *value) {
+    if (parse_double_fast(in, value)) {
+        return 0;
+    }
+    char *endptr = NULL;
+    if (!*in || isspace((unsigned char) *in)) {
+        return -1;
+    }
+    errno = 0;
+    double result = strtod(in, &endptr);
+    if (errno || !endptr || *endptr) {
+        return -1;
+    }
+    *value = result;
+    return 0;
+}
+
+#ifdef ANJAY_TEST
+#include "test/numbers.c"
+#endif // ANJAY_TEST
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_IO_NUMBERS_H
+#define ANJAY_IO_NUMBERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#define ANJAY_I64_STRING_SIZE sizeof("-9223372036854775808")
+#define ANJAY_FLOAT_STRING_SIZE sizeof("-0.000123456789")
+#define ANJAY_DOUBLE_STRING_SIZE sizeof("-1.2345678901234567e-308")
+
+/**
+ * Formats @p value as a decimal integer, without using printf().
+ *
+ * @param out Output buffer, at least ANJAY_I64_STRING_SIZE bytes long.
+ *
+ * @returns Length of the nullbyte-terminated string written to @p out.
+ */
+size_t _anjay_i64_to_string(char *out, int64_t value);
+
+/**
+ * Formats @p value using the shortest sequence of significant digits that
+ * parses back to exactly the same value.
+ *
+ * The layout mimics "%g": exponential notation is used if the decimal
+ * exponent is less than -4 or not less than 9, e.g. "0.1", "10000.5",
+ * "4.223e+37". Non-finite values are formatted as "nan", "inf" or "-inf".
+ *
+ * FIXME: The LwM2M spec calls for a "decimal" representation, which, in my
+ * understanding, excludes exponential representation. As printing
+ * floating-point numbers as pure decimal with sane precision is tricky, let's
+ * take the spec a bit loosely for now.
+ *
+ * @param out Output buffer, at least ANJAY_FLOAT_STRING_SIZE bytes long.
+ *
+ * @returns Length of the nullbyte-terminated string written to @p out.
+ */
+size_t _anjay_float_to_string(char *out, float value);
+
+/**
+ * Same as @ref _anjay_float_to_string, but for double precision values.
+ * Exponential notation is used if the decimal exponent is less than -4 or not
+ * less than 17.
+ *
+ * @param out Output buffer, at least ANJAY_DOUBLE_STRING_SIZE bytes long.
+ *
+ * @returns Length of the nullbyte-terminated string written to @p out.
+ */
+size_t _anjay_double_to_string(char *out, double value);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_IO_NUMBERS_H */
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <avsystem/commons/stream/stream_outbuf.h>
+#include <avsystem/commons/unit/test.h>
+
+static anjay_output_ctx_t *new_json_out(avs_stream_abstract_t *stream,
+                                        const anjay_uri_path_t *uri) {
+    anjay_output_ctx_t *out = _anjay_output_raw_json_create(stream, uri);
+    AVS_UNIT_ASSERT_NOT_NULL(out);
+    return out;
+}
+
+#define TEST_ENV(Size, Uri) \
+    char buf[Size]; \
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER; \
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf)); \
+    anjay_output_ctx_t *out = new_json_out((avs_stream_abstract_t *) &outbuf, \
+                                           &(Uri))
+
+#define VERIFY_BYTES(Data) do { \
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), sizeof(Data) - 1);\
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, Data, sizeof(Data) - 1); \
+} while (0)
+
+static const anjay_uri_path_t RESOURCE_PATH = {
+    .has_oid = true,
+    .oid = 3,
+    .has_iid = true,
+    .iid = 0,
+    .has_rid = true,
+    .rid = 1
+};
+
+static const anjay_uri_path_t OBJECT_PATH = {
+    .has_oid = true,
+    .oid = 3
+};
+
+AVS_UNIT_TEST(json_out, escaped_string) {
+    TEST_ENV(128, RESOURCE_PATH);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_string(out, "a\"b\\c\nd\x01"));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("{\"bn\":\"/3/0/1\",\"e\":["
+                 "{\"sv\":\"a\\\"b\\\\c\\nd\\u0001\"}]}");
+}
+
+AVS_UNIT_TEST(json_out, multiple_records) {
+    TEST_ENV(256, OBJECT_PATH);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_IID, 0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_i32(out, -42));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 2));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_double(out, 0.1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 3));
+    anjay_output_ctx_t *array = anjay_ret_array_start(out);
+    AVS_UNIT_ASSERT_NOT_NULL(array);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_index(array, 0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_bool(array, true));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_index(array, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_bool(array, false));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_finish(array));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 4));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_objlnk(out, 1, 65535));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("{\"bn\":\"/3\",\"e\":["
+                 "{\"n\":\"/0/1\",\"v\":-42},"
+                 "{\"n\":\"/0/2\",\"v\":0.1},"
+                 "{\"n\":\"/0/3/0\",\"bv\":true},"
+                 "{\"n\":\"/0/3/1\",\"bv\":false},"
+                 "{\"n\":\"/0/4\",\"ov\":\"1:65535\"}]}");
+}
+
+AVS_UNIT_TEST(json_out, bytes) {
+    TEST_ENV(128, RESOURCE_PATH);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    anjay_ret_bytes_ctx_t *bytes = anjay_ret_bytes_begin(out, 3);
+    AVS_UNIT_ASSERT_NOT_NULL(bytes);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_bytes_append(bytes, "abc", 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("{\"bn\":\"/3/0/1\",\"e\":[{\"sv\":\"YWJj\"}]}");
+}
+
+AVS_UNIT_TEST(json_out, string_longer_than_buffer) {
+    TEST_ENV(4096, RESOURCE_PATH);
+
+    char value[3 * JSON_OUT_BUFFER_SIZE];
+    memset(value, 'x', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    value[JSON_OUT_BUFFER_SIZE] = '"';
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_RID, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ret_string(out, value));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+
+    static const char PREFIX[] = "{\"bn\":\"/3/0/1\",\"e\":[{\"sv\":\"";
+    static const char SUFFIX[] = "\"}]}";
+    const size_t value_offset = sizeof(PREFIX) - 1;
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf),
+                          value_offset + sizeof(value) + sizeof(SUFFIX) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, PREFIX, value_offset);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&buf[value_offset], value,
+                                      JSON_OUT_BUFFER_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &buf[value_offset + JSON_OUT_BUFFER_SIZE], "\\\"", 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &buf[value_offset + JSON_OUT_BUFFER_SIZE + 2],
+            &value[JSON_OUT_BUFFER_SIZE + 1],
+            sizeof(value) - JSON_OUT_BUFFER_SIZE - 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &buf[value_offset + sizeof(value)], SUFFIX, sizeof(SUFFIX) - 1);
+}
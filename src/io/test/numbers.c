@@ -0,0 +1,251 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <math.h>
+
+#include <avsystem/commons/unit/test.h>
+
+#define ASSERT_FLOAT_STRING(Value, Expected) \
+    do { \
+        char buf[ANJAY_FLOAT_STRING_SIZE]; \
+        AVS_UNIT_ASSERT_EQUAL(_anjay_float_to_string(buf, (Value)), \
+                              sizeof(Expected) - 1); \
+        AVS_UNIT_ASSERT_EQUAL_STRING(buf, (Expected)); \
+    } while (0)
+
+#define ASSERT_DOUBLE_STRING(Value, Expected) \
+    do { \
+        char buf[ANJAY_DOUBLE_STRING_SIZE]; \
+        AVS_UNIT_ASSERT_EQUAL(_anjay_double_to_string(buf, (Value)), \
+                              sizeof(Expected) - 1); \
+        AVS_UNIT_ASSERT_EQUAL_STRING(buf, (Expected)); \
+    } while (0)
+
+AVS_UNIT_TEST(numbers_format, integers) {
+    char buf[ANJAY_I64_STRING_SIZE];
+    AVS_UNIT_ASSERT_EQUAL(_anjay_i64_to_string(buf, 0), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "0");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_i64_to_string(buf, -7), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "-7");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_i64_to_string(buf, 100), 3);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "100");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_i64_to_string(buf, INT64_MAX), 19);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "9223372036854775807");
+    AVS_UNIT_ASSERT_EQUAL(_anjay_i64_to_string(buf, INT64_MIN), 20);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "-9223372036854775808");
+}
+
+AVS_UNIT_TEST(numbers_format, special) {
+    ASSERT_DOUBLE_STRING(0.0, "0");
+    ASSERT_DOUBLE_STRING(-0.0, "-0");
+    ASSERT_DOUBLE_STRING(INFINITY, "inf");
+    ASSERT_DOUBLE_STRING(-INFINITY, "-inf");
+    ASSERT_DOUBLE_STRING(NAN, "nan");
+    ASSERT_FLOAT_STRING(-0.0f, "-0");
+    ASSERT_FLOAT_STRING((float) -INFINITY, "-inf");
+}
+
+AVS_UNIT_TEST(numbers_format, shortest) {
+    ASSERT_DOUBLE_STRING(0.1, "0.1");
+    ASSERT_DOUBLE_STRING(0.3, "0.3");
+    ASSERT_DOUBLE_STRING(0.1 + 0.2, "0.30000000000000004");
+    ASSERT_DOUBLE_STRING(10000.5, "10000.5");
+    ASSERT_DOUBLE_STRING(-1.5, "-1.5");
+    ASSERT_DOUBLE_STRING(DBL_MAX, "1.7976931348623157e+308");
+    ASSERT_FLOAT_STRING(0.1f, "0.1");
+    ASSERT_FLOAT_STRING(16777216.0f, "16777216");
+    ASSERT_FLOAT_STRING(FLT_MAX, "3.4028235e+38");
+}
+
+AVS_UNIT_TEST(numbers_format, subnormal) {
+    ASSERT_DOUBLE_STRING(4.9406564584124654e-324, "5e-324");
+    ASSERT_DOUBLE_STRING(-2.2250738585072009e-308,
+                         "-2.225073858507201e-308");
+    ASSERT_DOUBLE_STRING(DBL_MIN, "2.2250738585072014e-308");
+    ASSERT_FLOAT_STRING(1.40129846e-45f, "1e-45");
+    ASSERT_FLOAT_STRING(-1.1754942e-38f, "-1.1754942e-38");
+    ASSERT_FLOAT_STRING(FLT_MIN, "1.1754944e-38");
+}
+
+AVS_UNIT_TEST(numbers_format, exponent_switch_points) {
+    // both types switch to exponential notation below 1e-4, like "%g"
+    ASSERT_DOUBLE_STRING(1e-4, "0.0001");
+    ASSERT_DOUBLE_STRING(1.5e-4, "0.00015");
+    ASSERT_DOUBLE_STRING(1e-5, "1e-05");
+    ASSERT_DOUBLE_STRING(9.5e-5, "9.5e-05");
+    ASSERT_FLOAT_STRING(1e-4f, "0.0001");
+    ASSERT_FLOAT_STRING(1e-5f, "1e-05");
+
+    // float switches at 1e9
+    ASSERT_FLOAT_STRING(1e8f, "100000000");
+    ASSERT_FLOAT_STRING(999999940.0f, "999999940");
+    ASSERT_FLOAT_STRING(1e9f, "1e+09");
+    ASSERT_FLOAT_STRING(1.5e9f, "1.5e+09");
+
+    // double switches at 1e17
+    ASSERT_DOUBLE_STRING(1e9, "1000000000");
+    ASSERT_DOUBLE_STRING(1e16, "10000000000000000");
+    ASSERT_DOUBLE_STRING(99999999999999984.0, "99999999999999980");
+    ASSERT_DOUBLE_STRING(1e17, "1e+17");
+    ASSERT_DOUBLE_STRING(1.25e17, "1.25e+17");
+    ASSERT_DOUBLE_STRING(1e100, "1e+100");
+}
+
+static void assert_strtod_matches_libc(const char *in) {
+    double expected = strtod(in, NULL);
+    double actual;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtod(in, &actual));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&actual, &expected, sizeof(double));
+}
+
+AVS_UNIT_TEST(numbers_parse, double_fast_path_syntax) {
+    double value;
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("1.", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 1.0);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast(".5", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0.5);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("+2.5E1", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 25.0);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("-12.5e-1", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, -1.25);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("-0", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0.0);
+    AVS_UNIT_ASSERT_TRUE(signbit(value));
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("000000000000000000000042", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 42.0);
+
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast(".", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("-", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("e5", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1e", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1e+", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1.2.3", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast(" 1", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1 ", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("0x10", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("inf", &value));
+}
+
+AVS_UNIT_TEST(numbers_parse, double_fast_path_limits) {
+    double value;
+    // 19 significant digits are accepted by the parser, but only mantissas
+    // up to 2^53 are exact
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("9007199254740992", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 9007199254740992.0);
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("9007199254740993", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1234567890123456789", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("12345678901234567890", &value));
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("0.0000000000000000001", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 1e-19);
+
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("1e22", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 1e22);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("1e-22", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 1e-22);
+    AVS_UNIT_ASSERT_TRUE(parse_double_fast("-3.5e22", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, -3.5e22);
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1e23", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1e-23", &value));
+    AVS_UNIT_ASSERT_FALSE(parse_double_fast("1e99999", &value));
+
+    float fvalue;
+    AVS_UNIT_ASSERT_TRUE(parse_float_fast("16777216", &fvalue));
+    AVS_UNIT_ASSERT_EQUAL(fvalue, 16777216.0f);
+    AVS_UNIT_ASSERT_FALSE(parse_float_fast("16777217", &fvalue));
+    AVS_UNIT_ASSERT_TRUE(parse_float_fast("1e10", &fvalue));
+    AVS_UNIT_ASSERT_EQUAL(fvalue, 1e10f);
+    AVS_UNIT_ASSERT_FALSE(parse_float_fast("1e11", &fvalue));
+    AVS_UNIT_ASSERT_FALSE(parse_float_fast("1e-11", &fvalue));
+}
+
+AVS_UNIT_TEST(numbers_parse, double_slow_path) {
+    // results outside the fast path are left to strtod()
+    assert_strtod_matches_libc("9007199254740993");
+    assert_strtod_matches_libc("1234567890123456789");
+    assert_strtod_matches_libc("12345678901234567890");
+    assert_strtod_matches_libc("1e23");
+    assert_strtod_matches_libc("1e-23");
+    assert_strtod_matches_libc("2.2250738585072014e-308");
+    assert_strtod_matches_libc("1.7976931348623157e308");
+    assert_strtod_matches_libc("0x1p-3");
+    assert_strtod_matches_libc("inf");
+
+    double value;
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtod("1e400", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtod("", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtod(" 1", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtod("1e", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtod("woof", &value));
+
+    float fvalue;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtof("16777217", &fvalue));
+    AVS_UNIT_ASSERT_EQUAL(fvalue, 16777216.0f);
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtof("1e39", &fvalue));
+}
+
+AVS_UNIT_TEST(numbers_parse, format_round_trip) {
+    static const double VALUES[] = {
+        0.1, 1.0 / 3.0, 123456.789, 1e-5, 9.5e-5, 1e17, DBL_MIN, DBL_MAX
+    };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VALUES); ++i) {
+        char buf[ANJAY_DOUBLE_STRING_SIZE];
+        _anjay_double_to_string(buf, VALUES[i]);
+        double parsed;
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtod(buf, &parsed));
+        AVS_UNIT_ASSERT_EQUAL(parsed, VALUES[i]);
+    }
+}
+
+AVS_UNIT_TEST(numbers_parse, integers) {
+    long long value;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("0", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("-0", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("+42", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 42);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("-123456789012345678",
+                                                &value));
+    AVS_UNIT_ASSERT_EQUAL(value, -123456789012345678LL);
+
+    // longer numbers go through strtoll()
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("9223372036854775807",
+                                                &value));
+    AVS_UNIT_ASSERT_EQUAL(value, INT64_MAX);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("-9223372036854775808",
+                                                &value));
+    AVS_UNIT_ASSERT_EQUAL(value, INT64_MIN);
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("9223372036854775808",
+                                               &value));
+
+    // so do octal and hexadecimal ones
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("017", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 15);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("-0x1F", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, -31);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtoll("00", &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 0);
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("08", &value));
+
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("-", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll(" 1", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("1 ", &value));
+    AVS_UNIT_ASSERT_FAILED(_anjay_safe_strtoll("1.0", &value));
+}
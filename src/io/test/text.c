@@ -16,6 +16,7 @@
 
 #include <config.h>
 
+#include <avsystem/commons/base64.h>
 #include <avsystem/commons/stream.h>
 #include <avsystem/commons/unit/memstream.h>
 #include <avsystem/commons/unit/test.h>
@@ -115,6 +116,10 @@ AVS_UNIT_TEST(text_out, f32) {
     TEST_FLOAT(1.3125);
     TEST_FLOAT(10000.5);
     TEST_FLOAT(4.223e+37);
+    TEST_FLOAT(0.1);
+    TEST_FLOAT(-123456.79);
+    TEST_FLOAT(1e-05);
+    TEST_FLOAT(1e+09);
 }
 
 #undef TEST_FLOAT
@@ -132,6 +137,11 @@ AVS_UNIT_TEST(text_out, f64) {
     TEST_DOUBLE(1.2);
     TEST_DOUBLE(10000000000000.5);
     TEST_DOUBLE(3.26e+218);
+    TEST_DOUBLE(0.1);
+    TEST_DOUBLE(-0.0001);
+    TEST_DOUBLE(1e+17);
+    TEST_DOUBLE(5e-324);
+    TEST_DOUBLE(1.7976931348623157e+308);
 }
 
 #undef TEST_DOUBLE
@@ -172,6 +182,30 @@ AVS_UNIT_TEST(text_out, objlnk) {
 
 #undef TEST_OBJLNK
 
+AVS_UNIT_TEST(text_out, bytes) {
+    TEST_ENV(1024);
+
+    uint8_t data[500];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t) (i * 7);
+    }
+    char expected[1024];
+    AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(expected, sizeof(expected),
+                                              data, sizeof(data)));
+
+    anjay_ret_bytes_ctx_t *bytes =
+            anjay_ret_bytes_begin((anjay_output_ctx_t *) &out, sizeof(data));
+    AVS_UNIT_ASSERT_NOT_NULL(bytes);
+    // uneven appends exercise both the cached quantum and the bulk path
+    for (size_t offset = 0; offset < sizeof(data); offset += 7) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_bytes_append(
+                bytes, &data[offset], AVS_MIN(7, sizeof(data) - offset)));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(text_ret_close((anjay_output_ctx_t *) &out));
+    stringify_buf(&outbuf);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, expected);
+}
+
 AVS_UNIT_TEST(text_out, unimplemented) {
     TEST_ENV(512);
     AVS_UNIT_ASSERT_NOT_NULL(anjay_ret_bytes_begin((anjay_output_ctx_t *) &out, 3));
@@ -380,5 +414,58 @@ AVS_UNIT_TEST(text_in, objlnk) {
 #undef TEST_OBJLNK_FAIL
 #undef TEST_OBJLNK
 #undef TEST_OBJLNK_COMMON
+
+AVS_UNIT_TEST(text_in, bytes) {
+    TEST_ENV(1024);
+
+    uint8_t data[500];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (uint8_t) (i * 7);
+    }
+    char encoded[1024];
+    AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(encoded, sizeof(encoded),
+                                              data, sizeof(data)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, encoded,
+                                             strlen(encoded)));
+
+    uint8_t decoded[sizeof(data)];
+    size_t total_read = 0;
+    bool message_finished = false;
+    // reads not aligned to quanta exercise the cache of decoded bytes
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_TRUE(total_read < sizeof(decoded));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_get_bytes(
+                in, &bytes_read, &message_finished, &decoded[total_read],
+                AVS_MIN(5, sizeof(decoded) - total_read)));
+        total_read += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(total_read, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded, data, sizeof(data));
+
+    TEST_TEARDOWN;
+}
+
+#define TEST_BYTES_FAIL(Str) do { \
+    TEST_ENV(32); \
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, Str, sizeof(Str) - 1)); \
+    size_t bytes_read; \
+    bool message_finished; \
+    uint8_t buf[32]; \
+    AVS_UNIT_ASSERT_FAILED(anjay_get_bytes(in, &bytes_read, &message_finished, \
+                                           buf, sizeof(buf))); \
+    TEST_TEARDOWN; \
+} while (false)
+
+AVS_UNIT_TEST(text_in, bytes_invalid) {
+    TEST_BYTES_FAIL("QQ");
+    TEST_BYTES_FAIL("QQ=");
+    TEST_BYTES_FAIL("QQ==QUJD");
+    TEST_BYTES_FAIL("Q===");
+    TEST_BYTES_FAIL("QUJD QUJD");
+    TEST_BYTES_FAIL("QU*D");
+}
+
+#undef TEST_BYTES_FAIL
 #undef TEST_TEARDOWN
 #undef TEST_ENV
@@ -23,13 +23,9 @@
 ///////////////////////////////////////////////////////////// ENCODING // SIMPLE
 
 static anjay_output_ctx_t *new_tlv_out(avs_stream_abstract_t *stream) {
-    tlv_out_t *out = (tlv_out_t *) calloc(1, sizeof(tlv_out_t));
+    anjay_output_ctx_t *out = _anjay_output_raw_tlv_create(stream);
     AVS_UNIT_ASSERT_NOT_NULL(out);
-    out->vtable = &TLV_OUT_VTABLE;
-    out->next_entry_ptr = &out->entries;
-    out->stream = stream;
-    out->next_id.id = -1;
-    return (anjay_output_ctx_t *) out;
+    return out;
 }
 
 #define TEST_ENV_COMMON(Size) \
@@ -314,6 +310,39 @@ AVS_UNIT_TEST(tlv_out_array, array_index) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
 }
 
+AVS_UNIT_TEST(tlv_out, objects_with_arrays) {
+    TEST_ENV(512);
+
+    for (uint16_t iid = 1; iid <= 2; ++iid) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(out, ANJAY_ID_IID, iid));
+        anjay_output_ctx_t *obj = _anjay_output_object_start(out);
+        AVS_UNIT_ASSERT_NOT_NULL(obj);
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(obj, ANJAY_ID_RID, 1));
+        anjay_output_ctx_t *array = anjay_ret_array_start(obj);
+        AVS_UNIT_ASSERT_NOT_NULL(array);
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_index(array, 0));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_i32(array, 5));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_index(array, 1));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_i32(array, 300));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_array_finish(array));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_id(obj, ANJAY_ID_RID, 2));
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ret_string(obj, "ab"));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_object_finish(obj));
+    }
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+
+    VERIFY_BYTES(
+            "\x08\x01\x0D" // instance 1
+            "\x87\x01" // array
+            "\x41\x00\x05" "\x42\x01\x01\x2C" // array entries
+            "\xC2\x02" "ab" // string resource
+            "\x08\x02\x0D" // instance 2
+            "\x87\x01"
+            "\x41\x00\x05" "\x42\x01\x01\x2C"
+            "\xC2\x02" "ab");
+}
+
 AVS_UNIT_TEST(tlv_out, object_with_empty_bytes) {
     TEST_ENV(512);
 
@@ -16,21 +16,20 @@
 
 #include <config.h>
 
-#include <ctype.h>
-#include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include <avsystem/commons/base64.h>
 #include <avsystem/commons/stream.h>
 
 #include <anjay/core.h>
 
 #include "../coap/content_format.h"
 #include "../utils_core.h"
+#include "base64_codec.h"
 #include "base64_out.h"
+#include "numbers.h"
 #include "vtable.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -59,92 +58,58 @@ static anjay_ret_bytes_ctx_t *text_ret_bytes_begin(anjay_output_ctx_t *ctx_,
     return ctx->bytes;
 }
 
-static int text_ret_string(anjay_output_ctx_t *ctx_, const char *value) {
-    text_out_t *ctx = (text_out_t *) ctx_;
+static int text_ret_chars(text_out_t *ctx, const char *value, size_t size) {
     if (ctx->bytes) {
         return -1;
     }
 
     int retval = -1;
     if (!ctx->finished
-            && !(retval = avs_stream_write(ctx->stream, value, strlen(value)))) {
+            && !(retval = avs_stream_write(ctx->stream, value, size))) {
         ctx->finished = true;
     }
     return retval;
 }
 
-static int text_ret_i32(anjay_output_ctx_t *ctx_, int32_t value) {
-    text_out_t *ctx = (text_out_t *) ctx_;
-    if (ctx->bytes) {
-        return -1;
-    }
-
-    int retval = -1;
-    if (!ctx->finished
-            && !(retval = avs_stream_write_f(ctx->stream, "%" PRId32, value))) {
-        ctx->finished = true;
-    }
-    return retval;
+static int text_ret_string(anjay_output_ctx_t *ctx, const char *value) {
+    return text_ret_chars((text_out_t *) ctx, value, strlen(value));
 }
 
-static int text_ret_i64(anjay_output_ctx_t *ctx_, int64_t value) {
-    text_out_t *ctx = (text_out_t *) ctx_;
-    if (ctx->bytes) {
-        return -1;
-    }
-
-    int retval = -1;
-    if (!ctx->finished
-            && !(retval = avs_stream_write_f(ctx->stream, "%" PRId64, value))) {
-        ctx->finished = true;
-    }
-    return retval;
+static int text_ret_i32(anjay_output_ctx_t *ctx, int32_t value) {
+    char buf[ANJAY_I64_STRING_SIZE];
+    return text_ret_chars((text_out_t *) ctx, buf,
+                          _anjay_i64_to_string(buf, value));
 }
 
-static inline int text_ret_floating_point(text_out_t *ctx, double value,
-                                          int precision) {
-    if (ctx->bytes) {
-        return -1;
-    }
-    int retval = -1;
-    // FIXME: The spec calls for a "decimal" representation, which, in my
-    // understanding, excludes exponential representation.
-    // As printing floating-point numbers in C as pure decimal with sane
-    // precision is tricky, let's take the spec a bit loosely for now.
-    if (!ctx->finished
-            && !(retval = avs_stream_write_f(ctx->stream, "%.*g",
-                                             precision, value))) {
-        ctx->finished = true;
-    }
-    return retval;
+static int text_ret_i64(anjay_output_ctx_t *ctx, int64_t value) {
+    char buf[ANJAY_I64_STRING_SIZE];
+    return text_ret_chars((text_out_t *) ctx, buf,
+                          _anjay_i64_to_string(buf, value));
 }
 
 static int text_ret_float(anjay_output_ctx_t *ctx, float value) {
-    return text_ret_floating_point((text_out_t *) ctx, value, 9);
+    char buf[ANJAY_FLOAT_STRING_SIZE];
+    return text_ret_chars((text_out_t *) ctx, buf,
+                          _anjay_float_to_string(buf, value));
 }
 
 static int text_ret_double(anjay_output_ctx_t *ctx, double value) {
-    return text_ret_floating_point((text_out_t *) ctx, value, 17);
+    char buf[ANJAY_DOUBLE_STRING_SIZE];
+    return text_ret_chars((text_out_t *) ctx, buf,
+                          _anjay_double_to_string(buf, value));
 }
 
 static int text_ret_bool(anjay_output_ctx_t *ctx, bool value) {
     return text_ret_i32(ctx, value);
 }
 
-static int text_ret_objlnk(anjay_output_ctx_t *ctx_,
+static int text_ret_objlnk(anjay_output_ctx_t *ctx,
                            anjay_oid_t oid, anjay_iid_t iid) {
-    text_out_t *ctx = (text_out_t *) ctx_;
-    if (ctx->bytes) {
-        return -1;
-    }
-    int retval = -1;
-    if (!ctx->finished
-            && !(retval = avs_stream_write_f(ctx->stream,
-                                             "%" PRIu16 ":%" PRIu16,
-                                             oid, iid))) {
-        ctx->finished = true;
-    }
-    return retval;
+    char buf[sizeof("65535:65535")];
+    size_t size = _anjay_i64_to_string(buf, oid);
+    buf[size++] = ':';
+    size += _anjay_i64_to_string(&buf[size], iid);
+    return text_ret_chars((text_out_t *) ctx, buf, size);
 }
 
 static int text_ret_close(anjay_output_ctx_t *ctx_) {
@@ -200,16 +165,18 @@ typedef struct {
     bool bytes_mode;
     uint8_t bytes_cached[3];
     size_t num_bytes_cached;
+    // base64 characters read from the stream that do not form a full quartet
+    char chars_cached[3];
+    size_t num_chars_cached;
     char msg_finished;
 } text_in_t;
 
-static int has_valid_padding(const char *buffer,
-                             size_t size,
-                             bool msg_finished) {
-    const char *last = buffer + size;
-    /* Note: buffer is size+1 in length. Last byte is a NULL terminator though. */
-    assert(!*last);
-    return last - 1 >= buffer && *(last - 1) == '=' && !msg_finished ? -1 : 0;
+#define TEXT_IN_CHUNK_SIZE (4 * 64u)
+
+static bool is_padding_misplaced(const char *encoded,
+                                 size_t size,
+                                 bool at_msg_end) {
+    return size > 0 && encoded[size - 1] == '=' && !at_msg_end;
 }
 
 static void text_get_some_bytes_cache_flush(text_in_t *ctx,
@@ -236,38 +203,62 @@ static int text_get_some_bytes(anjay_input_ctx_t *ctx_,
     *out_bytes_read = 0;
 
     text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
-    // 4bytes + null terminator
-    char encoded[5];
-    size_t stream_bytes_read;
-    char stream_msg_finished = 0;
-
-    while (buf_size > 0) {
-        if (avs_stream_read(ctx->stream, &stream_bytes_read, &stream_msg_finished,
-                            encoded, sizeof(encoded) - 1)) {
+    char encoded[TEXT_IN_CHUNK_SIZE];
+
+    while (buf_size > 0 && !ctx->msg_finished) {
+        // Never read more quartets than needed to fill the output buffer, so
+        // that at most one of them has to be decoded into bytes_cached.
+        size_t chars_wanted = AVS_MIN(sizeof(encoded),
+                                      4 * ((buf_size + 2) / 3));
+        size_t stream_bytes_read;
+        char stream_msg_finished = 0;
+        memcpy(encoded, ctx->chars_cached, ctx->num_chars_cached);
+        if (avs_stream_read(ctx->stream, &stream_bytes_read,
+                            &stream_msg_finished,
+                            &encoded[ctx->num_chars_cached],
+                            chars_wanted - ctx->num_chars_cached)) {
             return -1;
         }
-        encoded[stream_bytes_read] = '\0';
-        if (stream_bytes_read % 4) {
+        ctx->msg_finished = !!stream_msg_finished;
+
+        size_t encoded_size = ctx->num_chars_cached + stream_bytes_read;
+        size_t num_chars_left = encoded_size % 4;
+        if (num_chars_left && ctx->msg_finished) {
             return -1;
         }
-        if (has_valid_padding(encoded, stream_bytes_read,
-                              !!stream_msg_finished)) {
+        encoded_size -= num_chars_left;
+
+        size_t direct_size = AVS_MIN(encoded_size, 4 * (buf_size / 3));
+        if (is_padding_misplaced(encoded, direct_size,
+                                 direct_size == encoded_size
+                                         && ctx->msg_finished)
+                || is_padding_misplaced(encoded, encoded_size,
+                                        ctx->msg_finished)) {
             return -1;
         }
-        assert(ctx->num_bytes_cached == 0);
         ssize_t num_decoded =
-                avs_base64_decode_strict((uint8_t *) ctx->bytes_cached,
-                                         sizeof(ctx->bytes_cached), encoded);
+                _anjay_base64_decode_block(current, encoded, direct_size);
         if (num_decoded < 0) {
-            return (int) num_decoded;
+            return -1;
         }
-        ctx->num_bytes_cached = (size_t) num_decoded;
-        text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
-        if (stream_msg_finished) {
-            break;
+        current += num_decoded;
+        buf_size -= (size_t) num_decoded;
+
+        if (direct_size < encoded_size) {
+            assert(encoded_size - direct_size == 4);
+            assert(ctx->num_bytes_cached == 0);
+            num_decoded = _anjay_base64_decode_block(ctx->bytes_cached,
+                                                     &encoded[direct_size], 4);
+            if (num_decoded < 0) {
+                return -1;
+            }
+            ctx->num_bytes_cached = (size_t) num_decoded;
+            text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
         }
+
+        memcpy(ctx->chars_cached, &encoded[encoded_size], num_chars_left);
+        ctx->num_chars_cached = num_chars_left;
     }
-    ctx->msg_finished = !!stream_msg_finished;
     *out_msg_finished = ctx->msg_finished && !ctx->num_bytes_cached;
     *out_bytes_read = (size_t) (current - (uint8_t *) out_buf);
     return 0;
@@ -296,80 +287,54 @@ static int text_get_string(anjay_input_ctx_t *ctx,
     return message_finished ? 0 : ANJAY_BUFFER_TOO_SHORT;
 }
 
-#define DEF_GETNUM(Type, Bufsize, ...) \
-static int safe_strto##Type (const char *in, TYPE##Type *value) { \
-    char *endptr = NULL; \
-    if (!*in || isspace((unsigned char)*in)) { \
-        return -1; \
-    } \
-    errno = 0; \
-    TYPE##Type tmp = strto##Type (in, &endptr __VA_ARGS__); \
-    if (errno || !endptr || *endptr) { \
-        return -1; \
-    } \
-    *value = tmp; \
-    return 0; \
-} \
-\
+#define DEF_GETNUM(Type, Bufsize) \
 static int text_get_##Type (anjay_input_ctx_t *ctx, TYPE##Type *value) { \
     char buf[Bufsize]; \
     int retval = anjay_get_string(ctx, buf, sizeof(buf)); \
     if (retval) { \
         return retval; \
     } \
-    return safe_strto##Type (buf, value); \
+    return _anjay_safe_strto##Type (buf, value); \
 }
 
-#if LLONG_MAX == INT64_MAX
-#define TYPEll int64_t
-#else
 #define TYPEll long long
-#endif
-
 #define TYPEf float
 #define TYPEd double
 
-DEF_GETNUM(ll, 32,, 0)
-DEF_GETNUM(f, ANJAY_MAX_FLOAT_STRING_SIZE, )
-DEF_GETNUM(d, ANJAY_MAX_DOUBLE_STRING_SIZE, )
+DEF_GETNUM(ll, 32)
+DEF_GETNUM(f, ANJAY_MAX_FLOAT_STRING_SIZE)
+DEF_GETNUM(d, ANJAY_MAX_DOUBLE_STRING_SIZE)
 
-int _anjay_safe_strtoll(const char *in, long long *value) {
-    TYPEll out;
-    if (safe_strtoll(in, &out)) {
+static int text_get_i32(anjay_input_ctx_t *ctx, int32_t *value) {
+    long long ll_value;
+    int retval = text_get_ll(ctx, &ll_value);
+    if (retval) {
+        return retval;
+    }
+    if (ll_value < INT32_MIN || ll_value > INT32_MAX) {
         return -1;
     }
-    *value = (long long)out;
+    *value = (int32_t) ll_value;
     return 0;
 }
 
-int _anjay_safe_strtod(const char *in, double *value) {
-    return safe_strtod(in, value);
-}
-
-#define DEF_GETI(Bits) \
-static int text_get_i##Bits (anjay_input_ctx_t *ctx, int##Bits##_t *value) { \
-    TYPEll ll_value; \
-    int retval = text_get_ll(ctx, &ll_value); \
-    if (retval) { \
-        return retval; \
-    } \
-    if (ll_value < INT##Bits##_MIN || ll_value > INT##Bits##_MAX) { \
-        return -1; \
-    } \
-    *value = (int##Bits##_t) ll_value; \
-    return 0; \
-}
-
-#if LLONG_MAX == INT64_MAX
-#define text_get_i64 text_get_ll
-#else
-DEF_GETI(64)
+static int text_get_i64(anjay_input_ctx_t *ctx, int64_t *value) {
+    long long ll_value;
+    int retval = text_get_ll(ctx, &ll_value);
+    if (retval) {
+        return retval;
+    }
+#if LLONG_MAX != INT64_MAX
+    if (ll_value < INT64_MIN || ll_value > INT64_MAX) {
+        return -1;
+    }
 #endif
-
-DEF_GETI(32)
+    *value = (int64_t) ll_value;
+    return 0;
+}
 
 static int text_get_bool(anjay_input_ctx_t *ctx, bool *value) {
-    TYPEll ll_value;
+    long long ll_value;
     int retval = text_get_ll(ctx, &ll_value);
     if (retval) {
         return retval;
@@ -398,9 +363,9 @@ static int text_get_objlnk(anjay_input_ctx_t *ctx,
         return -1;
     }
     *colon = '\0';
-    TYPEll oid, iid;
-    if (!(retval = (safe_strtoll(buf, &oid)
-            || safe_strtoll(colon + 1, &iid)) ? -1 : 0)) {
+    long long oid, iid;
+    if (!(retval = (_anjay_safe_strtoll(buf, &oid)
+            || _anjay_safe_strtoll(colon + 1, &iid)) ? -1 : 0)) {
         if (oid >= 0 && oid <= UINT16_MAX
                 && iid >= 0 && iid <= UINT16_MAX) {
             *out_oid = (anjay_oid_t) oid;
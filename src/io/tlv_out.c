@@ -17,9 +17,10 @@
 #include <config.h>
 
 #include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-#include <avsystem/commons/list.h>
 #include <avsystem/commons/stream.h>
 #include <avsystem/commons/utils.h>
 
@@ -35,12 +36,6 @@ typedef struct {
     int32_t id;
 } tlv_id_t;
 
-typedef struct {
-    size_t data_length;
-    tlv_id_t id;
-    char data[];
-} tlv_entry_t;
-
 typedef struct {
     const anjay_ret_bytes_ctx_vtable_t *vtable;
     char *out_ptr;
@@ -63,18 +58,39 @@ typedef union {
     tlv_null_bytes_t null;
 } tlv_bytes_t;
 
+/**
+ * Growable buffer shared by all nested contexts of a single TLV output tree.
+ * Nested entries are encoded in place, so that no per-entry allocations are
+ * necessary.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} tlv_arena_t;
+
 typedef struct tlv_out_struct {
     const anjay_output_ctx_vtable_t *vtable;
     int *errno_ptr;
     struct tlv_out_struct *parent;
     anjay_output_ctx_t *slave;
-    AVS_LIST(tlv_entry_t) entries;
-    AVS_LIST(tlv_entry_t) *next_entry_ptr;
+    // top-level context that owns the arena and the spare contexts
+    struct tlv_out_struct *root;
+    // offset in root->arena at which contents of this nested context start
+    size_t arena_offset;
     avs_stream_abstract_t *stream;
     tlv_id_t next_id;
     tlv_bytes_t bytes_ctx;
+
+    // the fields below are only used in the root context
+    tlv_arena_t arena;
+    // nested contexts that are no longer in use, kept for reuse
+    struct tlv_out_struct *spare_slaves;
 } tlv_out_t;
 
+// 1 byte of type field, up to 2 bytes of ID and up to 3 bytes of length
+#define TLV_MAX_HEADER_SIZE 6
+
 static int *tlv_errno_ptr(anjay_output_ctx_t *ctx) {
     return ((tlv_out_t *) ctx)->errno_ptr;
 }
@@ -95,15 +111,12 @@ static inline uint8_t typefield_length(uint32_t length) {
     }
 }
 
-static int write_shortened_u32(avs_stream_abstract_t *stream, uint32_t value) {
+static void encode_shortened_u32(char **out_ptr, uint32_t value) {
     uint8_t length = u32_length(value);
     assert(length <= 4);
-    union {
-        uint32_t uval;
-        char tab[4];
-    } value32;
-    value32.uval = avs_convert_be32(value);
-    return avs_stream_write(stream, value32.tab + (4 - length), length);
+    while (length--) {
+        *(*out_ptr)++ = (char) (uint8_t) (value >> (8 * length));
+    }
 }
 
 static size_t header_size(uint16_t id, size_t length) {
@@ -112,24 +125,59 @@ static size_t header_size(uint16_t id, size_t length) {
             ((length > 7) ? (size_t) u32_length((uint32_t) length) : 0);
 }
 
-static int write_header(avs_stream_abstract_t *stream,
-                        const tlv_id_t *id,
-                        size_t length) {
+/**
+ * Encodes a TLV header into @p out, which shall be at least
+ * TLV_MAX_HEADER_SIZE bytes long. Returns the number of bytes written, or 0 if
+ * the header cannot be represented.
+ */
+static size_t encode_header(char *out, const tlv_id_t *id, size_t length) {
     if (id->id != (uint16_t) id->id || length >> 24) {
-        return -1;
+        return 0;
     }
-    uint8_t typefield = (uint8_t) (
+    char *ptr = out;
+    *ptr++ = (char) (uint8_t) (
             ((id->type & 3) << 6) |
             ((id->id > UINT8_MAX) ? 0x20 : 0) |
             typefield_length((uint32_t) length));
-    int retval = avs_stream_write(stream, &typefield, 1);
-    if (!retval) {
-        retval = write_shortened_u32(stream, (uint16_t) id->id);
+    encode_shortened_u32(&ptr, (uint16_t) id->id);
+    if (length > 7) {
+        encode_shortened_u32(&ptr, (uint32_t) length);
     }
-    if (!retval && length > 7) {
-        retval = write_shortened_u32(stream, (uint32_t) length);
+    assert((size_t) (ptr - out) == header_size((uint16_t) id->id, length));
+    return (size_t) (ptr - out);
+}
+
+static int write_header(avs_stream_abstract_t *stream,
+                        const tlv_id_t *id,
+                        size_t length) {
+    char header[TLV_MAX_HEADER_SIZE];
+    size_t size = encode_header(header, id, length);
+    if (!size) {
+        return -1;
     }
-    return retval;
+    return avs_stream_write(stream, header, size);
+}
+
+static int arena_reserve(tlv_arena_t *arena, size_t additional_size) {
+    if (additional_size > SIZE_MAX - arena->size) {
+        return -1;
+    }
+    size_t required = arena->size + additional_size;
+    if (required <= arena->capacity) {
+        return 0;
+    }
+    size_t new_capacity = arena->capacity ? arena->capacity : 256;
+    while (new_capacity < required) {
+        new_capacity = (new_capacity > SIZE_MAX / 2) ? required
+                                                     : 2 * new_capacity;
+    }
+    char *new_data = (char *) realloc(arena->data, new_capacity);
+    if (!new_data) {
+        return -1;
+    }
+    arena->data = new_data;
+    arena->capacity = new_capacity;
+    return 0;
 }
 
 static inline int ensure_valid_for_value(tlv_out_t *ctx) {
@@ -139,29 +187,20 @@ static inline int ensure_valid_for_value(tlv_out_t *ctx) {
             || ctx->next_id.id < 0) ? -1 : 0;
 }
 
-static int write_entry(avs_stream_abstract_t *stream,
-                       const tlv_id_t *id,
-                       const void *buf,
-                       size_t length) {
-    int retval = write_header(stream, id, length);
-    if (!retval) {
-        retval = avs_stream_write(stream, buf, length);
-    }
-    return retval;
-}
-
 static char *add_buffered_entry(tlv_out_t *ctx, size_t length) {
-    tlv_entry_t *new_entry = (tlv_entry_t *)
-            AVS_LIST_NEW_BUFFER(sizeof(tlv_entry_t) + length);
-    if (!new_entry) {
+    tlv_arena_t *arena = &ctx->root->arena;
+    if (arena_reserve(arena, TLV_MAX_HEADER_SIZE + length)) {
+        return NULL;
+    }
+    size_t header_length =
+            encode_header(arena->data + arena->size, &ctx->next_id, length);
+    if (!header_length) {
         return NULL;
     }
-    new_entry->data_length = length;
-    new_entry->id = ctx->next_id;
     ctx->next_id.id = -1;
-    *ctx->next_entry_ptr = new_entry;
-    ctx->next_entry_ptr = AVS_LIST_NEXT_PTR(ctx->next_entry_ptr);
-    return new_entry->data;
+    char *data = arena->data + arena->size + header_length;
+    arena->size += header_length + length;
+    return data;
 }
 
 static int streamed_bytes_append(anjay_ret_bytes_ctx_t *ctx_,
@@ -293,39 +332,51 @@ static anjay_output_ctx_t *tlv_slave_start(tlv_out_t *ctx,
                                            tlv_id_type_t new_type,
                                            tlv_id_type_t inner_type);
 
-static int tlv_slave_finish(tlv_out_t *ctx, tlv_id_type_t next_id_type) {
-    if (!ctx->parent) {
+static void release_slave(tlv_out_t *slave);
+
+/**
+ * Wraps contents of a finished nested context, already encoded in the arena,
+ * into a single entry of its parent.
+ */
+static int add_slave_entry(tlv_out_t *ctx) {
+    tlv_out_t *parent = ctx->parent;
+    tlv_arena_t *arena = &ctx->root->arena;
+    assert(arena->size >= ctx->arena_offset);
+    size_t length = arena->size - ctx->arena_offset;
+    if (length >> 24 || parent->bytes_ctx.null.vtable) {
         return -1;
     }
-    size_t data_size = 0;
-    {
-        tlv_entry_t *entry = NULL;
-        AVS_LIST_FOREACH(entry, ctx->entries) {
-            data_size += header_size((uint16_t) entry->id.id,
-                                     entry->data_length) +
-                    entry->data_length;
+    int retval = -1;
+    if (parent->stream) {
+        if (!(retval = write_header(parent->stream, &parent->next_id, length))) {
+            retval = avs_stream_write(parent->stream,
+                                      arena->data + ctx->arena_offset, length);
         }
-    }
-    char *buffer = (char *) (data_size ? malloc(data_size) : NULL);
-    int retval = ((!data_size || buffer) ? 0 : -1);
-    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
-    avs_stream_outbuf_set_buffer(&outbuf, buffer, data_size);
-    AVS_LIST_CLEAR(&ctx->entries) {
-        if (!retval) {
-            retval = write_entry((avs_stream_abstract_t *) &outbuf,
-                                 &ctx->entries->id,
-                                 ctx->entries->data,
-                                 ctx->entries->data_length);
+        arena->size = ctx->arena_offset;
+    } else if (parent->parent) {
+        char header[TLV_MAX_HEADER_SIZE];
+        size_t header_length = encode_header(header, &parent->next_id, length);
+        if (header_length && !arena_reserve(arena, header_length)) {
+            char *contents = arena->data + ctx->arena_offset;
+            memmove(contents + header_length, contents, length);
+            memcpy(contents, header, header_length);
+            arena->size += header_length;
+            retval = 0;
         }
     }
-    if (!retval) {
-        size_t length = avs_stream_outbuf_offset(&outbuf);
-        anjay_ret_bytes_ctx_t *bytes = add_entry(ctx->parent, length);
-        retval = !bytes ? -1 : anjay_ret_bytes_append(bytes, buffer, length);
+    parent->next_id.id = -1;
+    return retval;
+}
+
+static int tlv_slave_finish(tlv_out_t *ctx, tlv_id_type_t next_id_type) {
+    if (!ctx->parent) {
+        return -1;
     }
-    free(buffer);
+    int retval = add_slave_entry(ctx);
+    // contents are now owned by the parent, so they must not be discarded
+    ctx->arena_offset = ctx->root->arena.size;
     ctx->parent->next_id.type = next_id_type;
-    _anjay_output_ctx_destroy((anjay_output_ctx_t **) &ctx);
+    release_slave(ctx);
     return retval;
 }
 
@@ -382,13 +433,33 @@ static int tlv_set_id(anjay_output_ctx_t *ctx_,
 
 static int tlv_output_close(anjay_output_ctx_t *ctx_) {
     tlv_out_t *ctx = (tlv_out_t *) ctx_;
-    AVS_LIST_CLEAR(&ctx->entries);
-    int retval = _anjay_output_ctx_destroy(&ctx->slave);
+    if (ctx->slave) {
+        release_slave((tlv_out_t *) ctx->slave);
+    }
     if (ctx->parent) {
+        // discard any unfinished contents
+        if (ctx->root->arena.size > ctx->arena_offset) {
+            ctx->root->arena.size = ctx->arena_offset;
+        }
         ctx->parent->next_id.id = -1;
         ctx->parent->slave = NULL;
+    } else {
+        free(ctx->arena.data);
+        memset(&ctx->arena, 0, sizeof(ctx->arena));
+        while (ctx->spare_slaves) {
+            tlv_out_t *spare = ctx->spare_slaves;
+            ctx->spare_slaves = spare->spare_slaves;
+            free(spare);
+        }
     }
-    return retval;
+    return 0;
+}
+
+static void release_slave(tlv_out_t *slave) {
+    tlv_out_t *root = slave->root;
+    tlv_output_close((anjay_output_ctx_t *) slave);
+    slave->spare_slaves = root->spare_slaves;
+    root->spare_slaves = slave;
 }
 
 static const anjay_output_ctx_vtable_t TLV_OUT_VTABLE = {
@@ -413,17 +484,25 @@ static anjay_output_ctx_t *tlv_slave_start(tlv_out_t *ctx,
                                            tlv_id_type_t expected_type,
                                            tlv_id_type_t new_type,
                                            tlv_id_type_t inner_type) {
-    tlv_out_t *object = NULL;
+    // bytes_ctx check: pending buffered data may point into the arena
     if (ctx->slave
+            || ctx->bytes_ctx.null.vtable
             || ctx->next_id.type != expected_type
-            || ctx->next_id.id < 0
-            || !(object = (tlv_out_t *) calloc(1, sizeof(tlv_out_t)))) {
+            || ctx->next_id.id < 0) {
+        return NULL;
+    }
+    tlv_out_t *object = ctx->root->spare_slaves;
+    if (object) {
+        ctx->root->spare_slaves = object->spare_slaves;
+        memset(object, 0, sizeof(*object));
+    } else if (!(object = (tlv_out_t *) calloc(1, sizeof(tlv_out_t)))) {
         return NULL;
     }
     object->vtable = &TLV_OUT_VTABLE;
     object->errno_ptr = ctx->errno_ptr;
     object->parent = ctx;
-    object->next_entry_ptr = &object->entries;
+    object->root = ctx->root;
+    object->arena_offset = ctx->root->arena.size;
     object->next_id.type = inner_type;
     object->next_id.id = -1;
     ctx->next_id.type = new_type;
@@ -437,7 +516,7 @@ _anjay_output_raw_tlv_create(avs_stream_abstract_t *stream) {
     if (ctx) {
         ctx->vtable = &TLV_OUT_VTABLE;
         ctx->errno_ptr = NULL;
-        ctx->next_entry_ptr = &ctx->entries;
+        ctx->root = ctx;
         ctx->stream = stream;
         ctx->next_id.id = -1;
     }
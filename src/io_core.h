@@ -82,6 +82,10 @@ _anjay_output_tlv_create(avs_stream_abstract_t *stream,
                          anjay_msg_details_t *inout_details);
 
 #ifdef WITH_JSON
+anjay_output_ctx_t *
+_anjay_output_raw_json_create(avs_stream_abstract_t *stream,
+                              const anjay_uri_path_t *uri);
+
 anjay_output_ctx_t *
 _anjay_output_json_create(avs_stream_abstract_t *stream,
                           int *errno_ptr,
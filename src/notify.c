@@ -16,6 +16,8 @@
 
 #include <config.h>
 
+#include <stdlib.h>
+
 #include <anjay_modules/dm_utils.h>
 #include <anjay_modules/notify.h>
 
@@ -23,6 +25,7 @@
 
 #include "anjay_core.h"
 #include "observe_core.h"
+#include "interface/register.h"
 
 VISIBILITY_SOURCE_BEGIN
 
@@ -117,14 +120,17 @@ int _anjay_notify_perform(anjay_t *anjay,
     int ret = 0;
     AVS_LIST(anjay_notify_queue_object_entry_t) it;
     AVS_LIST_FOREACH(it, queue) {
-        if (it->oid > 1) {
+        if (it->oid > ANJAY_DM_OID_ACCESS_CONTROL) {
             break;
         } else if (it->oid == ANJAY_DM_OID_SECURITY) {
             _anjay_update_ret(&ret, security_modified_notify(anjay, it));
         } else if (it->oid == ANJAY_DM_OID_SERVER) {
             _anjay_update_ret(&ret, server_modified_notify(anjay, it));
+        } else if (it->oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+            _anjay_access_control_cache_invalidate(anjay);
         }
     }
+    _anjay_register_dm_cache_refresh(anjay, queue);
     _anjay_update_ret(&ret, observe_notify(anjay, queue));
     AVS_LIST(anjay_dm_installed_module_t) module;
     AVS_LIST_FOREACH(module, anjay->dm.modules) {
@@ -164,16 +170,27 @@ find_or_create_object_entry(anjay_notify_queue_t *out_queue,
 }
 
 static int add_entry_to_iid_set(AVS_LIST(anjay_iid_t) *iid_set_ptr,
+                                anjay_iid_t **last_ptr,
                                 anjay_iid_t iid) {
-    AVS_LIST_ITERATE_PTR(iid_set_ptr) {
-        if (**iid_set_ptr == iid) {
-            return 0;
-        } else if (**iid_set_ptr > iid) {
-            break;
+    if (*last_ptr && **last_ptr == iid) {
+        return 0;
+    } else if (*last_ptr && **last_ptr < iid) {
+        // fast path: IIDs are usually reported in ascending order
+        iid_set_ptr = AVS_LIST_NEXT_PTR(last_ptr);
+    } else {
+        AVS_LIST_ITERATE_PTR(iid_set_ptr) {
+            if (**iid_set_ptr == iid) {
+                return 0;
+            } else if (**iid_set_ptr > iid) {
+                break;
+            }
         }
     }
     if (AVS_LIST_INSERT_NEW(anjay_iid_t, iid_set_ptr)) {
         **iid_set_ptr = iid;
+        if (!AVS_LIST_NEXT(*iid_set_ptr)) {
+            *last_ptr = *iid_set_ptr;
+        }
         return 0;
     } else {
         return -1;
@@ -181,14 +198,23 @@ static int add_entry_to_iid_set(AVS_LIST(anjay_iid_t) *iid_set_ptr,
 }
 
 static void remove_entry_from_iid_set(AVS_LIST(anjay_iid_t) *iid_set_ptr,
+                                      anjay_iid_t **last_ptr,
                                       anjay_iid_t iid) {
+    if (!*last_ptr || **last_ptr < iid) {
+        return;
+    }
+    anjay_iid_t *previous = NULL;
     AVS_LIST_ITERATE_PTR(iid_set_ptr) {
         if (**iid_set_ptr >= iid) {
             if (**iid_set_ptr == iid) {
+                if (*iid_set_ptr == *last_ptr) {
+                    *last_ptr = previous;
+                }
                 AVS_LIST_DELETE(iid_set_ptr);
             }
             return;
         }
+        previous = *iid_set_ptr;
     }
 }
 
@@ -216,15 +242,17 @@ int _anjay_notify_queue_instance_created(anjay_notify_queue_t *out_queue,
         anjay_log(ERROR, "Out of memory");
         return -1;
     }
-    if (add_entry_to_iid_set(
-            &(*entry_ptr)->instance_set_changes.known_added_iids, iid)) {
+    anjay_notify_queue_instance_entry_t *changes =
+            &(*entry_ptr)->instance_set_changes;
+    if (add_entry_to_iid_set(&changes->known_added_iids,
+                             &changes->known_added_iids_last, iid)) {
         anjay_log(ERROR, "Out of memory");
         delete_notify_queue_object_entry_if_empty(entry_ptr);
         return -1;
     }
-    remove_entry_from_iid_set(
-            &(*entry_ptr)->instance_set_changes.known_removed_iids, iid);
-    (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    remove_entry_from_iid_set(&changes->known_removed_iids,
+                              &changes->known_removed_iids_last, iid);
+    changes->instance_set_changed = true;
     return 0;
 }
 
@@ -237,15 +265,17 @@ int _anjay_notify_queue_instance_removed(anjay_notify_queue_t *out_queue,
         anjay_log(ERROR, "Out of memory");
         return -1;
     }
-    if (add_entry_to_iid_set(
-            &(*entry_ptr)->instance_set_changes.known_removed_iids, iid)) {
+    anjay_notify_queue_instance_entry_t *changes =
+            &(*entry_ptr)->instance_set_changes;
+    if (add_entry_to_iid_set(&changes->known_removed_iids,
+                             &changes->known_removed_iids_last, iid)) {
         anjay_log(ERROR, "Out of memory");
         delete_notify_queue_object_entry_if_empty(entry_ptr);
         return -1;
     }
-    remove_entry_from_iid_set(
-            &(*entry_ptr)->instance_set_changes.known_added_iids, iid);
-    (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    remove_entry_from_iid_set(&changes->known_added_iids,
+                              &changes->known_added_iids_last, iid);
+    changes->instance_set_changed = true;
     return 0;
 }
 
@@ -282,31 +312,78 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
         anjay_log(ERROR, "Out of memory");
         return -1;
     }
+    anjay_notify_queue_object_entry_t *obj_entry = *obj_entry_ptr;
     anjay_notify_queue_resource_entry_t new_entry = {
         .iid = iid,
         .rid = rid
     };
     AVS_LIST(anjay_notify_queue_resource_entry_t) *res_entry_ptr;
-    AVS_LIST_FOREACH_PTR(res_entry_ptr, &(*obj_entry_ptr)->resources_changed) {
-        int compare = compare_resource_entries(*res_entry_ptr, &new_entry);
-        if (compare == 0) {
-            return 0;
-        } else if (compare > 0) {
-            break;
+    int compare = -1;
+    if (obj_entry->resources_changed_last) {
+        compare = compare_resource_entries(obj_entry->resources_changed_last,
+                                           &new_entry);
+    }
+    if (compare == 0) {
+        return 0;
+    } else if (compare < 0) {
+        // fast path: bulk operations usually report changes in order
+        res_entry_ptr = obj_entry->resources_changed_last
+                ? AVS_LIST_NEXT_PTR(&obj_entry->resources_changed_last)
+                : &obj_entry->resources_changed;
+    } else {
+        AVS_LIST_FOREACH_PTR(res_entry_ptr, &obj_entry->resources_changed) {
+            compare = compare_resource_entries(*res_entry_ptr, &new_entry);
+            if (compare == 0) {
+                return 0;
+            } else if (compare > 0) {
+                break;
+            }
         }
     }
     if (!AVS_LIST_INSERT_NEW(anjay_notify_queue_resource_entry_t, res_entry_ptr)) {
         anjay_log(ERROR, "Out of memory");
-        if (!(*obj_entry_ptr)->instance_set_changes.instance_set_changed
-                && !(*obj_entry_ptr)->resources_changed) {
+        if (!obj_entry->instance_set_changes.instance_set_changed
+                && !obj_entry->resources_changed) {
             AVS_LIST_DELETE(obj_entry_ptr);
         }
         return -1;
     }
     **res_entry_ptr = new_entry;
+    if (!AVS_LIST_NEXT(*res_entry_ptr)) {
+        obj_entry->resources_changed_last = *res_entry_ptr;
+    }
     return 0;
 }
 
+void _anjay_notify_queue_remove_instance_resources(
+        anjay_notify_queue_t *queue, anjay_oid_t oid, anjay_iid_t iid) {
+    AVS_LIST(anjay_notify_queue_object_entry_t) *obj_it;
+    AVS_LIST_FOREACH_PTR(obj_it, queue) {
+        if ((*obj_it)->oid > oid) {
+            return;
+        } else if ((*obj_it)->oid == oid) {
+            break;
+        }
+    }
+    if (!*obj_it) {
+        return;
+    }
+    AVS_LIST(anjay_notify_queue_resource_entry_t) *res_it;
+    AVS_LIST_FOREACH_PTR(res_it, &(*obj_it)->resources_changed) {
+        if ((*res_it)->iid >= iid) {
+            break;
+        }
+    }
+    if (!*res_it || (*res_it)->iid != iid) {
+        return;
+    }
+    while (*res_it && (*res_it)->iid == iid) {
+        AVS_LIST_DELETE(res_it);
+    }
+    (*obj_it)->resources_changed_last =
+            AVS_LIST_TAIL((*obj_it)->resources_changed);
+}
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue) {
     AVS_LIST_CLEAR(out_queue) {
         AVS_LIST_CLEAR(&(*out_queue)->instance_set_changes.known_added_iids);
@@ -356,3 +433,129 @@ int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid) {
             || (retval = reschedule_notify(anjay)));
     return retval;
 }
+
+#ifdef WITH_THREAD_SAFE_NOTIFY
+struct anjay_pending_change_struct {
+    anjay_pending_change_t *next;
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+};
+
+static anjay_pending_change_t *take_pending(anjay_t *anjay) {
+    return __atomic_exchange_n(&anjay->scheduled_notify.pending, NULL,
+                               __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Pushes a chain of changes, from @p first to @p last linked through the next
+ * pointers, onto the pending stack.
+ *
+ * @returns true if the stack was empty before.
+ */
+static bool push_pending(anjay_t *anjay,
+                         anjay_pending_change_t *first,
+                         anjay_pending_change_t *last) {
+    anjay_pending_change_t *head =
+            __atomic_load_n(&anjay->scheduled_notify.pending,
+                            __ATOMIC_RELAXED);
+    do {
+        last->next = head;
+    } while (!__atomic_compare_exchange_n(&anjay->scheduled_notify.pending,
+                                          &head, first, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return !head;
+}
+
+void _anjay_notify_pending_cleanup(anjay_t *anjay) {
+    anjay_pending_change_t *change = take_pending(anjay);
+    while (change) {
+        anjay_pending_change_t *next = change->next;
+        free(change);
+        change = next;
+    }
+}
+
+bool _anjay_notify_pending_empty(anjay_t *anjay) {
+    return !__atomic_load_n(&anjay->scheduled_notify.pending,
+                            __ATOMIC_RELAXED);
+}
+
+#ifdef ANJAY_TEST
+#include "test/notify_mock.h"
+#endif // ANJAY_TEST
+
+int _anjay_notify_pending_drain(anjay_t *anjay) {
+    anjay_pending_change_t *change = take_pending(anjay);
+    if (!change) {
+        return 0;
+    }
+    int ret = 0;
+    anjay_pending_change_t *failed_first = NULL;
+    anjay_pending_change_t *failed_last = NULL;
+    while (change) {
+        anjay_pending_change_t *next = change->next;
+        // the queue is sorted and deduplicated, so the order of the stack does
+        // not matter
+        int result = _anjay_notify_queue_resource_change(
+                &anjay->scheduled_notify.queue,
+                change->oid, change->iid, change->rid);
+        if (result) {
+            _anjay_update_ret(&ret, result);
+            // keep the change, so that it is retried on the next drain
+            change->next = failed_first;
+            failed_first = change;
+            if (!failed_last) {
+                failed_last = change;
+            }
+        } else {
+            free(change);
+        }
+        change = next;
+    }
+    if (failed_first) {
+        push_pending(anjay, failed_first, failed_last);
+    }
+    _anjay_update_ret(&ret, reschedule_notify(anjay));
+    return ret;
+}
+
+int anjay_notify_changed_threadsafe(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid) {
+    // NOTE: this is called from arbitrary threads, so it must not log - log
+    // handlers are not required to be thread-safe
+    anjay_pending_change_t *change =
+            (anjay_pending_change_t *) malloc(sizeof(*change));
+    if (!change) {
+        return -1;
+    }
+    change->oid = oid;
+    change->iid = iid;
+    change->rid = rid;
+
+    if (push_pending(anjay, change, change)
+            && anjay->scheduled_notify.wakeup_cb) {
+        // the queue was empty, so nothing has woken the event loop yet
+        anjay->scheduled_notify.wakeup_cb(anjay->scheduled_notify.wakeup_arg);
+    }
+    return 0;
+}
+#else // WITH_THREAD_SAFE_NOTIFY
+int anjay_notify_changed_threadsafe(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid) {
+    (void) anjay;
+    (void) oid;
+    (void) iid;
+    (void) rid;
+    // not logging, as this may be called from any thread
+    return -1;
+}
+#endif // WITH_THREAD_SAFE_NOTIFY
+
+#ifdef ANJAY_TEST
+#include "test/notify.c"
+#endif // ANJAY_TEST
@@ -17,45 +17,86 @@
 #include <config.h>
 
 #include <math.h>
-
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <avsystem/commons/coap/ctx.h>
+#include <avsystem/commons/coap/tx_params.h>
+#include <avsystem/commons/stream/stream_net.h>
 #include <avsystem/commons/stream_v_table.h>
 
 #include <anjay_modules/time_defs.h>
 
 #include "coap/content_format.h"
 
+#include "access_control_utils.h"
 #include "anjay_core.h"
 #include "dm/query.h"
 #include "observe_core.h"
 
 VISIBILITY_SOURCE_BEGIN
 
+#ifdef WITH_NET_STATS
+#define observe_stat_inc(anjay, stat) ((void) ++(anjay)->observe.stat)
+#else
+#define observe_stat_inc(anjay, stat) ((void) 0)
+#endif // WITH_NET_STATS
+
 struct anjay_observe_entry_struct {
     const anjay_observe_key_t key;
     anjay_sched_handle_t notify_task;
     avs_time_real_t last_confirmable;
 
-    // last_sent has ALWAYS EXACTLY one element,
-    // but is stored as a list to allow easy moving from unsent
-    AVS_LIST(anjay_observe_resource_value_t) last_sent;
-
-    // pointer to some element of the
-    // anjay_observe_connection_entry_t::unsent list
-    // may or may not be the same as
-    // anjay_observe_connection_entry_t::unsent_last
-    // (depending on whether the last unsent value in the server refers
-    // to this resource+format or not)
-    AVS_LIST(anjay_observe_resource_value_t) last_unsent;
+    // last_sent is ALWAYS set
+    anjay_observe_resource_value_t *last_sent;
+
+    // pointer to the newest value in the
+    // anjay_observe_connection_entry_t::unsent queue that refers to this
+    // resource+format, or NULL if there is none
+    anjay_observe_resource_value_t *last_unsent;
+
+    // version of the Resource, as reported by the resource_version handler,
+    // at the time the newest value was read
+    uint64_t value_version;
+    bool value_version_valid;
 };
 
+// Unsent values are stored in a per-connection circular array of records,
+// allocated on first use. The payloads they refer to are shared, but each
+// record is charged for its own size plus the size of its payload against the
+// anjay_observe_state_t::stored_notifications_buffer_size limit. Records
+// removed from the middle of the queue are only marked as dead, by setting ref
+// to NULL, and their slots are reclaimed once they reach the head of the queue.
+typedef struct {
+    anjay_observe_resource_value_t *records;
+    size_t capacity;
+    size_t head;
+    // number of slots in use, including dead records
+    size_t used;
+    // number and total charge of live records
+    size_t count;
+    size_t bytes;
+} unsent_queue_t;
+
+// Confirmable notification sent in the pipelined mode, i.e. with nonzero
+// anjay_observe_state_t::max_notifications_in_flight, awaiting an ACK
+typedef struct {
+    anjay_observe_connection_entry_t *conn;
+    anjay_observe_key_t key;
+    avs_coap_msg_t *request;
+    avs_coap_retry_state_t retry_state;
+    anjay_sched_handle_t retransmit_task;
+} observe_in_flight_t;
+
 struct anjay_observe_connection_entry_struct {
     anjay_connection_key_t key;
     AVS_RBTREE(anjay_observe_entry_t) entries;
     anjay_sched_handle_t flush_task;
+    AVS_LIST(observe_in_flight_t) in_flight;
 
-    AVS_LIST(anjay_observe_resource_value_t) unsent;
-    // pointer to the last element of unsent
-    AVS_LIST(anjay_observe_resource_value_t) unsent_last;
+    unsent_queue_t unsent;
 };
 
 static inline const anjay_observe_entry_t *
@@ -110,31 +151,300 @@ static int entry_cmp(const void *left, const void *right) {
                          &((const anjay_observe_entry_t *) right)->key);
 }
 
-int _anjay_observe_init(anjay_t *anjay, bool confirmable_notifications) {
+#define PAYLOAD_POOL_MIN_BLOCK_SIZE 64
+
+/**
+ * @returns Size class of blocks able to hold @p block_size bytes, or
+ *          ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES if such blocks are too large to
+ *          be pooled. @p out_class_size is set to the actual size of the block
+ *          to allocate.
+ */
+static size_t payload_pool_class(size_t block_size, size_t *out_class_size) {
+    size_t size_class = 0;
+    size_t class_size = PAYLOAD_POOL_MIN_BLOCK_SIZE;
+    while (class_size < block_size
+            && size_class < ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES) {
+        class_size *= 2;
+        ++size_class;
+    }
+    *out_class_size = (size_class < ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES)
+            ? class_size : block_size;
+    return size_class;
+}
+
+static void *payload_pool_get(anjay_observe_payload_pool_t *pool,
+                              size_t block_size) {
+    size_t class_size;
+    size_t size_class = payload_pool_class(block_size, &class_size);
+    if (size_class < ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES
+            && pool->free_blocks[size_class]) {
+        void *block = pool->free_blocks[size_class];
+        pool->free_blocks[size_class] = *(void **) block;
+        pool->free_bytes -= class_size;
+        return block;
+    }
+    return malloc(class_size);
+}
+
+static void payload_pool_put(anjay_observe_payload_pool_t *pool,
+                             void *block,
+                             size_t block_size) {
+    size_t class_size;
+    size_t size_class = payload_pool_class(block_size, &class_size);
+    if (size_class < ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES
+            && pool->free_bytes + class_size <= pool->max_free_bytes) {
+        *(void **) block = pool->free_blocks[size_class];
+        pool->free_blocks[size_class] = block;
+        pool->free_bytes += class_size;
+    } else {
+        free(block);
+    }
+}
+
+static void payload_pool_cleanup(anjay_observe_payload_pool_t *pool) {
+    for (size_t i = 0; i < ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES; ++i) {
+        while (pool->free_blocks[i]) {
+            void *block = pool->free_blocks[i];
+            pool->free_blocks[i] = *(void **) block;
+            free(block);
+        }
+    }
+    pool->free_bytes = 0;
+}
+
+static size_t payload_block_size(size_t data_size) {
+    return offsetof(anjay_observe_payload_t, data) + data_size;
+}
+
+/**
+ * Creates a payload of @p size bytes and the given @p hash. If @p data is
+ * NULL, the payload only identifies the value and does not hold it.
+ */
+static anjay_observe_payload_t *
+payload_new_hashed(anjay_observe_payload_pool_t *pool,
+                   const void *data, size_t size, uint64_t hash) {
+    if (!size) {
+        return NULL;
+    }
+    const size_t data_size = data ? size : 0;
+    anjay_observe_payload_t *payload = (anjay_observe_payload_t *)
+            payload_pool_get(pool, payload_block_size(data_size));
+    if (payload) {
+        payload->pool = pool;
+        payload->refcount = 1;
+        payload->size = size;
+        payload->hash = hash;
+        payload->hashed_only = !data;
+        if (data) {
+            memcpy(payload->data, data, size);
+        }
+    }
+    return payload;
+}
+
+static anjay_observe_payload_t *
+payload_new(anjay_observe_payload_pool_t *pool, const void *data, size_t size) {
+    return payload_new_hashed(pool, data, size,
+                              _anjay_fnv1a_64_update(
+                                      ANJAY_FNV1A_64_OFFSET_BASIS, data, size));
+}
+
+static anjay_observe_payload_t *
+payload_acquire(anjay_observe_payload_t *payload) {
+    if (payload) {
+        ++payload->refcount;
+    }
+    return payload;
+}
+
+static void payload_release(anjay_observe_payload_t **payload_ptr) {
+    if (*payload_ptr && !--(*payload_ptr)->refcount) {
+        anjay_observe_payload_t *payload = *payload_ptr;
+        payload_pool_put(payload->pool, payload,
+                         payload_block_size(payload->hashed_only
+                                                    ? 0 : payload->size));
+    }
+    *payload_ptr = NULL;
+}
+
+/**
+ * @returns Number of bytes of the value actually held in @p payload.
+ */
+static inline size_t payload_size(const anjay_observe_payload_t *payload) {
+    return (payload && !payload->hashed_only) ? payload->size : 0;
+}
+
+static inline bool is_hashed_only(const anjay_observe_payload_t *payload) {
+    return payload && payload->hashed_only;
+}
+
+static inline const char *payload_data(const anjay_observe_payload_t *payload) {
+    return payload_size(payload) ? payload->data : NULL;
+}
+
+/**
+ * Checks whether @p payload represents a value of @p size bytes with the given
+ * @p hash, and, unless it is only hashed, the contents of @p data.
+ */
+static bool payload_matches(const anjay_observe_payload_t *payload,
+                            const void *data, size_t size, uint64_t hash) {
+    if (!payload) {
+        return !size;
+    }
+    // hashed_only is determined by the size, so it is the same for both
+    return payload->size == size && payload->hash == hash
+            && (payload->hashed_only
+                    || memcmp(payload->data, data, size) == 0);
+}
+
+static bool payload_equal(const anjay_observe_payload_t *left,
+                          const anjay_observe_payload_t *right) {
+    if (left == right) {
+        return true;
+    } else if (!left || !right) {
+        return false;
+    }
+    return payload_matches(left, right->data, right->size, right->hash);
+}
+
+static size_t unsent_record_charge(size_t value_length) {
+    return sizeof(anjay_observe_resource_value_t) + value_length;
+}
+
+static inline bool unsent_queue_empty(const unsent_queue_t *queue) {
+    return !queue->used;
+}
+
+static inline anjay_observe_resource_value_t *
+unsent_queue_at(const unsent_queue_t *queue, size_t index) {
+    return &queue->records[(queue->head + index) % queue->capacity];
+}
+
+static anjay_observe_resource_value_t *
+unsent_queue_first(const unsent_queue_t *queue) {
+    if (unsent_queue_empty(queue)) {
+        return NULL;
+    }
+    return unsent_queue_at(queue, 0);
+}
+
+/**
+ * Reserves a slot at the tail of the queue.
+ *
+ * @returns The reserved slot, or NULL if all slots are in use.
+ */
+static anjay_observe_resource_value_t *
+unsent_queue_reserve(unsent_queue_t *queue) {
+    if (queue->used >= queue->capacity) {
+        return NULL;
+    }
+    return unsent_queue_at(queue, queue->used++);
+}
+
+static void unsent_queue_kill(unsent_queue_t *queue,
+                              anjay_observe_resource_value_t *record) {
+    assert(record->ref);
+    record->ref = NULL;
+    --queue->count;
+    queue->bytes -= unsent_record_charge(payload_size(record->payload));
+    payload_release(&record->payload);
+}
+
+static void unsent_queue_reclaim(unsent_queue_t *queue) {
+    while (!unsent_queue_empty(queue) && !unsent_queue_first(queue)->ref) {
+        queue->head = (queue->head + 1) % queue->capacity;
+        --queue->used;
+    }
+    if (unsent_queue_empty(queue)) {
+        queue->head = 0;
+    }
+}
+
+static void unsent_queue_pop(unsent_queue_t *queue) {
+    anjay_observe_resource_value_t *record = unsent_queue_first(queue);
+    if (record->ref->last_unsent == record) {
+        record->ref->last_unsent = NULL;
+    }
+    unsent_queue_kill(queue, record);
+    unsent_queue_reclaim(queue);
+}
+
+static void remove_all_unsent_values(anjay_observe_connection_entry_t *conn) {
+    while (!unsent_queue_empty(&conn->unsent)) {
+        unsent_queue_pop(&conn->unsent);
+    }
+}
+
+int _anjay_observe_init(anjay_t *anjay,
+                        const anjay_configuration_t *config) {
     if (!(anjay->observe.connection_entries =
             AVS_RBTREE_NEW(anjay_observe_connection_entry_t,
                            connection_state_cmp))) {
         anjay_log(ERROR, "Could not initialize Observe structures");
         return -1;
     }
-    anjay->observe.confirmable_notifications = confirmable_notifications;
+    anjay->observe.confirmable_notifications =
+            config->confirmable_notifications;
+    anjay->observe.max_notifications_in_flight =
+            config->max_notifications_in_flight;
+    anjay->observe.notification_overflow_policy =
+            config->notification_overflow_policy;
+    anjay->observe.coalesce_notifications = config->coalesce_notifications;
+    anjay->observe.rand_seed = (anjay_rand_seed_t) time(NULL);
+
+    // the buffer needs to be able to hold at least a single value
+    const size_t min_buffer_size =
+            unsent_record_charge(ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE);
+    size_t buffer_size = config->stored_notifications_buffer_size;
+    if (!buffer_size) {
+        buffer_size = AVS_MAX(ANJAY_DEFAULT_STORED_NOTIFICATIONS_BUFFER_SIZE,
+                              min_buffer_size);
+    } else if (buffer_size < min_buffer_size) {
+        anjay_log(WARNING, "stored_notifications_buffer_size too small, "
+                  "using %zu bytes instead", min_buffer_size);
+        buffer_size = min_buffer_size;
+    }
+    anjay->observe.stored_notifications_buffer_size = buffer_size;
+    // released payloads are kept for reuse up to the size of the buffer
+    anjay->observe.payload_pool.max_free_bytes = buffer_size;
     return 0;
 }
 
+static void delete_in_flight(anjay_t *anjay,
+                             AVS_LIST(observe_in_flight_t) *in_flight_ptr) {
+    _anjay_sched_del(anjay->sched, &(*in_flight_ptr)->retransmit_task);
+    free((*in_flight_ptr)->request);
+    AVS_LIST_DELETE(in_flight_ptr);
+}
+
 static void cleanup_connection(anjay_t *anjay,
                                anjay_observe_connection_entry_t *conn) {
+    remove_all_unsent_values(conn);
     AVS_RBTREE_DELETE(&conn->entries) {
         _anjay_sched_del(anjay->sched, &(*conn->entries)->notify_task);
-        AVS_LIST_CLEAR(&(*conn->entries)->last_sent);
+        if ((*conn->entries)->last_sent) {
+            payload_release(&(*conn->entries)->last_sent->payload);
+            free((*conn->entries)->last_sent);
+        }
     }
     _anjay_sched_del(anjay->sched, &conn->flush_task);
-    AVS_LIST_CLEAR(&conn->unsent);
+    while (conn->in_flight) {
+        delete_in_flight(anjay, &conn->in_flight);
+    }
+    free(conn->unsent.records);
 }
 
+static void clear_read_cache(anjay_t *anjay);
+
 void _anjay_observe_cleanup(anjay_t *anjay) {
     AVS_RBTREE_DELETE(&anjay->observe.connection_entries) {
         cleanup_connection(anjay, *anjay->observe.connection_entries);
     }
+    _anjay_sched_del(anjay->sched, &anjay->observe.read_cache_clear_task);
+    clear_read_cache(anjay);
+    free(anjay->observe.read_buffer);
+    anjay->observe.read_buffer = NULL;
+    payload_pool_cleanup(&anjay->observe.payload_pool);
 }
 
 static int observe_setup_for_sending(avs_stream_abstract_t *stream,
@@ -145,12 +455,33 @@ static int observe_setup_for_sending(avs_stream_abstract_t *stream,
     return 0;
 }
 
+static avs_stream_write_some_t outbuf_write_some;
+
+static int observe_write_some(avs_stream_abstract_t *stream_,
+                              const void *data,
+                              size_t *data_length) {
+    anjay_observe_stream_t *stream = (anjay_observe_stream_t *) stream_;
+    stream->hash = _anjay_fnv1a_64_update(stream->hash, data, *data_length);
+    // once the value does not fit, the buffer is no longer written to
+    const bool fits = (stream->length + *data_length <= stream->capacity);
+    stream->length += *data_length;
+    if (fits) {
+        size_t written = *data_length;
+        int result = outbuf_write_some(stream_, data, &written);
+        if (result || written != *data_length) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 const anjay_observe_stream_t *_anjay_observe_stream_initializer__(void) {
     static volatile bool initialized = false;
 
     static avs_stream_v_table_t vtable;
     static const anjay_observe_stream_t initializer = {
-        .outbuf = { .vtable = &vtable }
+        .outbuf = { .vtable = &vtable },
+        .hash = ANJAY_FNV1A_64_OFFSET_BASIS
     };
     static const anjay_coap_stream_ext_t coap_ext = {
         .setup_response = observe_setup_for_sending
@@ -163,6 +494,8 @@ const anjay_observe_stream_t *_anjay_observe_stream_initializer__(void) {
     if (!initialized) {
         memcpy(&vtable, AVS_STREAM_OUTBUF_STATIC_INITIALIZER.vtable,
                sizeof(avs_stream_v_table_t));
+        outbuf_write_some = vtable.write_some;
+        vtable.write_some = observe_write_some;
         vtable.extension_list = extensions;
 
         initialized = true;
@@ -175,21 +508,22 @@ static void clear_entry(anjay_t *anjay,
                         anjay_observe_connection_entry_t *connection,
                         anjay_observe_entry_t *entry) {
     _anjay_sched_del(anjay->sched, &entry->notify_task);
-    AVS_LIST_CLEAR(&entry->last_sent);
+    entry->value_version_valid = false;
+    if (entry->last_sent) {
+        payload_release(&entry->last_sent->payload);
+        free(entry->last_sent);
+        entry->last_sent = NULL;
+    }
 
     if (entry->last_unsent) {
-        anjay_observe_resource_value_t **unsent_ptr;
-        anjay_observe_resource_value_t *helper;
-        anjay_observe_resource_value_t *server_last_unsent = NULL;
-        AVS_LIST_DELETABLE_FOREACH_PTR(unsent_ptr, helper,
-                                       &connection->unsent) {
-            if ((*unsent_ptr)->ref != entry) {
-                server_last_unsent = *unsent_ptr;
-            } else {
-                AVS_LIST_DELETE(unsent_ptr);
+        unsent_queue_t *queue = &connection->unsent;
+        for (size_t i = 0; i < queue->used; ++i) {
+            anjay_observe_resource_value_t *record = unsent_queue_at(queue, i);
+            if (record->ref == entry) {
+                unsent_queue_kill(queue, record);
             }
         }
-        connection->unsent_last = server_last_unsent;
+        unsent_queue_reclaim(queue);
         entry->last_unsent = NULL;
     }
 }
@@ -205,8 +539,7 @@ static void delete_connection_if_empty(
         anjay_t *anjay,
         AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) *conn_ptr) {
     if (!AVS_RBTREE_FIRST((*conn_ptr)->entries)) {
-        assert(!(*conn_ptr)->unsent);
-        assert(!(*conn_ptr)->unsent_last);
+        assert(unsent_queue_empty(&(*conn_ptr)->unsent));
         delete_connection(anjay, conn_ptr);
     }
 }
@@ -244,53 +577,109 @@ static int schedule_trigger(anjay_t *anjay,
                         trigger_observe, entry);
 }
 
-static AVS_LIST(anjay_observe_resource_value_t)
-create_resource_value(const anjay_msg_details_t *details,
-                      anjay_observe_entry_t *ref,
-                      const avs_coap_msg_identity_t *identity,
-                      double numeric,
-                      const void *data, size_t size) {
-    AVS_LIST(anjay_observe_resource_value_t) result =
-            (anjay_observe_resource_value_t *) AVS_LIST_NEW_BUFFER(
-                    offsetof(anjay_observe_resource_value_t, value) + size);
-    if (!result) {
-        anjay_log(ERROR, "Out of memory");
-        return NULL;
-    }
+static void init_resource_value(anjay_observe_resource_value_t *result,
+                                const anjay_msg_details_t *details,
+                                anjay_observe_entry_t *ref,
+                                const avs_coap_msg_identity_t *identity,
+                                double numeric,
+                                anjay_observe_payload_t *payload) {
     result->details = *details;
     result->ref = ref;
     result->identity = *identity;
     result->numeric = numeric;
-    AVS_STATIC_ASSERT(sizeof(result->value_length) == sizeof(size),
-                      length_size);
-    memcpy((void *) (intptr_t) &result->value_length, &size, sizeof(size));
-    assert(data || !size);
-    if (data) {
-        memcpy(result->value, data, size);
-    }
+    result->payload = payload_acquire(payload);
     result->timestamp = avs_time_real_now();
-    return result;
 }
 
-static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
+/**
+ * Detaches the newest unsent value of @p entry so that a new one, charged
+ * @p charge bytes, can take its place in the queue.
+ *
+ * @returns The record that held the value, if the new value fits within the
+ *          buffer size limit in its place. Otherwise the record is removed
+ *          from the queue and NULL is returned.
+ */
+static anjay_observe_resource_value_t *
+take_over_last_unsent(anjay_t *anjay,
+                      unsent_queue_t *queue,
+                      anjay_observe_entry_t *entry,
+                      size_t charge) {
+    anjay_observe_resource_value_t *previous = entry->last_unsent;
+    entry->last_unsent = NULL;
+    const size_t previous_charge =
+            unsent_record_charge(payload_size(previous->payload));
+    if (queue->bytes - previous_charge + charge
+            <= anjay->observe.stored_notifications_buffer_size) {
+        queue->bytes -= previous_charge;
+        payload_release(&previous->payload);
+        return previous;
+    }
+    unsent_queue_kill(queue, previous);
+    unsent_queue_reclaim(queue);
+    return NULL;
+}
+
+static int insert_new_value(anjay_t *anjay,
+                            anjay_observe_connection_entry_t *conn_state,
                             anjay_observe_entry_t *entry,
                             const anjay_msg_details_t *details,
                             const avs_coap_msg_identity_t *identity,
                             double numeric,
-                            const void *data,
-                            size_t size) {
-    AVS_LIST(anjay_observe_resource_value_t) res_value =
-            create_resource_value(details, entry, identity,
-                                  numeric, data, size);
-    if (!res_value) {
-        return -1;
+                            anjay_observe_payload_t *payload) {
+    unsent_queue_t *queue = &conn_state->unsent;
+    if (!queue->records) {
+        // every record is charged at least its own size, so there can never
+        // be more of them than this
+        const size_t capacity = anjay->observe.stored_notifications_buffer_size
+                                / unsent_record_charge(0);
+        if (!(queue->records = (anjay_observe_resource_value_t *) calloc(
+                capacity, sizeof(*queue->records)))) {
+            anjay_log(ERROR, "Out of memory");
+            return -1;
+        }
+        queue->capacity = capacity;
+    }
+
+    const size_t charge = unsent_record_charge(payload_size(payload));
+    anjay_observe_resource_value_t *record = NULL;
+    bool record_live = false;
+    if (entry->last_unsent
+            && (anjay->observe.coalesce_notifications
+                    || (is_hashed_only(payload)
+                            && is_hashed_only(
+                                    entry->last_unsent->payload)))) {
+        // values only kept as hashes are serialized again when sending, so
+        // there is no point in queueing more than one of them in a row
+        record_live = !!(record = take_over_last_unsent(anjay, queue, entry,
+                                                        charge));
+    }
+    while (!record
+            && (queue->bytes + charge
+                            > anjay->observe.stored_notifications_buffer_size
+                    || !(record = unsent_queue_reserve(queue)))) {
+        if (anjay->observe.notification_overflow_policy
+                        == ANJAY_NOTIFICATION_OVERFLOW_COALESCE
+                && entry->last_unsent) {
+            observe_stat_inc(anjay, notifications_dropped);
+            record_live = !!(record = take_over_last_unsent(anjay, queue,
+                                                            entry, charge));
+        } else if (!unsent_queue_empty(queue)) {
+            anjay_log(DEBUG, "stored notifications buffer full, dropping the "
+                      "oldest value");
+            observe_stat_inc(anjay, notifications_dropped);
+            unsent_queue_pop(queue);
+        } else {
+            anjay_log(ERROR, "value too large to be stored");
+            return -1;
+        }
     }
-    AVS_LIST_APPEND(&conn_state->unsent_last, res_value);
-    conn_state->unsent_last = res_value;
-    if (!conn_state->unsent) {
-        conn_state->unsent = res_value;
+
+    if (!record_live) {
+        ++queue->count;
     }
-    entry->last_unsent = res_value;
+    queue->bytes += charge;
+    init_resource_value(record, details, entry, identity, numeric, payload);
+    entry->last_unsent = record;
     return 0;
 }
 
@@ -306,8 +695,8 @@ static int insert_error(anjay_t *anjay,
         .msg_code = _anjay_make_error_response_code(outer_result),
         .format = AVS_COAP_FORMAT_NONE
     };
-    return insert_new_value(conn_state, entry, &details, identity,
-                            NAN, NULL, 0);
+    return insert_new_value(anjay, conn_state, entry, &details, identity,
+                            NAN, NULL);
 }
 
 static int get_effective_attrs(anjay_t *anjay,
@@ -368,8 +757,7 @@ static int insert_initial_value(
         const anjay_msg_details_t *details,
         const avs_coap_msg_identity_t *identity,
         double numeric,
-        const void *data,
-        size_t size) {
+        anjay_observe_payload_t *payload) {
     assert(!entry->last_sent);
     assert(!entry->last_unsent);
 
@@ -379,12 +767,19 @@ static int insert_initial_value(
     anjay_dm_internal_res_attrs_t attrs;
     // we assume that the initial value should be treated as sent,
     // even though we haven't actually sent it ourselves
-    if (!(result = get_attrs(anjay, &attrs, &entry->key))
-            && (entry->last_sent =
-                    create_resource_value(details, entry, identity,
-                                          numeric, data, size))
-            && !(result = schedule_trigger(anjay, entry,
-                                           attrs.standard.common.max_period))) {
+    if (!(result = get_attrs(anjay, &attrs, &entry->key))) {
+        if ((entry->last_sent = (anjay_observe_resource_value_t *) malloc(
+                sizeof(*entry->last_sent)))) {
+            init_resource_value(entry->last_sent, details, entry, identity,
+                                numeric, payload);
+            result = schedule_trigger(anjay, entry,
+                                      attrs.standard.common.max_period);
+        } else {
+            anjay_log(ERROR, "Out of memory");
+            result = -1;
+        }
+    }
+    if (!result) {
         entry->last_confirmable = now;
     } else {
         clear_entry(anjay, conn_state, entry);
@@ -432,13 +827,12 @@ find_or_create_connection_state(anjay_t *anjay,
     return conn;
 }
 
-int _anjay_observe_put_entry(anjay_t *anjay,
-                             const anjay_observe_key_t *key,
-                             const anjay_msg_details_t *details,
-                             const avs_coap_msg_identity_t *identity,
-                             double numeric,
-                             const void *data,
-                             size_t size) {
+static int put_entry(anjay_t *anjay,
+                     const anjay_observe_key_t *key,
+                     const anjay_msg_details_t *details,
+                     const avs_coap_msg_identity_t *identity,
+                     double numeric,
+                     anjay_observe_payload_t *payload) {
     assert(key->rid >= -1 && key->rid <= UINT16_MAX);
     AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn =
             find_or_create_connection_state(anjay, &key->connection);
@@ -455,7 +849,7 @@ int _anjay_observe_put_entry(anjay_t *anjay,
 
     clear_entry(anjay, conn, entry);
     int result = insert_initial_value(anjay, conn, entry, details, identity,
-                                      numeric, data, size);
+                                      numeric, payload);
     if (!result) {
         return 0;
     }
@@ -466,6 +860,42 @@ int _anjay_observe_put_entry(anjay_t *anjay,
     return result;
 }
 
+int _anjay_observe_put_entry(anjay_t *anjay,
+                             const anjay_observe_key_t *key,
+                             const anjay_msg_details_t *details,
+                             const avs_coap_msg_identity_t *identity,
+                             double numeric,
+                             const void *data,
+                             size_t size) {
+    anjay_observe_payload_t *payload =
+            payload_new(&anjay->observe.payload_pool, data, size);
+    if (!payload && size) {
+        anjay_log(ERROR, "Out of memory");
+        return -1;
+    }
+    int result = put_entry(anjay, key, details, identity, numeric, payload);
+    payload_release(&payload);
+    return result;
+}
+
+int _anjay_observe_put_hashed_entry(anjay_t *anjay,
+                                    const anjay_observe_key_t *key,
+                                    const anjay_msg_details_t *details,
+                                    const avs_coap_msg_identity_t *identity,
+                                    double numeric,
+                                    size_t size,
+                                    uint64_t hash) {
+    anjay_observe_payload_t *payload =
+            payload_new_hashed(&anjay->observe.payload_pool, NULL, size, hash);
+    if (!payload && size) {
+        anjay_log(ERROR, "Out of memory");
+        return -1;
+    }
+    int result = put_entry(anjay, key, details, identity, numeric, payload);
+    payload_release(&payload);
+    return result;
+}
+
 static void
 delete_entry(anjay_t *anjay,
              AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) *conn_ptr,
@@ -577,11 +1007,9 @@ static bool should_update(const anjay_observe_resource_value_t *previous,
                           const anjay_dm_resource_attributes_t *attrs,
                           const anjay_msg_details_t *details,
                           double numeric,
-                          const char *data,
-                          size_t length) {
+                          const anjay_observe_payload_t *payload) {
     if (details->format == previous->details.format
-            && length == previous->value_length
-            && memcmp(data, previous->value, length) == 0) {
+            && payload_equal(payload, previous->payload)) {
         return false;
     }
 
@@ -598,28 +1026,202 @@ static bool should_update(const anjay_observe_resource_value_t *previous,
             || process_ltgt(previous, attrs->greater_than, numeric);
 }
 
+struct anjay_observe_cached_read_struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    int32_t rid;
+    uint16_t format;
+    // value length, or a negative error code
+    ssize_t result;
+    anjay_msg_details_t details;
+    double numeric;
+    anjay_observe_payload_t *payload;
+};
+
+static void clear_read_cache(anjay_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->observe.read_cache) {
+        payload_release(&anjay->observe.read_cache->payload);
+    }
+}
+
+static int clear_read_cache_job(anjay_t *anjay, void *dummy) {
+    (void) dummy;
+    clear_read_cache(anjay);
+    return 0;
+}
+
+static AVS_LIST(anjay_observe_cached_read_t) *
+find_cached_read(anjay_t *anjay, const anjay_observe_key_t *key) {
+    AVS_LIST(anjay_observe_cached_read_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->observe.read_cache) {
+        if ((*it)->oid == key->oid && (*it)->iid == key->iid
+                && (*it)->rid == key->rid && (*it)->format == key->format) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static bool cached_read_affected(const anjay_observe_cached_read_t *cached,
+                                 const anjay_observe_key_t *changed) {
+    if (cached->oid != changed->oid) {
+        return false;
+    }
+    if (changed->iid == ANJAY_IID_INVALID) {
+        return true;
+    }
+    if (cached->iid != changed->iid) {
+        return false;
+    }
+    // reads of whole Instances include the changed Resource
+    return changed->rid < 0 || cached->rid < 0 || cached->rid == changed->rid;
+}
+
+/**
+ * Drops cached reads of the paths that overlap with @p changed, so that values
+ * changed within the current scheduler run are not masked by the cache.
+ */
+static void invalidate_cached_reads(anjay_t *anjay,
+                                    const anjay_observe_key_t *changed) {
+    AVS_LIST(anjay_observe_cached_read_t) *it = &anjay->observe.read_cache;
+    while (*it) {
+        if (cached_read_affected(*it, changed)) {
+            payload_release(&(*it)->payload);
+            AVS_LIST_DELETE(it);
+        } else {
+            it = AVS_LIST_NEXT_PTR(it);
+        }
+    }
+}
+
+static void cache_read(anjay_t *anjay,
+                       const anjay_observe_key_t *key,
+                       ssize_t result,
+                       const anjay_msg_details_t *details,
+                       double numeric,
+                       anjay_observe_payload_t *payload) {
+    AVS_LIST(anjay_observe_cached_read_t) cached =
+            AVS_LIST_NEW_ELEMENT(anjay_observe_cached_read_t);
+    if (!cached) {
+        // the cache is only an optimization, nothing bad happens without it
+        return;
+    }
+    if (!anjay->observe.read_cache_clear_task
+            && _anjay_sched_now(anjay->sched,
+                                &anjay->observe.read_cache_clear_task,
+                                clear_read_cache_job, NULL)) {
+        AVS_LIST_DELETE(&cached);
+        return;
+    }
+    cached->oid = key->oid;
+    cached->iid = key->iid;
+    cached->rid = key->rid;
+    cached->format = key->format;
+    cached->result = result;
+    cached->details = *details;
+    cached->numeric = numeric;
+    cached->payload = payload_acquire(payload);
+    AVS_LIST_INSERT(&anjay->observe.read_cache, cached);
+}
+
+char *_anjay_observe_read_buffer(anjay_t *anjay) {
+    if (!anjay->observe.read_buffer
+            && !(anjay->observe.read_buffer = (char *) malloc(
+                    ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE))) {
+        anjay_log(ERROR, "Out of memory");
+    }
+    return anjay->observe.read_buffer;
+}
+
+static anjay_dm_read_args_t observe_read_args(const anjay_observe_key_t *key) {
+    return (const anjay_dm_read_args_t) {
+        .ssid = key->connection.ssid,
+        .uri = {
+            .has_oid = true,
+            .oid = key->oid,
+            .has_iid = (key->iid != ANJAY_IID_INVALID),
+            .iid = key->iid,
+            .has_rid = (key->rid >= 0),
+            .rid = (anjay_rid_t) key->rid,
+        },
+        .requested_format = key->format,
+        .observe_serial = true
+    };
+}
+
+/**
+ * Reads the current value of the resource observed by @p entry.
+ *
+ * @returns Length of the value, or a negative error code. On success,
+ *          @p out_payload is set to a new reference to the value, which the
+ *          caller needs to release, or to NULL if the value is empty.
+ */
 static inline ssize_t read_new_value(anjay_t *anjay,
                                      const anjay_dm_object_def_t *const *obj,
                                      const anjay_observe_entry_t *entry,
                                      anjay_msg_details_t *out_details,
                                      double *out_numeric,
-                                     char *buffer,
-                                     size_t size) {
-    return _anjay_dm_read_for_observe(
-            anjay, obj,
-            &(const anjay_dm_read_args_t) {
-                .ssid = entry->key.connection.ssid,
-                .uri = {
-                    .has_oid = true,
-                    .oid = entry->key.oid,
-                    .has_iid = (entry->key.iid != ANJAY_IID_INVALID),
-                    .iid = entry->key.iid,
-                    .has_rid = (entry->key.rid >= 0),
-                    .rid = (anjay_rid_t) entry->key.rid,
-                },
-                .requested_format = entry->key.format,
-                .observe_serial = true
-            }, out_details, out_numeric, buffer, size);
+                                     anjay_observe_payload_t **out_payload) {
+    // Reads of whole Objects are filtered by per-instance access control, so
+    // they may yield different results for different servers. Reads of single
+    // Instances or Resources only differ in the access check itself, which is
+    // repeated for each server; the value is read once per scheduler run.
+    const bool cacheable = (entry->key.iid != ANJAY_IID_INVALID);
+    *out_payload = NULL;
+    if (cacheable) {
+        AVS_LIST(anjay_observe_cached_read_t) *cached_ptr =
+                find_cached_read(anjay, &entry->key);
+        if (cached_ptr) {
+            const anjay_observe_cached_read_t *cached = *cached_ptr;
+            if (cached->result >= 0
+                    && !_anjay_access_control_action_allowed(
+                            anjay, &(const anjay_action_info_t) {
+                                .oid = entry->key.oid,
+                                .iid = entry->key.iid,
+                                .ssid = entry->key.connection.ssid,
+                                .action = ANJAY_ACTION_READ
+                            })) {
+                return ANJAY_ERR_UNAUTHORIZED;
+            }
+            *out_details = cached->details;
+            *out_numeric = cached->numeric;
+            *out_payload = payload_acquire(cached->payload);
+            return cached->result;
+        }
+    }
+
+    char *buffer = _anjay_observe_read_buffer(anjay);
+    if (!buffer) {
+        return ANJAY_ERR_INTERNAL;
+    }
+    anjay_observe_stream_t out =
+            _anjay_new_observe_stream(out_details, buffer,
+                                      ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE);
+    const anjay_dm_read_args_t read_args = observe_read_args(&entry->key);
+    ssize_t result = _anjay_dm_read_for_observe(
+            anjay, obj, &read_args, out_numeric,
+            (avs_stream_abstract_t *) &out);
+    if (!result && out.length) {
+        result = (ssize_t) out.length;
+        // values too large for the buffer are only kept as hashes
+        const char *data = (out.length <= out.capacity) ? buffer : NULL;
+        // an unchanged value keeps sharing the payload that is already stored
+        anjay_observe_payload_t *newest = newest_value(entry)->payload;
+        if (payload_matches(newest, data, out.length, out.hash)) {
+            *out_payload = payload_acquire(newest);
+        } else if (!(*out_payload =
+                payload_new_hashed(&anjay->observe.payload_pool, data,
+                                   out.length, out.hash))) {
+            anjay_log(ERROR, "Out of memory");
+            return ANJAY_ERR_INTERNAL;
+        }
+    }
+    // ANJAY_ERR_UNAUTHORIZED may be specific to the server, don't share it
+    if (cacheable && result != ANJAY_ERR_UNAUTHORIZED) {
+        cache_read(anjay, &entry->key, result, out_details, *out_numeric,
+                   *out_payload);
+    }
+    return result;
 }
 
 static int bind_stream_by_ssid(anjay_t *anjay,
@@ -642,34 +1244,234 @@ static bool confirmable_required(const avs_time_real_t now,
             avs_time_duration_from_scalar(1, AVS_TIME_DAY));
 }
 
-static anjay_observe_resource_value_t *
-detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state) {
-    assert(conn_state->unsent);
-    anjay_observe_entry_t *entry = conn_state->unsent->ref;
-    if (entry->last_unsent == conn_state->unsent) {
-        entry->last_unsent = NULL;
+static avs_coap_msg_type_t
+notification_msg_type(const anjay_observe_resource_value_t *value,
+                      const avs_time_real_t now) {
+    if (value->details.msg_type != AVS_COAP_MSG_CONFIRMABLE
+            && confirmable_required(now, value->ref)) {
+        return AVS_COAP_MSG_CONFIRMABLE;
     }
-    anjay_observe_resource_value_t *result =
-            AVS_LIST_DETACH(&conn_state->unsent);
-    if (conn_state->unsent_last == result) {
-        assert(!conn_state->unsent);
-        conn_state->unsent_last = NULL;
-    }
-    return result;
+    return value->details.msg_type;
 }
 
 static void value_sent(anjay_observe_connection_entry_t *conn_state) {
-    anjay_observe_resource_value_t *sent =
-            detach_first_unsent_value(conn_state);
-    anjay_observe_entry_t *entry = sent->ref;
-    assert(AVS_LIST_SIZE(entry->last_sent) <= 1);
-    AVS_LIST_CLEAR(&entry->last_sent);
-    entry->last_sent = sent;
+    const anjay_observe_resource_value_t *sent =
+            unsent_queue_first(&conn_state->unsent);
+    assert(sent);
+    anjay_observe_resource_value_t *last_sent = sent->ref->last_sent;
+    payload_release(&last_sent->payload);
+    *last_sent = *sent;
+    payload_acquire(last_sent->payload);
+    unsent_queue_pop(&conn_state->unsent);
 }
 
 static int sched_flush_send_queue(anjay_t *anjay,
                                   anjay_observe_connection_entry_t *conn);
 
+static int retransmit_notification_job(anjay_t *anjay, void *in_flight_);
+
+static int send_in_flight(anjay_t *anjay, observe_in_flight_t *in_flight) {
+    avs_coap_tx_params_t tx_params =
+            avs_coap_ctx_get_tx_params(anjay->coap_ctx);
+    avs_coap_update_retry_state(&in_flight->retry_state, &tx_params,
+                                &anjay->observe.rand_seed);
+    int result = avs_coap_ctx_send(anjay->coap_ctx,
+                                   avs_stream_net_getsock(anjay->comm_stream),
+                                   in_flight->request);
+    if (!result
+            && _anjay_sched(anjay->sched, &in_flight->retransmit_task,
+                            in_flight->retry_state.recv_timeout,
+                            retransmit_notification_job, in_flight)) {
+        anjay_log(ERROR, "Could not schedule notification retransmission");
+        result = -1;
+    }
+    return result;
+}
+
+static int finish_notification(anjay_t *anjay, bool confirmable) {
+    int result = avs_stream_finish_message(anjay->comm_stream);
+    if (!result && confirmable) {
+        // avs_stream_finish_message() waits for the ACK in this case
+        observe_stat_inc(anjay, notifications_acknowledged);
+    }
+    return result;
+}
+
+static int
+send_confirmable_pipelined(anjay_t *anjay,
+                           anjay_observe_connection_entry_t *conn_state) {
+    AVS_LIST(observe_in_flight_t) in_flight =
+            AVS_LIST_NEW_ELEMENT(observe_in_flight_t);
+    if (!in_flight) {
+        anjay_log(ERROR, "Out of memory");
+        return -1;
+    }
+
+    int result = _anjay_coap_stream_take_request(anjay->comm_stream,
+                                                 &in_flight->request);
+    if (result == ANJAY_COAP_STREAM_REQUEST_BLOCKWISE) {
+        // part of the notification has already been sent block-wise, so it
+        // needs to be completed in the usual, blocking way
+        AVS_LIST_DELETE(&in_flight);
+        return finish_notification(anjay, true);
+    }
+
+    if (!result) {
+        in_flight->conn = conn_state;
+        in_flight->key =
+                unsent_queue_first(&conn_state->unsent)->ref->key;
+        if (!(result = send_in_flight(anjay, in_flight))) {
+            AVS_LIST_APPEND(&conn_state->in_flight, in_flight);
+            return 0;
+        }
+    }
+    delete_in_flight(anjay, &in_flight);
+    return result;
+}
+
+// Stream that passes a value serialized again at the time of sending directly
+// into the message already set up on anjay->comm_stream, while also copying it
+// into an anjay_observe_stream_t
+typedef struct {
+    const avs_stream_v_table_t *vtable;
+    avs_stream_abstract_t *backend;
+    anjay_observe_stream_t *copy;
+} resend_stream_t;
+
+static int resend_stream_write_some(avs_stream_abstract_t *stream_,
+                                    const void *data,
+                                    size_t *data_length) {
+    resend_stream_t *stream = (resend_stream_t *) stream_;
+    int result = avs_stream_write(stream->backend, data, *data_length);
+    if (!result) {
+        result = avs_stream_write((avs_stream_abstract_t *) stream->copy,
+                                  data, *data_length);
+    }
+    return result;
+}
+
+static int resend_stream_setup_response(avs_stream_abstract_t *stream,
+                                        const anjay_msg_details_t *details) {
+    // the message has already been set up by the caller
+    (void) stream;
+    (void) details;
+    return 0;
+}
+
+static int resend_stream_finish_message(avs_stream_abstract_t *stream) {
+    // the notification is finished by send_entry()
+    (void) stream;
+    return -1;
+}
+
+static int resend_stream_read(avs_stream_abstract_t *stream,
+                              size_t *out_bytes_read,
+                              char *out_message_finished,
+                              void *buffer,
+                              size_t buffer_length) {
+    (void) stream;
+    (void) out_bytes_read;
+    (void) out_message_finished;
+    (void) buffer;
+    (void) buffer_length;
+    return -1;
+}
+
+static int resend_stream_peek(avs_stream_abstract_t *stream, size_t offset) {
+    (void) stream;
+    (void) offset;
+    return -1;
+}
+
+static int resend_stream_reset(avs_stream_abstract_t *stream) {
+    (void) stream;
+    return -1;
+}
+
+static int resend_stream_close(avs_stream_abstract_t *stream) {
+    // the stream lives on the stack and does not own the backend
+    (void) stream;
+    return 0;
+}
+
+static int resend_stream_errno(avs_stream_abstract_t *stream) {
+    return avs_stream_errno(((resend_stream_t *) stream)->backend);
+}
+
+int _anjay_observe_resend_value(anjay_t *anjay,
+                                const anjay_observe_key_t *key,
+                                double *out_numeric,
+                                anjay_observe_stream_t *copy) {
+    static const anjay_coap_stream_ext_t COAP_EXT = {
+        .setup_response = resend_stream_setup_response
+    };
+    static const avs_stream_v_table_extension_t EXTENSIONS[] = {
+        { ANJAY_COAP_STREAM_EXTENSION, &COAP_EXT },
+        AVS_STREAM_V_TABLE_EXTENSION_NULL
+    };
+    static const avs_stream_v_table_t VTABLE = {
+        resend_stream_write_some,
+        resend_stream_finish_message,
+        resend_stream_read,
+        resend_stream_peek,
+        resend_stream_reset,
+        resend_stream_close,
+        resend_stream_errno,
+        EXTENSIONS
+    };
+    resend_stream_t stream = { &VTABLE, anjay->comm_stream, copy };
+
+    const anjay_dm_object_def_t *const *obj =
+            _anjay_dm_find_object_by_oid(anjay, key->oid);
+    if (!obj) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    const anjay_dm_read_args_t read_args = observe_read_args(key);
+    *out_numeric = NAN;
+    return _anjay_dm_read_for_observe(anjay, obj, &read_args, out_numeric,
+                                      (avs_stream_abstract_t *) &stream);
+}
+
+/**
+ * Writes @p value into the notification set up on anjay->comm_stream.
+ *
+ * Values only kept as hashes are serialized again, so the current value is
+ * sent, which may be newer than the one that triggered the notification. In
+ * that case, @p out_resent_numeric and @p out_resent_payload are set to
+ * describe the value actually sent.
+ */
+static int write_value(anjay_t *anjay,
+                       const anjay_observe_resource_value_t *value,
+                       double *out_resent_numeric,
+                       anjay_observe_payload_t **out_resent_payload) {
+    if (!is_hashed_only(value->payload)) {
+        return avs_stream_write(anjay->comm_stream,
+                                payload_data(value->payload),
+                                payload_size(value->payload));
+    }
+
+    char *buffer = _anjay_observe_read_buffer(anjay);
+    if (!buffer) {
+        return ANJAY_ERR_INTERNAL;
+    }
+    anjay_msg_details_t details;
+    anjay_observe_stream_t copy =
+            _anjay_new_observe_stream(&details, buffer,
+                                      ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE);
+    int result = _anjay_observe_resend_value(anjay, &value->ref->key,
+                                             out_resent_numeric, &copy);
+    if (!result && copy.length) {
+        const char *data = (copy.length <= copy.capacity) ? buffer : NULL;
+        if (!(*out_resent_payload =
+                payload_new_hashed(&anjay->observe.payload_pool, data,
+                                   copy.length, copy.hash))) {
+            anjay_log(ERROR, "Out of memory");
+            result = ANJAY_ERR_INTERNAL;
+        }
+    }
+    return result;
+}
+
 static int send_entry(anjay_t *anjay,
                       anjay_observe_connection_entry_t *conn_state) {
     if (bind_stream_by_ssid(anjay,
@@ -678,42 +1480,64 @@ static int send_entry(anjay_t *anjay,
     }
     anjay_active_server_info_t *server = anjay->current_connection.server;
     int result;
-    assert(conn_state->unsent);
-    anjay_observe_entry_t *entry = conn_state->unsent->ref;
-    const avs_coap_msg_identity_t *id = &conn_state->unsent->identity;
-    anjay_msg_details_t details = conn_state->unsent->details;
+    const anjay_observe_resource_value_t *value =
+            unsent_queue_first(&conn_state->unsent);
+    assert(value);
+    anjay_observe_entry_t *entry = value->ref;
+    const avs_coap_msg_identity_t *id = &value->identity;
+    anjay_msg_details_t details = value->details;
     avs_coap_msg_identity_t notify_id;
 
     avs_time_real_t now = avs_time_real_now();
-    if (details.msg_type != AVS_COAP_MSG_CONFIRMABLE
-            && confirmable_required(now, entry)) {
-        details.msg_type = AVS_COAP_MSG_CONFIRMABLE;
-    }
+    details.msg_type = notification_msg_type(value, now);
+    const bool confirmable = (details.msg_type == AVS_COAP_MSG_CONFIRMABLE);
+    const bool resend = is_hashed_only(value->payload);
+    double resent_numeric = NAN;
+    anjay_observe_payload_t *resent_payload = NULL;
 
     (void) ((result = _anjay_coap_stream_setup_request(
                     anjay->comm_stream, &details, &id->token))
-            || (result = avs_stream_write(anjay->comm_stream,
-                                          conn_state->unsent->value,
-                                          conn_state->unsent->value_length))
+            || (result = write_value(anjay, value, &resent_numeric,
+                                     &resent_payload))
             || (result = _anjay_coap_stream_get_request_identity(
-                    anjay->comm_stream, &notify_id))
-            || (result = avs_stream_finish_message(anjay->comm_stream)));
+                    anjay->comm_stream, &notify_id)));
+    if (!result) {
+        if (confirmable && anjay->observe.max_notifications_in_flight) {
+            result = send_confirmable_pipelined(anjay, conn_state);
+        } else {
+            result = finish_notification(anjay, confirmable);
+        }
+    }
 
     avs_stream_reset(anjay->comm_stream);
     _anjay_release_server_stream(anjay);
 
     if (!result) {
-        if (details.msg_type == AVS_COAP_MSG_CONFIRMABLE) {
+        observe_stat_inc(anjay, notifications_sent);
+        if (confirmable) {
             entry->last_confirmable = now;
         }
         value_sent(conn_state);
         entry->last_sent->identity.msg_id = notify_id.msg_id;
+        if (resend) {
+            // further values are compared against the one actually sent
+            payload_release(&entry->last_sent->payload);
+            entry->last_sent->payload = resent_payload;
+            entry->last_sent->numeric = resent_numeric;
+            resent_payload = NULL;
+        }
     } else if (result == AVS_COAP_CTX_ERR_NETWORK) {
         anjay_log(ERROR, "network communication error while sending Observe");
         _anjay_schedule_server_reconnect(anjay, server);
         // reschedule notification
         sched_flush_send_queue(anjay, conn_state);
+    } else if (resend) {
+        // the value could not be serialized again; drop it so that it does
+        // not block the queue, the next trigger will pick up the change
+        observe_stat_inc(anjay, notifications_dropped);
+        unsent_queue_pop(&conn_state->unsent);
     }
+    payload_release(&resent_payload);
     return result;
 }
 
@@ -750,20 +1574,12 @@ static inline bool is_error_value(const anjay_observe_resource_value_t *value) {
     return avs_coap_msg_code_get_class(value->details.msg_code) >= 4;
 }
 
-static void remove_all_unsent_values(anjay_observe_connection_entry_t *conn) {
-    while (conn->unsent) {
-        AVS_LIST(anjay_observe_resource_value_t) value =
-                detach_first_unsent_value(conn);
-        AVS_LIST_DELETE(&value);
-    }
-}
-
 static int handle_send_queue_entry(anjay_t *anjay,
                                    anjay_observe_connection_entry_t *conn_state,
                                    observe_server_state_t observe_state) {
-    assert(conn_state->unsent);
+    assert(!unsent_queue_empty(&conn_state->unsent));
     assert(observe_state.server_active);
-    bool is_error = is_error_value(conn_state->unsent);
+    bool is_error = is_error_value(unsent_queue_first(&conn_state->unsent));
     int result = send_entry(anjay, conn_state);
     if (result > 0) {
         anjay_log(INFO, "Reset received as reply to notification, result == %d",
@@ -784,6 +1600,130 @@ static int handle_send_queue_entry(anjay_t *anjay,
     return result;
 }
 
+static int requeue_last_sent(anjay_t *anjay,
+                             anjay_observe_connection_entry_t *conn,
+                             anjay_observe_entry_t *entry) {
+    assert(!entry->last_unsent);
+    const anjay_observe_resource_value_t *value = entry->last_sent;
+    int result = insert_new_value(anjay, conn, entry, &value->details,
+                                  &value->identity, value->numeric,
+                                  value->payload);
+    if (!result) {
+        entry->last_unsent->timestamp = value->timestamp;
+    }
+    return result;
+}
+
+static void
+notification_not_acknowledged(anjay_t *anjay,
+                              AVS_LIST(observe_in_flight_t) *in_flight_ptr) {
+    anjay_observe_connection_entry_t *conn = (*in_flight_ptr)->conn;
+    const uint16_t msg_id = avs_coap_msg_get_id((*in_flight_ptr)->request);
+    AVS_RBTREE_ELEM(anjay_observe_entry_t) entry =
+            AVS_RBTREE_FIND(conn->entries,
+                            entry_query(&(*in_flight_ptr)->key));
+    delete_in_flight(anjay, in_flight_ptr);
+
+    if (!server_state(anjay, conn->key.ssid).notification_storing_enabled) {
+        remove_all_unsent_values(conn);
+    } else if (entry && !entry->last_unsent
+            && entry->last_sent->identity.msg_id == msg_id) {
+        // no newer value has been queued in the meantime, so the one that
+        // has not been acknowledged will be sent again with the next flush
+        requeue_last_sent(anjay, conn, entry);
+    }
+}
+
+static int retransmit_notification_job(anjay_t *anjay, void *in_flight_) {
+    observe_in_flight_t *in_flight = (observe_in_flight_t *) in_flight_;
+    anjay_observe_connection_entry_t *conn = in_flight->conn;
+    AVS_LIST(observe_in_flight_t) *in_flight_ptr =
+            AVS_LIST_FIND_PTR(&conn->in_flight, in_flight);
+    assert(in_flight_ptr);
+
+    if (bind_stream_by_ssid(anjay, conn->key.ssid, conn->key.type)) {
+        anjay_log(ERROR, "could not get stream for server %u",
+                  conn->key.ssid);
+        notification_not_acknowledged(anjay, in_flight_ptr);
+        return 0;
+    }
+    anjay_active_server_info_t *server = anjay->current_connection.server;
+
+    int result = AVS_COAP_CTX_ERR_TIMEOUT;
+    if (in_flight->retry_state.retry_count
+            < avs_coap_ctx_get_tx_params(anjay->coap_ctx).max_retransmit) {
+        anjay_log(DEBUG, "retransmitting notification");
+        result = send_in_flight(anjay, in_flight);
+    }
+    _anjay_release_server_stream(anjay);
+
+    if (result) {
+        anjay_log(ERROR, "Confirmable notification not acknowledged, "
+                  "result == %d", result);
+        notification_not_acknowledged(anjay, in_flight_ptr);
+        if (result == AVS_COAP_CTX_ERR_NETWORK) {
+            _anjay_schedule_server_reconnect(anjay, server);
+        }
+    }
+    return 0;
+}
+
+anjay_observe_queue_stats_t _anjay_observe_queue_stats(anjay_t *anjay) {
+    anjay_observe_queue_stats_t result = { 0, 0 };
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn;
+    AVS_RBTREE_FOREACH(conn, anjay->observe.connection_entries) {
+        result.count += conn->unsent.count;
+        result.bytes += conn->unsent.bytes;
+    }
+    return result;
+}
+
+int _anjay_observe_handle_response(anjay_t *anjay, const avs_coap_msg_t *msg) {
+    const avs_coap_msg_type_t type = avs_coap_msg_get_type(msg);
+    if (type != AVS_COAP_MSG_ACKNOWLEDGEMENT && type != AVS_COAP_MSG_RESET) {
+        return 1;
+    }
+
+    const anjay_connection_key_t query_key = {
+        .ssid = _anjay_dm_current_ssid(anjay),
+        .type = anjay->current_connection.conn_type
+    };
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIND(anjay->observe.connection_entries,
+                            connection_query(&query_key));
+    if (!conn) {
+        return 1;
+    }
+
+    const uint16_t msg_id = avs_coap_msg_get_id(msg);
+    AVS_LIST(observe_in_flight_t) *in_flight_ptr;
+    AVS_LIST_FOREACH_PTR(in_flight_ptr, &conn->in_flight) {
+        if (avs_coap_msg_get_id((*in_flight_ptr)->request) == msg_id) {
+            break;
+        }
+    }
+    if (!*in_flight_ptr) {
+        return 1;
+    }
+
+    const anjay_observe_key_t key = (*in_flight_ptr)->key;
+    delete_in_flight(anjay, in_flight_ptr);
+    if (type == AVS_COAP_MSG_RESET) {
+        anjay_log(INFO, "Reset received as reply to notification");
+        _anjay_observe_remove_entry(anjay, &key);
+        // the above might've deleted the connection entry
+        conn = AVS_RBTREE_FIND(anjay->observe.connection_entries,
+                               connection_query(&query_key));
+    } else {
+        observe_stat_inc(anjay, notifications_acknowledged);
+    }
+
+    if (conn && !unsent_queue_empty(&conn->unsent)) {
+        sched_flush_send_queue(anjay, conn);
+    }
+    return 0;
+}
+
 static void schedule_all_triggers(anjay_t *anjay,
                                   anjay_observe_connection_entry_t *conn) {
     anjay_observe_key_t observe_key;
@@ -804,6 +1744,18 @@ static void schedule_all_triggers(anjay_t *anjay,
     }
 }
 
+static bool
+in_flight_limit_reached(anjay_t *anjay,
+                        const anjay_observe_connection_entry_t *conn) {
+    // only Confirmable notifications are subject to the limit
+    return anjay->observe.max_notifications_in_flight
+            && AVS_LIST_SIZE(conn->in_flight)
+                    >= anjay->observe.max_notifications_in_flight
+            && notification_msg_type(unsent_queue_first(&conn->unsent),
+                                     avs_time_real_now())
+                    == AVS_COAP_MSG_CONFIRMABLE;
+}
+
 static int flush_send_queue(anjay_t *anjay, void *conn_) {
     anjay_observe_connection_entry_t *conn =
             (anjay_observe_connection_entry_t *) conn_;
@@ -812,8 +1764,10 @@ static int flush_send_queue(anjay_t *anjay, void *conn_) {
     observe_server_state_t observe_state;
     bool observe_state_filled = false;
 
-    while (result >= 0 && conn && conn->unsent) {
-        anjay_observe_key_t key = conn->unsent->ref->key;
+    while (result >= 0 && conn && !unsent_queue_empty(&conn->unsent)
+            && !in_flight_limit_reached(anjay, conn)) {
+        anjay_observe_key_t key =
+                unsent_queue_first(&conn->unsent)->ref->key;
         if (!observe_state_filled) {
             observe_state = server_state(anjay, key.connection.ssid);
             observe_state_filled = true;
@@ -830,7 +1784,7 @@ static int flush_send_queue(anjay_t *anjay, void *conn_) {
                                    connection_query(&key.connection));
         }
     }
-    if (result >= 0 && conn && !conn->unsent) {
+    if (result >= 0 && conn && unsent_queue_empty(&conn->unsent)) {
         schedule_all_triggers(anjay, conn);
     }
     return result;
@@ -866,6 +1820,100 @@ int _anjay_observe_sched_flush_current_connection(anjay_t *anjay) {
     return sched_flush_send_queue(anjay, conn);
 }
 
+static avs_coap_msg_type_t
+notification_type(anjay_t *anjay, const anjay_dm_internal_res_attrs_t *attrs) {
+#ifdef WITH_CON_ATTR
+    if (attrs->custom.data.con >= 0) {
+        return (attrs->custom.data.con > 0)
+                ? AVS_COAP_MSG_CONFIRMABLE : AVS_COAP_MSG_NON_CONFIRMABLE;
+    }
+#else // WITH_CON_ATTR
+    (void) attrs;
+#endif // WITH_CON_ATTR
+    return anjay->observe.confirmable_notifications
+            ? AVS_COAP_MSG_CONFIRMABLE : AVS_COAP_MSG_NON_CONFIRMABLE;
+}
+
+static int query_resource_version(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj,
+                                  const anjay_observe_key_t *key,
+                                  uint64_t *out_version) {
+    if (key->rid < 0) {
+        // versions are only reported for single Resources
+        return -1;
+    }
+    return _anjay_dm_resource_version(anjay, obj, key->iid,
+                                      (anjay_rid_t) key->rid, out_version,
+                                      NULL);
+}
+
+/**
+ * Queues the newest value of @p entry again, without reading it from the data
+ * model, as it is known not to have changed.
+ */
+static int insert_unchanged_value(anjay_t *anjay,
+                                  anjay_observe_connection_entry_t *conn_state,
+                                  anjay_observe_entry_t *entry,
+                                  const anjay_dm_internal_res_attrs_t *attrs) {
+    // the read would check access control, so it needs to be done here
+    if (!_anjay_access_control_action_allowed(
+            anjay, &(const anjay_action_info_t) {
+                .oid = entry->key.oid,
+                .iid = entry->key.iid,
+                .ssid = entry->key.connection.ssid,
+                .action = ANJAY_ACTION_READ
+            })) {
+        return ANJAY_ERR_UNAUTHORIZED;
+    }
+    // the record holding the newest value may be reused for the new one
+    anjay_observe_resource_value_t value = *newest_value(entry);
+    payload_acquire(value.payload);
+    value.details.msg_type = notification_type(anjay, attrs);
+    int result = insert_new_value(anjay, conn_state, entry, &value.details,
+                                  &value.identity, value.numeric,
+                                  value.payload);
+    payload_release(&value.payload);
+    return result;
+}
+
+/**
+ * Reads the current value of @p entry and queues it if a notification is due.
+ *
+ * @returns 0 or a negative error code; @p out_newest is set to true if the
+ *          value read is now the newest value of @p entry.
+ */
+static int insert_read_value(anjay_t *anjay,
+                             anjay_observe_connection_entry_t *conn_state,
+                             anjay_observe_entry_t *entry,
+                             const anjay_dm_object_def_t *const *obj,
+                             const anjay_dm_internal_res_attrs_t *attrs,
+                             bool pmax_expired,
+                             bool *out_newest) {
+    anjay_msg_details_t observe_details;
+    double numeric = NAN;
+    anjay_observe_payload_t *payload;
+    ssize_t size = read_new_value(anjay, obj, entry, &observe_details, &numeric,
+                                  &payload);
+    if (size < 0) {
+        return (int) size;
+    }
+    observe_details.msg_type = notification_type(anjay, attrs);
+
+    const anjay_observe_resource_value_t *newest = newest_value(entry);
+    int result = 0;
+    if (pmax_expired || should_update(newest, &attrs->standard,
+                                      &observe_details, numeric, payload)) {
+        result = insert_new_value(anjay, conn_state, entry, &observe_details,
+                                  &newest->identity, numeric, payload);
+        *out_newest = !result;
+    } else {
+        *out_newest = (observe_details.format == newest->details.format
+                       && payload_equal(payload, newest->payload));
+    }
+    payload_release(&payload);
+    return result;
+}
+
 static int
 update_notification_value(anjay_t *anjay,
                           anjay_observe_connection_entry_t *conn_state,
@@ -888,31 +1936,20 @@ update_notification_value(anjay_t *anjay,
 
     bool pmax_expired = has_pmax_expired(newest_value(entry),
                                          &attrs.standard.common);
-    char buf[ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE];
-    anjay_msg_details_t observe_details;
-    double numeric = NAN;
-    ssize_t size = read_new_value(anjay, obj, entry, &observe_details, &numeric,
-                                  buf, sizeof(buf));
-    if (size < 0) {
-        return (int) size;
-    }
-#ifdef WITH_CON_ATTR
-    if (attrs.custom.data.con >= 0) {
-        observe_details.msg_type = (attrs.custom.data.con > 0)
-                ? AVS_COAP_MSG_CONFIRMABLE : AVS_COAP_MSG_NON_CONFIRMABLE;
-    } else
-#endif // WITH_CON_ATTR
-    {
-        observe_details.msg_type = anjay->observe.confirmable_notifications
-                ? AVS_COAP_MSG_CONFIRMABLE : AVS_COAP_MSG_NON_CONFIRMABLE;
-    }
-
-    if (pmax_expired || should_update(newest_value(entry), &attrs.standard,
-                                      &observe_details, numeric,
-                                      buf, (size_t) size)) {
-        result = insert_new_value(conn_state, entry, &observe_details,
-                                  &newest_value(entry)->identity, numeric,
-                                  buf, (size_t) size);
+    uint64_t version = 0;
+    const bool version_known =
+            !query_resource_version(anjay, obj, &entry->key, &version);
+    if (version_known && entry->value_version_valid
+            && version == entry->value_version) {
+        if (pmax_expired) {
+            result = insert_unchanged_value(anjay, conn_state, entry, &attrs);
+        }
+    } else {
+        bool newest = false;
+        result = insert_read_value(anjay, conn_state, entry, obj, &attrs,
+                                   pmax_expired, &newest);
+        entry->value_version_valid = (version_known && newest);
+        entry->value_version = version;
     }
 
     if (schedule_trigger(anjay, entry, attrs.standard.common.max_period)) {
@@ -1143,6 +2180,7 @@ int _anjay_observe_notify(anjay_t *anjay,
     assert(key->format == AVS_COAP_FORMAT_NONE);
     const anjay_dm_object_def_t *const *obj =
             _anjay_dm_find_object_by_oid(anjay, key->oid);
+    invalidate_cached_reads(anjay, key);
 
     // iterate through all SSIDs we have
     int result = 0;
@@ -26,22 +26,38 @@
 #include "coap/coap_stream.h"
 #include "servers.h"
 #include "sched.h"
+#include "utils_core.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 #ifdef WITH_OBSERVE
 
+/**
+ * Stream that serializes a value into a fixed buffer. Data that does not fit
+ * in the buffer is discarded, but all of it is still counted and hashed, so
+ * that values larger than the buffer can be compared against previous ones.
+ */
 typedef struct {
     avs_stream_outbuf_t outbuf;
     anjay_msg_details_t *details;
+    size_t capacity;
+    // total length of the value; if larger than capacity, the buffer contents
+    // are incomplete and shall not be used
+    size_t length;
+    // FNV-1a hash of the whole value
+    uint64_t hash;
 } anjay_observe_stream_t;
 
 const anjay_observe_stream_t *_anjay_observe_stream_initializer__(void);
 
 static inline anjay_observe_stream_t
-_anjay_new_observe_stream(anjay_msg_details_t *details) {
+_anjay_new_observe_stream(anjay_msg_details_t *details,
+                          char *buffer,
+                          size_t size) {
     anjay_observe_stream_t retval = *_anjay_observe_stream_initializer__();
+    avs_stream_outbuf_set_buffer(&retval.outbuf, buffer, size);
     retval.details = details;
+    retval.capacity = size;
     return retval;
 }
 
@@ -49,9 +65,65 @@ typedef struct anjay_observe_entry_struct anjay_observe_entry_t;
 typedef struct anjay_observe_connection_entry_struct
         anjay_observe_connection_entry_t;
 
+typedef struct anjay_observe_cached_read_struct anjay_observe_cached_read_t;
+
+#define ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES 16
+
+/**
+ * Free lists of payload blocks, indexed by power-of-two size class. Released
+ * payloads are kept for reuse instead of being freed, so that storing a new
+ * value does not normally require an allocation. At most max_free_bytes worth
+ * of blocks are kept.
+ */
+typedef struct {
+    void *free_blocks[ANJAY_OBSERVE_PAYLOAD_POOL_CLASSES];
+    size_t free_bytes;
+    size_t max_free_bytes;
+} anjay_observe_payload_pool_t;
+
+/**
+ * Immutable, reference-counted serialized value. A single payload is shared by
+ * the read cache and by queued and last sent values of all connections.
+ */
+typedef struct {
+    // pool to return the payload to when it is released
+    anjay_observe_payload_pool_t *pool;
+    size_t refcount;
+    // length of the serialized value
+    size_t size;
+    // FNV-1a hash of the serialized value
+    uint64_t hash;
+    // if true, the value was larger than ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE,
+    // so data is empty and the current value is serialized again when
+    // sending; size and hash of the value actually sent are then stored as the
+    // last sent one, and consecutive queued values of this kind are coalesced
+    bool hashed_only;
+    char data[1]; // actually a FAM
+} anjay_observe_payload_t;
+
 typedef struct {
     AVS_RBTREE(anjay_observe_connection_entry_t) connection_entries;
+    // values read during the current scheduler run, shared between all
+    // observations of the same path and format
+    AVS_LIST(anjay_observe_cached_read_t) read_cache;
+    anjay_observe_payload_pool_t payload_pool;
+    anjay_sched_handle_t read_cache_clear_task;
+    // scratch buffer of ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE bytes for reading
+    // new values, allocated on first use
+    char *read_buffer;
     bool confirmable_notifications;
+    // 0 means that Confirmable notifications are sent synchronously
+    size_t max_notifications_in_flight;
+    anjay_rand_seed_t rand_seed;
+    size_t stored_notifications_buffer_size;
+    anjay_notification_overflow_policy_t notification_overflow_policy;
+    bool coalesce_notifications;
+
+#ifdef WITH_NET_STATS
+    uint64_t notifications_sent;
+    uint64_t notifications_acknowledged;
+    uint64_t notifications_dropped;
+#endif // WITH_NET_STATS
 } anjay_observe_state_t;
 
 typedef struct {
@@ -60,8 +132,8 @@ typedef struct {
     avs_coap_msg_identity_t identity;
     avs_time_real_t timestamp;
     double numeric;
-    const size_t value_length;
-    char value[1]; // actually a FAM
+    // NULL for empty values
+    anjay_observe_payload_t *payload;
 } anjay_observe_resource_value_t;
 
 typedef struct {
@@ -72,7 +144,8 @@ typedef struct {
     uint16_t format;
 } anjay_observe_key_t;
 
-int _anjay_observe_init(anjay_t *anjay, bool confirmable_notifications);
+int _anjay_observe_init(anjay_t *anjay,
+                        const anjay_configuration_t *config);
 
 void _anjay_observe_cleanup(anjay_t *anjay);
 
@@ -84,14 +157,65 @@ int _anjay_observe_put_entry(anjay_t *anjay,
                              const void *data,
                              size_t size);
 
+/**
+ * Variant of @ref _anjay_observe_put_entry for values larger than
+ * ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE, which are only identified by their
+ * length and hash, as calculated by anjay_observe_stream_t.
+ */
+int _anjay_observe_put_hashed_entry(anjay_t *anjay,
+                                    const anjay_observe_key_t *key,
+                                    const anjay_msg_details_t *details,
+                                    const avs_coap_msg_identity_t *identity,
+                                    double numeric,
+                                    size_t size,
+                                    uint64_t hash);
+
 void _anjay_observe_remove_entry(anjay_t *anjay,
                                  const anjay_observe_key_t *key);
 
+/**
+ * @returns Scratch buffer of ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE bytes for
+ *          serializing observed values, allocated on first use, or NULL if
+ *          out of memory.
+ */
+char *_anjay_observe_read_buffer(anjay_t *anjay);
+
+/**
+ * Serializes the current value of the resource observed with @p key directly
+ * into anjay->comm_stream, on which the message carrying it has already been
+ * set up. The bytes actually sent are also written into @p copy, so that they
+ * can be stored or hashed.
+ */
+int _anjay_observe_resend_value(anjay_t *anjay,
+                                const anjay_observe_key_t *key,
+                                double *out_numeric,
+                                anjay_observe_stream_t *copy);
+
 void _anjay_observe_remove_by_msg_id(anjay_t *anjay,
                                      uint16_t notify_id);
 
 int _anjay_observe_sched_flush_current_connection(anjay_t *anjay);
 
+/**
+ * Matches @p msg against the Confirmable notifications awaiting
+ * acknowledgement on the current connection.
+ *
+ * @returns 0 if @p msg was an ACK or Reset for one of them and has been
+ *          handled, or a positive value if it is unrelated to notifications.
+ */
+int _anjay_observe_handle_response(anjay_t *anjay, const avs_coap_msg_t *msg);
+
+typedef struct {
+    size_t count;
+    size_t bytes;
+} anjay_observe_queue_stats_t;
+
+/**
+ * @returns Number and total size of notifications queued for sending on all
+ *          connections.
+ */
+anjay_observe_queue_stats_t _anjay_observe_queue_stats(anjay_t *anjay);
+
 int _anjay_observe_notify(anjay_t *anjay,
                           const anjay_observe_key_t *origin_key,
                           bool invert_ssid_match);
@@ -104,6 +228,7 @@ anjay_output_ctx_t *_anjay_observe_decorate_ctx(anjay_output_ctx_t *backend,
 #define _anjay_observe_init(...) ((int) 0)
 #define _anjay_observe_cleanup(...) ((void) 0)
 #define _anjay_observe_sched_flush_current_connection(...) ((void) 0)
+#define _anjay_observe_handle_response(...) ((int) 1)
 
 #endif // WITH_OBSERVE
 
@@ -50,11 +50,208 @@ anjay_sched_t *_anjay_sched_new(anjay_t *anjay) {
     return sched;
 }
 
+#ifdef WITH_SCHED_HEAP
+
+/*
+ * Binary min-heap backend. Each entry remembers its own index in the heap
+ * array, so that arbitrary entries can be removed in O(log n) without
+ * searching for them.
+ */
+
+#define SCHED_HEAP_MIN_CAPACITY 16
+
+static bool entry_before(const anjay_sched_entry_t *left,
+                         const anjay_sched_entry_t *right) {
+    if (avs_time_monotonic_before(left->when, right->when)) {
+        return true;
+    }
+    if (avs_time_monotonic_before(right->when, left->when)) {
+        return false;
+    }
+    return left->seq < right->seq;
+}
+
+static void heap_put(anjay_sched_t *sched,
+                     size_t index,
+                     anjay_sched_entry_t *entry) {
+    sched->heap[index] = entry;
+    entry->heap_index = index;
+}
+
+static void heap_sift_up(anjay_sched_t *sched, size_t index) {
+    anjay_sched_entry_t *entry = sched->heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!entry_before(entry, sched->heap[parent])) {
+            break;
+        }
+        heap_put(sched, index, sched->heap[parent]);
+        index = parent;
+    }
+    heap_put(sched, index, entry);
+}
+
+static void heap_sift_down(anjay_sched_t *sched, size_t index) {
+    anjay_sched_entry_t *entry = sched->heap[index];
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= sched->heap_size) {
+            break;
+        }
+        if (child + 1 < sched->heap_size
+                && entry_before(sched->heap[child + 1], sched->heap[child])) {
+            ++child;
+        }
+        if (!entry_before(sched->heap[child], entry)) {
+            break;
+        }
+        heap_put(sched, index, sched->heap[child]);
+        index = child;
+    }
+    heap_put(sched, index, entry);
+}
+
+static int heap_reserve(anjay_sched_t *sched, size_t size) {
+    if (size <= sched->heap_capacity) {
+        return 0;
+    }
+    size_t new_capacity = sched->heap_capacity
+            ? 2 * sched->heap_capacity : SCHED_HEAP_MIN_CAPACITY;
+    if (new_capacity < sched->heap_capacity
+            || new_capacity > SIZE_MAX / sizeof(*sched->heap)) {
+        return -1;
+    }
+    anjay_sched_entry_t **new_heap = (anjay_sched_entry_t **)
+            realloc(sched->heap, new_capacity * sizeof(*sched->heap));
+    if (!new_heap) {
+        return -1;
+    }
+    sched->heap = new_heap;
+    sched->heap_capacity = new_capacity;
+    return 0;
+}
+
+static void heap_shrink(anjay_sched_t *sched) {
+    if (sched->heap_capacity <= SCHED_HEAP_MIN_CAPACITY
+            || sched->heap_size > sched->heap_capacity / 4) {
+        return;
+    }
+    size_t new_capacity = sched->heap_capacity / 2;
+    anjay_sched_entry_t **new_heap = (anjay_sched_entry_t **)
+            realloc(sched->heap, new_capacity * sizeof(*sched->heap));
+    if (new_heap) {
+        sched->heap = new_heap;
+        sched->heap_capacity = new_capacity;
+    }
+}
+
+static size_t entries_count(const anjay_sched_t *sched) {
+    return sched->heap_size;
+}
+
+static int entries_insert(anjay_sched_t *sched,
+                          AVS_LIST(anjay_sched_entry_t) entry) {
+    if (heap_reserve(sched, sched->heap_size + 1)) {
+        sched_log(ERROR, "could not grow scheduler heap");
+        return -1;
+    }
+    entry->seq = sched->next_seq++;
+    heap_put(sched, sched->heap_size++, entry);
+    heap_sift_up(sched, entry->heap_index);
+    return 0;
+}
+
+static bool entries_contain(anjay_sched_t *sched,
+                            const anjay_sched_entry_t *entry) {
+#ifdef NDEBUG
+    /* Searching the heap would make removal O(n), so release builds trust the
+     * handle - see _anjay_sched_del() */
+    (void) sched;
+    (void) entry;
+    return true;
+#else
+    /* the entry is not dereferenced, as the handle might be dangling */
+    for (size_t i = 0; i < sched->heap_size; ++i) {
+        if (sched->heap[i] == entry) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
+static AVS_LIST(anjay_sched_entry_t)
+entries_detach(anjay_sched_t *sched, anjay_sched_entry_t *entry) {
+    assert(entries_contain(sched, entry));
+    size_t index = entry->heap_index;
+    anjay_sched_entry_t *last = sched->heap[--sched->heap_size];
+    if (last != entry) {
+        heap_put(sched, index, last);
+        if (index > 0 && entry_before(last, sched->heap[(index - 1) / 2])) {
+            heap_sift_up(sched, index);
+        } else {
+            heap_sift_down(sched, index);
+        }
+    }
+    heap_shrink(sched);
+    return entry;
+}
+
+static void entries_cleanup(anjay_sched_t *sched) {
+    assert(!sched->heap_size);
+    free(sched->heap);
+    sched->heap = NULL;
+    sched->heap_capacity = 0;
+}
+
+#else // WITH_SCHED_HEAP
+
+/*
+ * Sorted list backend. Insertion and removal of arbitrary entries are O(n),
+ * but it does not need any memory apart from the entries themselves.
+ */
+
+static size_t entries_count(const anjay_sched_t *sched) {
+    return AVS_LIST_SIZE(sched->entries);
+}
+
+static int entries_insert(anjay_sched_t *sched,
+                          AVS_LIST(anjay_sched_entry_t) entry) {
+    AVS_LIST(anjay_sched_entry_t) *entry_ptr = NULL;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &sched->entries) {
+        if (avs_time_monotonic_before(entry->when, (*entry_ptr)->when)) {
+            break;
+        }
+    }
+    AVS_LIST_INSERT(entry_ptr, entry);
+    return 0;
+}
+
+static bool entries_contain(anjay_sched_t *sched,
+                            const anjay_sched_entry_t *entry) {
+    return AVS_LIST_FIND_PTR(&sched->entries, entry) != NULL;
+}
+
+static AVS_LIST(anjay_sched_entry_t)
+entries_detach(anjay_sched_t *sched, anjay_sched_entry_t *entry) {
+    AVS_LIST(anjay_sched_entry_t) *entry_ptr =
+            AVS_LIST_FIND_PTR(&sched->entries, entry);
+    assert(entry_ptr);
+    return AVS_LIST_DETACH(entry_ptr);
+}
+
+static void entries_cleanup(anjay_sched_t *sched) {
+    assert(!sched->entries);
+    (void) sched;
+}
+
+#endif // WITH_SCHED_HEAP
+
 static anjay_sched_entry_t *fetch_task(anjay_sched_t *sched,
                                        const avs_time_monotonic_t *now) {
-    if (sched->entries
-            && !avs_time_monotonic_before(*now, sched->entries->when)) {
-        return AVS_LIST_DETACH(&sched->entries);
+    anjay_sched_entry_t *first = _anjay_sched_first_entry(sched);
+    if (first && !avs_time_monotonic_before(*now, first->when)) {
+        return entries_detach(sched, first);
     } else {
         return NULL;
     }
@@ -142,7 +339,7 @@ ssize_t _anjay_sched_run(anjay_sched_t *sched) {
     _anjay_sched_time_to_next(sched, &delay);
     sched_log(TRACE, "%lu scheduled tasks remain; next after "
                      "%" PRId64 ".%09" PRId32,
-              (unsigned long)AVS_LIST_SIZE(sched->entries),
+              (unsigned long) entries_count(sched),
               delay.seconds, delay.nanoseconds);
     return tasks_executed;
 }
@@ -156,11 +353,16 @@ void _anjay_sched_delete(anjay_sched_t **sched_ptr) {
 
     /* execute any remaining tasks */
     _anjay_sched_run(*sched_ptr);
-    AVS_LIST_CLEAR(&(*sched_ptr)->entries) {
-        if ((*sched_ptr)->entries->handle_ptr) {
-            *(*sched_ptr)->entries->handle_ptr = NULL;
+    anjay_sched_entry_t *entry;
+    while ((entry = _anjay_sched_first_entry(*sched_ptr))) {
+        AVS_LIST(anjay_sched_entry_t) detached =
+                entries_detach(*sched_ptr, entry);
+        if (detached->handle_ptr) {
+            *detached->handle_ptr = NULL;
         }
+        AVS_LIST_DELETE(&detached);
     }
+    entries_cleanup(*sched_ptr);
     free(*sched_ptr);
     *sched_ptr = NULL;
 }
@@ -168,22 +370,16 @@ void _anjay_sched_delete(anjay_sched_t **sched_ptr) {
 static anjay_sched_handle_t
 insert_entry(anjay_sched_t *sched,
              AVS_LIST(anjay_sched_entry_t) entry) {
-    anjay_sched_entry_t **entry_ptr = NULL;
-
     if (!sched || sched->shut_down) {
         sched_log(DEBUG, "scheduler already shut down");
         return NULL;
     }
 
-    AVS_LIST_FOREACH_PTR(entry_ptr, &sched->entries) {
-        if (avs_time_monotonic_before(entry->when, (*entry_ptr)->when)) {
-            break;
-        }
+    if (entries_insert(sched, entry)) {
+        return NULL;
     }
-
-    AVS_LIST_INSERT(entry_ptr, entry);
     sched_log(TRACE, "%p inserted; %lu tasks scheduled",
-              (void*)entry, (unsigned long)AVS_LIST_SIZE(sched->entries));
+              (void*)entry, (unsigned long) entries_count(sched));
     return entry;
 }
 
@@ -242,12 +438,6 @@ sched_delayed(anjay_sched_t *sched,
     return insert_entry(sched, entry);
 }
 
-static anjay_sched_entry_t **find_task_entry_ptr(anjay_sched_t *sched,
-                                                 anjay_sched_handle_t *handle) {
-    return AVS_LIST_FIND_PTR(&sched->entries,
-                             *((anjay_sched_entry_t **) handle));
-}
-
 static int schedule(anjay_sched_t *sched,
                     anjay_sched_handle_t *out_handle,
                     anjay_sched_retryable_backoff_t *backoff_config,
@@ -299,39 +489,37 @@ int _anjay_sched_del(anjay_sched_t *sched, anjay_sched_handle_t *handle) {
     }
     sched_log(TRACE, "canceling task %p", *handle);
     int result = 0;
-    anjay_sched_entry_t **task_ptr = find_task_entry_ptr(sched, handle);
-    if (!task_ptr) {
+    anjay_sched_entry_t *task = (anjay_sched_entry_t *) *handle;
+    if (!entries_contain(sched, task)) {
         sched_log(ERROR, "cannot delete task %p - not found", *handle);
         assert(0 && "Dangling handle detected");
         result = -1;
-    } else if (handle != (*task_ptr)->handle_ptr) {
+    } else if (handle != task->handle_ptr) {
         assert(0 && "Removing task via non-original handle");
         result = -1;
     } else {
-        if ((*task_ptr)->handle_ptr) {
-            *(*task_ptr)->handle_ptr = NULL;
-        }
-        AVS_LIST_DELETE(task_ptr);
+        AVS_LIST(anjay_sched_entry_t) detached = entries_detach(sched, task);
+        *detached->handle_ptr = NULL;
+        AVS_LIST_DELETE(&detached);
     }
     return result;
 }
 
 int _anjay_sched_time_to_next(anjay_sched_t *sched,
                               avs_time_duration_t *delay) {
-    anjay_sched_entry_t *elem;
     avs_time_monotonic_t now = avs_time_monotonic_now();
+    anjay_sched_entry_t *elem = _anjay_sched_first_entry(sched);
+    if (!elem) {
+        return -1;
+    }
 
-    AVS_LIST_FOREACH(elem, sched->entries) {
-        if (delay) {
-            *delay = avs_time_monotonic_diff(elem->when, now);
-            if (avs_time_duration_less(*delay, AVS_TIME_DURATION_ZERO)) {
-                *delay = AVS_TIME_DURATION_ZERO;
-            }
+    if (delay) {
+        *delay = avs_time_monotonic_diff(elem->when, now);
+        if (avs_time_duration_less(*delay, AVS_TIME_DURATION_ZERO)) {
+            *delay = AVS_TIME_DURATION_ZERO;
         }
-        return 0;
     }
-
-    return -1;
+    return 0;
 }
 
 #ifdef ANJAY_TEST
@@ -69,6 +69,10 @@ int _anjay_sched(anjay_sched_t *sched,
  * Removes job handle (pointed by @p handle) from the scheduler, and therefore
  * invalidates it by setting it to NULL.
  *
+ * @p handle must not refer to a job that has already been executed or removed.
+ * Such dangling handles are always detected by the list backend, but the heap
+ * backend (WITH_SCHED_HEAP) only detects them in debug builds.
+ *
  * @param sched     Scheduler object to remove job from.
  * @param handle    Pointer to the job handle to remove.
  *
@@ -35,6 +35,12 @@ typedef struct {
     avs_time_monotonic_t when;
     anjay_sched_clb_t clb;
     void *clb_data;
+#ifdef WITH_SCHED_HEAP
+    /* position of the entry in anjay_sched_t::heap */
+    size_t heap_index;
+    /* insertion order; keeps entries scheduled for the same time FIFO */
+    uint64_t seq;
+#endif // WITH_SCHED_HEAP
 } anjay_sched_entry_t;
 
 typedef struct {
@@ -45,10 +51,31 @@ typedef struct {
 
 struct anjay_sched_struct {
     anjay_t *anjay;
+#ifdef WITH_SCHED_HEAP
+    /* binary min-heap of entries, ordered by (when, seq) */
+    anjay_sched_entry_t **heap;
+    size_t heap_size;
+    size_t heap_capacity;
+    uint64_t next_seq;
+#else // WITH_SCHED_HEAP
     AVS_LIST(anjay_sched_entry_t) entries;
+#endif // WITH_SCHED_HEAP
     bool shut_down;
 };
 
+/**
+ * Returns the entry that will be executed first, or NULL if there are no jobs
+ * scheduled. Works regardless of the backend used.
+ */
+static inline anjay_sched_entry_t *
+_anjay_sched_first_entry(const anjay_sched_t *sched) {
+#ifdef WITH_SCHED_HEAP
+    return sched->heap_size ? sched->heap[0] : NULL;
+#else // WITH_SCHED_HEAP
+    return sched->entries;
+#endif // WITH_SCHED_HEAP
+}
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_SCHED_INTERNAL_H */
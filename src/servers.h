@@ -19,6 +19,8 @@
 
 #include <anjay/core.h>
 
+#include <avsystem/commons/coap/tx_params.h>
+
 #include "utils_core.h"
 #include "sched.h"
 #include "coap/coap_stream.h"
@@ -36,17 +38,60 @@ typedef struct {
     AVS_LIST(anjay_iid_t) instances;
 } anjay_dm_cache_object_t;
 
+/**
+ * Snapshot of the data model structure, as presented in Register and Update
+ * messages, shared by all servers. It is kept up to date incrementally, based
+ * on the instance set changes passed to @ref _anjay_notify_perform.
+ */
+typedef struct {
+    AVS_LIST(anjay_dm_cache_object_t) objects;
+    /** Incremented whenever objects change */
+    uint64_t generation;
+    /** If false, objects need to be rebuilt from scratch before use */
+    bool valid;
+    /** CoRE Link Format representation of objects, built on first use */
+    char *payload;
+    size_t payload_size;
+    /** Generation of objects that payload has been built from */
+    uint64_t payload_generation;
+} anjay_registration_dm_cache_t;
+
 typedef struct {
     int64_t lifetime_s;
-    AVS_LIST(anjay_dm_cache_object_t) dm;
+    /** Generation of anjay_t::registration_dm_cache that was presented */
+    uint64_t dm_generation;
     anjay_binding_mode_t binding_mode;
 } anjay_update_parameters_t;
 
+typedef enum {
+    ANJAY_REGISTRATION_EXCHANGE_UPDATE,
+    ANJAY_REGISTRATION_EXCHANGE_REGISTER
+} anjay_registration_exchange_type_t;
+
+/**
+ * Register or Update request sent without waiting for the response.
+ * Retransmissions are performed by a scheduler job and the response is matched
+ * in anjay_serve().
+ */
+typedef struct {
+    /** NULL if there is no exchange in progress */
+    avs_coap_msg_t *request;
+    anjay_registration_exchange_type_t type;
+    /** Parameters to store as last_update_params once the request succeeds */
+    anjay_update_parameters_t params;
+    avs_coap_retry_state_t retry_state;
+    /** Seeded when the server is activated; used for retransmission jitter */
+    anjay_rand_seed_t rand_seed;
+    /** Set after receiving an empty ACK; the response comes separately */
+    bool separate_ack_received;
+} anjay_update_exchange_t;
+
 typedef struct {
     AVS_LIST(const anjay_string_t) endpoint_path;
     anjay_connection_type_t conn_type;
     avs_time_monotonic_t expire_time;
     anjay_update_parameters_t last_update_params;
+    anjay_update_exchange_t update_exchange;
 } anjay_registration_info_t;
 
 typedef enum {
@@ -83,6 +128,14 @@ typedef struct {
 
     bool needs_socket_update;
 
+    /**
+     * Set whenever the socket is closed, (re)connected or replaced. The socket
+     * object may stay the same while its system socket changes, so
+     * anjay_get_sockets() checks and clears this flag to decide whether to
+     * bump anjay_servers_t::public_sockets_generation.
+     */
+    bool socket_changed;
+
     bool queue_mode;
 
     /**
@@ -110,6 +163,14 @@ typedef struct {
      * <c>_anjay_connection_internal_ensure_online()</c>.
      */
     anjay_sched_handle_t queue_mode_close_socket_clb_handle;
+
+    /**
+     * State of a Block1 request being received on this connection, if any.
+     * Blocks are buffered across anjay_serve() calls instead of waiting for
+     * them on the socket - see
+     * <c>_anjay_coap_stream_set_block1_reassembly()</c>.
+     */
+    anjay_coap_block1_reassembly_t *block1_reassembly;
 } anjay_server_connection_t;
 
 typedef struct {
@@ -119,7 +180,17 @@ typedef struct {
     anjay_server_connection_t udp_connection;
 
     anjay_registration_info_t registration_info;
+    /**
+     * Handle to the job sending the next Update or, while a Register or Update
+     * exchange is in progress, to the job retransmitting it.
+     */
     anjay_sched_handle_t sched_update_handle;
+    /**
+     * Delay before sending another Register or Update after the previous one
+     * failed asynchronously. Doubles on each consecutive failure, zero after
+     * a successful request.
+     */
+    avs_time_duration_t update_retry_delay;
 } anjay_active_server_info_t;
 
 // inactive servers include administratively disabled ones
@@ -128,6 +199,12 @@ typedef struct {
     anjay_ssid_t ssid;
     anjay_sched_handle_t sched_reactivate_handle;
     bool needs_activation;
+    /**
+     * Value of anjay_active_server_info_t::update_retry_delay to restore on
+     * reactivation, non-zero if the server has been deactivated after its
+     * Register failed.
+     */
+    avs_time_duration_t update_retry_delay;
 } anjay_inactive_server_info_t;
 
 typedef struct {
@@ -135,6 +212,8 @@ typedef struct {
     AVS_LIST(anjay_inactive_server_info_t) inactive;
 
     AVS_LIST(avs_net_abstract_socket_t *const) public_sockets;
+    /* incremented whenever the contents of public_sockets change */
+    uint64_t public_sockets_generation;
 } anjay_servers_t;
 
 typedef struct {
@@ -192,6 +271,32 @@ bool _anjay_servers_is_connected_to_non_bootstrap(anjay_servers_t *servers);
 int _anjay_schedule_server_reconnect(anjay_t *anjay,
                                      anjay_active_server_info_t *server);
 
+/**
+ * Matches a non-request message received on the currently bound connection
+ * against the Update exchange in progress on it, if any, and handles it.
+ *
+ * @returns
+ * - 0 if @p msg was related to the Update exchange,
+ * - a positive value if it was not,
+ * - a negative value in case of error.
+ */
+int _anjay_server_handle_update_response(anjay_t *anjay,
+                                         const avs_coap_msg_t *msg);
+
+/**
+ * Fails the Update exchange in progress on the currently bound connection, if
+ * any, after receiving on that connection failed with a network error.
+ */
+void _anjay_server_handle_network_error(anjay_t *anjay);
+
+/**
+ * Returns true if a Register has been sent to @p server and its response is
+ * yet to be received. Until then, the server is not considered connected and
+ * its requests are not served.
+ */
+bool _anjay_server_registration_pending(
+        const anjay_active_server_info_t *server);
+
 anjay_binding_mode_t
 _anjay_server_cached_binding_mode(anjay_active_server_info_t *server);
 
@@ -17,6 +17,7 @@
 #include <config.h>
 
 #include <inttypes.h>
+#include <time.h>
 
 #include "../dm/query.h"
 
@@ -38,9 +39,12 @@ static void active_server_detach_delete(
 
 static int
 initialize_active_server(anjay_t *anjay,
-                         anjay_ssid_t ssid,
+                         const anjay_inactive_server_info_t *inactive_server,
                          anjay_active_server_info_t *server) {
-    server->ssid = ssid;
+    server->ssid = inactive_server->ssid;
+    server->registration_info.update_exchange.rand_seed =
+            (anjay_rand_seed_t) time(NULL);
+    server->update_retry_delay = inactive_server->update_retry_delay;
 
     if (_anjay_server_refresh(anjay, server, true)) {
         anjay_log(TRACE, "could not initialize sockets for SSID %u",
@@ -66,8 +70,8 @@ initialize_active_server(anjay_t *anjay,
 }
 
 static AVS_LIST(anjay_active_server_info_t)
-create_active_server_from_ssid(anjay_t *anjay,
-                               anjay_ssid_t ssid) {
+create_active_server(anjay_t *anjay,
+                     const anjay_inactive_server_info_t *inactive_server) {
     AVS_LIST(anjay_active_server_info_t) server =
             AVS_LIST_NEW_ELEMENT(anjay_active_server_info_t);
 
@@ -76,7 +80,7 @@ create_active_server_from_ssid(anjay_t *anjay,
         return NULL;
     }
 
-    if (initialize_active_server(anjay, ssid, server)) {
+    if (initialize_active_server(anjay, inactive_server, server)) {
         active_server_detach_delete(anjay, &server);
         return NULL;
     }
@@ -97,7 +101,7 @@ static int activate_server_job(anjay_t *anjay, void *ssid_) {
     assert(*inactive_server_ptr && "_anjay_servers_find_inactive_ptr broken");
 
     AVS_LIST(anjay_active_server_info_t) new_server =
-            create_active_server_from_ssid(anjay, ssid);
+            create_active_server(anjay, *inactive_server_ptr);
     if (!new_server) {
         return -1;
     }
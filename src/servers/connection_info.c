@@ -73,6 +73,9 @@ avs_net_abstract_socket_t *_anjay_connection_internal_get_socket(
 
 void
 _anjay_connection_internal_clean_socket(anjay_server_connection_t *connection) {
+    if (connection->conn_priv_data_.socket) {
+        connection->socket_changed = true;
+    }
     avs_net_socket_cleanup(&connection->conn_priv_data_.socket);
     memset(&connection->conn_priv_data_, 0,
            sizeof(connection->conn_priv_data_));
@@ -266,6 +269,7 @@ refresh_connection(anjay_t *anjay,
         if (existing_socket == NULL || force_reconnect
                 || out_connection->needs_socket_update) {
             _anjay_connection_internal_clean_socket(out_connection);
+            out_connection->socket_changed = true;
             if (def->create_connected_socket(anjay, out_connection, info,
                                              &dtls_keys)
                 || avs_net_socket_get_local_port(
@@ -636,13 +640,14 @@ int _anjay_server_setup_registration_connection(
 }
 
 static void connection_suspend(anjay_connection_ref_t conn_ref) {
-    const anjay_server_connection_t *connection =
+    anjay_server_connection_t *connection =
             _anjay_get_server_connection(conn_ref);
     if (connection) {
         avs_net_abstract_socket_t *socket =
                 _anjay_connection_internal_get_socket(connection);
         if (socket) {
             avs_net_socket_close(socket);
+            connection->socket_changed = true;
         }
     }
 }
@@ -675,6 +680,8 @@ int _anjay_connection_internal_ensure_online(
         // already connected, OK
         return 0;
     }
+    // whatever happens below, the system socket will not be the same
+    connection->socket_changed = true;
     if (opt.state != AVS_NET_SOCKET_STATE_CLOSED
             && avs_net_socket_close(connection->conn_priv_data_.socket)) {
         anjay_log(ERROR, "Could not close the socket (?!)");
@@ -18,6 +18,7 @@
 
 #include "../servers.h"
 #include "../anjay_core.h"
+#include "../interface/register.h"
 
 #define ANJAY_SERVERS_INTERNALS
 
@@ -37,6 +38,9 @@ static int enter_offline_job(anjay_t *anjay,
     AVS_LIST_FOREACH(server, anjay->servers.active) {
         disable_connection(&server->udp_connection);
         _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+        // nothing would retransmit the request or receive its response
+        _anjay_update_exchange_cleanup(
+                &server->registration_info.update_exchange);
     }
     _anjay_sched_del(anjay->sched, &anjay->reload_servers_sched_job_handle);
     anjay->offline = true;
@@ -20,6 +20,8 @@
 
 #include <anjay_modules/time_defs.h>
 
+#include <avsystem/commons/coap/tx_params.h>
+
 #include "../sched.h"
 #include "../anjay_core.h"
 #include "../servers.h"
@@ -139,6 +141,12 @@ static int send_update_sched_job(anjay_t *anjay, void *args) {
         }
     }
 
+    if (result == ANJAY_REGISTRATION_UPDATE_IN_PROGRESS) {
+        // the response will be handled in anjay_serve(); the retransmission
+        // job has already been scheduled in place of this one
+        return 0;
+    }
+
     // Updates are retryable, so we only need to reschedule after success
     if (!result) {
         result = _anjay_server_reschedule_update_job(anjay, server);
@@ -190,6 +198,250 @@ schedule_next_update(anjay_t *anjay,
                            DONT_RECONNECT);
 }
 
+/**
+ * Performs the actions that follow a successful Register, i.e. schedules the
+ * first Update and flushes notifications that were waiting for the server.
+ */
+static int registration_succeeded(anjay_t *anjay,
+                                  anjay_active_server_info_t *server) {
+    server->update_retry_delay = AVS_TIME_DURATION_ZERO;
+    _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+
+    int result;
+    if (server->registration_info.last_update_params.dm_generation
+            != anjay->registration_dm_cache.generation) {
+        // the data model changed while the Register was in flight
+        result = schedule_update(anjay, &server->sched_update_handle, server,
+                                 AVS_TIME_DURATION_ZERO, DONT_RECONNECT);
+    } else {
+        result = schedule_next_update(anjay, &server->sched_update_handle,
+                                      server);
+    }
+    if (result) {
+        anjay_log(WARNING, "could not schedule Update for server %u",
+                  server->ssid);
+    }
+
+    _anjay_observe_sched_flush_current_connection(anjay);
+    _anjay_bootstrap_notify_regular_connection_available(anjay);
+    return 0;
+}
+
+static int update_retransmission_job(anjay_t *anjay, void *ssid_);
+
+static int schedule_update_retransmission(anjay_t *anjay,
+                                          anjay_active_server_info_t *server,
+                                          avs_time_duration_t delay) {
+    _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+    if (_anjay_sched(anjay->sched, &server->sched_update_handle, delay,
+                     update_retransmission_job,
+                     (void *) (uintptr_t) server->ssid)) {
+        anjay_log(ERROR, "could not schedule Update retransmission for "
+                  "server %u", server->ssid);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @returns Delay before the next attempt after a Register or Update failed
+ * asynchronously, i.e. outside of a retryable job whose scheduler backoff
+ * would apply. Doubles the delay to use after another consecutive failure.
+ */
+static avs_time_duration_t
+next_retry_delay(anjay_active_server_info_t *server) {
+    const anjay_sched_retryable_backoff_t backoff =
+            ANJAY_SERVER_RETRYABLE_BACKOFF;
+    avs_time_duration_t delay = server->update_retry_delay;
+    if (avs_time_duration_less(delay, backoff.delay)) {
+        delay = backoff.delay;
+    }
+    server->update_retry_delay = avs_time_duration_mul(delay, 2);
+    if (avs_time_duration_less(backoff.max_delay,
+                               server->update_retry_delay)) {
+        server->update_retry_delay = backoff.max_delay;
+    }
+    return delay;
+}
+
+/**
+ * Schedules another Update attempt after an Update failed asynchronously.
+ * After a network error, the connection is re-established before sending the
+ * Update.
+ */
+static int schedule_update_retry(anjay_t *anjay,
+                                 anjay_active_server_info_t *server,
+                                 int failure) {
+    reconnect_required_t refresh = DONT_RECONNECT;
+    if (failure == AVS_COAP_CTX_ERR_NETWORK) {
+        anjay_log(ERROR, "network communication error while updating "
+                         "registration for SSID==%" PRIu16, server->ssid);
+        refresh = DO_RECONNECT;
+    }
+
+    avs_time_duration_t delay = next_retry_delay(server);
+
+    _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+    if (schedule_update(anjay, &server->sched_update_handle, server, delay,
+                        refresh)) {
+        anjay_log(ERROR, "could not schedule send_update_sched_job");
+        return -1;
+    }
+    return 0;
+}
+
+static int deactivate_unregistered_server_job(anjay_t *anjay, void *ssid_) {
+    anjay_ssid_t ssid = (anjay_ssid_t) (uintptr_t) ssid_;
+    anjay_active_server_info_t *server =
+            _anjay_servers_find_active(&anjay->servers, ssid);
+    if (!server || _anjay_server_registration_pending(server)) {
+        // the server is gone or has been registered to again in the meantime
+        return 0;
+    }
+
+    avs_time_duration_t reactivate_delay = next_retry_delay(server);
+    avs_time_duration_t update_retry_delay = server->update_retry_delay;
+    anjay_inactive_server_info_t *inactive_server =
+            _anjay_server_deactivate(anjay, &anjay->servers, ssid,
+                                     reactivate_delay);
+    if (!inactive_server) {
+        return -1;
+    }
+    // the backoff continues after reactivation
+    inactive_server->update_retry_delay = update_retry_delay;
+    return 0;
+}
+
+/**
+ * Handles a Register that failed asynchronously the same way as one that
+ * failed during server activation: the server is deactivated, so that it is
+ * not considered connected until it is activated and registered to again.
+ *
+ * Deactivation is deferred to a scheduler job, as the server may still be
+ * bound to the comm stream.
+ */
+static int register_failed(anjay_t *anjay,
+                           anjay_active_server_info_t *server,
+                           int failure) {
+    anjay_log(ERROR, "could not register to server %u: %d",
+              server->ssid, failure);
+    _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+    if (_anjay_sched_now(anjay->sched, NULL,
+                         deactivate_unregistered_server_job,
+                         (void *) (uintptr_t) server->ssid)) {
+        anjay_log(ERROR, "could not schedule deactivation of server %u",
+                  server->ssid);
+        return -1;
+    }
+    return 0;
+}
+
+static int exchange_failed(anjay_t *anjay,
+                           anjay_active_server_info_t *server,
+                           bool is_register,
+                           int failure) {
+    if (is_register) {
+        return register_failed(anjay, server, failure);
+    }
+    return schedule_update_retry(anjay, server, failure);
+}
+
+static int update_retransmission_job(anjay_t *anjay, void *ssid_) {
+    anjay_ssid_t ssid = (anjay_ssid_t) (uintptr_t) ssid_;
+    anjay_active_server_info_t *server =
+            _anjay_servers_find_active(&anjay->servers, ssid);
+    if (!server || !server->registration_info.update_exchange.request) {
+        return 0;
+    }
+
+    const bool is_register =
+            _anjay_register_in_progress(&server->registration_info);
+
+    anjay_connection_ref_t connection = {
+        .server = server,
+        .conn_type = server->registration_info.conn_type
+    };
+    if (_anjay_bind_server_stream(anjay, connection)) {
+        anjay_log(ERROR, "could not get stream for server %u", server->ssid);
+        _anjay_update_exchange_cleanup(
+                &server->registration_info.update_exchange);
+        return exchange_failed(anjay, server, is_register, -1);
+    }
+
+    int result = _anjay_update_registration_retransmit(anjay);
+    _anjay_release_server_stream(anjay);
+
+    if (result) {
+        return exchange_failed(anjay, server, is_register, result);
+    }
+    return schedule_update_retransmission(
+            anjay, server,
+            server->registration_info.update_exchange.retry_state
+                    .recv_timeout);
+}
+
+void _anjay_server_handle_network_error(anjay_t *anjay) {
+    anjay_active_server_info_t *server = anjay->current_connection.server;
+    assert(server);
+    if (anjay->current_connection.conn_type
+                    != server->registration_info.conn_type
+            || !server->registration_info.update_exchange.request) {
+        return;
+    }
+
+    // most likely an ICMP error caused by the Register or Update; there is
+    // no point in waiting for retransmissions to time out
+    const bool is_register =
+            _anjay_register_in_progress(&server->registration_info);
+    _anjay_update_exchange_cleanup(&server->registration_info.update_exchange);
+    exchange_failed(anjay, server, is_register, AVS_COAP_CTX_ERR_NETWORK);
+}
+
+int _anjay_server_handle_update_response(anjay_t *anjay,
+                                         const avs_coap_msg_t *msg) {
+    anjay_active_server_info_t *server = anjay->current_connection.server;
+    assert(server);
+    if (anjay->current_connection.conn_type
+            != server->registration_info.conn_type) {
+        return ANJAY_REGISTRATION_UPDATE_UNRELATED;
+    }
+
+    const bool is_register =
+            _anjay_register_in_progress(&server->registration_info);
+    int result = _anjay_update_registration_handle_response(anjay, msg);
+    switch (result) {
+    case ANJAY_REGISTRATION_UPDATE_UNRELATED:
+        return result;
+    case ANJAY_REGISTRATION_UPDATE_IN_PROGRESS:
+        return schedule_update_retransmission(
+                anjay, server,
+                avs_coap_exchange_lifetime(&anjay->udp_tx_params));
+    case ANJAY_REGISTRATION_UPDATE_REJECTED:
+        anjay_log(DEBUG, "update rejected for SSID = %u; re-registering",
+                  server->ssid);
+        _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+        return force_server_reregister(anjay, server);
+    case 0:
+        if (is_register) {
+            return registration_succeeded(anjay, server);
+        }
+        server->update_retry_delay = AVS_TIME_DURATION_ZERO;
+        _anjay_observe_sched_flush_current_connection(anjay);
+        return _anjay_server_reschedule_update_job(anjay, server);
+    default:
+        if (is_register) {
+            return register_failed(anjay, server, result);
+        }
+        anjay_log(ERROR, "could not update registration: %d", result);
+        return schedule_update_retry(anjay, server, result);
+    }
+}
+
+bool _anjay_server_registration_pending(
+        const anjay_active_server_info_t *server) {
+    return _anjay_register_in_progress(&server->registration_info);
+}
+
 static int send_update(anjay_t *anjay,
                        anjay_active_server_info_t *server) {
     anjay_connection_ref_t connection = {
@@ -202,13 +454,23 @@ static int send_update(anjay_t *anjay,
     }
 
     int result = _anjay_update_registration(anjay);
-    if (result == ANJAY_REGISTRATION_UPDATE_REJECTED) {
+    if (result == ANJAY_REGISTRATION_UPDATE_IN_PROGRESS) {
+        if (schedule_update_retransmission(
+                anjay, server,
+                server->registration_info.update_exchange.retry_state
+                        .recv_timeout)) {
+            _anjay_update_exchange_cleanup(
+                    &server->registration_info.update_exchange);
+            result = -1;
+        }
+    } else if (result == ANJAY_REGISTRATION_UPDATE_REJECTED) {
         anjay_log(DEBUG, "update rejected for SSID = %u; re-registering",
                   server->ssid);
         result = force_server_reregister(anjay, server);
     } else if (result != 0) {
         anjay_log(ERROR, "could not send registration update: %d", result);
     } else {
+        server->update_retry_delay = AVS_TIME_DURATION_ZERO;
         _anjay_observe_sched_flush_current_connection(anjay);
     }
 
@@ -266,7 +528,14 @@ int _anjay_server_reschedule_update_job(anjay_t *anjay,
 static int reschedule_update_for_server(anjay_t *anjay,
                                         anjay_active_server_info_t *server,
                                         reconnect_required_t refresh) {
+    if (!refresh && _anjay_register_in_progress(&server->registration_info)) {
+        // an Update will be sent after the Register if the data model changed
+        return 0;
+    }
     _anjay_sched_del(anjay->sched, &server->sched_update_handle);
+    // a response to an Update sent earlier could not reflect the changes
+    // that this new Update is about to report
+    _anjay_update_exchange_cleanup(&server->registration_info.update_exchange);
     if (schedule_update(anjay, &server->sched_update_handle, server,
                         AVS_TIME_DURATION_ZERO, refresh)) {
         anjay_log(ERROR, "could not schedule send_update_sched_job");
@@ -347,15 +616,17 @@ int _anjay_server_register(anjay_t *anjay,
     int result = _anjay_register(anjay);
     avs_stream_reset(anjay->comm_stream);
 
-    if (!result) {
-        _anjay_sched_del(anjay->sched, &server->sched_update_handle);
-        if (schedule_next_update(anjay, &server->sched_update_handle, server)) {
-            anjay_log(WARNING, "could not schedule Update for server %u",
-                      server->ssid);
+    if (result == ANJAY_REGISTRATION_UPDATE_IN_PROGRESS) {
+        result = schedule_update_retransmission(
+                anjay, server,
+                server->registration_info.update_exchange.retry_state
+                        .recv_timeout);
+        if (result) {
+            _anjay_update_exchange_cleanup(
+                    &server->registration_info.update_exchange);
         }
-
-        _anjay_observe_sched_flush_current_connection(anjay);
-        _anjay_bootstrap_notify_regular_connection_available(anjay);
+    } else if (!result) {
+        result = registration_succeeded(anjay, server);
     }
     _anjay_release_server_stream(anjay);
     return result;
@@ -367,6 +638,11 @@ int _anjay_server_deregister(anjay_t *anjay,
         .server = server,
         .conn_type = server->registration_info.conn_type
     };
+    if (!server->registration_info.endpoint_path) {
+        anjay_log(DEBUG, "server %u has never been registered to, skipping "
+                  "De-Register", server->ssid);
+        return 0;
+    }
     if (connection.conn_type >= ANJAY_CONNECTION_WILDCARD
             || _anjay_bind_server_stream(anjay, connection)) {
         anjay_log(ERROR, "could not get stream for server %u, skipping",
@@ -25,9 +25,22 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Sends a Register message to @p server . The response is usually handled
+ * later, in anjay_serve(); if the registration fails then, another attempt is
+ * scheduled with exponential backoff.
+ *
+ * @returns 0 if the Register has been sent (or, if it needed to be sent
+ * block-wise, succeeded), or a negative value on error.
+ */
 int _anjay_server_register(anjay_t *anjay,
                            anjay_active_server_info_t *server);
 
+/**
+ * @returns ANJAY_REGISTRATION_UPDATE_IN_PROGRESS if an Update has been sent and
+ * its response is yet to be received - the next Update is scheduled once it
+ * arrives; otherwise, the result of the operation.
+ */
 int _anjay_server_update_or_reregister(anjay_t *anjay,
                                        anjay_active_server_info_t *server);
 
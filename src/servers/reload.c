@@ -17,6 +17,7 @@
 #include <config.h>
 
 #include "../dm/query.h"
+#include "../interface/register.h"
 
 #define ANJAY_SERVERS_INTERNALS
 
@@ -76,7 +77,11 @@ static int reload_active_server(anjay_t *anjay,
     }
 
     if (needs_reconnect && server->ssid != ANJAY_SSID_BOOTSTRAP) {
-        _anjay_server_update_or_reregister(anjay, server);
+        if (_anjay_server_update_or_reregister(anjay, server)
+                == ANJAY_REGISTRATION_UPDATE_IN_PROGRESS) {
+            // next Update will be scheduled once the response arrives
+            return 0;
+        }
         return _anjay_server_reschedule_update_job(anjay, server);
     }
     return 0;
@@ -40,6 +40,7 @@ static void connection_cleanup(anjay_t *anjay,
     _anjay_connection_internal_clean_socket(connection);
     _anjay_sched_del(anjay->sched,
                      &connection->queue_mode_close_socket_clb_handle);
+    _anjay_coap_block1_reassembly_cleanup(&connection->block1_reassembly);
 }
 
 void _anjay_server_cleanup(anjay_t *anjay, anjay_active_server_info_t *server) {
@@ -71,7 +72,10 @@ void _anjay_servers_cleanup(anjay_t *anjay) {
         _anjay_sched_del(anjay->sched,
                          &anjay->servers.inactive->sched_reactivate_handle);
     }
-    AVS_LIST_CLEAR(&anjay->servers.public_sockets);
+    if (anjay->servers.public_sockets) {
+        AVS_LIST_CLEAR(&anjay->servers.public_sockets);
+        ++anjay->servers.public_sockets_generation;
+    }
 }
 
 static bool
@@ -108,63 +112,77 @@ _anjay_connection_get_prepared_socket(anjay_t *anjay,
     return socket;
 }
 
+/**
+ * @returns Socket of the specified connection if it shall be polled, or NULL.
+ * @p inout_changed is set to true if the system socket might have changed
+ * since the previous call, even if the socket object did not.
+ */
 static avs_net_abstract_socket_t *
 get_online_connection_socket(anjay_t *anjay,
                              anjay_active_server_info_t *server,
-                             anjay_connection_type_t conn_type) {
+                             anjay_connection_type_t conn_type,
+                             bool *inout_changed) {
     anjay_server_connection_t *connection =
             _anjay_get_server_connection((anjay_connection_ref_t) {
                                              .server = server,
                                              .conn_type = conn_type
                                          });
-    if (connection
-            && should_connection_be_online(anjay, server->ssid, connection)) {
-        return _anjay_connection_get_prepared_socket(anjay, server, connection);
+    if (!connection) {
+        return NULL;
     }
-    return NULL;
-}
-
-static int
-add_socket_onto_list(AVS_LIST(avs_net_abstract_socket_t *const) *tail_ptr,
-                     avs_net_abstract_socket_t *socket) {
-    AVS_LIST_INSERT_NEW(avs_net_abstract_socket_t *const, tail_ptr);
-    if (!*tail_ptr) {
-        anjay_log(ERROR, "Out of memory while building socket list");
-        return -1;
+    avs_net_abstract_socket_t *socket = NULL;
+    if (should_connection_be_online(anjay, server->ssid, connection)) {
+        socket = _anjay_connection_get_prepared_socket(anjay, server,
+                                                       connection);
     }
-    *(avs_net_abstract_socket_t **) (intptr_t) *tail_ptr = socket;
-    return 0;
+    // checked last, as preparing the socket might have reconnected it
+    if (connection->socket_changed) {
+        connection->socket_changed = false;
+        *inout_changed = true;
+    }
+    return socket;
 }
 
 AVS_LIST(avs_net_abstract_socket_t *const) anjay_get_sockets(anjay_t *anjay) {
-    AVS_LIST_CLEAR(&anjay->servers.public_sockets);
-    AVS_LIST(avs_net_abstract_socket_t *const) *tail_ptr =
-            &anjay->servers.public_sockets;
+    anjay_socket_list_updater_t updater = {
+        .tail_ptr = &anjay->servers.public_sockets,
+        .changed = false
+    };
 
     bool sms_active = false;
     anjay_active_server_info_t *server;
     AVS_LIST_FOREACH(server, anjay->servers.active) {
         avs_net_abstract_socket_t *udp_socket =
                 get_online_connection_socket(anjay, server,
-                                             ANJAY_CONNECTION_UDP);
-        if (udp_socket && !add_socket_onto_list(tail_ptr, udp_socket)) {
-            tail_ptr = AVS_LIST_NEXT_PTR(tail_ptr);
+                                             ANJAY_CONNECTION_UDP,
+                                             &updater.changed);
+        if (udp_socket) {
+            _anjay_socket_list_updater_add(&updater, udp_socket);
         }
 
-        if (get_online_connection_socket(anjay, server, ANJAY_CONNECTION_SMS)) {
+        if (get_online_connection_socket(anjay, server, ANJAY_CONNECTION_SMS,
+                                         &updater.changed)) {
             sms_active = true;
         }
     }
 
     if (sms_active) {
         assert(_anjay_sms_router(anjay));
-        add_socket_onto_list(tail_ptr, _anjay_sms_poll_socket(anjay));
+        _anjay_socket_list_updater_add(&updater, _anjay_sms_poll_socket(anjay));
     }
 
-    _anjay_downloader_get_sockets(&anjay->downloader, tail_ptr);
+    _anjay_downloader_update_socket_list(&anjay->downloader, &updater);
+    _anjay_socket_list_updater_finish(&updater);
+    if (updater.changed) {
+        ++anjay->servers.public_sockets_generation;
+    }
     return anjay->servers.public_sockets;
 }
 
+uint64_t anjay_get_sockets_generation(anjay_t *anjay) {
+    return anjay->servers.public_sockets_generation;
+}
+
 anjay_active_server_info_t *
 _anjay_servers_find_by_udp_socket(anjay_servers_t *servers,
                                   avs_net_abstract_socket_t *socket) {
@@ -194,7 +212,8 @@ int _anjay_schedule_socket_update(anjay_t *anjay,
 bool _anjay_servers_is_connected_to_non_bootstrap(anjay_servers_t *servers) {
     AVS_LIST(anjay_active_server_info_t) server;
     AVS_LIST_FOREACH(server, servers->active) {
-        if (server->ssid != ANJAY_SSID_BOOTSTRAP) {
+        if (server->ssid != ANJAY_SSID_BOOTSTRAP
+                && !_anjay_server_registration_pending(server)) {
             return true;
         }
     }
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <avsystem/commons/unit/test.h>
+
+#include <anjay_test/dm.h>
+
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t oiid;
+    anjay_ssid_t owner;
+    anjay_ssid_t acl_ssid;
+    anjay_access_mask_t acl_mask;
+} fake_ac_instance_t;
+
+// Access Control Object Instances, with IIDs equal to indices
+static struct {
+    fake_ac_instance_t instances[2];
+    size_t num_instances;
+    size_t acl_reads;
+} FAKE_AC_DATA;
+
+static int fake_ac_instance_it(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t *out,
+                               void **cookie) {
+    (void) anjay; (void) obj_ptr;
+    uintptr_t index = (uintptr_t) *cookie;
+    if (index < FAKE_AC_DATA.num_instances) {
+        *out = (anjay_iid_t) index;
+        *cookie = (void *) (index + 1);
+    } else {
+        *out = ANJAY_IID_INVALID;
+    }
+    return 0;
+}
+
+static int fake_ac_instance_present(anjay_t *anjay,
+                                    const anjay_dm_object_def_t *const *obj_ptr,
+                                    anjay_iid_t iid) {
+    (void) anjay; (void) obj_ptr;
+    return iid < FAKE_AC_DATA.num_instances;
+}
+
+static int fake_ac_resource_read(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 anjay_output_ctx_t *ctx) {
+    (void) anjay; (void) obj_ptr;
+    AVS_UNIT_ASSERT_TRUE(iid < FAKE_AC_DATA.num_instances);
+    const fake_ac_instance_t *instance = &FAKE_AC_DATA.instances[iid];
+    switch (rid) {
+    case ANJAY_DM_RID_ACCESS_CONTROL_OID:
+        return anjay_ret_i32(ctx, instance->oid);
+    case ANJAY_DM_RID_ACCESS_CONTROL_OIID:
+        return anjay_ret_i32(ctx, instance->oiid);
+    case ANJAY_DM_RID_ACCESS_CONTROL_OWNER:
+        return anjay_ret_i32(ctx, instance->owner);
+    case ANJAY_DM_RID_ACCESS_CONTROL_ACL: {
+        ++FAKE_AC_DATA.acl_reads;
+        anjay_output_ctx_t *array = anjay_ret_array_start(ctx);
+        if (!array
+                || anjay_ret_array_index(array, instance->acl_ssid)
+                || anjay_ret_i32(array, instance->acl_mask)
+                || anjay_ret_array_finish(array)) {
+            return -1;
+        }
+        return 0;
+    }
+    default:
+        return ANJAY_ERR_NOT_FOUND;
+    }
+}
+
+static const anjay_dm_object_def_t *const FAKE_AC =
+        &(const anjay_dm_object_def_t) {
+            .oid = ANJAY_DM_OID_ACCESS_CONTROL,
+            .supported_rids = ANJAY_DM_SUPPORTED_RIDS(
+                    ANJAY_DM_RID_ACCESS_CONTROL_OID,
+                    ANJAY_DM_RID_ACCESS_CONTROL_OIID,
+                    ANJAY_DM_RID_ACCESS_CONTROL_ACL,
+                    ANJAY_DM_RID_ACCESS_CONTROL_OWNER),
+            .handlers = {
+                .instance_it = fake_ac_instance_it,
+                .instance_present = fake_ac_instance_present,
+                .resource_present = anjay_dm_resource_present_TRUE,
+                .resource_read = fake_ac_resource_read,
+                .transaction_begin = anjay_dm_transaction_NOOP,
+                .transaction_validate = anjay_dm_transaction_NOOP,
+                .transaction_commit = anjay_dm_transaction_NOOP,
+                .transaction_rollback = anjay_dm_transaction_NOOP
+            }
+        };
+
+// two servers, so that Access Control is actually enforced
+#define AC_TEST_INIT \
+    FAKE_AC_DATA.num_instances = 2; \
+    FAKE_AC_DATA.instances[0] = (fake_ac_instance_t) { \
+        .oid = 42, \
+        .oiid = 1, \
+        .owner = 2, \
+        .acl_ssid = 1, \
+        .acl_mask = ANJAY_ACCESS_MASK_READ \
+    }; \
+    FAKE_AC_DATA.instances[1] = (fake_ac_instance_t) { \
+        .oid = 42, \
+        .oiid = 2, \
+        .owner = 1, \
+        .acl_ssid = 2, \
+        .acl_mask = ANJAY_ACCESS_MASK_READ | ANJAY_ACCESS_MASK_WRITE \
+    }; \
+    FAKE_AC_DATA.acl_reads = 0; \
+    DM_TEST_INIT_GENERIC((&OBJ, &FAKE_AC), (1, 2), ())
+
+static bool action_allowed(anjay_t *anjay,
+                           anjay_iid_t iid,
+                           anjay_ssid_t ssid,
+                           anjay_request_action_t action) {
+    return _anjay_access_control_action_allowed(
+            anjay, &(const anjay_action_info_t) {
+                .oid = 42,
+                .iid = iid,
+                .ssid = ssid,
+                .action = action
+            });
+}
+
+AVS_UNIT_TEST(access_control_cache, hits) {
+    AC_TEST_INIT;
+    AVS_UNIT_ASSERT_NULL(anjay->access_control_cache.targets);
+
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->access_control_cache.targets);
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 2);
+
+    // all further checks are answered from the cache
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 2, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 2, 2, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 2, 1, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 3, 1, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 2);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(access_control_cache, invalidated_on_change) {
+    AC_TEST_INIT;
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 2);
+
+    FAKE_AC_DATA.instances[0].acl_mask |= ANJAY_ACCESS_MASK_WRITE;
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(
+            &queue, ANJAY_DM_OID_ACCESS_CONTROL, 0,
+            ANJAY_DM_RID_ACCESS_CONTROL_ACL));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_flush(anjay, &queue));
+    AVS_UNIT_ASSERT_NULL(anjay->access_control_cache.targets);
+
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->access_control_cache.targets);
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 4);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(access_control_cache, bypassed_in_transaction) {
+    AC_TEST_INIT;
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_RBTREE(anjay_acl_cache_target_t) targets =
+            anjay->access_control_cache.targets;
+    AVS_UNIT_ASSERT_NOT_NULL(targets);
+
+    _anjay_dm_transaction_begin(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_include_object(anjay,
+                                                                 &FAKE_AC));
+    // uncommitted change is visible, but neither cached nor read from cache
+    FAKE_AC_DATA.instances[0].acl_mask |= ANJAY_ACCESS_MASK_WRITE;
+    FAKE_AC_DATA.acl_reads = 0;
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    // only the ACL of the matching Access Control instance is read
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 1);
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 2);
+    AVS_UNIT_ASSERT_TRUE(anjay->access_control_cache.targets == targets);
+
+    FAKE_AC_DATA.instances[0].acl_mask = ANJAY_ACCESS_MASK_READ;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_transaction_rollback(anjay));
+
+    // the cache built before the transaction is still valid after rollback
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_EQUAL(FAKE_AC_DATA.acl_reads, 2);
+
+    DM_TEST_FINISH;
+}
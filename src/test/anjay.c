@@ -594,12 +594,19 @@ AVS_UNIT_TEST(queue_mode, behaviour) {
     ////// ASSERT QUEUE MODE //////
     AVS_UNIT_ASSERT_NOT_NULL(
             anjay->servers.active->udp_connection.queue_mode_close_socket_clb_handle);
-    AVS_UNIT_ASSERT_NOT_NULL(anjay_get_sockets(anjay));
+    AVS_LIST(avs_net_abstract_socket_t *const) sockets =
+            anjay_get_sockets(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(sockets);
+    uint64_t generation = anjay_get_sockets_generation(anjay);
+    // unchanged set of sockets is reported without rebuilding the list
+    AVS_UNIT_ASSERT_TRUE(anjay_get_sockets(anjay) == sockets);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_sockets_generation(anjay), generation);
     AVS_UNIT_ASSERT_EQUAL(sched_time_to_next_s(anjay->sched), 93);
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(93, AVS_TIME_S));
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
     AVS_UNIT_ASSERT_NULL(anjay_get_sockets(anjay));
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_sockets_generation(anjay), generation + 1);
     AVS_UNIT_ASSERT_NULL(
             anjay->servers.active->udp_connection.queue_mode_close_socket_clb_handle);
 
@@ -707,6 +714,12 @@ AVS_UNIT_TEST(queue_mode, change) {
     avs_unit_mocksock_input(mocksocks[0],
                             UPDATE_RESPONSE, sizeof(UPDATE_RESPONSE) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
+    // the response is not waited for, only retransmission is scheduled
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->servers.active->registration_info
+                                     .update_exchange.request);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_NULL(anjay->servers.active->registration_info
+                                 .update_exchange.request);
 
     AVS_UNIT_ASSERT_NOT_NULL(
             anjay->servers.active->udp_connection.queue_mode_close_socket_clb_handle);
@@ -720,3 +733,130 @@ AVS_UNIT_TEST(queue_mode, change) {
 
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(socket_list, reconnect_bumps_generation) {
+    DM_TEST_INIT_WITH_SSIDS(42);
+    AVS_LIST(avs_net_abstract_socket_t *const) sockets =
+            anjay_get_sockets(anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(sockets), 1);
+    AVS_UNIT_ASSERT_TRUE(*sockets == mocksocks[0]);
+    uint64_t generation = anjay_get_sockets_generation(anjay);
+
+    AVS_UNIT_ASSERT_TRUE(anjay_get_sockets(anjay) == sockets);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_sockets_generation(anjay), generation);
+
+    // the same socket object is reconnected, so it gets a new system socket
+    _anjay_connection_suspend((anjay_connection_ref_t) {
+                                  .server = anjay->servers.active,
+                                  .conn_type = ANJAY_CONNECTION_UDP
+                              });
+    avs_unit_mocksock_expect_remote_hostname(mocksocks[0],
+                                             "server.example.org");
+    avs_unit_mocksock_expect_remote_port(mocksocks[0], "8378");
+    avs_unit_mocksock_expect_connect(mocksocks[0],
+                                     "server.example.org", "8378");
+    sockets = anjay_get_sockets(anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(sockets), 1);
+    AVS_UNIT_ASSERT_TRUE(*sockets == mocksocks[0]);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_sockets_generation(anjay), generation + 1);
+
+    AVS_UNIT_ASSERT_TRUE(anjay_get_sockets(anjay) == sockets);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_sockets_generation(anjay), generation + 1);
+
+    DM_TEST_FINISH;
+}
+
+#define SERVE_MANY_READ_REQUEST(MsgId) \
+        "\x40\x01" MsgId /* CoAP header */ \
+        "\xB2" "42" /* OID */ \
+        "\x02" "69" /* IID */ \
+        "\x01" "4" /* RID */
+
+#define SERVE_MANY_READ_RESPONSE(MsgId) \
+        "\x60\x45" MsgId /* CoAP header */ \
+        "\xc0" /* Content-Format */ \
+        "\xff" "514"
+
+static void serve_many_expect_read(anjay_t *anjay) {
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+}
+
+static void serve_many_input_read(anjay_t *anjay,
+                                  avs_net_abstract_socket_t *socket,
+                                  const char *request,
+                                  size_t request_size) {
+    avs_unit_mocksock_input(socket, request, request_size);
+    serve_many_expect_read(anjay);
+}
+
+static void assert_recv_timeout_restored(avs_net_abstract_socket_t *socket) {
+    avs_net_socket_opt_value_t value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_opt(
+            socket, AVS_NET_SOCKET_OPT_RECV_TIMEOUT, &value));
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            value.recv_timeout, avs_time_duration_from_scalar(1, AVS_TIME_S)));
+}
+
+AVS_UNIT_TEST(serve_many, all_pending_served) {
+    DM_TEST_INIT;
+    static const char REQUEST1[] = SERVE_MANY_READ_REQUEST("\xFA\x3E");
+    static const char REQUEST2[] = SERVE_MANY_READ_REQUEST("\xFA\x3F");
+    serve_many_input_read(anjay, mocksocks[0], REQUEST1, sizeof(REQUEST1) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3E"));
+    serve_many_input_read(anjay, mocksocks[0], REQUEST2, sizeof(REQUEST2) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3F"));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve_many(anjay, mocksocks[0], 2));
+    avs_unit_mocksock_assert_io_clean(mocksocks[0]);
+    assert_recv_timeout_restored(mocksocks[0]);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(serve_many, limit_leaves_requests_pending) {
+    DM_TEST_INIT;
+    static const char REQUEST1[] = SERVE_MANY_READ_REQUEST("\xFA\x3E");
+    static const char REQUEST2[] = SERVE_MANY_READ_REQUEST("\xFA\x3F");
+    serve_many_input_read(anjay, mocksocks[0], REQUEST1, sizeof(REQUEST1) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3E"));
+    avs_unit_mocksock_input(mocksocks[0], REQUEST2, sizeof(REQUEST2) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve_many(anjay, mocksocks[0], 1));
+    assert_recv_timeout_restored(mocksocks[0]);
+
+    // the second request is still waiting on the socket
+    serve_many_expect_read(anjay);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3F"));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve_many(anjay, mocksocks[0], 1));
+    avs_unit_mocksock_assert_io_clean(mocksocks[0]);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(serve_many, stops_when_no_more_requests) {
+    DM_TEST_INIT;
+    static const char REQUEST[] = SERVE_MANY_READ_REQUEST("\xFA\x3E");
+    serve_many_input_read(anjay, mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3E"));
+    avs_unit_mocksock_input_fail(mocksocks[0], -1);
+    avs_unit_mocksock_expect_errno(mocksocks[0], ETIMEDOUT);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve_many(anjay, mocksocks[0], 5));
+    avs_unit_mocksock_assert_io_clean(mocksocks[0]);
+    assert_recv_timeout_restored(mocksocks[0]);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(serve_many, stops_after_network_error) {
+    DM_TEST_INIT;
+    static const char REQUEST[] = SERVE_MANY_READ_REQUEST("\xFA\x3E");
+    avs_unit_mocksock_input_fail(mocksocks[0], -1);
+    avs_unit_mocksock_expect_errno(mocksocks[0], ECONNREFUSED);
+    avs_unit_mocksock_input(mocksocks[0], REQUEST, sizeof(REQUEST) - 1);
+    AVS_UNIT_ASSERT_FAILED(anjay_serve_many(anjay, mocksocks[0], 2));
+
+    // the request queued after the error has not been touched
+    serve_many_expect_read(anjay);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], SERVE_MANY_READ_RESPONSE("\xFA\x3E"));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    avs_unit_mocksock_assert_io_clean(mocksocks[0]);
+    DM_TEST_FINISH;
+}
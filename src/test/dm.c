@@ -2523,3 +2523,50 @@ AVS_UNIT_TEST(dm_res_read, no_space) {
 
     DM_TEST_FINISH;
 }
+
+static int collect_oid(anjay_t *anjay,
+                       const anjay_dm_object_def_t *const *obj,
+                       void *oids_) {
+    (void) anjay;
+    AVS_LIST(anjay_oid_t) *oids = (AVS_LIST(anjay_oid_t) *) oids_;
+    AVS_LIST(anjay_oid_t) oid = AVS_LIST_NEW_ELEMENT(anjay_oid_t);
+    AVS_UNIT_ASSERT_NOT_NULL(oid);
+    *oid = (*obj)->oid;
+    AVS_LIST_APPEND(oids, oid);
+    return 0;
+}
+
+AVS_UNIT_TEST(dm_objects, find_and_iterate) {
+    DM_TEST_INIT;
+    AVS_UNIT_ASSERT_TRUE(_anjay_dm_find_object_by_oid(anjay, 0)
+                         == &FAKE_SECURITY);
+    AVS_UNIT_ASSERT_TRUE(_anjay_dm_find_object_by_oid(anjay, 1)
+                         == &FAKE_SERVER);
+    AVS_UNIT_ASSERT_TRUE(_anjay_dm_find_object_by_oid(anjay, 25)
+                         == &OBJ_WITH_RESET);
+    AVS_UNIT_ASSERT_TRUE(_anjay_dm_find_object_by_oid(anjay, 42) == &OBJ);
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_dm_find_object_by_oid(anjay, 128)
+            == (const anjay_dm_object_def_t *const *) &EXECUTE_OBJ);
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_dm_find_object_by_oid(anjay, 667)
+            == (const anjay_dm_object_def_t *const *) &OBJ_WITH_RES_OPS);
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay, 2));
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay, 43));
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay, 65535));
+
+    AVS_UNIT_ASSERT_FAILED(anjay_register_object(anjay, &OBJ));
+
+    AVS_LIST(anjay_oid_t) oids = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_foreach_object(anjay, collect_oid,
+                                                     &oids));
+    static const anjay_oid_t EXPECTED_OIDS[] = { 0, 1, 25, 42, 128, 667 };
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(oids), AVS_ARRAY_SIZE(EXPECTED_OIDS));
+    size_t i = 0;
+    AVS_LIST(anjay_oid_t) oid;
+    AVS_LIST_FOREACH(oid, oids) {
+        AVS_UNIT_ASSERT_EQUAL(*oid, EXPECTED_OIDS[i++]);
+    }
+    AVS_LIST_CLEAR(&oids);
+    DM_TEST_FINISH;
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <avsystem/commons/unit/test.h>
+#include <anjay_test/mock_clock.h>
+
+static void
+assert_resources_changed(anjay_notify_queue_object_entry_t *entry,
+                         const anjay_notify_queue_resource_entry_t *expected,
+                         size_t expected_count) {
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(entry->resources_changed),
+                          expected_count);
+    AVS_LIST(anjay_notify_queue_resource_entry_t) it = entry->resources_changed;
+    for (size_t i = 0; i < expected_count; ++i, it = AVS_LIST_NEXT(it)) {
+        AVS_UNIT_ASSERT_EQUAL(it->iid, expected[i].iid);
+        AVS_UNIT_ASSERT_EQUAL(it->rid, expected[i].rid);
+    }
+    AVS_UNIT_ASSERT_TRUE(entry->resources_changed_last
+                         == AVS_LIST_TAIL(entry->resources_changed));
+}
+
+#define ASSERT_RESOURCES_CHANGED(Entry, ...) \
+    do { \
+        const anjay_notify_queue_resource_entry_t expected[] = { \
+            __VA_ARGS__ \
+        }; \
+        assert_resources_changed((Entry), expected, \
+                                 AVS_ARRAY_SIZE(expected)); \
+    } while (0)
+
+static void assert_iids(AVS_LIST(anjay_iid_t) iids,
+                        const anjay_iid_t *last,
+                        const anjay_iid_t *expected,
+                        size_t expected_count) {
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(iids), expected_count);
+    AVS_LIST(anjay_iid_t) it = iids;
+    for (size_t i = 0; i < expected_count; ++i, it = AVS_LIST_NEXT(it)) {
+        AVS_UNIT_ASSERT_EQUAL(*it, expected[i]);
+    }
+    AVS_UNIT_ASSERT_TRUE(last == AVS_LIST_TAIL(iids));
+}
+
+#define ASSERT_IIDS(List, Last, ...) \
+    do { \
+        const anjay_iid_t expected[] = { __VA_ARGS__ }; \
+        assert_iids((List), (Last), expected, AVS_ARRAY_SIZE(expected)); \
+    } while (0)
+
+#define ASSERT_IIDS_EMPTY(List, Last) \
+    do { \
+        AVS_UNIT_ASSERT_NULL(List); \
+        AVS_UNIT_ASSERT_NULL(Last); \
+    } while (0)
+
+AVS_UNIT_TEST(notify_queue, resources_in_order) {
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                2));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 2,
+                                                                0));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 1);
+    ASSERT_RESOURCES_CHANGED(queue, { 1, 1 }, { 1, 2 }, { 2, 0 });
+    _anjay_notify_clear_queue(&queue);
+}
+
+AVS_UNIT_TEST(notify_queue, resources_out_of_order) {
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 2,
+                                                                0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                5));
+    ASSERT_RESOURCES_CHANGED(queue, { 1, 5 }, { 2, 0 });
+
+    // inserted in the middle
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                7));
+    ASSERT_RESOURCES_CHANGED(queue, { 1, 5 }, { 1, 7 }, { 2, 0 });
+
+    // appended after out-of-order inserts, using the tail pointer
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 3,
+                                                                1));
+    ASSERT_RESOURCES_CHANGED(queue, { 1, 5 }, { 1, 7 }, { 2, 0 }, { 3, 1 });
+
+    // inserted at the head
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 0,
+                                                                9));
+    ASSERT_RESOURCES_CHANGED(queue,
+                             { 0, 9 }, { 1, 5 }, { 1, 7 }, { 2, 0 }, { 3, 1 });
+
+    _anjay_notify_queue_remove_instance_resources(&queue, 42, 3);
+    ASSERT_RESOURCES_CHANGED(queue, { 0, 9 }, { 1, 5 }, { 1, 7 }, { 2, 0 });
+    _anjay_notify_queue_remove_instance_resources(&queue, 42, 1);
+    ASSERT_RESOURCES_CHANGED(queue, { 0, 9 }, { 2, 0 });
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 4,
+                                                                4));
+    ASSERT_RESOURCES_CHANGED(queue, { 0, 9 }, { 2, 0 }, { 4, 4 });
+
+    _anjay_notify_clear_queue(&queue);
+}
+
+AVS_UNIT_TEST(notify_queue, resources_merged) {
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 2,
+                                                                0));
+    anjay_notify_queue_resource_entry_t *last = queue->resources_changed_last;
+
+    // duplicate of the tail
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 2,
+                                                                0));
+    // duplicates of the entries before the tail
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 42, 1,
+                                                                3));
+    ASSERT_RESOURCES_CHANGED(queue, { 1, 1 }, { 1, 3 }, { 2, 0 });
+    AVS_UNIT_ASSERT_TRUE(queue->resources_changed_last == last);
+
+    // entries for other objects are kept separately
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_resource_change(&queue, 7, 2,
+                                                                0));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 2);
+    AVS_UNIT_ASSERT_EQUAL(queue->oid, 7);
+    ASSERT_RESOURCES_CHANGED(queue, { 2, 0 });
+    ASSERT_RESOURCES_CHANGED(AVS_LIST_NEXT(queue),
+                             { 1, 1 }, { 1, 3 }, { 2, 0 });
+
+    _anjay_notify_clear_queue(&queue);
+}
+
+AVS_UNIT_TEST(notify_queue, instances) {
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 5));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 1));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 1);
+    anjay_notify_queue_instance_entry_t *changes =
+            &queue->instance_set_changes;
+    AVS_UNIT_ASSERT_TRUE(changes->instance_set_changed);
+    ASSERT_IIDS(changes->known_added_iids, changes->known_added_iids_last,
+                1, 3, 5);
+    ASSERT_IIDS_EMPTY(changes->known_removed_iids,
+                      changes->known_removed_iids_last);
+
+    // removing the tail moves it back
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 5));
+    ASSERT_IIDS(changes->known_added_iids, changes->known_added_iids_last,
+                1, 3);
+    ASSERT_IIDS(changes->known_removed_iids, changes->known_removed_iids_last,
+                5);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 1));
+    ASSERT_IIDS(changes->known_added_iids, changes->known_added_iids_last, 3);
+    ASSERT_IIDS(changes->known_removed_iids, changes->known_removed_iids_last,
+                1, 5);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(&queue, 42,
+                                                                 5));
+    ASSERT_IIDS(changes->known_added_iids, changes->known_added_iids_last,
+                3, 5);
+    ASSERT_IIDS(changes->known_removed_iids, changes->known_removed_iids_last,
+                1);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_removed(&queue, 42,
+                                                                 5));
+    ASSERT_IIDS_EMPTY(changes->known_added_iids,
+                      changes->known_added_iids_last);
+    ASSERT_IIDS(changes->known_removed_iids, changes->known_removed_iids_last,
+                1, 3, 5);
+
+    _anjay_notify_clear_queue(&queue);
+}
+
+#ifdef WITH_THREAD_SAFE_NOTIFY
+
+#include <pthread.h>
+
+static anjay_t *pending_test_setup(void) {
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(0, AVS_TIME_S));
+    anjay_t *anjay = (anjay_t *) calloc(1, sizeof(anjay_t));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay->sched = _anjay_sched_new(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->sched);
+    return anjay;
+}
+
+static void pending_test_teardown(anjay_t *anjay) {
+    _anjay_notify_pending_cleanup(anjay);
+    _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    _anjay_sched_delete(&anjay->sched);
+    free(anjay);
+    _anjay_mock_clock_finish();
+}
+
+static size_t queued_resources_count(anjay_t *anjay) {
+    size_t count = 0;
+    AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, anjay->scheduled_notify.queue) {
+        count += AVS_LIST_SIZE(it->resources_changed);
+    }
+    return count;
+}
+
+AVS_UNIT_TEST(notify_threadsafe, time_to_next_while_pending) {
+    anjay_t *anjay = pending_test_setup();
+    avs_time_duration_t delay;
+    AVS_UNIT_ASSERT_FAILED(anjay_sched_time_to_next(anjay, &delay));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed_threadsafe(anjay, 42, 1, 3));
+    AVS_UNIT_ASSERT_FALSE(_anjay_notify_pending_empty(anjay));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sched_time_to_next(anjay, &delay));
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(delay,
+                                                 AVS_TIME_DURATION_ZERO));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_pending_drain(anjay));
+    AVS_UNIT_ASSERT_TRUE(_anjay_notify_pending_empty(anjay));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->scheduled_notify.handle);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->scheduled_notify.queue), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay->scheduled_notify.queue->oid, 42);
+    AVS_UNIT_ASSERT_EQUAL(queued_resources_count(anjay), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay->scheduled_notify.queue->resources_changed->iid,
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(anjay->scheduled_notify.queue->resources_changed->rid,
+                          3);
+
+    pending_test_teardown(anjay);
+}
+
+static int fail_queue_resource_change(anjay_notify_queue_t *out_queue,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid,
+                                      anjay_rid_t rid) {
+    (void) out_queue; (void) oid; (void) iid; (void) rid;
+    return -1;
+}
+
+AVS_UNIT_TEST(notify_threadsafe, failed_changes_retained) {
+    anjay_t *anjay = pending_test_setup();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed_threadsafe(anjay, 42, 1, 3));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed_threadsafe(anjay, 42, 2, 4));
+
+    AVS_UNIT_MOCK(_anjay_notify_queue_resource_change) =
+            fail_queue_resource_change;
+    AVS_UNIT_ASSERT_FAILED(_anjay_notify_pending_drain(anjay));
+    AVS_UNIT_ASSERT_FALSE(_anjay_notify_pending_empty(anjay));
+    AVS_UNIT_ASSERT_NULL(anjay->scheduled_notify.queue);
+
+    AVS_UNIT_MOCK(_anjay_notify_queue_resource_change) = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_pending_drain(anjay));
+    AVS_UNIT_ASSERT_TRUE(_anjay_notify_pending_empty(anjay));
+    AVS_UNIT_ASSERT_EQUAL(queued_resources_count(anjay), 2);
+
+    pending_test_teardown(anjay);
+}
+
+#define PRODUCER_THREADS 4
+#define CHANGES_PER_PRODUCER 1000
+
+typedef struct {
+    anjay_t *anjay;
+    anjay_oid_t oid;
+    int *finished_producers;
+} producer_args_t;
+
+static void *producer_thread(void *args_) {
+    producer_args_t *args = (producer_args_t *) args_;
+    for (anjay_iid_t iid = 0; iid < CHANGES_PER_PRODUCER; ++iid) {
+        while (anjay_notify_changed_threadsafe(args->anjay, args->oid, iid,
+                                               0)) {
+        }
+    }
+    __atomic_add_fetch(args->finished_producers, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void count_wakeup(void *counter) {
+    __atomic_add_fetch((int *) counter, 1, __ATOMIC_RELAXED);
+}
+
+AVS_UNIT_TEST(notify_threadsafe, concurrent_push_and_drain) {
+    anjay_t *anjay = pending_test_setup();
+    int wakeups = 0;
+    anjay->scheduled_notify.wakeup_cb = count_wakeup;
+    anjay->scheduled_notify.wakeup_arg = &wakeups;
+
+    int finished_producers = 0;
+    pthread_t threads[PRODUCER_THREADS];
+    producer_args_t args[PRODUCER_THREADS];
+    for (size_t i = 0; i < PRODUCER_THREADS; ++i) {
+        args[i] = (producer_args_t) {
+            .anjay = anjay,
+            .oid = (anjay_oid_t) i,
+            .finished_producers = &finished_producers
+        };
+        AVS_UNIT_ASSERT_SUCCESS(pthread_create(&threads[i], NULL,
+                                               producer_thread, &args[i]));
+    }
+
+    while (__atomic_load_n(&finished_producers, __ATOMIC_ACQUIRE)
+            < PRODUCER_THREADS) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_pending_drain(anjay));
+    }
+    for (size_t i = 0; i < PRODUCER_THREADS; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(threads[i], NULL));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_pending_drain(anjay));
+    AVS_UNIT_ASSERT_TRUE(_anjay_notify_pending_empty(anjay));
+
+    AVS_UNIT_ASSERT_TRUE(__atomic_load_n(&wakeups, __ATOMIC_RELAXED) > 0);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->scheduled_notify.queue),
+                          PRODUCER_THREADS);
+    AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, anjay->scheduled_notify.queue) {
+        AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(it->resources_changed),
+                              CHANGES_PER_PRODUCER);
+    }
+
+    pending_test_teardown(anjay);
+}
+
+#endif // WITH_THREAD_SAFE_NOTIFY
@@ -14,20 +14,13 @@
  * limitations under the License.
  */
 
-#ifndef ANJAY_COAP_IDSOURCE_STATIC_H
-#define ANJAY_COAP_IDSOURCE_STATIC_H
+#ifndef ANJAY_TEST_NOTIFY_MOCK_H
+#define ANJAY_TEST_NOTIFY_MOCK_H
 
-#include "id_source.h"
+#include <avsystem/commons/unit/mock_helpers.h>
 
-VISIBILITY_PRIVATE_HEADER_BEGIN
+AVS_UNIT_MOCK_CREATE(_anjay_notify_queue_resource_change)
+#define _anjay_notify_queue_resource_change(...) \
+        AVS_UNIT_MOCK_WRAPPER(_anjay_notify_queue_resource_change)(__VA_ARGS__)
 
-coap_id_source_t *
-_anjay_coap_id_source_new_static(const avs_coap_msg_identity_t *id);
-
-void
-_anjay_coap_id_source_static_reset(coap_id_source_t *self_,
-                                   const avs_coap_msg_identity_t *new_id);
-
-VISIBILITY_PRIVATE_HEADER_END
-
-#endif // ANJAY_COAP_IDSOURCE_STATIC_H
+#endif /* ANJAY_TEST_NOTIFY_MOCK_H */
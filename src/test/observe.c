@@ -84,8 +84,9 @@ static void assert_observe(anjay_t *anjay,
     AVS_UNIT_ASSERT_NULL(entity->last_unsent);
     AVS_UNIT_ASSERT_NOT_NULL(entity->last_sent);
     assert_msg_details_equal(&entity->last_sent->details, details);
-    AVS_UNIT_ASSERT_EQUAL(entity->last_sent->value_length, length);
-    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(entity->last_sent->value, data, length);
+    AVS_UNIT_ASSERT_EQUAL(payload_size(entity->last_sent->payload), length);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload_data(entity->last_sent->payload),
+                                      data, length);
 }
 
 static void expect_server_res_read(anjay_t *anjay,
@@ -615,6 +616,65 @@ AVS_UNIT_TEST(notify, confirmable) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(notify, confirmable_pipelined) {
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_GENERIC((DM_TEST_DEFAULT_OBJECTS), (14),
+                         (.confirmable_notifications = true,
+                          .max_notifications_in_flight = 1));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_put_entry(
+            anjay, &(const anjay_observe_key_t) {
+                { 14, ANJAY_CONNECTION_UDP }, 42, 69, 4, AVS_COAP_FORMAT_NONE
+            }, &(const anjay_msg_details_t) {
+                .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                .msg_code = AVS_COAP_CODE_CONTENT,
+                .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                .observe_serial = true
+            }, &(avs_coap_msg_identity_t) {}, 514.0, "514", 3));
+    assert_observe_size(anjay, 1);
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+
+    ////// CONFIRMABLE NOTIFICATION //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    static const char NOTIFY_RESPONSE[] =
+            "\x40\x45\x69\xED" // CoAP header
+            "\x63\xF9\x00\x00" // Observe option
+            "\x60" // Content-Format
+            "\xFF" "42";
+    avs_unit_mocksock_expect_output(mocksocks[0], NOTIFY_RESPONSE,
+                                    sizeof(NOTIFY_RESPONSE) - 1);
+    // the flush does not wait for the ACK
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(conn->in_flight), 1);
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_sent, 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_acknowledged, 0);
+#endif // WITH_NET_STATS
+
+    ////// ACK HANDLED BY anjay_serve() //////
+    static const char NOTIFY_ACK[] =
+            "\x60\x00\x69\xED";
+    avs_unit_mocksock_input(mocksocks[0], NOTIFY_ACK, sizeof(NOTIFY_ACK) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_NULL(conn->in_flight);
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_acknowledged, 1);
+#endif // WITH_NET_STATS
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(notify, extremes) {
     static const anjay_dm_internal_res_attrs_t ATTRS = {
         .standard = {
@@ -1310,7 +1370,9 @@ static void test_observe_entry(anjay_t *anjay,
 
 static anjay_t *create_test_env(void) {
     anjay_t *anjay = (anjay_t *) calloc(1, sizeof(anjay_t));
-    _anjay_observe_init(anjay, false);
+    _anjay_observe_init(anjay, &(const anjay_configuration_t) {
+                            .confirmable_notifications = false
+                        });
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 1);
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 3, 2);
     test_observe_entry(anjay, 1, ANJAY_CONNECTION_UDP, 2, 9, 4);
@@ -1382,6 +1444,397 @@ static inline void expect_notify_clear(void) {
     AVS_UNIT_ASSERT_NULL(MOCK_NOTIFY);
 }
 
+AVS_UNIT_TEST(notify, read_shared_between_servers) {
+    static const anjay_dm_internal_res_attrs_t ATTRS = {
+        .standard = {
+            .common = {
+                .min_period = 1,
+                .max_period = 365 * 24 * 60 * 60 // a year
+            },
+            .greater_than = ANJAY_ATTRIB_VALUE_NONE,
+            .less_than = ANJAY_ATTRIB_VALUE_NONE,
+            .step = ANJAY_ATTRIB_VALUE_NONE
+        }
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14, 34);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ssids); ++i) {
+        expect_read_res_attrs(anjay, &OBJ, ssids[i], 69, 4, &ATTRS);
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_put_entry(
+                anjay, &(const anjay_observe_key_t) {
+                    { ssids[i], ANJAY_CONNECTION_UDP },
+                    42, 69, 4, AVS_COAP_FORMAT_NONE
+                }, &(const anjay_msg_details_t) {
+                    .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                    .msg_code = AVS_COAP_CODE_CONTENT,
+                    .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                    .observe_serial = true
+                }, &NULL_IDENTITY, 514.0, "514", 3));
+    }
+    _anjay_mock_dm_expect_clean();
+    assert_observe_size(anjay, 2);
+
+    ////// READ ONCE FOR BOTH SERVERS //////
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_INT(0, 42));
+    anjay_observe_payload_t *payloads[2];
+    size_t num_payloads = 0;
+    AVS_RBTREE_ELEM(anjay_observe_connection_entry_t) conn;
+    AVS_RBTREE_FOREACH(conn, anjay->observe.connection_entries) {
+        anjay_msg_details_t details;
+        double numeric = NAN;
+        anjay_observe_payload_t **payload = &payloads[num_payloads++];
+        AVS_UNIT_ASSERT_EQUAL(read_new_value(anjay, &OBJ,
+                                             AVS_RBTREE_FIRST(conn->entries),
+                                             &details, &numeric, payload), 2);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload_data(*payload), "42", 2);
+        AVS_UNIT_ASSERT_EQUAL(details.format, ANJAY_COAP_FORMAT_PLAINTEXT);
+        AVS_UNIT_ASSERT_EQUAL(numeric, 42.0);
+        _anjay_mock_dm_expect_clean();
+    }
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->observe.read_cache), 1);
+    // the same payload is shared, not copied
+    AVS_UNIT_ASSERT_TRUE(payloads[0] == payloads[1]);
+    AVS_UNIT_ASSERT_EQUAL(payloads[0]->refcount, 3);
+    payload_release(&payloads[0]);
+    payload_release(&payloads[1]);
+
+    ////// CACHE CLEARED ON NEXT SCHEDULER RUN //////
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
+    AVS_UNIT_ASSERT_NULL(anjay->observe.read_cache);
+
+    DM_TEST_FINISH;
+}
+
+static void cache_test_read(anjay_t *anjay,
+                            anjay_oid_t oid,
+                            anjay_iid_t iid,
+                            int32_t rid) {
+    anjay_observe_payload_t *payload =
+            payload_new(&anjay->observe.payload_pool, "42", 2);
+    AVS_UNIT_ASSERT_NOT_NULL(payload);
+    cache_read(anjay, &(const anjay_observe_key_t) {
+                   { 14, ANJAY_CONNECTION_UDP }, oid, iid, rid,
+                   AVS_COAP_FORMAT_NONE
+               }, 2, &(const anjay_msg_details_t) {
+                   .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                   .msg_code = AVS_COAP_CODE_CONTENT,
+                   .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                   .observe_serial = true
+               }, 42.0, payload);
+    payload_release(&payload);
+}
+
+static bool is_read_cached(anjay_t *anjay,
+                           anjay_oid_t oid,
+                           anjay_iid_t iid,
+                           int32_t rid) {
+    return find_cached_read(anjay, &(const anjay_observe_key_t) {
+                                { 14, ANJAY_CONNECTION_UDP }, oid, iid, rid,
+                                AVS_COAP_FORMAT_NONE
+                            }) != NULL;
+}
+
+static void notify_changed(anjay_t *anjay,
+                           anjay_oid_t oid,
+                           anjay_iid_t iid,
+                           int32_t rid) {
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_notify(
+            anjay, &(const anjay_observe_key_t) {
+                { 14, ANJAY_CONNECTION_WILDCARD }, oid, iid, rid,
+                AVS_COAP_FORMAT_NONE
+            }, true));
+}
+
+AVS_UNIT_TEST(notify, read_cache_invalidated_on_change) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    cache_test_read(anjay, 42, 69, 4);
+    cache_test_read(anjay, 42, 69, 5);
+    cache_test_read(anjay, 42, 69, -1);
+    cache_test_read(anjay, 42, 70, 4);
+    cache_test_read(anjay, 43, 69, 4);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->observe.read_cache), 5);
+
+    ////// RESOURCE CHANGE - RESOURCE AND INSTANCE READS DROPPED //////
+    notify_changed(anjay, 42, 69, 4);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->observe.read_cache), 3);
+    AVS_UNIT_ASSERT_FALSE(is_read_cached(anjay, 42, 69, 4));
+    AVS_UNIT_ASSERT_FALSE(is_read_cached(anjay, 42, 69, -1));
+    AVS_UNIT_ASSERT_TRUE(is_read_cached(anjay, 42, 69, 5));
+    AVS_UNIT_ASSERT_TRUE(is_read_cached(anjay, 42, 70, 4));
+    AVS_UNIT_ASSERT_TRUE(is_read_cached(anjay, 43, 69, 4));
+
+    ////// INSTANCE CHANGE - ALL READS WITHIN IT DROPPED //////
+    notify_changed(anjay, 42, 70, -1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->observe.read_cache), 2);
+    AVS_UNIT_ASSERT_FALSE(is_read_cached(anjay, 42, 70, 4));
+
+    ////// INSTANCE SET CHANGE - ALL READS WITHIN THE OBJECT DROPPED //////
+    notify_changed(anjay, 42, ANJAY_IID_INVALID, -1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay->observe.read_cache), 1);
+    AVS_UNIT_ASSERT_TRUE(is_read_cached(anjay, 43, 69, 4));
+
+    DM_TEST_FINISH;
+}
+
+static uint64_t TEST_RESOURCE_VERSION;
+
+static int test_resource_version(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 uint64_t *out_version) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) rid;
+    *out_version = TEST_RESOURCE_VERSION;
+    return 0;
+}
+
+static const anjay_dm_object_def_t *const OBJ_WITH_VERSION =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .supported_rids = ANJAY_DM_SUPPORTED_RIDS(0, 1, 2, 3, 4, 5, 6),
+            .handlers = {
+                ANJAY_MOCK_DM_HANDLERS,
+                .instance_reset = _anjay_test_dm_instance_reset_NOOP,
+                .resource_version = test_resource_version
+            }
+        };
+
+AVS_UNIT_TEST(notify, read_skipped_if_version_unchanged) {
+    static const anjay_dm_internal_res_attrs_t ATTRS = {
+        .standard = {
+            .common = {
+                .min_period = 1,
+                .max_period = 365 * 24 * 60 * 60 // a year
+            },
+            .greater_than = ANJAY_ATTRIB_VALUE_NONE,
+            .less_than = ANJAY_ATTRIB_VALUE_NONE,
+            .step = ANJAY_ATTRIB_VALUE_NONE
+        }
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_VERSION, &FAKE_SECURITY, &FAKE_SERVER);
+    TEST_RESOURCE_VERSION = 1;
+    expect_read_res_attrs(anjay, &OBJ_WITH_VERSION, 1, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_put_entry(
+            anjay, &(const anjay_observe_key_t) {
+                { 1, ANJAY_CONNECTION_UDP }, 42, 69, 4, AVS_COAP_FORMAT_NONE
+            }, &(const anjay_msg_details_t) {
+                .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                .msg_code = AVS_COAP_CODE_CONTENT,
+                .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                .observe_serial = true
+            }, &NULL_IDENTITY, 514.0, "514", 3));
+    _anjay_mock_dm_expect_clean();
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry = AVS_RBTREE_FIRST(conn->entries);
+
+    ////// VERSION NOT KNOWN YET - VALUE IS READ //////
+    expect_read_res_attrs(anjay, &OBJ_WITH_VERSION, 1, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ_WITH_VERSION, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    AVS_UNIT_ASSERT_SUCCESS(update_notification_value(anjay, conn, entry));
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 1);
+    AVS_UNIT_ASSERT_TRUE(entry->value_version_valid);
+
+    ////// SAME VERSION - READ IS SKIPPED //////
+    clear_read_cache(anjay);
+    expect_read_res_attrs(anjay, &OBJ_WITH_VERSION, 1, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(update_notification_value(anjay, conn, entry));
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 1);
+
+    ////// NEW VERSION - VALUE IS READ AGAIN //////
+    TEST_RESOURCE_VERSION = 2;
+    expect_read_res_attrs(anjay, &OBJ_WITH_VERSION, 1, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ_WITH_VERSION, 69, 4, ANJAY_MOCK_DM_INT(0, 43));
+    AVS_UNIT_ASSERT_SUCCESS(update_notification_value(anjay, conn, entry));
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 2);
+    AVS_UNIT_ASSERT_EQUAL(entry->value_version, 2);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, large_value_hashed) {
+    static const anjay_dm_internal_res_attrs_t ATTRS = {
+        .standard = {
+            .common = {
+                .min_period = 1,
+                .max_period = 365 * 24 * 60 * 60 // a year
+            },
+            .greater_than = ANJAY_ATTRIB_VALUE_NONE,
+            .less_than = ANJAY_ATTRIB_VALUE_NONE,
+            .step = ANJAY_ATTRIB_VALUE_NONE
+        }
+    };
+    static char LARGE_VALUE[ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 2];
+    memset(LARGE_VALUE, 'x', sizeof(LARGE_VALUE) - 1);
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_put_entry(
+            anjay, &(const anjay_observe_key_t) {
+                { 14, ANJAY_CONNECTION_UDP }, 42, 69, 4, AVS_COAP_FORMAT_NONE
+            }, &(const anjay_msg_details_t) {
+                .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                .msg_code = AVS_COAP_CODE_CONTENT,
+                .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                .observe_serial = true
+            }, &NULL_IDENTITY, 514.0, "514", 3));
+    _anjay_mock_dm_expect_clean();
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry = AVS_RBTREE_FIRST(conn->entries);
+
+    ////// VALUE LARGER THAN THE BUFFER IS ONLY HASHED //////
+    anjay_msg_details_t details;
+    double numeric = NAN;
+    anjay_observe_payload_t *first;
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_STRING(0, LARGE_VALUE));
+    AVS_UNIT_ASSERT_EQUAL(read_new_value(anjay, &OBJ, entry, &details,
+                                         &numeric, &first),
+                          ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 1);
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_NOT_NULL(first);
+    AVS_UNIT_ASSERT_TRUE(first->hashed_only);
+    AVS_UNIT_ASSERT_EQUAL(payload_size(first), 0);
+    AVS_UNIT_ASSERT_TRUE(should_update(entry->last_sent, &ATTRS.standard,
+                                       &details, numeric, first));
+    AVS_UNIT_ASSERT_SUCCESS(insert_new_value(anjay, conn, entry, &details,
+                                             &NULL_IDENTITY, numeric, first));
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.bytes, unsent_record_charge(0));
+
+    ////// UNCHANGED VALUE IS RECOGNIZED BY ITS HASH //////
+    clear_read_cache(anjay);
+    anjay_observe_payload_t *second;
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_STRING(0, LARGE_VALUE));
+    AVS_UNIT_ASSERT_EQUAL(read_new_value(anjay, &OBJ, entry, &details,
+                                         &numeric, &second),
+                          ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 1);
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_TRUE(second == first);
+    AVS_UNIT_ASSERT_FALSE(should_update(entry->last_unsent, &ATTRS.standard,
+                                        &details, numeric, second));
+    payload_release(&first);
+    payload_release(&second);
+
+    ////// CONSECUTIVE HASHED VALUES ARE COALESCED //////
+    anjay_observe_payload_t *third =
+            payload_new_hashed(&anjay->observe.payload_pool, NULL,
+                               ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 1,
+                               entry->last_unsent->payload->hash + 1);
+    AVS_UNIT_ASSERT_NOT_NULL(third);
+    AVS_UNIT_ASSERT_SUCCESS(insert_new_value(anjay, conn, entry, &details,
+                                             &NULL_IDENTITY, numeric, third));
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 1);
+    AVS_UNIT_ASSERT_TRUE(entry->last_unsent->payload == third);
+    payload_release(&third);
+
+    ////// CURRENT VALUE IS SENT AND REMEMBERED AS THE LAST SENT ONE //////
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Hi"));
+    static const char NOTIFY_RESPONSE[] =
+            "\x50\x45\x69\xED" // CoAP header
+            "\x63\xF4\x00\x00" // Observe option
+            "\x60" // Content-Format
+            "\xFF" "Hi";
+    avs_unit_mocksock_expect_output(mocksocks[0], NOTIFY_RESPONSE,
+                                    sizeof(NOTIFY_RESPONSE) - 1);
+    AVS_UNIT_ASSERT_SUCCESS(send_entry(anjay, conn));
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_TRUE(unsent_queue_empty(&conn->unsent));
+    AVS_UNIT_ASSERT_FALSE(entry->last_sent->payload->hashed_only);
+    AVS_UNIT_ASSERT_EQUAL(payload_size(entry->last_sent->payload), 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload_data(entry->last_sent->payload),
+                                      "Hi", 2);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, large_value_block2) {
+    static const anjay_dm_internal_res_attrs_t ATTRS = {
+        .standard = {
+            .common = {
+                .min_period = 1,
+                .max_period = 365 * 24 * 60 * 60 // a year
+            },
+            .greater_than = ANJAY_ATTRIB_VALUE_NONE,
+            .less_than = ANJAY_ATTRIB_VALUE_NONE,
+            .step = ANJAY_ATTRIB_VALUE_NONE
+        }
+    };
+    static char LARGE_VALUE[ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 2];
+    memset(LARGE_VALUE, 'x', sizeof(LARGE_VALUE) - 1);
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_observe_put_entry(
+            anjay, &(const anjay_observe_key_t) {
+                { 14, ANJAY_CONNECTION_UDP }, 42, 69, 4, AVS_COAP_FORMAT_NONE
+            }, &(const anjay_msg_details_t) {
+                .msg_type = AVS_COAP_MSG_ACKNOWLEDGEMENT,
+                .msg_code = AVS_COAP_CODE_CONTENT,
+                .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                .observe_serial = true
+            }, &NULL_IDENTITY, 514.0, "514", 3));
+    _anjay_mock_dm_expect_clean();
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry = AVS_RBTREE_FIRST(conn->entries);
+
+    anjay_msg_details_t details = entry->last_sent->details;
+    anjay_observe_payload_t *value =
+            payload_new_hashed(&anjay->observe.payload_pool, NULL,
+                               ANJAY_MAX_OBSERVABLE_RESOURCE_SIZE + 1,
+                               entry->last_sent->payload->hash + 1);
+    AVS_UNIT_ASSERT_NOT_NULL(value);
+    AVS_UNIT_ASSERT_SUCCESS(insert_new_value(anjay, conn, entry, &details,
+                                             &NULL_IDENTITY, NAN, value));
+    payload_release(&value);
+
+    ////// ONLY THE FIRST BLOCK2 BLOCK IS SENT //////
+    _anjay_mock_dm_expect_instance_present(anjay, &OBJ, 69, 1);
+    _anjay_mock_dm_expect_resource_present(anjay, &OBJ, 69, 4, 1);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, 0,
+                                        ANJAY_MOCK_DM_STRING(0, LARGE_VALUE));
+    static const char NOTIFY_HEADER[] =
+            "\x50\x45\x69\xED" // CoAP header
+            "\x63\xF4\x00\x00" // Observe option
+            "\x60" // Content-Format
+            "\xB1\x0E" // Block2: seq_num 0, more, size 1024
+            "\xFF";
+    char notify_response[sizeof(NOTIFY_HEADER) - 1 + 1024];
+    memcpy(notify_response, NOTIFY_HEADER, sizeof(NOTIFY_HEADER) - 1);
+    memset(notify_response + sizeof(NOTIFY_HEADER) - 1, 'x', 1024);
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response,
+                                    sizeof(notify_response));
+    AVS_UNIT_ASSERT_SUCCESS(send_entry(anjay, conn));
+    _anjay_mock_dm_expect_clean();
+    AVS_UNIT_ASSERT_TRUE(unsent_queue_empty(&conn->unsent));
+    AVS_UNIT_ASSERT_TRUE(entry->last_sent->payload->hashed_only);
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(notify, notify_changed) {
     anjay_t *anjay = create_test_env();
 
@@ -1878,12 +2331,12 @@ AVS_UNIT_TEST(notify, reconnect) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
     // mocking reconnect is rather hard, so let's just check it's scheduled
-    AVS_UNIT_ASSERT_TRUE(anjay->sched->entries
+    AVS_UNIT_ASSERT_TRUE(_anjay_sched_first_entry(anjay->sched)
             == anjay->servers.active->sched_update_handle);
     // encoded update args:
     // - SSID==14 (0x000E)
     // - reconnect required == true (hence the 1 at the higher-order byte)
-    AVS_UNIT_ASSERT_EQUAL((uintptr_t) anjay->sched->entries->clb_data, 0x1000E);
+    AVS_UNIT_ASSERT_EQUAL((uintptr_t) _anjay_sched_first_entry(anjay->sched)->clb_data, 0x1000E);
     _anjay_sched_del(anjay->sched, &anjay->servers.active->sched_update_handle);
 
     // resend
@@ -1894,7 +2347,163 @@ AVS_UNIT_TEST(notify, reconnect) {
                                     sizeof(NOTIFY_RESPONSE) - 1);
     AVS_UNIT_ASSERT_SUCCESS(anjay_sched_run(anjay));
 
-    AVS_UNIT_ASSERT_NULL(anjay->sched->entries);
+    AVS_UNIT_ASSERT_NULL(_anjay_sched_first_entry(anjay->sched));
+
+    DM_TEST_FINISH;
+}
+
+static void insert_test_value(anjay_t *anjay,
+                              anjay_observe_connection_entry_t *conn,
+                              anjay_observe_entry_t *entry,
+                              const char *value) {
+    anjay_observe_payload_t *payload =
+            payload_new(&anjay->observe.payload_pool, value, strlen(value));
+    AVS_UNIT_ASSERT_NOT_NULL(payload);
+    AVS_UNIT_ASSERT_SUCCESS(insert_new_value(
+            anjay, conn, entry, &(const anjay_msg_details_t) {
+                .msg_type = AVS_COAP_MSG_NON_CONFIRMABLE,
+                .msg_code = AVS_COAP_CODE_CONTENT,
+                .format = ANJAY_COAP_FORMAT_PLAINTEXT,
+                .observe_serial = true
+            }, &NULL_IDENTITY, NAN, payload));
+    payload_release(&payload);
+}
+
+static void assert_first_unsent(anjay_observe_connection_entry_t *conn,
+                                const char *value) {
+    const anjay_observe_resource_value_t *first =
+            unsent_queue_first(&conn->unsent);
+    AVS_UNIT_ASSERT_NOT_NULL(first);
+    AVS_UNIT_ASSERT_EQUAL(payload_size(first->payload), strlen(value));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload_data(first->payload),
+                                      value, strlen(value));
+}
+
+AVS_UNIT_TEST(stored_notifications, drop_oldest) {
+    anjay_t *anjay = create_test_env();
+    anjay->observe.stored_notifications_buffer_size =
+            3 * unsent_record_charge(2);
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry1 = AVS_RBTREE_FIRST(conn->entries);
+    anjay_observe_entry_t *entry2 = AVS_RBTREE_ELEM_NEXT(entry1);
+
+    insert_test_value(anjay, conn, entry1, "v1");
+    insert_test_value(anjay, conn, entry2, "v2");
+    insert_test_value(anjay, conn, entry1, "v3");
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 3);
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_dropped, 0);
+#endif // WITH_NET_STATS
+
+    // buffer is full, v1 needs to go
+    insert_test_value(anjay, conn, entry2, "v4");
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 3);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.bytes, 3 * unsent_record_charge(2));
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_dropped, 1);
+#endif // WITH_NET_STATS
+    assert_first_unsent(conn, "v2");
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            payload_data(entry1->last_unsent->payload), "v3", 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            payload_data(entry2->last_unsent->payload), "v4", 2);
+
+    unsent_queue_pop(&conn->unsent);
+    assert_first_unsent(conn, "v3");
+    unsent_queue_pop(&conn->unsent);
+    AVS_UNIT_ASSERT_NULL(entry1->last_unsent);
+    assert_first_unsent(conn, "v4");
+    unsent_queue_pop(&conn->unsent);
+    AVS_UNIT_ASSERT_NULL(entry2->last_unsent);
+    AVS_UNIT_ASSERT_TRUE(unsent_queue_empty(&conn->unsent));
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.bytes, 0);
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(stored_notifications, coalesce) {
+    anjay_t *anjay = create_test_env();
+    anjay->observe.stored_notifications_buffer_size =
+            3 * unsent_record_charge(2);
+    anjay->observe.notification_overflow_policy =
+            ANJAY_NOTIFICATION_OVERFLOW_COALESCE;
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry1 = AVS_RBTREE_FIRST(conn->entries);
+    anjay_observe_entry_t *entry2 = AVS_RBTREE_ELEM_NEXT(entry1);
+
+    insert_test_value(anjay, conn, entry1, "v1");
+    insert_test_value(anjay, conn, entry2, "v2");
+    insert_test_value(anjay, conn, entry1, "v3");
+
+    // buffer is full, v4 replaces v2 in place
+    insert_test_value(anjay, conn, entry2, "v4");
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 3);
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_dropped, 1);
+#endif // WITH_NET_STATS
+    assert_first_unsent(conn, "v1");
+    clear_entry(anjay, conn, entry1);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 1);
+    assert_first_unsent(conn, "v4");
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(stored_notifications, latest_value_wins) {
+    anjay_t *anjay = create_test_env();
+    anjay->observe.coalesce_notifications = true;
+    anjay_observe_connection_entry_t *conn =
+            AVS_RBTREE_FIRST(anjay->observe.connection_entries);
+    anjay_observe_entry_t *entry1 = AVS_RBTREE_FIRST(conn->entries);
+    anjay_observe_entry_t *entry2 = AVS_RBTREE_ELEM_NEXT(entry1);
+
+    insert_test_value(anjay, conn, entry1, "v1");
+    insert_test_value(anjay, conn, entry2, "v2");
+    // v3 takes the place of v1, ahead of v2
+    insert_test_value(anjay, conn, entry1, "v3");
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 2);
+#ifdef WITH_NET_STATS
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.notifications_dropped, 0);
+#endif // WITH_NET_STATS
+    assert_first_unsent(conn, "v3");
+
+    // payloads are stored outside of the queue, so even a longer value
+    // replaces v2 in place
+    static const char LONG_VALUE[] =
+            "0123456789abcdef0123456789abcdef0123456789abcdef";
+    insert_test_value(anjay, conn, entry2, LONG_VALUE);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 2);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.used, 2);
+    assert_first_unsent(conn, "v3");
+    clear_entry(anjay, conn, entry1);
+    AVS_UNIT_ASSERT_EQUAL(conn->unsent.count, 1);
+    assert_first_unsent(conn, LONG_VALUE);
+
+    destroy_test_env(anjay);
+}
+
+AVS_UNIT_TEST(observe_payload_pool, blocks_reused) {
+    DM_TEST_INIT;
+    anjay_observe_payload_pool_t *pool = &anjay->observe.payload_pool;
+    anjay_observe_payload_t *first = payload_new(pool, "514", 3);
+    AVS_UNIT_ASSERT_NOT_NULL(first);
+    const void *block = first;
+    payload_release(&first);
+    AVS_UNIT_ASSERT_EQUAL(pool->free_bytes, PAYLOAD_POOL_MIN_BLOCK_SIZE);
+
+    ////// VALUE OF THE SAME SIZE CLASS REUSES THE BLOCK //////
+    anjay_observe_payload_t *second = payload_new(pool, "42", 2);
+    AVS_UNIT_ASSERT_TRUE((const void *) second == block);
+    AVS_UNIT_ASSERT_EQUAL(pool->free_bytes, 0);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload_data(second), "42", 2);
+
+    ////// BLOCKS OVER THE LIMIT ARE FREED //////
+    pool->max_free_bytes = 0;
+    payload_release(&second);
+    AVS_UNIT_ASSERT_EQUAL(pool->free_bytes, 0);
+    AVS_UNIT_ASSERT_NULL(pool->free_blocks[0]);
 
     DM_TEST_FINISH;
 }
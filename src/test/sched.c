@@ -299,3 +299,53 @@ AVS_UNIT_TEST(sched, retryable_job_handle_nullification) {
     AVS_UNIT_ASSERT_NULL(global.task);
     teardown_test(&env);
 }
+
+typedef struct {
+    int *last_executed;
+    int id;
+} ordered_task_t;
+
+static int assert_order_task(anjay_t *anjay, void *task_) {
+    (void) anjay;
+    ordered_task_t *task = (ordered_task_t *) task_;
+    AVS_UNIT_ASSERT_TRUE(*task->last_executed < task->id);
+    *task->last_executed = task->id;
+    return 0;
+}
+
+AVS_UNIT_TEST(sched, ordering_with_deletions) {
+    sched_test_env_t env = setup_test();
+
+    enum { NUM_TASKS = 100 };
+    ordered_task_t tasks[NUM_TASKS];
+    anjay_sched_handle_t handles[NUM_TASKS] = { NULL };
+    int last_executed = -1;
+
+    // schedule groups of tasks in reverse order of their delays; tasks with
+    // the same delay have to be executed in the order they were scheduled in
+    for (int group = NUM_TASKS / 10 - 1; group >= 0; --group) {
+        for (int i = group * 10; i < (group + 1) * 10; ++i) {
+            tasks[i].last_executed = &last_executed;
+            tasks[i].id = i;
+            AVS_UNIT_ASSERT_SUCCESS(_anjay_sched(
+                    env.sched, &handles[i],
+                    avs_time_duration_from_scalar(group, AVS_TIME_S),
+                    assert_order_task, &tasks[i]));
+        }
+    }
+    for (int i = 0; i < NUM_TASKS; i += 3) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_sched_del(env.sched, &handles[i]));
+        AVS_UNIT_ASSERT_NULL(handles[i]);
+    }
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(NUM_TASKS / 10,
+                                                            AVS_TIME_S));
+    AVS_UNIT_ASSERT_EQUAL(NUM_TASKS - (NUM_TASKS + 2) / 3,
+                          _anjay_sched_run(env.sched));
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        AVS_UNIT_ASSERT_NULL(handles[i]);
+    }
+    AVS_UNIT_ASSERT_FAILED(_anjay_sched_time_to_next(env.sched, NULL));
+
+    teardown_test(&env);
+}
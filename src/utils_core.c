@@ -490,6 +490,30 @@ fail:
     return NULL;
 }
 
+int _anjay_socket_list_updater_add(anjay_socket_list_updater_t *updater,
+                                   avs_net_abstract_socket_t *socket) {
+    if (!*updater->tail_ptr) {
+        if (!AVS_LIST_INSERT_NEW(avs_net_abstract_socket_t *const,
+                                 updater->tail_ptr)) {
+            anjay_log(ERROR, "Out of memory while building socket list");
+            return -1;
+        }
+        updater->changed = true;
+    } else if (**updater->tail_ptr != socket) {
+        updater->changed = true;
+    }
+    *(avs_net_abstract_socket_t **) (intptr_t) *updater->tail_ptr = socket;
+    updater->tail_ptr = AVS_LIST_NEXT_PTR(updater->tail_ptr);
+    return 0;
+}
+
+void _anjay_socket_list_updater_finish(anjay_socket_list_updater_t *updater) {
+    if (*updater->tail_ptr) {
+        AVS_LIST_CLEAR(updater->tail_ptr);
+        updater->changed = true;
+    }
+}
+
 #ifdef ANJAY_TEST
 #include "test/utils.c"
 #endif // ANJAY_TEST
@@ -25,6 +25,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -32,6 +33,7 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 #define anjay_log(...) _anjay_log(anjay, __VA_ARGS__)
 
 int _anjay_safe_strtoll(const char *in, long long *value);
+int _anjay_safe_strtof(const char *in, float *value);
 int _anjay_safe_strtod(const char *in, double *value);
 
 #define ANJAY_MAX_URL_PROTO_SIZE sizeof("coaps")
@@ -100,6 +102,29 @@ _anjay_create_connected_udp_socket(anjay_t *anjay,
                                    const void *config,
                                    const anjay_url_t *uri);
 
+/**
+ * Helper for rebuilding a list of sockets in place. List elements are reused
+ * as long as the sockets are the same as during the previous rebuild, so that
+ * no allocations happen while the set of sockets does not change.
+ */
+typedef struct {
+    /* position in the list at which the next socket will be put */
+    AVS_LIST(avs_net_abstract_socket_t *const) *tail_ptr;
+    /* set if the list contents differ from the previous rebuild */
+    bool changed;
+} anjay_socket_list_updater_t;
+
+/**
+ * Puts @p socket at the current position of @p updater and advances it.
+ */
+int _anjay_socket_list_updater_add(anjay_socket_list_updater_t *updater,
+                                   avs_net_abstract_socket_t *socket);
+
+/**
+ * Removes all list elements past the current position of @p updater.
+ */
+void _anjay_socket_list_updater_finish(anjay_socket_list_updater_t *updater);
+
 static inline size_t _anjay_max_power_of_2_not_greater_than(size_t bound) {
     int exponent = -1;
     while (bound) {
@@ -109,6 +134,21 @@ static inline size_t _anjay_max_power_of_2_not_greater_than(size_t bound) {
     return (exponent >= 0) ? ((size_t) 1 << exponent) : 0;
 }
 
+#define ANJAY_FNV1A_64_OFFSET_BASIS UINT64_C(0xcbf29ce484222325)
+
+/**
+ * Continues calculating a 64-bit FNV-1a hash of a byte sequence. The initial
+ * value of @p hash shall be @ref ANJAY_FNV1A_64_OFFSET_BASIS .
+ */
+static inline uint64_t
+_anjay_fnv1a_64_update(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_UTILS_H
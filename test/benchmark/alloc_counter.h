@@ -0,0 +1,72 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANJAY_BENCHMARK_ALLOC_COUNTER_H
+#define ANJAY_BENCHMARK_ALLOC_COUNTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Heap allocation counter for benchmarks. When the benchmark is linked with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (which test/benchmark/
+ * CMakeLists.txt does for benchmarks listed in ALLOC_COUNTING_BENCHMARKS),
+ * every allocation made by the library is counted.
+ *
+ * This header defines functions, so it shall be included in exactly one
+ * translation unit of a benchmark.
+ */
+
+static size_t g_alloc_count;
+
+#ifdef ANJAY_BENCHMARK_COUNT_ALLOCATIONS
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    ++g_alloc_count;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    ++g_alloc_count;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    ++g_alloc_count;
+    return __real_realloc(ptr, size);
+}
+
+static inline bool alloc_counting_enabled(void) {
+    return true;
+}
+
+#else // ANJAY_BENCHMARK_COUNT_ALLOCATIONS
+
+static inline bool alloc_counting_enabled(void) {
+    return false;
+}
+
+#endif // ANJAY_BENCHMARK_COUNT_ALLOCATIONS
+
+static inline size_t alloc_count(void) {
+    return g_alloc_count;
+}
+
+#endif /* ANJAY_BENCHMARK_ALLOC_COUNTER_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/base64.h>
+#include <avsystem/commons/time.h>
+
+#include "../../src/io/base64_codec.h"
+
+#define NUM_ITERATIONS 50
+#define DATA_SIZE (64 * 1024)
+#define ENCODED_SIZE _ANJAY_BASE64_ENCODED_SIZE(DATA_SIZE)
+
+// The chunk size the text/plain output context used to encode in
+#define LEGACY_CHUNK_SIZE (3 * 64)
+
+typedef int encode_fn_t(char *out, const uint8_t *in, size_t in_size);
+typedef int decode_fn_t(uint8_t *out, const char *in, size_t in_size);
+
+static int legacy_encode(char *out, const uint8_t *in, size_t in_size) {
+    for (size_t offset = 0; offset < in_size; offset += LEGACY_CHUNK_SIZE) {
+        size_t chunk_size = in_size - offset;
+        if (chunk_size > LEGACY_CHUNK_SIZE) {
+            chunk_size = LEGACY_CHUNK_SIZE;
+        }
+        char encoded[4 * (LEGACY_CHUNK_SIZE / 3) + 1];
+        if (avs_base64_encode(encoded, sizeof(encoded),
+                              &in[offset], chunk_size)) {
+            return -1;
+        }
+        size_t encoded_size = strlen(encoded);
+        memcpy(out, encoded, encoded_size);
+        out += encoded_size;
+    }
+    return 0;
+}
+
+// Quartet-by-quartet decoding, as previously done by text_get_some_bytes()
+static int legacy_decode(uint8_t *out, const char *in, size_t in_size) {
+    for (size_t offset = 0; offset < in_size; offset += 4) {
+        char encoded[5];
+        memcpy(encoded, &in[offset], 4);
+        encoded[4] = '\0';
+        uint8_t decoded[3];
+        ssize_t decoded_size =
+                avs_base64_decode_strict(decoded, sizeof(decoded), encoded);
+        if (decoded_size < 0) {
+            return -1;
+        }
+        memcpy(out, decoded, (size_t) decoded_size);
+        out += decoded_size;
+    }
+    return 0;
+}
+
+static int bulk_encode(char *out, const uint8_t *in, size_t in_size) {
+    _anjay_base64_encode_block(out, in, in_size);
+    return 0;
+}
+
+static int bulk_decode(uint8_t *out, const char *in, size_t in_size) {
+    return _anjay_base64_decode_block(out, in, in_size) < 0 ? -1 : 0;
+}
+
+static void report(const char *what, avs_time_monotonic_t start,
+                   size_t bytes_per_iteration) {
+    avs_time_duration_t elapsed =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start);
+    int64_t elapsed_us;
+    avs_time_duration_to_scalar(&elapsed_us, AVS_TIME_US, elapsed);
+    double mb_per_s = elapsed_us > 0
+            ? (double) (bytes_per_iteration * NUM_ITERATIONS)
+                    / (double) elapsed_us
+            : 0.0;
+    printf("%-24s %10" PRId64 " us %10.2f MB/s\n", what, elapsed_us,
+           mb_per_s);
+}
+
+static int run_encode(const char *name, encode_fn_t *encode,
+                      const uint8_t *data, char *encoded) {
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        if (encode(encoded, data, DATA_SIZE)) {
+            fprintf(stderr, "could not encode: %s\n", name);
+            return -1;
+        }
+    }
+    report(name, start, DATA_SIZE);
+    return 0;
+}
+
+static int run_decode(const char *name, decode_fn_t *decode,
+                      const char *encoded, const uint8_t *expected,
+                      uint8_t *decoded) {
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        if (decode(decoded, encoded, ENCODED_SIZE)) {
+            fprintf(stderr, "could not decode: %s\n", name);
+            return -1;
+        }
+    }
+    report(name, start, ENCODED_SIZE);
+    if (memcmp(decoded, expected, DATA_SIZE)) {
+        fprintf(stderr, "decoded data mismatch: %s\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+int main(void) {
+    uint8_t *data = (uint8_t *) malloc(DATA_SIZE);
+    uint8_t *decoded = (uint8_t *) malloc(DATA_SIZE);
+    char *legacy_encoded = (char *) malloc(ENCODED_SIZE);
+    char *bulk_encoded = (char *) malloc(ENCODED_SIZE);
+    if (!data || !decoded || !legacy_encoded || !bulk_encoded) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    uint32_t state = 1;
+    for (size_t i = 0; i < DATA_SIZE; ++i) {
+        state = state * 1103515245u + 12345u;
+        data[i] = (uint8_t) (state >> 16);
+    }
+
+    printf("base64 codec benchmark, %d iterations of %d bytes\n",
+           NUM_ITERATIONS, DATA_SIZE);
+    int result = run_encode("legacy encode", legacy_encode, data,
+                            legacy_encoded);
+    if (!result) {
+        result = run_encode("bulk encode", bulk_encode, data, bulk_encoded);
+    }
+    if (!result && memcmp(legacy_encoded, bulk_encoded, ENCODED_SIZE)) {
+        fprintf(stderr, "encoded data mismatch\n");
+        result = -1;
+    }
+    if (!result) {
+        result = run_decode("legacy decode", legacy_decode, bulk_encoded,
+                            data, decoded);
+    }
+    if (!result) {
+        memset(decoded, 0, DATA_SIZE);
+        result = run_decode("bulk decode", bulk_decode, bulk_encoded,
+                            data, decoded);
+    }
+
+    free(data);
+    free(decoded);
+    free(legacy_encoded);
+    free(bulk_encoded);
+    return result ? 1 : 0;
+}
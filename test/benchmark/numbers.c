@@ -0,0 +1,137 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/time.h>
+
+#include "../../src/io/numbers.h"
+#include "../../src/utils_core.h"
+
+#define NUM_VALUES 100000
+#define STRING_SIZE 32
+
+static uint64_t g_rand_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t next_rand(void) {
+    g_rand_state ^= g_rand_state << 13;
+    g_rand_state ^= g_rand_state >> 7;
+    g_rand_state ^= g_rand_state << 17;
+    return g_rand_state;
+}
+
+static void report(const char *what, avs_time_monotonic_t start) {
+    avs_time_duration_t elapsed =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start);
+    int64_t elapsed_us;
+    avs_time_duration_to_scalar(&elapsed_us, AVS_TIME_US, elapsed);
+    printf("%-32s %10" PRId64 " us (%.1f ns/value)\n", what, elapsed_us,
+           1000.0 * (double) elapsed_us / NUM_VALUES);
+}
+
+int main(void) {
+    double *values = (double *) malloc(NUM_VALUES * sizeof(double));
+    int64_t *ints = (int64_t *) malloc(NUM_VALUES * sizeof(int64_t));
+    char *strings = (char *) malloc(NUM_VALUES * STRING_SIZE);
+    if (!values || !ints || !strings) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    // sensor-like samples with a few significant digits, plus arbitrary bits
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        if (i % 2) {
+            values[i] = (double) (int64_t) (next_rand() % 2000000 - 1000000)
+                    / 1000.0;
+        } else {
+            // normal numbers only: strtod() reports ERANGE for subnormals
+            uint64_t bits = (next_rand() & ~(UINT64_C(1) << 62))
+                    | (UINT64_C(1) << 52);
+            memcpy(&values[i], &bits, sizeof(bits));
+        }
+        ints[i] = (int64_t) next_rand() >> (next_rand() % 64);
+    }
+
+    printf("number conversion benchmark, %d values\n", NUM_VALUES);
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        snprintf(&strings[i * STRING_SIZE], STRING_SIZE, "%.17g", values[i]);
+    }
+    report("snprintf(\"%.17g\")", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        _anjay_double_to_string(&strings[i * STRING_SIZE], values[i]);
+    }
+    report("_anjay_double_to_string()", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        double value = strtod(&strings[i * STRING_SIZE], NULL);
+        if (memcmp(&value, &values[i], sizeof(value))) {
+            fprintf(stderr, "round trip failed: %s\n",
+                    &strings[i * STRING_SIZE]);
+            return 1;
+        }
+    }
+    report("strtod()", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        double value;
+        if (_anjay_safe_strtod(&strings[i * STRING_SIZE], &value)
+                || memcmp(&value, &values[i], sizeof(value))) {
+            fprintf(stderr, "round trip failed: %s\n",
+                    &strings[i * STRING_SIZE]);
+            return 1;
+        }
+    }
+    report("_anjay_safe_strtod()", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        snprintf(&strings[i * STRING_SIZE], STRING_SIZE, "%" PRId64, ints[i]);
+    }
+    report("snprintf(\"%\" PRId64)", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        _anjay_i64_to_string(&strings[i * STRING_SIZE], ints[i]);
+    }
+    report("_anjay_i64_to_string()", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        long long value;
+        if (_anjay_safe_strtoll(&strings[i * STRING_SIZE], &value)
+                || value != ints[i]) {
+            fprintf(stderr, "round trip failed: %s\n",
+                    &strings[i * STRING_SIZE]);
+            return 1;
+        }
+    }
+    report("_anjay_safe_strtoll()", start);
+
+    free(values);
+    free(ints);
+    free(strings);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <avsystem/commons/time.h>
+
+#include "../../src/sched.h"
+#include "../../src/utils_core.h"
+
+#define NUM_TASKS 100000
+
+static int noop_task(anjay_t *anjay, void *data) {
+    (void) anjay;
+    (void) data;
+    return 0;
+}
+
+static void report(const char *what, avs_time_monotonic_t start) {
+    avs_time_duration_t elapsed =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start);
+    int64_t elapsed_us;
+    avs_time_duration_to_scalar(&elapsed_us, AVS_TIME_US, elapsed);
+    printf("%-40s %10" PRId64 " us (%.3f us/task)\n", what, elapsed_us,
+           (double) elapsed_us / NUM_TASKS);
+}
+
+static void shuffle(size_t *indices, size_t count, anjay_rand_seed_t *seed) {
+    for (size_t i = count - 1; i > 0; --i) {
+        size_t j = _anjay_rand32(seed) % (i + 1);
+        size_t tmp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = tmp;
+    }
+}
+
+int main(void) {
+    anjay_sched_t *sched = _anjay_sched_new(NULL);
+    anjay_sched_handle_t *handles = (anjay_sched_handle_t *)
+            calloc(NUM_TASKS, sizeof(anjay_sched_handle_t));
+    size_t *indices = (size_t *) calloc(NUM_TASKS, sizeof(size_t));
+    if (!sched || !handles || !indices) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    anjay_rand_seed_t seed = 42;
+    for (size_t i = 0; i < NUM_TASKS; ++i) {
+        indices[i] = i;
+    }
+
+    printf("scheduler benchmark, %d tasks\n", NUM_TASKS);
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_TASKS; ++i) {
+        avs_time_duration_t delay = avs_time_duration_from_scalar(
+                60 + _anjay_rand32(&seed) % 3600, AVS_TIME_S);
+        if (_anjay_sched(sched, &handles[i], delay, noop_task, NULL)) {
+            fprintf(stderr, "could not schedule task %lu\n", (unsigned long) i);
+            return 1;
+        }
+    }
+    report("schedule (random delays)", start);
+
+    shuffle(indices, NUM_TASKS, &seed);
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_TASKS; ++i) {
+        if (_anjay_sched_del(sched, &handles[indices[i]])) {
+            fprintf(stderr, "could not cancel task %lu\n",
+                    (unsigned long) indices[i]);
+            return 1;
+        }
+    }
+    report("cancel (random order)", start);
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_TASKS; ++i) {
+        if (_anjay_sched_now(sched, &handles[i], noop_task, NULL)) {
+            fprintf(stderr, "could not schedule task %lu\n", (unsigned long) i);
+            return 1;
+        }
+    }
+    report("schedule (no delay)", start);
+
+    start = avs_time_monotonic_now();
+    ssize_t executed = _anjay_sched_run(sched);
+    report("run", start);
+    if (executed != NUM_TASKS) {
+        fprintf(stderr, "executed %ld tasks, expected %d\n", (long) executed,
+                NUM_TASKS);
+        return 1;
+    }
+
+    free(indices);
+    free(handles);
+    _anjay_sched_delete(&sched);
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2017 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <avsystem/commons/stream/stream_outbuf.h>
+#include <avsystem/commons/time.h>
+
+#include "../../src/io_core.h"
+#include "../../src/io/test/bigdata.h"
+
+#include "alloc_counter.h"
+
+#define NUM_ITERATIONS 100
+#define OUT_BUFFER_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+    const char *name;
+    size_t instances;
+    size_t resources;
+    size_t array_entries;
+    const char *value;
+} scenario_t;
+
+static const scenario_t SCENARIOS[] = {
+    { "small values, 100 instances", 100, 10, 0, "42" },
+    { "multiple resources, 50 instances", 50, 4, 25, "42" },
+    { "1 kB values, 20 instances", 20, 10, 0, DATA1kB },
+    { "100 kB values, 4 instances", 4, 2, 4, DATA100kB },
+};
+
+static int encode_object(avs_stream_abstract_t *stream,
+                         const scenario_t *scenario) {
+    anjay_output_ctx_t *out = _anjay_output_raw_tlv_create(stream);
+    if (!out) {
+        return -1;
+    }
+    int result = 0;
+    for (size_t i = 0; !result && i < scenario->instances; ++i) {
+        anjay_output_ctx_t *instance = NULL;
+        if ((result = _anjay_output_set_id(out, ANJAY_ID_IID, (uint16_t) i))
+                || !(instance = _anjay_output_object_start(out))) {
+            result = -1;
+            break;
+        }
+        for (size_t j = 0; !result && j < scenario->resources; ++j) {
+            if ((result = _anjay_output_set_id(instance, ANJAY_ID_RID,
+                                               (uint16_t) j))) {
+                break;
+            }
+            if (!scenario->array_entries) {
+                result = anjay_ret_string(instance, scenario->value);
+                continue;
+            }
+            anjay_output_ctx_t *array = anjay_ret_array_start(instance);
+            if (!array) {
+                result = -1;
+                break;
+            }
+            for (size_t k = 0; !result && k < scenario->array_entries; ++k) {
+                if (!(result = anjay_ret_array_index(array, (anjay_riid_t) k))) {
+                    result = anjay_ret_string(array, scenario->value);
+                }
+            }
+            if (!result) {
+                result = anjay_ret_array_finish(array);
+            }
+        }
+        if (!result) {
+            result = _anjay_output_object_finish(instance);
+        }
+    }
+    if (_anjay_output_ctx_destroy(&out)) {
+        result = -1;
+    }
+    return result;
+}
+
+static int run_scenario(const scenario_t *scenario, char *buffer) {
+    size_t encoded_size = 0;
+    size_t allocs_before = alloc_count();
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&outbuf, buffer, OUT_BUFFER_SIZE);
+        if (encode_object((avs_stream_abstract_t *) &outbuf, scenario)) {
+            fprintf(stderr, "could not encode: %s\n", scenario->name);
+            return -1;
+        }
+        encoded_size = avs_stream_outbuf_offset(&outbuf);
+    }
+    avs_time_duration_t elapsed =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start);
+    size_t allocs = alloc_count() - allocs_before;
+
+    int64_t elapsed_us;
+    avs_time_duration_to_scalar(&elapsed_us, AVS_TIME_US, elapsed);
+    double mb_per_s = elapsed_us > 0
+            ? (double) (encoded_size * NUM_ITERATIONS) / (double) elapsed_us
+            : 0.0;
+    printf("%-36s %9lu B %10.2f MB/s", scenario->name,
+           (unsigned long) encoded_size, mb_per_s);
+    if (alloc_counting_enabled()) {
+        printf(" %10.1f allocs/response",
+               (double) allocs / NUM_ITERATIONS);
+    }
+    printf("\n");
+    return 0;
+}
+
+int main(void) {
+    char *buffer = (char *) malloc(OUT_BUFFER_SIZE);
+    if (!buffer) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("TLV encoder benchmark, %d iterations per scenario\n",
+           NUM_ITERATIONS);
+    int result = 0;
+    for (size_t i = 0; !result && i < sizeof(SCENARIOS) / sizeof(*SCENARIOS);
+            ++i) {
+        result = run_scenario(&SCENARIOS[i], buffer);
+    }
+
+    free(buffer);
+    return result ? 1 : 0;
+}
@@ -224,3 +224,36 @@ class MultipleBootstrapSecurityInstancesNotAllowed(test_suite.Lwm2mTest):
         self.bootstrap_server.send(req)
         self.assertMsgEqual(Lwm2mErrorResponse.matching(req)(code=coap.Code.RES_BAD_REQUEST),
                             self.bootstrap_server.recv(timeout_s=2))
+
+
+class ClientBootstrapAfterRegisterFailure(test_suite.Lwm2mSingleServerTest):
+    def setUp(self):
+        self.setup_demo_with_servers(servers=1,
+                                     bootstrap_server=True,
+                                     extra_cmdline_args=['--bootstrap-holdoff', '3'],
+                                     auto_register=False)
+
+    def tearDown(self):
+        self.teardown_demo_with_servers(auto_deregister=False)
+
+    def runTest(self):
+        pkt = self.serv.recv()
+        self.assertMsgEqual(
+            Lwm2mRegister('/rd?lwm2m=%s&ep=%s&lt=86400' % (DEMO_LWM2M_VERSION, DEMO_ENDPOINT_NAME)),
+            pkt)
+
+        # the server is not served before it accepts the Register
+        req = Lwm2mRead('/3/0/0')
+        self.serv.send(req)
+        self.assertMsgEqual(Lwm2mErrorResponse.matching(req)(code=coap.Code.RES_SERVICE_UNAVAILABLE,
+                                                             options=ANY),
+                            self.serv.recv())
+
+        self.serv.send(Lwm2mErrorResponse.matching(pkt)(code=coap.Code.RES_FORBIDDEN))
+
+        # the client is not registered to any server, so it should fall back
+        # to Client Initiated Bootstrap once the Hold Off Time elapses
+        pkt = self.bootstrap_server.recv(timeout_s=5)
+        self.assertMsgEqual(Lwm2mRequestBootstrap(endpoint_name=DEMO_ENDPOINT_NAME),
+                            pkt)
+        self.bootstrap_server.send(Lwm2mChanged.matching(pkt)())
@@ -64,11 +64,9 @@ class SeparateResponseTest(test_suite.Lwm2mSingleServerTest):
 
         self.serv.send(invalid_req)
 
-        # it should trigger a Service Not Available response
-        self.assertMsgEqual(
-                Lwm2mErrorResponse.matching(invalid_req)(code=coap.Code.RES_SERVICE_UNAVAILABLE,
-                                                         options=ANY),
-                self.serv.recv(timeout_s=1))
+        # it should be rejected, as it does not match the pending Update
+        self.assertMsgEqual(Lwm2mReset.matching(invalid_req)(),
+                            self.serv.recv(timeout_s=1))
 
         # Separate Response: actual response
         req = Lwm2mChanged(msg_id=next(msg_id_generator),